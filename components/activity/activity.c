@@ -1,5 +1,25 @@
 #include "activity.h"
+#include <stdio.h>
 #include <string.h>
+#include <sys/stat.h>
+#include "timebase.h"
+#include "sdkconfig.h"
+
+#if CONFIG_ACTIVITY_STATS_CYCLES
+#include "esp_cpu.h"
+#include "esp_log.h"
+#include "activity_ref.h"
+
+static const char *TAG = "activity";
+
+/* This session's statistics in CPU cycles, next to the former double
+ * update fed the same samples. One session records at a time. */
+static struct {
+    activity_ref_t ref;
+    uint64_t update, refresh, former;
+    uint32_t samples, reads;
+} s_cyc;
+#endif
 
 void activity_init(activity_t *a, uint32_t id) {
     if (!a) return;
@@ -8,49 +28,182 @@ void activity_init(activity_t *a, uint32_t id) {
     a->state = ACTIVITY_STATE_IDLE;
 }
 
-esp_err_t activity_start(activity_t *a, time_t start_ts) {
+esp_err_t activity_start(activity_t *a, int64_t start_utc_us) {
     if (!a) return ESP_ERR_INVALID_ARG;
     uint32_t id = a->id;
     memset(a, 0, sizeof(*a));
     a->id = id;
-    a->start_ts = (start_ts == 0) ? time(NULL) : start_ts;
+    a->start_utc_us = (start_utc_us == 0) ? timebase_now_utc_us() : start_utc_us;
+    a->start_ts = (time_t)(a->start_utc_us / 1000000);
     a->state = ACTIVITY_STATE_RECORDING;
+#if CONFIG_ACTIVITY_STATS_CYCLES
+    memset(&s_cyc, 0, sizeof(s_cyc));
+#endif
     return ESP_OK;
 }
 
-esp_err_t activity_update(activity_t *a, float dt_s, float speed_mps, float spm, float power_w, float distance_delta_m, uint32_t stroke_delta) {
+esp_err_t activity_update(activity_t *a, int64_t dt_us, float speed_mps, float spm, float power_w, float distance_delta_m, uint32_t stroke_delta) {
     if (!a || a->state != ACTIVITY_STATE_RECORDING) return ESP_ERR_INVALID_STATE;
+#if CONFIG_ACTIVITY_STATS_CYCLES
+    const int64_t dt_in_us = dt_us;
+    const uint32_t c0 = esp_cpu_get_cycle_count();
+#endif
+
+    if (dt_us < 0) dt_us = 0;
+    if (dt_us > INT32_MAX) dt_us = INT32_MAX;
 
-    if (dt_s < 0) dt_s = 0;
-    
     // Totals
     a->distance_m += distance_delta_m;
     a->stroke_count += stroke_delta;
-    a->total_dt += dt_s;
-    a->duration_ms = (uint32_t)(a->total_dt * 1000);
-
-    // Accumulators for averages
-    a->sum_speed_dt += speed_mps * dt_s;
-    a->sum_spm_dt += spm * dt_s;
-    a->sum_power_dt += power_w * dt_s;
-
-    // Recompute Averages
-    if (a->total_dt > 0.001f) {
-        a->avg_speed_mps = (float)(a->sum_speed_dt / a->total_dt);
-        a->avg_spm       = (float)(a->sum_spm_dt   / a->total_dt);
-        a->avg_power_w   = (float)(a->sum_power_dt / a->total_dt);
-    }
-    
+    a->total_us += dt_us;
+
+    // Accumulators for averages; the averages themselves are computed on read
+    activity_acc_add(&a->acc, (int32_t)dt_us, speed_mps, spm, power_w);
+    a->stats_dirty = true;
+
     // Update Max
     if (speed_mps > a->max_speed_mps) a->max_speed_mps = speed_mps;
     if (spm > a->max_spm) a->max_spm = spm;
-    
+    if (power_w > a->max_power_w) a->max_power_w = power_w;
+
+#if CONFIG_ACTIVITY_STATS_CYCLES
+    const uint32_t c1 = esp_cpu_get_cycle_count();
+    activity_ref_update(&s_cyc.ref, dt_in_us, speed_mps, spm, power_w, distance_delta_m, stroke_delta);
+    s_cyc.update += c1 - c0;
+    s_cyc.former += esp_cpu_get_cycle_count() - c1;
+    s_cyc.samples++;
+#endif
     return ESP_OK;
 }
 
-esp_err_t activity_stop(activity_t *a, time_t end_ts) {
+void activity_refresh_stats(activity_t *a) {
+    if (!a || !a->stats_dirty) return;
+#if CONFIG_ACTIVITY_STATS_CYCLES
+    const uint32_t c0 = esp_cpu_get_cycle_count();
+#endif
+    a->duration_ms = (uint32_t)(a->total_us / 1000);
+    if (a->total_us > 1000) {
+        activity_acc_mean(&a->acc, a->total_us, &a->avg_speed_mps, &a->avg_spm, &a->avg_power_w);
+    }
+    a->stats_dirty = false;
+#if CONFIG_ACTIVITY_STATS_CYCLES
+    s_cyc.refresh += esp_cpu_get_cycle_count() - c0;
+    s_cyc.reads++;
+#endif
+}
+
+float activity_avg_speed_mps(activity_t *a) {
+    activity_refresh_stats(a);
+    return a ? a->avg_speed_mps : 0.0f;
+}
+
+float activity_avg_spm(activity_t *a) {
+    activity_refresh_stats(a);
+    return a ? a->avg_spm : 0.0f;
+}
+
+float activity_avg_power_w(activity_t *a) {
+    activity_refresh_stats(a);
+    return a ? a->avg_power_w : 0.0f;
+}
+
+esp_err_t activity_stop(activity_t *a, int64_t end_utc_us) {
     if (!a || a->state != ACTIVITY_STATE_RECORDING) return ESP_ERR_INVALID_STATE;
-    a->end_ts = (end_ts == 0) ? time(NULL) : end_ts;
+    activity_refresh_stats(a);
+#if CONFIG_ACTIVITY_STATS_CYCLES
+    if (s_cyc.samples) {
+        // Per sample, the fixed-point side pays for its reads too
+        const double n = (double)s_cyc.samples;
+        const double fixed = (double)(s_cyc.update + s_cyc.refresh) / n;
+        const double former = (double)s_cyc.former / n;
+        ESP_LOGI(TAG, "stats: %lu samples, %lu reads: fixed %.1f cycles/sample (update %.1f, %.1f per read), "
+                 "former double %.1f cycles/sample (%.1fx); avg speed %.3f vs %.3f m/s",
+                 (unsigned long)s_cyc.samples, (unsigned long)s_cyc.reads, fixed, (double)s_cyc.update / n,
+                 s_cyc.reads ? (double)s_cyc.refresh / s_cyc.reads : 0.0, former, fixed > 0 ? former / fixed : 0.0,
+                 (double)a->avg_speed_mps, (double)s_cyc.ref.avg_speed_mps);
+    }
+#endif
+    a->end_utc_us = (end_utc_us == 0) ? timebase_now_utc_us() : end_utc_us;
+    a->end_ts = (time_t)(a->end_utc_us / 1000000);
     a->state = ACTIVITY_STATE_STOPPED;
     return ESP_OK;
-}
\ No newline at end of file
+}
+
+esp_err_t activity_to_json(const activity_t *a, char *buf, size_t buf_len) {
+    if (!a || !buf || buf_len == 0) return ESP_ERR_INVALID_ARG;
+
+    int n = snprintf(buf, buf_len,
+                     "{\"id\":%lu,\"start_utc_us\":%lld,\"end_utc_us\":%lld,\"duration_ms\":%lu,"
+                     "\"distance_m\":%.1f,\"stroke_count\":%lu,"
+                     "\"avg_speed_mps\":%.3f,\"max_speed_mps\":%.3f,\"avg_spm\":%.1f,\"max_spm\":%.1f,"
+                     "\"avg_power_w\":%.1f,\"max_power_w\":%.1f",
+                     (unsigned long)a->id, (long long)a->start_utc_us, (long long)a->end_utc_us,
+                     (unsigned long)a->duration_ms, (double)a->distance_m, (unsigned long)a->stroke_count,
+                     (double)a->avg_speed_mps, (double)a->max_speed_mps, (double)a->avg_spm, (double)a->max_spm,
+                     (double)a->avg_power_w, (double)a->max_power_w);
+
+    for (int i = 0; i < BEST_EFFORT_COUNT && n > 0 && (size_t)n < buf_len; i++) {
+        const best_effort_target_t *t = &best_effort_targets[i];
+        n += snprintf(buf + n, buf_len - n, ",\"best_%s_%s\":%.1f", t->name, t->is_time ? "m" : "s",
+                      (double)a->best_effort[i]);
+    }
+    if (n > 0 && (size_t)n < buf_len) n += snprintf(buf + n, buf_len - n, "}");
+    return (n > 0 && (size_t)n < buf_len) ? ESP_OK : ESP_ERR_INVALID_SIZE;
+}
+
+#define ACTIVITY_CSV_HEADER \
+    "id,start_utc_s,end_utc_s,duration_s,distance_m,stroke_count," \
+    "avg_speed_mps,max_speed_mps,avg_spm,max_spm,avg_power_w,max_power_w," \
+    "best_500m_s,best_1k_s,best_2k_s,best_1min_m\n"
+
+esp_err_t activity_to_csv_row(const activity_t *a, char *buf, size_t buf_len) {
+    if (!a || !buf || buf_len == 0) return ESP_ERR_INVALID_ARG;
+
+    int n = snprintf(buf, buf_len, "%lu,%lld,%lld,%.1f,%.1f,%lu,%.3f,%.3f,%.1f,%.1f,%.1f,%.1f",
+                     (unsigned long)a->id, (long long)(a->start_utc_us / 1000000),
+                     (long long)(a->end_utc_us / 1000000), (double)a->duration_ms * 1e-3,
+                     (double)a->distance_m, (unsigned long)a->stroke_count,
+                     (double)a->avg_speed_mps, (double)a->max_speed_mps, (double)a->avg_spm, (double)a->max_spm,
+                     (double)a->avg_power_w, (double)a->max_power_w);
+
+    for (int i = 0; i < BEST_EFFORT_COUNT && n > 0 && (size_t)n < buf_len; i++) {
+        n += snprintf(buf + n, buf_len - n, ",%.1f", (double)a->best_effort[i]);
+    }
+    return (n > 0 && (size_t)n < buf_len) ? ESP_OK : ESP_ERR_INVALID_SIZE;
+}
+
+esp_err_t activity_save_to_sd(sd_mmc_helper_t *sd, const activity_t *a, bool append_index_csv) {
+    if (!sd || !a) return ESP_ERR_INVALID_ARG;
+    if (!sd->mounted) return ESP_ERR_INVALID_STATE;
+
+    char path[128];
+    snprintf(path, sizeof(path), "%s/activities", sd->mount_point);
+    mkdir(path, 0775);
+
+    char buf[512];
+    esp_err_t err = activity_to_json(a, buf, sizeof(buf));
+    if (err != ESP_OK) return err;
+
+    snprintf(path, sizeof(path), "%s/activities/activity_%lu.json", sd->mount_point, (unsigned long)a->id);
+    FILE *f = fopen(path, "w");
+    if (!f) return ESP_FAIL;
+    fputs(buf, f);
+    fputc('\n', f);
+    fclose(f);
+
+    if (!append_index_csv) return ESP_OK;
+
+    err = activity_to_csv_row(a, buf, sizeof(buf));
+    if (err != ESP_OK) return err;
+
+    snprintf(path, sizeof(path), "%s/activities/index.csv", sd->mount_point);
+    struct stat st;
+    bool fresh = (stat(path, &st) != 0 || st.st_size == 0);
+    f = fopen(path, "a");
+    if (!f) return ESP_FAIL;
+    if (fresh) fputs(ACTIVITY_CSV_HEADER, f);
+    fputs(buf, f);
+    fputc('\n', f);
+    fclose(f);
+    return ESP_OK;
+}
@@ -0,0 +1,42 @@
+// components/activity/activity_acc.c
+#include "activity_acc.h"
+
+#define FIXED_LIMIT 2147483520.0f     // largest float below 2^31
+
+/* v * scale rounded to int32; 0 for negative values and NaN, saturating at the top. */
+static int32_t to_fixed(float v, float scale)
+{
+    float s = v * scale;
+    if (!(s > 0.0f))
+        return 0;
+    if (s >= FIXED_LIMIT)
+        return INT32_MAX;
+
+    // Ties to even: values one bit finer than the scale land on .5 exactly,
+    // and always rounding those up would bias the sums
+    int32_t r = (int32_t)s;
+    float f = s - (float)r;
+    return r + ((f > 0.5f) | ((f == 0.5f) & r));
+}
+
+void activity_acc_add(activity_acc_t *acc, int32_t dt_us, float speed_mps, float spm, float power_w)
+{
+    acc->speed_dt += (int64_t)to_fixed(speed_mps, ACTIVITY_ACC_SPEED_SCALE) * dt_us;
+    acc->spm_dt += (int64_t)to_fixed(spm, ACTIVITY_ACC_SPM_SCALE) * dt_us;
+    acc->power_dt += (int64_t)to_fixed(power_w, ACTIVITY_ACC_POWER_SCALE) * dt_us;
+}
+
+void activity_acc_mean(const activity_acc_t *acc, int64_t total_us,
+                       float *speed_mps, float *spm, float *power_w)
+{
+    if (total_us <= 1000) {
+        *speed_mps = *spm = *power_w = 0;
+        return;
+    }
+
+    // A few double divisions at the read rate, never per sample
+    const double t = (double)total_us;
+    *speed_mps = (float)((double)acc->speed_dt / t / (double)ACTIVITY_ACC_SPEED_SCALE);
+    *spm = (float)((double)acc->spm_dt / t / (double)ACTIVITY_ACC_SPM_SCALE);
+    *power_w = (float)((double)acc->power_dt / t / (double)ACTIVITY_ACC_POWER_SCALE);
+}
@@ -0,0 +1,493 @@
+// components/activity/activity_index.c
+#include "activity_index.h"
+
+#include <dirent.h>
+#include <fcntl.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "esp_log.h"
+#include "sdkconfig.h"
+#include "activity_log.h"
+#include "best_effort.h"
+
+static const char *TAG = "activity_index";
+
+_Static_assert(sizeof(activity_index_hdr_t) == ACTIVITY_INDEX_HDR_SIZE, "index header size");
+_Static_assert(sizeof(activity_index_rec_t) == ACTIVITY_INDEX_REC_SIZE, "index record size");
+
+static int s_fd = -1;
+static activity_index_hdr_t s_hdr;
+static char s_dir[64];              // "<mount>/activities"
+
+/* -------------------------------------------------------------------------- */
+/* File                                                                       */
+/* -------------------------------------------------------------------------- */
+
+static uint32_t hdr_crc(const activity_index_hdr_t *h)
+{
+    return alog_crc32(0, h, offsetof(activity_index_hdr_t, crc));
+}
+
+static uint32_t rec_crc(const activity_index_rec_t *r)
+{
+    return alog_crc32(0, r, offsetof(activity_index_rec_t, crc));
+}
+
+static off_t rec_offset(uint32_t i)
+{
+    return (off_t)ACTIVITY_INDEX_HDR_SIZE + (off_t)i * ACTIVITY_INDEX_REC_SIZE;
+}
+
+static void hdr_init(activity_index_hdr_t *h, uint32_t count, uint32_t next_id)
+{
+    memset(h, 0, sizeof(*h));
+    memcpy(h->magic, ACTIVITY_INDEX_MAGIC, 4);
+    h->version = ACTIVITY_INDEX_VERSION;
+    h->header_size = ACTIVITY_INDEX_HDR_SIZE;
+    h->record_size = ACTIVITY_INDEX_REC_SIZE;
+    h->count = count;
+    h->next_id = next_id;
+}
+
+static bool hdr_valid(const activity_index_hdr_t *h)
+{
+    return memcmp(h->magic, ACTIVITY_INDEX_MAGIC, 4) == 0 && h->version == ACTIVITY_INDEX_VERSION &&
+           h->header_size == ACTIVITY_INDEX_HDR_SIZE && h->record_size == ACTIVITY_INDEX_REC_SIZE &&
+           h->crc == hdr_crc(h);
+}
+
+static esp_err_t write_at(int fd, off_t off, const void *buf, size_t len)
+{
+    if (lseek(fd, off, SEEK_SET) != off || write(fd, buf, len) != (ssize_t)len)
+        return ESP_FAIL;
+    return ESP_OK;
+}
+
+static bool read_rec(uint32_t i, activity_index_rec_t *r)
+{
+    return lseek(s_fd, rec_offset(i), SEEK_SET) == rec_offset(i) &&
+           read(s_fd, r, sizeof(*r)) == (ssize_t)sizeof(*r) && r->crc == rec_crc(r);
+}
+
+static esp_err_t write_hdr(void)
+{
+    s_hdr.crc = hdr_crc(&s_hdr);
+    if (write_at(s_fd, 0, &s_hdr, sizeof(s_hdr)) != ESP_OK)
+        return ESP_FAIL;
+    return (fsync(s_fd) == 0) ? ESP_OK : ESP_FAIL;
+}
+
+/* -------------------------------------------------------------------------- */
+/* Summaries                                                                  */
+/* -------------------------------------------------------------------------- */
+
+static void rec_from_activity(activity_index_rec_t *r, const activity_t *a, const char *base, uint32_t flags)
+{
+    memset(r, 0, sizeof(*r));
+    r->id = a->id;
+    r->flags = flags;
+    r->start_utc_us = a->start_utc_us;
+    r->end_utc_us = a->end_utc_us;
+    r->duration_ms = a->duration_ms;
+    r->stroke_count = a->stroke_count;
+    r->distance_m = a->distance_m;
+    r->avg_speed_mps = a->avg_speed_mps;
+    r->max_speed_mps = a->max_speed_mps;
+    r->avg_spm = a->avg_spm;
+    r->max_spm = a->max_spm;
+    r->avg_power_w = a->avg_power_w;
+    r->max_power_w = a->max_power_w;
+    memcpy(r->best_effort, a->best_effort, sizeof(r->best_effort));
+    snprintf(r->base, sizeof(r->base), "%s", base ? base : "");
+    r->crc = rec_crc(r);
+}
+
+/* Running totals over the rows of one stroke log. */
+typedef struct {
+    uint32_t rows;
+    double   power_sum;
+    activity_log_row_t last;
+    activity_index_rec_t *r;
+    best_effort_t *be;          // reset per log; the stroke rows are its input
+} log_scan_t;
+
+static void scan_row(log_scan_t *s, const activity_log_row_t *row)
+{
+    activity_index_rec_t *r = s->r;
+    float speed = (row->pace_500m_s > 0) ? 500.0f / row->pace_500m_s : 0;
+    if (speed > r->max_speed_mps) r->max_speed_mps = speed;
+    if (row->spm_instant > r->max_spm) r->max_spm = row->spm_instant;
+    if (row->power_w > r->max_power_w) r->max_power_w = row->power_w;
+    s->power_sum += row->power_w;
+    best_effort_update(s->be, row->session_time_us, row->total_distance_m);
+    s->last = *row;
+    s->rows++;
+}
+
+static void scan_finish(log_scan_t *s)
+{
+    activity_index_rec_t *r = s->r;
+    if (s->rows == 0) return;
+
+    double secs = (double)s->last.session_time_us * 1e-6;
+    r->end_utc_us = s->last.utc_us;
+    r->duration_ms = (uint32_t)(s->last.session_time_us / 1000);
+    r->stroke_count = s->last.stroke_count;
+    r->distance_m = s->last.total_distance_m;
+    r->avg_speed_mps = (secs > 0) ? (float)(r->distance_m / secs) : 0;
+    r->avg_spm = (secs > 0) ? (float)(r->stroke_count * 60.0 / secs) : 0;
+    r->avg_power_w = (float)(s->power_sum / s->rows);
+
+    best_effort_finish(s->be);
+    best_effort_get(s->be, r->best_effort);
+}
+
+static bool summarise_bin(const char *path, activity_index_rec_t *r, best_effort_t *be)
+{
+    FILE *f = fopen(path, "rb");
+    if (!f) return false;
+
+    uint8_t *buf = malloc(ALOG_BIN_BLOCK_SIZE);
+    alog_bin_file_hdr_t hdr;
+    size_t n = buf ? fread(buf, 1, ALOG_BIN_HEADER_SIZE, f) : 0;
+    if (!buf || !alog_bin_parse_header(buf, n, &hdr)) {
+        free(buf);
+        fclose(f);
+        return false;
+    }
+
+    r->id = hdr.session_id;
+    r->start_utc_us = hdr.start_utc_us;
+
+    best_effort_reset(be);
+    log_scan_t s = { .r = r, .be = be };
+    alog_bin_unpack_state_t st = {0};
+    for (uint32_t seq = 0;; seq++) {
+        if (fseek(f, alog_bin_block_offset(seq), SEEK_SET) != 0) break;
+        n = fread(buf, 1, ALOG_BIN_BLOCK_SIZE, f);
+        if (n == 0) break;
+
+        int count = alog_bin_check_block(buf, n, seq);
+        if (count < 0) continue;
+
+        const alog_bin_record_t *recs = alog_bin_block_records(buf);
+        for (int i = 0; i < count; i++) {
+            activity_log_row_t row;
+            alog_bin_unpack(&hdr, &recs[i], &st, &row);
+            scan_row(&s, &row);
+        }
+    }
+    scan_finish(&s);
+
+    free(buf);
+    fclose(f);
+    return true;
+}
+
+static bool summarise_csv(const char *path, activity_index_rec_t *r, best_effort_t *be)
+{
+    FILE *f = fopen(path, "r");
+    if (!f) return false;
+
+    best_effort_reset(be);
+    log_scan_t s = { .r = r, .be = be };
+    char line[256];
+    bool first = true;
+    while (fgets(line, sizeof(line), f)) {
+        struct tm tm = {0};
+        int ms, sh, sm, ss, sms;
+        char pace[16], avg_pace[16];
+        unsigned long count;
+        activity_log_row_t row = {0};
+
+        // Global Time,Session Time,Distance,Pace,SPM,Avg Pace,Avg Speed,Stroke Length,Stroke Count,lat,lon,Power
+        int got = sscanf(line, "%d-%d-%d %d:%d:%d.%d,%d:%d:%d.%d,%f,%15[^,],%f,%15[^,],%f,%f,%lu,%lf,%lf,%f",
+                         &tm.tm_year, &tm.tm_mon, &tm.tm_mday, &tm.tm_hour, &tm.tm_min, &tm.tm_sec, &ms,
+                         &sh, &sm, &ss, &sms, &row.total_distance_m, pace, &row.spm_instant, avg_pace,
+                         &row.avg_speed_mps, &row.stroke_length_m, &count, &row.gps_lat, &row.gps_lon,
+                         &row.power_w);
+        if (got < 18) continue;     // header or damaged line
+
+        tm.tm_year -= 1900;
+        tm.tm_mon -= 1;
+        tm.tm_isdst = -1;
+        row.utc_us = (int64_t)mktime(&tm) * 1000000LL + ms * 1000LL;   // written in the device's TZ
+        row.session_time_us = (((int64_t)sh * 3600 + sm * 60 + ss) * 1000LL + sms) * 1000LL;
+        row.stroke_count = (uint32_t)count;
+
+        int pm;
+        float psec;
+        if (sscanf(pace, "%d:%f", &pm, &psec) == 2) row.pace_500m_s = pm * 60.0f + psec;
+
+        if (first) {
+            r->start_utc_us = row.utc_us - row.session_time_us;
+            first = false;
+        }
+        scan_row(&s, &row);
+    }
+    fclose(f);
+    scan_finish(&s);
+    return !first;
+}
+
+/* CSV logs keep the activity id in the splits file only. */
+static uint32_t id_from_splits(const char *base_path)
+{
+    char path[160];
+    snprintf(path, sizeof(path), "%s" ACTIVITY_LOG_SUFFIX_SPLITS, base_path);
+    FILE *f = fopen(path, "r");
+    if (!f) return 0;
+
+    char line[96];
+    unsigned id = 0;
+    for (int i = 0; i < 8 && fgets(line, sizeof(line), f); i++) {
+        if (sscanf(line, "Activity ID,%u", &id) == 1) break;
+    }
+    fclose(f);
+    return id;
+}
+
+static int by_start(const void *a, const void *b)
+{
+    int64_t x = ((const activity_index_rec_t *)a)->start_utc_us;
+    int64_t y = ((const activity_index_rec_t *)b)->start_utc_us;
+    return (x > y) - (x < y);
+}
+
+static bool has_suffix(const char *s, const char *suffix)
+{
+    size_t n = strlen(s), m = strlen(suffix);
+    return n >= m && strcmp(s + n - m, suffix) == 0;
+}
+
+/* -------------------------------------------------------------------------- */
+/* Public API                                                                 */
+/* -------------------------------------------------------------------------- */
+
+esp_err_t activity_index_rebuild(void)
+{
+    if (!s_dir[0]) return ESP_ERR_INVALID_STATE;
+
+    DIR *d = opendir(s_dir);
+    if (!d) return ESP_FAIL;
+
+    size_t n = 0, cap = 32;
+    activity_index_rec_t *recs = malloc(cap * sizeof(*recs));
+    best_effort_point_t *be_pts = malloc(CONFIG_BEST_EFFORT_HISTORY * sizeof(*be_pts));
+    if (!recs || !be_pts) {
+        free(recs);
+        free(be_pts);
+        closedir(d);
+        return ESP_ERR_NO_MEM;
+    }
+    best_effort_t be;
+    best_effort_init(&be, be_pts, CONFIG_BEST_EFFORT_HISTORY);
+
+    struct dirent *e;
+    while ((e = readdir(d)) != NULL) {
+        bool is_bin = has_suffix(e->d_name, ACTIVITY_LOG_SUFFIX_STROKES_BIN);
+        if (!is_bin && !has_suffix(e->d_name, ACTIVITY_LOG_SUFFIX_STROKES_CSV)) continue;
+        const char *suffix = is_bin ? ACTIVITY_LOG_SUFFIX_STROKES_BIN : ACTIVITY_LOG_SUFFIX_STROKES_CSV;
+
+        if (n == cap) {
+            activity_index_rec_t *grown = realloc(recs, 2 * cap * sizeof(*recs));
+            if (!grown) break;
+            recs = grown;
+            cap *= 2;
+        }
+
+        int name_len = (int)(strlen(e->d_name) - strlen(suffix));
+        char path[160], base_path[160];
+        snprintf(path, sizeof(path), "%s/%s", s_dir, e->d_name);
+        snprintf(base_path, sizeof(base_path), "%s/%.*s", s_dir, name_len, e->d_name);
+
+        activity_index_rec_t *r = &recs[n];
+        memset(r, 0, sizeof(*r));
+        bool ok = is_bin ? summarise_bin(path, r, &be) : summarise_csv(path, r, &be);
+        if (!ok) {
+            ESP_LOGW(TAG, "rebuild: skipping unreadable %s", e->d_name);
+            continue;
+        }
+        if (r->id == 0) r->id = id_from_splits(base_path);
+
+        r->flags = ACTIVITY_INDEX_F_REBUILT;
+        snprintf(r->base, sizeof(r->base), "activities/%.*s", name_len, e->d_name);
+        r->crc = rec_crc(r);
+        n++;
+    }
+    closedir(d);
+    free(be_pts);
+
+    qsort(recs, n, sizeof(*recs), by_start);
+    uint32_t next_id = 1;
+    for (size_t i = 0; i < n; i++) {
+        if (recs[i].id >= next_id) next_id = recs[i].id + 1;
+    }
+
+    // Write the new index beside the old one, then swap
+    char path[96], tmp[96];
+    snprintf(path, sizeof(path), "%s/index.bin", s_dir);
+    snprintf(tmp, sizeof(tmp), "%s/index.tmp", s_dir);
+
+    activity_index_hdr_t h;
+    hdr_init(&h, (uint32_t)n, next_id);
+    h.crc = hdr_crc(&h);
+
+    esp_err_t err = ESP_FAIL;
+    int fd = open(tmp, O_WRONLY | O_CREAT | O_TRUNC, 0664);
+    if (fd >= 0) {
+        size_t len = n * sizeof(*recs);
+        if (write(fd, &h, sizeof(h)) == (ssize_t)sizeof(h) &&
+            (len == 0 || write(fd, recs, len) == (ssize_t)len) && fsync(fd) == 0)
+            err = ESP_OK;
+        close(fd);
+    }
+    free(recs);
+
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "rebuild: write %s failed", tmp);
+        unlink(tmp);
+        return err;
+    }
+
+    if (s_fd >= 0) {
+        close(s_fd);
+        s_fd = -1;
+    }
+    unlink(path);                   // FAT rename does not replace
+    if (rename(tmp, path) != 0) {
+        ESP_LOGE(TAG, "rebuild: rename failed");
+        return ESP_FAIL;
+    }
+
+    s_fd = open(path, O_RDWR);
+    if (s_fd < 0) return ESP_FAIL;
+    s_hdr = h;
+
+    ESP_LOGW(TAG, "Rebuilt index: %u sessions, next id %lu", (unsigned)n, (unsigned long)next_id);
+    return ESP_OK;
+}
+
+esp_err_t activity_index_open(const char *mount_point)
+{
+    if (!mount_point) return ESP_ERR_INVALID_ARG;
+    if (s_fd >= 0) return ESP_OK;
+
+    snprintf(s_dir, sizeof(s_dir), "%s/activities", mount_point);
+    mkdir(s_dir, 0775);
+
+    char path[96];
+    snprintf(path, sizeof(path), "%s/index.bin", s_dir);
+    s_fd = open(path, O_RDWR | O_CREAT, 0664);
+    if (s_fd < 0) {
+        ESP_LOGE(TAG, "open %s failed", path);
+        return ESP_FAIL;
+    }
+
+    off_t size = lseek(s_fd, 0, SEEK_END);
+    if (size < (off_t)sizeof(s_hdr) || lseek(s_fd, 0, SEEK_SET) != 0 ||
+        read(s_fd, &s_hdr, sizeof(s_hdr)) != (ssize_t)sizeof(s_hdr) || !hdr_valid(&s_hdr)) {
+        // New card, first boot with an index, or a damaged header
+        return activity_index_rebuild();
+    }
+
+    // Settle the count against what is actually in the file
+    uint32_t in_file = (uint32_t)((size - ACTIVITY_INDEX_HDR_SIZE) / ACTIVITY_INDEX_REC_SIZE);
+    activity_index_rec_t r;
+    bool dirty = false;
+    while (s_hdr.count < in_file && read_rec(s_hdr.count, &r)) {
+        // Appended, but the header update did not make it
+        s_hdr.count++;
+        if (r.id >= s_hdr.next_id) s_hdr.next_id = r.id + 1;
+        dirty = true;
+    }
+    if (s_hdr.count > in_file || (s_hdr.count > 0 && !read_rec(s_hdr.count - 1, &r))) {
+        ESP_LOGW(TAG, "index records damaged");
+        return activity_index_rebuild();
+    }
+    if (dirty) write_hdr();
+    if (in_file > s_hdr.count) ftruncate(s_fd, rec_offset(s_hdr.count));
+
+    ESP_LOGI(TAG, "Index: %lu sessions, next id %lu", (unsigned long)s_hdr.count, (unsigned long)s_hdr.next_id);
+    return ESP_OK;
+}
+
+void activity_index_close(void)
+{
+    if (s_fd >= 0) close(s_fd);
+    s_fd = -1;
+}
+
+uint32_t activity_index_count(void)
+{
+    return (s_fd >= 0) ? s_hdr.count : 0;
+}
+
+uint32_t activity_index_next_id(void)
+{
+    return (s_fd >= 0 && s_hdr.next_id > 0) ? s_hdr.next_id : 1;
+}
+
+esp_err_t activity_index_append(const activity_t *a, const char *base, uint32_t flags)
+{
+    if (!a) return ESP_ERR_INVALID_ARG;
+    if (s_fd < 0) return ESP_ERR_INVALID_STATE;
+
+    activity_index_rec_t r;
+    rec_from_activity(&r, a, base, flags);
+
+    // A rebuild at boot may already have summarised the session journal
+    // recovery is closing; the live summary replaces it instead of doubling it
+    uint32_t slot = s_hdr.count;
+    activity_index_rec_t last;
+    if (slot > 0 && read_rec(slot - 1, &last) && last.id == a->id) slot--;
+
+    // Record first: if the header write is lost, open() still finds it
+    if (write_at(s_fd, rec_offset(slot), &r, sizeof(r)) != ESP_OK || fsync(s_fd) != 0) {
+        ESP_LOGE(TAG, "append failed");
+        return ESP_FAIL;
+    }
+
+    s_hdr.count = slot + 1;
+    if (a->id >= s_hdr.next_id) s_hdr.next_id = a->id + 1;
+    return write_hdr();
+}
+
+esp_err_t activity_index_get(uint32_t i, activity_index_rec_t *out)
+{
+    if (!out) return ESP_ERR_INVALID_ARG;
+    if (s_fd < 0) return ESP_ERR_INVALID_STATE;
+    if (i >= s_hdr.count) return ESP_ERR_NOT_FOUND;
+    return read_rec(i, out) ? ESP_OK : ESP_ERR_INVALID_CRC;
+}
+
+int activity_index_latest(activity_index_rec_t *out, int max)
+{
+    if (!out || max <= 0 || s_fd < 0) return 0;
+
+    uint32_t n = (s_hdr.count < (uint32_t)max) ? s_hdr.count : (uint32_t)max;
+    if (n == 0) return 0;
+
+    // One read for the whole tail, then flip it to newest first
+    off_t off = rec_offset(s_hdr.count - n);
+    ssize_t len = (ssize_t)(n * sizeof(*out));
+    if (lseek(s_fd, off, SEEK_SET) != off || read(s_fd, out, (size_t)len) != len) return 0;
+
+    for (uint32_t i = 0; i < n / 2; i++) {
+        activity_index_rec_t t = out[i];
+        out[i] = out[n - 1 - i];
+        out[n - 1 - i] = t;
+    }
+
+    int good = 0;
+    for (uint32_t i = 0; i < n; i++) {
+        if (out[i].crc == rec_crc(&out[i])) out[good++] = out[i];
+    }
+    return good;
+}
@@ -0,0 +1,29 @@
+// components/activity/activity_ref.c
+#include "activity_ref.h"
+
+void activity_ref_update(activity_ref_t *a, int64_t dt_us, float speed_mps, float spm, float power_w,
+                         float distance_delta_m, uint32_t stroke_delta)
+{
+    if (dt_us < 0) dt_us = 0;
+    const double dt_s = (double)dt_us * 1e-6;
+
+    a->distance_m += distance_delta_m;
+    a->stroke_count += stroke_delta;
+    a->total_us += dt_us;
+    a->duration_ms = (uint32_t)(a->total_us / 1000);
+
+    a->sum_speed_dt += speed_mps * dt_s;
+    a->sum_spm_dt += spm * dt_s;
+    a->sum_power_dt += power_w * dt_s;
+
+    if (a->total_us > 1000) {
+        const double total_s = (double)a->total_us * 1e-6;
+        a->avg_speed_mps = (float)(a->sum_speed_dt / total_s);
+        a->avg_spm = (float)(a->sum_spm_dt / total_s);
+        a->avg_power_w = (float)(a->sum_power_dt / total_s);
+    }
+
+    if (speed_mps > a->max_speed_mps) a->max_speed_mps = speed_mps;
+    if (spm > a->max_spm) a->max_spm = spm;
+    if (power_w > a->max_power_w) a->max_power_w = power_w;
+}
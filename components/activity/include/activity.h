@@ -6,6 +6,8 @@
 
 #include "esp_err.h"
 #include "sd_mmc_helper.h"
+#include "activity_acc.h"
+#include "best_effort.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -28,13 +30,17 @@ typedef struct {
     // Time
     time_t   start_ts;        // epoch seconds
     time_t   end_ts;          // epoch seconds
-    uint32_t duration_ms;     // derived from updates or end-start
+    int64_t  start_utc_us;    // timebase UTC, microseconds
+    int64_t  end_utc_us;
+    uint32_t duration_ms;     // derived from updates (see activity_refresh_stats)
 
     // Totals
     float    distance_m;
     uint32_t stroke_count;
 
-    // Stats
+    // Stats. avg_* and duration_ms are cached: they are brought up to date by
+    // activity_refresh_stats(), the avg getters and activity_stop(), not by
+    // every activity_update(). max_* are always current.
     float    avg_speed_mps;
     float    max_speed_mps;
 
@@ -44,12 +50,16 @@ typedef struct {
     float    avg_power_w;
     float    max_power_w;
 
+    // Best efforts, indexed by best_effort_id_t: seconds for the distance
+    // targets, meters for the time ones, 0 until reached. Filled by the
+    // caller from its best_effort_t tracker.
+    float    best_effort[BEST_EFFORT_COUNT];
+
     // Internal accumulators (don’t edit directly)
     activity_state_t state;
-    double   sum_speed_dt;    // speed * dt
-    double   sum_spm_dt;      // spm   * dt
-    double   sum_power_dt;    // power * dt
-    double   total_dt;        // seconds
+    bool     stats_dirty;     // accumulators changed since the cached stats
+    activity_acc_t acc;       // time-weighted sums (fixed point)
+    int64_t  total_us;        // sum of update dt, microseconds
 } activity_t;
 
 /**
@@ -58,22 +68,22 @@ typedef struct {
 void activity_init(activity_t *a, uint32_t id);
 
 /**
- * Start a session. If start_ts==0, uses current time(NULL) (requires time set).
+ * Start a session. If start_utc_us==0, uses timebase_now_utc_us().
  * Resets totals/stats and switches to RECORDING state.
  */
-esp_err_t activity_start(activity_t *a, time_t start_ts);
+esp_err_t activity_start(activity_t *a, int64_t start_utc_us);
 
 /**
- * Update activity with a time delta (seconds) and instantaneous metrics.
+ * Update activity with a time delta and instantaneous metrics.
  * Call this every 1–2 strokes (or on a timer).
  *
- * - dt_s: elapsed time since last update
+ * - dt_us: elapsed time since last update, microseconds
  * - speed_mps/spm/power_w: latest measured values
  * - distance_delta_m: distance increment since last update (can be 0 if unknown)
  * - stroke_delta: number of strokes since last update (0/1/2)
  */
 esp_err_t activity_update(activity_t *a,
-                          float dt_s,
+                          int64_t dt_us,
                           float speed_mps,
                           float spm,
                           float power_w,
@@ -81,10 +91,23 @@ esp_err_t activity_update(activity_t *a,
                           uint32_t stroke_delta);
 
 /**
- * Stop a session. If end_ts==0, uses time(NULL).
+ * Stop a session. If end_utc_us==0, uses timebase_now_utc_us().
  * Computes avg stats if not computed yet and switches to STOPPED state.
  */
-esp_err_t activity_stop(activity_t *a, time_t end_ts);
+esp_err_t activity_stop(activity_t *a, int64_t end_utc_us);
+
+/**
+ * Bring avg_* and duration_ms up to date with the accumulators. Cheap when
+ * nothing changed; call it before copying the struct for a summary.
+ */
+void activity_refresh_stats(activity_t *a);
+
+/**
+ * Session averages so far (refreshing the cache if needed).
+ */
+float activity_avg_speed_mps(activity_t *a);
+float activity_avg_spm(activity_t *a);
+float activity_avg_power_w(activity_t *a);
 
 /**
  * Convenience getters.
@@ -94,7 +117,8 @@ static inline bool activity_is_recording(const activity_t *a) {
 }
 
 /**
- * Serialize summary to JSON (single object).
+ * Serialize summary to JSON (single object). Uses the cached stats, so
+ * refresh (or stop) first.
  * buf must be provided by caller.
  */
 esp_err_t activity_to_json(const activity_t *a, char *buf, size_t buf_len);
@@ -0,0 +1,48 @@
+// components/activity/include/activity_acc.h
+#pragma once
+
+/*
+ * Time-weighted sums behind the session averages (speed, SPM, power).
+ *
+ * activity_update() adds one sample per sensor tick (200 Hz), so the sums
+ * are int64 fixed point: each value is scaled by a power of two in float
+ * (exact), converted to int32 and multiplied by dt as int32 x int32 ->
+ * int64. No double maths runs per sample (the ESP32-S3 FPU is single
+ * precision) and the sums never lose resolution as they grow. In the
+ * normal range of each value (speed >= 2 m/s, SPM >= 8, power >= 128 W)
+ * the scaled value is the float itself and the sums are exact; below that
+ * a sample is rounded (ties to even) to the scale step, which moves an
+ * average by well under a float ulp. At the top of the rowing range
+ * (6 m/s, 40 spm) the sums last more than 60 h. The division into
+ * averages happens only on read.
+ *
+ * Plain C only: the host benchmark links this file.
+ */
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define ACTIVITY_ACC_SPEED_SCALE    4194304.0f  // 2^22, saturates at 512 m/s
+#define ACTIVITY_ACC_SPM_SCALE      1048576.0f  // 2^20, saturates at 2048 spm
+#define ACTIVITY_ACC_POWER_SCALE    65536.0f    // 2^16, saturates at 32768 W
+
+typedef struct {
+    int64_t speed_dt;   // speed * scale * dt_us
+    int64_t spm_dt;     // spm   * scale * dt_us
+    int64_t power_dt;   // power * scale * dt_us
+} activity_acc_t;
+
+/* One sample held for dt_us (0..INT32_MAX). Negative values and NaN add
+ * nothing; values past the scale range saturate. */
+void activity_acc_add(activity_acc_t *acc, int32_t dt_us, float speed_mps, float spm, float power_w);
+
+/* Means over total_us (all 0 while total_us <= 1 ms). */
+void activity_acc_mean(const activity_acc_t *acc, int64_t total_us,
+                       float *speed_mps, float *spm, float *power_w);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,93 @@
+// components/activity/include/activity_index.h
+#pragma once
+
+/*
+ * Session history: <mount>/activities/index.bin
+ *
+ *   [activity_index_hdr_t, 64 bytes]
+ *   [activity_index_rec_t, 160 bytes] x count, oldest first
+ *
+ * Appending writes one record at the end and then the header with the new
+ * count, so the cost does not depend on the archive size, and the newest N
+ * sessions are one seek + one read. Every record and the header carry a
+ * CRC. A record written without its header update (power cut in between)
+ * is adopted on the next open; anything unreadable makes open() rebuild
+ * the index from the stroke logs in activities/. So does an index of an
+ * older version: version 2 added the best efforts, which a rebuild works
+ * out again from the logs.
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "esp_err.h"
+#include "activity.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define ACTIVITY_INDEX_MAGIC        "RCAI"
+#define ACTIVITY_INDEX_VERSION      2
+#define ACTIVITY_INDEX_HDR_SIZE     64
+#define ACTIVITY_INDEX_REC_SIZE     160
+#define ACTIVITY_INDEX_BASE_LEN     64
+
+#define ACTIVITY_INDEX_F_RECOVERED  0x01    // closed by journal recovery
+#define ACTIVITY_INDEX_F_REBUILT    0x02    // summarised from the log by a rebuild
+
+typedef struct {
+    char     magic[4];          // ACTIVITY_INDEX_MAGIC
+    uint16_t version;
+    uint16_t header_size;       // ACTIVITY_INDEX_HDR_SIZE
+    uint16_t record_size;       // ACTIVITY_INDEX_REC_SIZE
+    uint16_t reserved0;
+    uint32_t count;             // records in the file
+    uint32_t next_id;           // first unused activity id
+    uint8_t  reserved[40];
+    uint32_t crc;               // crc32 of the bytes above
+} activity_index_hdr_t;
+
+typedef struct {
+    uint32_t id;
+    uint32_t flags;             // ACTIVITY_INDEX_F_*
+    int64_t  start_utc_us;
+    int64_t  end_utc_us;
+    uint32_t duration_ms;
+    uint32_t stroke_count;
+    float    distance_m;
+    float    avg_speed_mps;
+    float    max_speed_mps;
+    float    avg_spm;
+    float    max_spm;
+    float    avg_power_w;
+    float    max_power_w;
+    float    best_effort[BEST_EFFORT_COUNT];    // as activity_t.best_effort
+    uint8_t  reserved[16];
+    char     base[ACTIVITY_INDEX_BASE_LEN];  // "activities/<name>", log files add their suffix
+    uint32_t crc;               // crc32 of the bytes above
+} activity_index_rec_t;
+
+/* Open (creating or rebuilding as needed). Keeps the file open. */
+esp_err_t activity_index_open(const char *mount_point);
+void activity_index_close(void);
+
+uint32_t activity_index_count(void);
+
+/* First id not used by any indexed session (1 on an empty card). */
+uint32_t activity_index_next_id(void);
+
+/* Append a finished session. `base` is activity_log_t.filename_base. */
+esp_err_t activity_index_append(const activity_t *a, const char *base, uint32_t flags);
+
+/* Record `i`, 0 = oldest. */
+esp_err_t activity_index_get(uint32_t i, activity_index_rec_t *out);
+
+/* Up to `max` newest records, newest first. Returns how many were read. */
+int activity_index_latest(activity_index_rec_t *out, int max);
+
+/* Throw the index away and summarise every stroke log in activities/. */
+esp_err_t activity_index_rebuild(void);
+
+#ifdef __cplusplus
+}
+#endif
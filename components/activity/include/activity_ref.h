@@ -0,0 +1,37 @@
+// components/activity/include/activity_ref.h
+#pragma once
+
+/*
+ * The session statistics as activity_update() kept them before
+ * activity_acc.h: double time-weighted sums, all three averages recomputed
+ * on every sample. Nothing records with it; it is the baseline the
+ * fixed-point statistics are measured against, on the device
+ * (CONFIG_ACTIVITY_STATS_CYCLES) and by tools/bench/bench_activity.
+ *
+ * Plain C only: the host benchmark links this file.
+ */
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct {
+    float    distance_m;
+    uint32_t stroke_count;
+    uint32_t duration_ms;
+    float    avg_speed_mps, max_speed_mps;
+    float    avg_spm, max_spm;
+    float    avg_power_w, max_power_w;
+    double   sum_speed_dt, sum_spm_dt, sum_power_dt;
+    int64_t  total_us;
+} activity_ref_t;
+
+/* Same arguments as activity_update(). */
+void activity_ref_update(activity_ref_t *a, int64_t dt_us, float speed_mps, float spm, float power_w,
+                         float distance_delta_m, uint32_t stroke_delta);
+
+#ifdef __cplusplus
+}
+#endif
@@ -1,68 +1,170 @@
 #include "activity_log.h"
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 #include <sys/stat.h>
 #include <time.h>
+#include <unistd.h>
 #include "math.h"
 #include "esp_log.h"
+#include "timebase.h"
+#include "activity_log_csv.h"
+#include "sdkconfig.h"
 
 static const char *TAG = "activity_log";
 
+#ifndef CONFIG_ACTIVITY_LOG_PREALLOC_KB
+#define CONFIG_ACTIVITY_LOG_PREALLOC_KB 512
+#endif
+#ifndef CONFIG_ACTIVITY_LOG_IO_BUF_KB
+#define CONFIG_ACTIVITY_LOG_IO_BUF_KB 4
+#endif
+
+// CSV batch and stdio buffers: whole sectors, so a spilled buffer is one FAT write
+#define IO_BUF_SIZE ((size_t)CONFIG_ACTIVITY_LOG_IO_BUF_KB * 1024)
+
 /* -------------------------------------------------------------------------- */
-/* Format Helpers (Preserved)                                                */
+/* Binary Blocks                                                             */
 /* -------------------------------------------------------------------------- */
 
-// Convert time_t to "YYYY-MM-DD HH:MM:SS"
-static void format_timestamp(time_t ts, char *buf, size_t len)
+// Seconds to add to UTC to get the local time the device displays
+static int32_t local_utc_offset_s(time_t ts)
 {
-    if (!buf || len < 20)
-        return;
-    struct tm tm_info;
-    localtime_r(&ts, &tm_info);
-    strftime(buf, len, "%Y-%m-%d %H:%M:%S", &tm_info);
+    struct tm tm_utc;
+    gmtime_r(&ts, &tm_utc);
+    tm_utc.tm_isdst = 0;
+    return (int32_t)(ts - mktime(&tm_utc));
 }
 
-static void fmt_session_time_ms(float total_sec, char *out, size_t len)
+static esp_err_t bin_write_header(activity_log_t *log)
 {
-    if (total_sec < 0)
-        total_sec = 0;
+    uint8_t hdr[ALOG_BIN_HEADER_SIZE];
+    alog_bin_build_header(&log->bin_hdr, hdr);
+
+    if (fseek(log->f_main, 0, SEEK_SET) != 0 ||
+        sd_io_fwrite(hdr, 1, sizeof(hdr), log->f_main) != sizeof(hdr))
+        return ESP_FAIL;
+
+    log->bin_hdr_dirty = false;
+    return ESP_OK;
+}
 
-    int h = (int)(total_sec / 3600);
-    int rem = (int)total_sec % 3600;
-    int m = rem / 60;
-    int s = rem % 60;
-    int ms = (int)((total_sec - floorf(total_sec)) * 1000.0f);
+/*
+ * Write the records appended since the last commit where they go in the
+ * current block, and nothing else. The block header (count + CRC) is only
+ * written when the block closes: a full block goes out as one 4 KB write at
+ * its sector-aligned offset, header included, and the writer moves on to
+ * the next one. Until then the open block has no valid header on the card;
+ * activity_log_stop() writes it (bin_close), and after a power cut journal
+ * recovery does (activity_log_seal_tail).
+ */
+static esp_err_t bin_flush(activity_log_t *log)
+{
+    alog_bin_writer_t *w = &log->bin;
+    if (w->count == w->flushed && !log->bin_hdr_dirty)
+        return ESP_OK;
 
-    if (ms < 0)
-        ms = 0;
-    if (ms > 999)
-        ms = 999;
+    if (log->bin_hdr_dirty && bin_write_header(log) != ESP_OK)
+        return ESP_FAIL;
 
-    snprintf(out, len, "%02d:%02d:%02d.%03d", h, m, s, ms);
+    const bool full = w->count >= ALOG_BIN_RECORDS_PER_BLOCK;
+    long off = alog_bin_block_offset(w->seq);
+    size_t from = 0, len = ALOG_BIN_BLOCK_SIZE;
+    if (full)
+    {
+        alog_bin_writer_seal(w);
+    }
+    else
+    {
+        from = sizeof(alog_bin_block_hdr_t) + (size_t)w->flushed * sizeof(alog_bin_record_t);
+        len = (size_t)(w->count - w->flushed) * sizeof(alog_bin_record_t);
+    }
+    bool ok = len == 0 ||
+              (fseek(log->f_main, off + (long)from, SEEK_SET) == 0 &&
+               sd_io_fwrite(w->block + from, 1, len, log->f_main) == len);
+    if (!ok)
+    {
+        ESP_LOGE(TAG, "bin block %lu write failed", (unsigned long)w->seq);
+        return ESP_FAIL;
+    }
+
+    w->flushed = w->count;
+    if (full)
+        alog_bin_writer_next(w);
+
+    sd_io_fflush(log->f_main);
+    return ESP_OK;
 }
 
-// Convert seconds float to "MM:SS.s" (Pace format)
-static void format_pace(float seconds, char *buf, size_t len)
+/* Give the open block its header: the last block of the file is short. */
+static esp_err_t bin_close(activity_log_t *log)
 {
-    if (!buf || len == 0)
-        return;
+    alog_bin_writer_t *w = &log->bin;
+    if (w->flushed == 0)
+        return ESP_OK;
+
+    alog_bin_writer_seal(w);
+    bool ok = fseek(log->f_main, alog_bin_block_offset(w->seq), SEEK_SET) == 0 &&
+              sd_io_fwrite(w->block, 1, sizeof(alog_bin_block_hdr_t), log->f_main) == sizeof(alog_bin_block_hdr_t);
+    if (!ok)
+    {
+        ESP_LOGE(TAG, "bin block %lu header write failed", (unsigned long)w->seq);
+        return ESP_FAIL;
+    }
+    return ESP_OK;
+}
 
-    if (seconds <= 0.0f || seconds > 3600.0f)
+static esp_err_t bin_append(activity_log_t *log, const activity_log_row_t *row)
+{
+    if (log->bin.seq == 0 && log->bin.count == 0)
     {
-        snprintf(buf, len, "--:--.-");
-        return;
+        // Anchor the header on the first row's own timestamp (start_ts only has 1 s resolution)
+        if (row->utc_us > 0)
+        {
+            log->bin_hdr.start_utc_us = row->utc_us - row->session_time_us;
+            log->bin_hdr_dirty = true;
+        }
     }
 
-    int min = (int)(seconds / 60.0f);
-    float sec_rem = seconds - (min * 60.0f);
+    alog_bin_record_t rec;
+    alog_bin_pack(row, &rec);
+    // A full block goes out now; a partial one waits for the commit
+    return alog_bin_writer_append(&log->bin, &rec) ? bin_flush(log) : ESP_OK;
+}
 
-    snprintf(buf, len, "%02d:%04.1f", min, sec_rem);
+static esp_err_t csv_write_batch(activity_log_t *log)
+{
+    if (log->batch_len == 0)
+        return ESP_OK;
+    size_t n = sd_io_fwrite(log->batch, 1, log->batch_len, log->f_main);
+    bool ok = (n == log->batch_len);
+    log->batch_len = 0;
+    if (!ok)
+    {
+        ESP_LOGE(TAG, "stroke batch write failed");
+        return ESP_FAIL;
+    }
+    return ESP_OK;
 }
 
 /* -------------------------------------------------------------------------- */
 /* File / Dir Helpers                                                        */
 /* -------------------------------------------------------------------------- */
 
+/*
+ * Grow a freshly created file to `bytes` so FATFS allocates its cluster chain
+ * now instead of while the session is writing. The content past the logical
+ * end is undefined; activity_log_stop() (or journal recovery) truncates it.
+ */
+static void preallocate(FILE *f, long bytes)
+{
+    if (bytes <= 0)
+        return;
+    if (fseek(f, bytes - 1, SEEK_SET) != 0 || fputc(0, f) == EOF || sd_io_fflush(f) != 0)
+        ESP_LOGW(TAG, "preallocate %ld bytes failed", bytes);
+    fseek(f, 0, SEEK_SET);
+}
+
 static esp_err_t ensure_dir(const char *path)
 {
     struct stat st;
@@ -90,29 +192,69 @@ void activity_log_init(activity_log_t *log)
     if (!log)
         return;
     memset(log, 0, sizeof(activity_log_t));
-    log->flush_every_n = 5;
+}
+
+void activity_log_set_format(activity_log_t *log, activity_log_format_t format)
+{
+    if (log)
+        log->format = format;
+}
+
+void activity_log_set_fit(activity_log_t *log, bool enabled)
+{
+    if (log)
+        log->fit_enabled = enabled;
 }
 
 void activity_log_set_split_interval(activity_log_t *log, uint32_t interval_m)
 {
     if (log)
     {
-        log->split_interval_m = (float)interval_m;
-        ESP_LOGI(TAG, "Split interval set to %.0fm", log->split_interval_m);
+        log->split_mode = ALOG_SPLIT_DISTANCE;
+        log->split_interval = (float)interval_m;
+        ESP_LOGI(TAG, "Split interval set to %.0fm", log->split_interval);
+    }
+}
+
+void activity_log_set_split_time(activity_log_t *log, uint32_t interval_s)
+{
+    if (log)
+    {
+        log->split_mode = ALOG_SPLIT_TIME;
+        log->split_interval = (float)interval_s;
+        ESP_LOGI(TAG, "Split interval set to %.0fs", log->split_interval);
     }
 }
 
+static float split_interval_or_default(const activity_log_t *log)
+{
+    if (log->split_interval > 0.1f)
+        return log->split_interval;
+    return (log->split_mode == ALOG_SPLIT_TIME) ? 300.0f : 1000.0f;
+}
+
+void activity_log_split_init(const activity_log_t *log, alog_split_state_t *s)
+{
+    alog_split_init(s, log->split_mode, split_interval_or_default(log));
+}
+
 esp_err_t activity_log_start(activity_log_t *log, sd_mmc_helper_t *sd, time_t start_ts, uint32_t activity_id)
 {
     if (!log || !sd || !sd->mounted)
         return ESP_ERR_INVALID_STATE;
 
-    float cached_interval = log->split_interval_m; 
+    alog_split_mode_t cached_mode = log->split_mode;
+    float cached_interval = split_interval_or_default(log);
+    activity_log_format_t cached_format = log->format;
+    bool cached_fit = log->fit_enabled;
 
     activity_log_init(log); 
 
-    log->split_interval_m = (cached_interval > 0.1f) ? cached_interval : 1000.0f;
-    log->next_split_index = 1;
+    log->split_mode = cached_mode;
+    log->split_interval = cached_interval;
+    log->format = cached_format;
+    log->fit_enabled = cached_fit;
+    log->utc_offset_s = local_utc_offset_s(start_ts);
 
     // 1. Create Directory
     char dir_full[128];
@@ -126,53 +268,116 @@ esp_err_t activity_log_start(activity_log_t *log, sd_mmc_helper_t *sd, time_t st
     // Store relative path base for reference
     snprintf(log->filename_base, sizeof(log->filename_base), "activities/%s", base_name);
 
-    // 3. Open Main Log File (.csv)
+    // 3. Open Main Log File (.csv or .bin)
+    bool binary = (log->format == ACTIVITY_LOG_FORMAT_BINARY);
     char full_path_main[160];
-    snprintf(full_path_main, sizeof(full_path_main), "%s/activities/%s_Strokes.csv", sd->mount_point, base_name);
+    snprintf(full_path_main, sizeof(full_path_main), "%s/activities/%s%s", sd->mount_point, base_name,
+             binary ? ACTIVITY_LOG_SUFFIX_STROKES_BIN : ACTIVITY_LOG_SUFFIX_STROKES_CSV);
 
-    log->f_main = fopen(full_path_main, "w");
+    uint8_t *block = NULL;
+    if (binary)
+    {
+        block = malloc(ALOG_BIN_BLOCK_SIZE);
+        if (!block)
+        {
+            ESP_LOGE(TAG, "no memory for bin block");
+            return ESP_ERR_NO_MEM;
+        }
+    }
+    else
+    {
+        // Rows are formatted here and handed to stdio with one fwrite per batch
+        log->batch = malloc(IO_BUF_SIZE);
+        if (!log->batch)
+        {
+            ESP_LOGE(TAG, "no memory for CSV batch");
+            return ESP_ERR_NO_MEM;
+        }
+    }
+
+    // Storage counters cover this session
+    sd_io_stats_reset();
+
+    log->f_main = sd_io_fopen(full_path_main, binary ? "wb" : "w");
     if (!log->f_main)
     {
         ESP_LOGE(TAG, "fopen main failed: %s", full_path_main);
+        free(block);
+        free(log->batch);
+        log->batch = NULL;
         return ESP_FAIL;
     }
+    setvbuf(log->f_main, NULL, _IOFBF, IO_BUF_SIZE);
+    preallocate(log->f_main, (long)CONFIG_ACTIVITY_LOG_PREALLOC_KB * 1024);
 
     // 4. Open Splits Log File (_Splits.csv)
     char full_path_splits[160];
-    snprintf(full_path_splits, sizeof(full_path_splits), "%s/activities/%s_Splits.csv", sd->mount_point, base_name);
+    snprintf(full_path_splits, sizeof(full_path_splits), "%s/activities/%s" ACTIVITY_LOG_SUFFIX_SPLITS,
+             sd->mount_point, base_name);
 
-    log->f_splits = fopen(full_path_splits, "w");
+    log->f_splits = sd_io_fopen(full_path_splits, "w");
     if (!log->f_splits)
     {
         ESP_LOGW(TAG, "fopen splits failed: %s", full_path_splits);
         // We can continue with just the main log if splits fail
     }
+    else
+    {
+        setvbuf(log->f_splits, NULL, _IOFBF, IO_BUF_SIZE);
+    }
 
     // 5. Write Headers
-    if (log->f_main)
+    if (binary)
     {
-        // Your Custom Header
-        fprintf(log->f_main,
-                "Global Time,Session Time,Distance (m),Pace (/500m),SPM,Avg Pace (/500m),Average Speed (m/s),"
-                "Stroke Length (m),Stroke Count,gps_lat,gps_lon,Power (W),Drive Time (s),Recovery Time (s),Recovery Ratio\n");
+        timebase_status_t tb;
+        timebase_get_status(&tb);
+
+        alog_bin_writer_reset(&log->bin, block);
+        log->bin_hdr = (alog_bin_file_hdr_t){
+            .session_id = activity_id,
+            .split_mode = (uint16_t)log->split_mode,
+            .split_interval = (uint32_t)log->split_interval,
+            .start_utc_us = (int64_t)start_ts * 1000000LL,
+            .utc_offset_s = log->utc_offset_s,
+            .rate_ppb = tb.rate_ppb,
+        };
+        if (bin_write_header(log) != ESP_OK)
+            ESP_LOGW(TAG, "bin header write failed");
+        sd_io_fflush(log->f_main);
+    }
+    else
+    {
+        fputs(ALOG_CSV_STROKE_HEADER, log->f_main);
     }
 
     if (log->f_splits) {
-        // 1. Prepare Metadata Strings
-        char time_str[32];
-        format_timestamp(start_ts, time_str, sizeof(time_str)); // Uses your existing helper
-        
-        // 2. Write Metadata Rows (Device Settings)
-        fprintf(log->f_splits, "Device Info,ESP32S3-BLE Rowing Speed Coach\n");
-        fprintf(log->f_splits, "Session Start,%s\n", time_str);
-        fprintf(log->f_splits, "Split Setting,%.0f meters\n", log->split_interval_m); //
-        fprintf(log->f_splits, "Activity ID,%u\n", (unsigned int)activity_id);
-        
-        // 3. Add an empty row for separation (optional but readable)
-        fprintf(log->f_splits, "\n");
-
-        // 4. Write the Actual Data Columns
-        fprintf(log->f_splits, "Split #,Total Dist (m),Split Dist (m),Split Time,Avg Pace (/500m),Avg SPM\n");
+        alog_csv_write_splits_preamble(log->f_splits, (int64_t)start_ts, log->utc_offset_s,
+                                       log->split_mode, log->split_interval, activity_id);
+    }
+
+    // 6. FIT activity file (<base>.fit), streamed alongside
+    if (log->fit_enabled)
+    {
+        char full_path_fit[160];
+        snprintf(full_path_fit, sizeof(full_path_fit), "%s/activities/%s" ACTIVITY_LOG_SUFFIX_FIT,
+                 sd->mount_point, base_name);
+
+        fit_writer_config_t fit_cfg = {
+            .serial = activity_id,
+            .start_utc_us = (int64_t)start_ts * 1000000LL,
+            .utc_offset_s = log->utc_offset_s,
+            .sub_sport = FIT_SUB_SPORT_GENERIC,
+        };
+        log->f_fit = sd_io_fopen(full_path_fit, "wb");
+        if (log->f_fit)
+            setvbuf(log->f_fit, NULL, _IOFBF, IO_BUF_SIZE);
+        if (!log->f_fit || !fit_writer_begin(&log->fit, log->f_fit, &fit_cfg))
+        {
+            ESP_LOGW(TAG, "FIT file disabled: %s", full_path_fit);
+            if (log->f_fit)
+                sd_io_fclose(log->f_fit);
+            log->f_fit = NULL;
+        }
     }
 
     log->opened = true;
@@ -186,90 +391,152 @@ esp_err_t activity_log_append(activity_log_t *log, const activity_log_row_t *row
         return ESP_ERR_INVALID_STATE;
 
     // --- 1. Write Stroke Row ---
-    char time_str[32];
-    format_timestamp(row->rtc_time, time_str, sizeof(time_str));
-    char pace_inst_str[24];
-    format_pace(row->pace_500m_s, pace_inst_str, sizeof(pace_inst_str));
-    char pace_avg_str[24];
-    format_pace(row->avg_pace_500m_s, pace_avg_str, sizeof(pace_avg_str));
-    char session_time_str[32];
-    fmt_session_time_ms(row->session_time_s, session_time_str, sizeof(session_time_str));
-
-    fprintf(log->f_main, "%s,%s,%.1f,%s,%.1f,%s,%.2f,%.2f,%lu,%.7f,%.7f,%.1f,%.2f,%.2f,%.2f\n",
-            time_str, session_time_str, (double)row->total_distance_m, pace_inst_str,
-            (double)row->spm_instant, pace_avg_str, (double)row->avg_speed_mps,
-            (double)row->stroke_length_m, (unsigned long)row->stroke_count,
-            row->gps_lat, row->gps_lon, (double)row->power_w,
-            (double)row->drive_time_s, (double)row->recovery_time_s, (double)row->recovery_ratio);
-
-    log->pending++;
-    if (log->pending >= log->flush_every_n)
+    if (log->format == ACTIVITY_LOG_FORMAT_BINARY)
     {
-        fflush(log->f_main);
-        log->pending = 0;
+        bin_append(log, row);
     }
-
-    // --- 2. Check for Split ---
-    // If enabled (>0) and we crossed the threshold relative to last split
-    if (log->split_interval_m > 0)
+    else
     {
-        float dist_delta = row->total_distance_m - log->last_split_dist_m;
+        if (IO_BUF_SIZE - log->batch_len < ALOG_CSV_STROKE_MAX)
+            csv_write_batch(log);
+        log->batch_len += alog_csv_format_stroke(log->batch + log->batch_len, IO_BUF_SIZE - log->batch_len,
+                                                 row, log->utc_offset_s);
+    }
 
-        if (dist_delta >= log->split_interval_m)
-        {
-            float time_delta = row->session_time_s - log->last_split_time_s;
-
-            // Avoid division by zero
-            float split_pace = 0;
-            if (dist_delta > 0)
-            {
-                // Pace = Time / (Dist / 500)
-                split_pace = time_delta / (dist_delta / 500.0f);
-            }
-
-            // Create Split Row
-            activity_log_split_row_t split = {
-                .split_index = log->next_split_index++,
-                .total_dist_m = row->total_distance_m,
-                .split_dist_m = dist_delta,
-                .split_time_s = time_delta,
-                .split_pace_s = split_pace,
-                .avg_spm = row->spm_instant // Simplified: Current SPM is proxy for Avg SPM of split
-                                            // (Ideally caller calculates true avg, but this suffices for dummy data)
-            };
+    if (log->f_fit)
+    {
+        fit_record_t rec = {
+            .utc_us = row->utc_us,
+            .distance_m = row->total_distance_m,
+            .speed_mps = (row->pace_500m_s > 0) ? 500.0f / row->pace_500m_s : 0,
+            .power_w = row->power_w,
+            .spm = row->spm_instant,
+            .has_fix = row->gps_lat != 0.0 || row->gps_lon != 0.0,
+            .lat_deg = row->gps_lat,
+            .lon_deg = row->gps_lon,
+        };
+        fit_writer_record(&log->fit, &rec);
+    }
 
-            activity_log_append_split(log, &split);
+    return ESP_OK;
+}
 
-            // Update State
-            log->last_split_dist_m = row->total_distance_m;
-            log->last_split_time_s = row->session_time_s;
-        }
-    }
+static esp_err_t split_csv(activity_log_t *log, const activity_log_split_row_t *row)
+{
+    if (!log->f_splits)
+        return ESP_ERR_INVALID_STATE;
 
+    alog_csv_write_split(log->f_splits, row);
+    log->splits_dirty = true;
     return ESP_OK;
 }
 
 esp_err_t activity_log_append_split(activity_log_t *log, const activity_log_split_row_t *row)
 {
-    if (!log || !log->opened || !log->f_splits)
+    if (!log || !log->opened)
         return ESP_ERR_INVALID_STATE;
 
-    char split_time_str[32];
-    fmt_session_time_ms(row->split_time_s, split_time_str, sizeof(split_time_str));
+    if (log->f_fit)
+        fit_writer_lap(&log->fit, log->split_mode == ALOG_SPLIT_TIME ? FIT_LAP_TRIGGER_TIME
+                                                                      : FIT_LAP_TRIGGER_DISTANCE);
+    return split_csv(log, row);
+}
 
-    char pace_str[24];
-    format_pace(row->split_pace_s, pace_str, sizeof(pace_str));
+esp_err_t activity_log_append_last_split(activity_log_t *log, const activity_log_split_row_t *row)
+{
+    if (!log || !log->opened)
+        return ESP_ERR_INVALID_STATE;
 
-    fprintf(log->f_splits, "%d,%.0f,%.0f,%s,%s,%.1f\n",
-            row->split_index,
-            (double)row->total_dist_m,
-            (double)row->split_dist_m,
-            split_time_str,
-            pace_str,
-            (double)row->avg_spm);
+    // Its FIT lap is the session-end one fit_writer_finish() closes
+    return split_csv(log, row);
+}
 
-    fflush(log->f_splits);
-    return ESP_OK;
+esp_err_t activity_log_commit(activity_log_t *log)
+{
+    if (!log || !log->opened || !log->f_main)
+        return ESP_ERR_INVALID_STATE;
+
+    // Both are no-ops when nothing was appended since the last commit
+    esp_err_t err;
+    if (log->format == ACTIVITY_LOG_FORMAT_BINARY)
+        err = bin_flush(log);
+    else
+        err = (csv_write_batch(log) == ESP_OK && sd_io_fflush(log->f_main) == 0) ? ESP_OK : ESP_FAIL;
+
+    if (log->f_splits && log->splits_dirty)
+    {
+        sd_io_fflush(log->f_splits);
+        log->splits_dirty = false;
+    }
+    // The FIT file only goes out with activity_log_sync(); nothing reads it before stop
+    return err;
+}
+
+uint32_t activity_log_drain(activity_log_t *log, activity_log_ring_t *ring)
+{
+    const bool write = log && log->opened;
+    uint32_t total = 0;
+
+    const activity_log_msg_t *msg;
+    uint32_t n;
+    while ((n = alog_ring_peek(ring, &msg)) > 0)
+    {
+        for (uint32_t i = 0; write && i < n; i++)
+        {
+            if (msg[i].kind == ACTIVITY_LOG_MSG_SPLIT)
+                activity_log_append_split(log, &msg[i].split);
+            else
+                activity_log_append(log, &msg[i].row);
+        }
+        alog_ring_release(ring, n);
+        total += n;
+    }
+
+    if (write && total > 0)
+        activity_log_commit(log);
+    return total;
+}
+
+long activity_log_main_length(const activity_log_t *log)
+{
+    if (!log || !log->f_main)
+        return 0;
+
+    if (log->format == ACTIVITY_LOG_FORMAT_BINARY)
+    {
+        const alog_bin_writer_t *w = &log->bin;
+        long len = alog_bin_block_offset(w->seq);
+        if (w->flushed > 0)
+            len += (long)(sizeof(alog_bin_block_hdr_t) + (size_t)w->flushed * sizeof(alog_bin_record_t));
+        return len;
+    }
+    return ftell(log->f_main);      // CSV only ever appends
+}
+
+long activity_log_splits_length(const activity_log_t *log)
+{
+    return (log && log->f_splits) ? ftell(log->f_splits) : 0;
+}
+
+esp_err_t activity_log_sync(activity_log_t *log)
+{
+    if (!log || !log->opened)
+        return ESP_ERR_INVALID_STATE;
+
+    esp_err_t err = ESP_OK;
+    if (log->f_main)
+    {
+        err = activity_log_commit(log);
+        sd_io_fsync(log->f_main);
+    }
+    if (log->f_splits)
+        sd_io_fsync(log->f_splits);
+    if (log->f_fit)
+    {
+        fit_writer_flush(&log->fit);
+        sd_io_fsync(log->f_fit);
+    }
+    return err;
 }
 
 esp_err_t activity_log_stop(activity_log_t *log)
@@ -278,17 +545,289 @@ esp_err_t activity_log_stop(activity_log_t *log)
     {
         if (log->f_main)
         {
-            fflush(log->f_main);
-            fclose(log->f_main);
+            activity_log_commit(log);
+            if (log->format == ACTIVITY_LOG_FORMAT_BINARY)
+                bin_close(log);
+
+            // Drop the preallocated tail
+            sd_io_fflush(log->f_main);
+            if (ftruncate(fileno(log->f_main), activity_log_main_length(log)) != 0)
+                ESP_LOGW(TAG, "truncate main log failed");
+            sd_io_fclose(log->f_main);
             log->f_main = NULL;
         }
+        if (log->f_fit)
+        {
+            if (!fit_writer_finish(&log->fit))
+                ESP_LOGW(TAG, "FIT finish failed");
+            sd_io_fclose(log->f_fit);
+            log->f_fit = NULL;
+        }
+
+        // How the card kept up, after every write of the session but the last close
+        sd_io_stats_t io;
+        sd_io_stats_get(&io);
+        ESP_LOGI(TAG, "SD: %s, %lu KB/s, %lu slow ops, worst %.1f ms", sd_io_health_name(sd_io_health(&io)),
+                 (unsigned long)(sd_io_bytes_per_s(&io) / 1024), (unsigned long)io.slow,
+                 (double)io.max_us * 1e-3);
         if (log->f_splits)
         {
-            fflush(log->f_splits);
-            fclose(log->f_splits);
+            fputc('\n', log->f_splits);
+            sd_io_stats_write_csv(log->f_splits, &io);
+            sd_io_fflush(log->f_splits);
+            sd_io_fclose(log->f_splits);
             log->f_splits = NULL;
         }
+        free(log->bin.block);
+        log->bin.block = NULL;
+        free(log->batch);
+        log->batch = NULL;
         log->opened = false;
     }
     return ESP_OK;
-}
\ No newline at end of file
+}
+
+esp_err_t activity_log_export_csv(const char *bin_path, const char *csv_path)
+{
+    if (!bin_path || !csv_path)
+        return ESP_ERR_INVALID_ARG;
+
+    FILE *in = fopen(bin_path, "rb");
+    if (!in)
+    {
+        ESP_LOGE(TAG, "export: open %s failed", bin_path);
+        return ESP_FAIL;
+    }
+
+    uint8_t *buf = malloc(ALOG_BIN_BLOCK_SIZE);
+    if (!buf)
+    {
+        fclose(in);
+        return ESP_ERR_NO_MEM;
+    }
+
+    alog_bin_file_hdr_t hdr;
+    size_t n = fread(buf, 1, ALOG_BIN_HEADER_SIZE, in);
+    if (!alog_bin_parse_header(buf, n, &hdr))
+    {
+        ESP_LOGE(TAG, "export: %s has no valid header", bin_path);
+        free(buf);
+        fclose(in);
+        return ESP_ERR_INVALID_VERSION;
+    }
+
+    FILE *out = fopen(csv_path, "w");
+    if (!out)
+    {
+        ESP_LOGE(TAG, "export: open %s failed", csv_path);
+        free(buf);
+        fclose(in);
+        return ESP_FAIL;
+    }
+    fputs(ALOG_CSV_STROKE_HEADER, out);
+
+    alog_bin_unpack_state_t st = {0};
+    alog_csv_roll_t *roll = malloc(sizeof(*roll));
+    if (roll)
+        alog_csv_roll_init(roll);
+    uint32_t rows = 0, bad_blocks = 0;
+    for (uint32_t seq = 0;; seq++)
+    {
+        if (fseek(in, alog_bin_block_offset(seq), SEEK_SET) != 0)
+            break;
+        n = fread(buf, 1, ALOG_BIN_BLOCK_SIZE, in);
+        if (n == 0)
+            break;
+
+        int count = alog_bin_check_block(buf, n, seq);
+        if (count < 0)
+        {
+            bad_blocks++;
+            continue;
+        }
+
+        const alog_bin_record_t *recs = alog_bin_block_records(buf);
+        for (int i = 0; i < count; i++)
+        {
+            activity_log_row_t row;
+            alog_bin_unpack(&hdr, &recs[i], &st, &row);
+            if (roll)
+                alog_csv_roll_fill(roll, &row);
+            alog_csv_write_stroke(out, &row, hdr.utc_offset_s);
+        }
+        rows += (uint32_t)count;
+    }
+
+    fclose(out);
+    fclose(in);
+    free(roll);
+    free(buf);
+
+    ESP_LOGI(TAG, "export: %lu rows -> %s (%lu bad blocks)",
+             (unsigned long)rows, csv_path, (unsigned long)bad_blocks);
+    return ESP_OK;
+}
+
+esp_err_t activity_log_export_fit(const char *bin_path, const char *fit_path)
+{
+    if (!bin_path || !fit_path)
+        return ESP_ERR_INVALID_ARG;
+
+    FILE *in = fopen(bin_path, "rb");
+    if (!in)
+    {
+        ESP_LOGE(TAG, "export: open %s failed", bin_path);
+        return ESP_FAIL;
+    }
+
+    uint8_t *buf = malloc(ALOG_BIN_BLOCK_SIZE);
+    fit_writer_t *w = malloc(sizeof(*w));
+    if (!buf || !w)
+    {
+        free(w);
+        free(buf);
+        fclose(in);
+        return ESP_ERR_NO_MEM;
+    }
+
+    alog_bin_file_hdr_t hdr;
+    size_t n = fread(buf, 1, ALOG_BIN_HEADER_SIZE, in);
+    if (!alog_bin_parse_header(buf, n, &hdr))
+    {
+        ESP_LOGE(TAG, "export: %s has no valid header", bin_path);
+        free(w);
+        free(buf);
+        fclose(in);
+        return ESP_ERR_INVALID_VERSION;
+    }
+
+    FILE *out = fopen(fit_path, "wb");
+    if (out)
+        setvbuf(out, NULL, _IOFBF, IO_BUF_SIZE);
+    fit_writer_config_t cfg = {
+        .serial = hdr.session_id,
+        .start_utc_us = hdr.start_utc_us,
+        .utc_offset_s = hdr.utc_offset_s,
+        .sub_sport = FIT_SUB_SPORT_GENERIC,
+    };
+    if (!out || !fit_writer_begin(w, out, &cfg))
+    {
+        ESP_LOGE(TAG, "export: open %s failed", fit_path);
+        if (out)
+            fclose(out);
+        free(w);
+        free(buf);
+        fclose(in);
+        return ESP_FAIL;
+    }
+
+    // Laps where the split engine closes them, replayed over the catches as the host converter does
+    const fit_lap_trigger_t trigger =
+        (hdr.split_mode == ALOG_SPLIT_TIME) ? FIT_LAP_TRIGGER_TIME : FIT_LAP_TRIGGER_DISTANCE;
+    alog_split_state_t sp;
+    alog_split_init(&sp, (alog_split_mode_t)hdr.split_mode, (float)hdr.split_interval);
+    activity_log_split_row_t split;
+
+    alog_bin_unpack_state_t st = {0};
+    uint32_t rows = 0, bad_blocks = 0;
+    for (uint32_t seq = 0;; seq++)
+    {
+        if (fseek(in, alog_bin_block_offset(seq), SEEK_SET) != 0)
+            break;
+        n = fread(buf, 1, ALOG_BIN_BLOCK_SIZE, in);
+        if (n == 0)
+            break;
+
+        int count = alog_bin_check_block(buf, n, seq);
+        if (count < 0)
+        {
+            bad_blocks++;
+            continue;
+        }
+
+        const alog_bin_record_t *recs = alog_bin_block_records(buf);
+        for (int i = 0; i < count; i++)
+        {
+            activity_log_row_t row;
+            alog_bin_unpack(&hdr, &recs[i], &st, &row);
+            while (alog_split_sample(&sp, row.session_time_us, row.total_distance_m, &split))
+                fit_writer_lap(w, trigger);
+            alog_split_stroke(&sp, row.spm_instant, row.power_w);
+
+            fit_record_t rec = {
+                .utc_us = row.utc_us,
+                .distance_m = row.total_distance_m,
+                .speed_mps = (row.pace_500m_s > 0) ? 500.0f / row.pace_500m_s : 0,
+                .power_w = row.power_w,
+                .spm = row.spm_instant,
+                .has_fix = row.gps_lat != 0.0 || row.gps_lon != 0.0,
+                .lat_deg = row.gps_lat,
+                .lon_deg = row.gps_lon,
+            };
+            fit_writer_record(w, &rec);
+        }
+        rows += (uint32_t)count;
+    }
+
+    bool ok = fit_writer_finish(w);
+    ok = fflush(out) == 0 && ok;
+    if (ok)
+        fsync(fileno(out));
+    ok = fclose(out) == 0 && ok;
+    fclose(in);
+    free(w);
+    free(buf);
+
+    if (!ok)
+    {
+        ESP_LOGE(TAG, "export: write %s failed", fit_path);
+        return ESP_FAIL;
+    }
+    ESP_LOGI(TAG, "export: %lu rows -> %s (%lu bad blocks)",
+             (unsigned long)rows, fit_path, (unsigned long)bad_blocks);
+    return ESP_OK;
+}
+
+esp_err_t activity_log_seal_tail(const char *bin_path)
+{
+    if (!bin_path)
+        return ESP_ERR_INVALID_ARG;
+
+    FILE *f = fopen(bin_path, "r+b");
+    if (!f)
+        return ESP_FAIL;
+
+    esp_err_t err = ESP_OK;
+    uint8_t *buf = NULL;
+    long len = (fseek(f, 0, SEEK_END) == 0) ? ftell(f) : -1;
+    long body = len - ALOG_BIN_HEADER_SIZE;
+    // Nothing past the file header, or the last block closed whole
+    if (body <= 0 || body % ALOG_BIN_BLOCK_SIZE == 0)
+        goto out;
+
+    uint32_t seq = (uint32_t)(body / ALOG_BIN_BLOCK_SIZE);
+    size_t n = (size_t)(body % ALOG_BIN_BLOCK_SIZE);
+    buf = malloc(ALOG_BIN_BLOCK_SIZE);
+    if (!buf || fseek(f, alog_bin_block_offset(seq), SEEK_SET) != 0 || fread(buf, 1, n, f) != n)
+    {
+        err = buf ? ESP_FAIL : ESP_ERR_NO_MEM;
+        goto out;
+    }
+    if (alog_bin_check_block(buf, n, seq) >= 0)
+        goto out;
+
+    int count = alog_bin_seal_block(buf, n, seq);
+    if (fseek(f, alog_bin_block_offset(seq), SEEK_SET) != 0 ||
+        fwrite(buf, 1, sizeof(alog_bin_block_hdr_t), f) != sizeof(alog_bin_block_hdr_t) || fflush(f) != 0)
+    {
+        err = ESP_FAIL;
+        goto out;
+    }
+    fsync(fileno(f));
+    ESP_LOGI(TAG, "sealed block %lu (%d records) of %s", (unsigned long)seq, count, bin_path);
+
+out:
+    free(buf);
+    fclose(f);
+    return err;
+}
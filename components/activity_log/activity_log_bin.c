@@ -0,0 +1,271 @@
+// components/activity_log/activity_log_bin.c
+#include "activity_log_bin.h"
+
+#include <math.h>
+#include <stddef.h>
+#include <string.h>
+
+_Static_assert(sizeof(alog_bin_record_t) == 28, "record layout changed: bump ALOG_BIN_VERSION");
+_Static_assert(sizeof(alog_bin_file_hdr_t) == 40, "header layout changed: bump ALOG_BIN_VERSION");
+_Static_assert(sizeof(alog_bin_block_hdr_t) == 16, "block header layout changed");
+_Static_assert(sizeof(alog_bin_block_hdr_t) + ALOG_BIN_RECORDS_PER_BLOCK * sizeof(alog_bin_record_t)
+               <= ALOG_BIN_BLOCK_SIZE, "block overflow");
+
+/* -------------------------------------------------------------------------- */
+/* CRC32 (IEEE 802.3, reflected; same as zlib crc32())                        */
+/* -------------------------------------------------------------------------- */
+
+static uint32_t s_crc_table[256];
+static bool s_crc_ready = false;
+
+static void crc_table_init(void)
+{
+    for (uint32_t i = 0; i < 256; i++) {
+        uint32_t c = i;
+        for (int k = 0; k < 8; k++) {
+            c = (c & 1) ? (0xEDB88320u ^ (c >> 1)) : (c >> 1);
+        }
+        s_crc_table[i] = c;
+    }
+    s_crc_ready = true;
+}
+
+uint32_t alog_crc32(uint32_t crc, const void *buf, size_t len)
+{
+    if (!s_crc_ready) crc_table_init();
+
+    const uint8_t *p = (const uint8_t *)buf;
+    crc = ~crc;
+    while (len--) {
+        crc = s_crc_table[(crc ^ *p++) & 0xFF] ^ (crc >> 8);
+    }
+    return ~crc;
+}
+
+/* -------------------------------------------------------------------------- */
+/* Field table                                                                */
+/* -------------------------------------------------------------------------- */
+
+static const alog_bin_field_t s_fields[] = {
+    { "session_ms", ALOG_FT_U32, offsetof(alog_bin_record_t, session_ms),    0, 0.001f },
+    { "dist_m",     ALOG_FT_U32, offsetof(alog_bin_record_t, dist_dm),       0, 0.1f },
+    { "lat_deg",    ALOG_FT_I32, offsetof(alog_bin_record_t, lat_e7),        0, 1e-7f },
+    { "lon_deg",    ALOG_FT_I32, offsetof(alog_bin_record_t, lon_e7),        0, 1e-7f },
+    { "speed_mps",  ALOG_FT_U16, offsetof(alog_bin_record_t, speed_cmps),    0, 0.01f },
+    { "strokes",    ALOG_FT_U16, offsetof(alog_bin_record_t, stroke_count),  0, 1.0f },
+    { "power_w",    ALOG_FT_U16, offsetof(alog_bin_record_t, power_dw),      0, 0.1f },
+    { "drive_s",    ALOG_FT_U16, offsetof(alog_bin_record_t, drive_10ms),    0, 0.01f },
+    { "recovery_s", ALOG_FT_U16, offsetof(alog_bin_record_t, recovery_10ms), 0, 0.01f },
+    { "spm",        ALOG_FT_U8,  offsetof(alog_bin_record_t, spm_x4),        0, 0.25f },
+};
+
+#define FIELD_COUNT (sizeof(s_fields) / sizeof(s_fields[0]))
+
+_Static_assert(sizeof(alog_bin_file_hdr_t) + FIELD_COUNT * sizeof(alog_bin_field_t) + 4
+               <= ALOG_BIN_HEADER_SIZE, "field table does not fit the header");
+
+const alog_bin_field_t *alog_bin_fields(size_t *count)
+{
+    if (count) *count = FIELD_COUNT;
+    return s_fields;
+}
+
+/* -------------------------------------------------------------------------- */
+/* File header                                                                */
+/* -------------------------------------------------------------------------- */
+
+void alog_bin_build_header(const alog_bin_file_hdr_t *hdr, uint8_t out[ALOG_BIN_HEADER_SIZE])
+{
+    memset(out, 0, ALOG_BIN_HEADER_SIZE);
+
+    alog_bin_file_hdr_t h = *hdr;
+    memcpy(h.magic, ALOG_BIN_MAGIC, 4);
+    h.version = ALOG_BIN_VERSION;
+    h.header_size = ALOG_BIN_HEADER_SIZE;
+    h.block_size = ALOG_BIN_BLOCK_SIZE;
+    h.record_size = sizeof(alog_bin_record_t);
+    h.field_count = FIELD_COUNT;
+
+    size_t off = 0;
+    memcpy(out + off, &h, sizeof(h));
+    off += sizeof(h);
+    memcpy(out + off, s_fields, sizeof(s_fields));
+    off += sizeof(s_fields);
+
+    uint32_t crc = alog_crc32(0, out, off);
+    memcpy(out + off, &crc, sizeof(crc));
+}
+
+bool alog_bin_parse_header(const uint8_t *buf, size_t len, alog_bin_file_hdr_t *out)
+{
+    if (!buf || len < sizeof(alog_bin_file_hdr_t)) return false;
+
+    alog_bin_file_hdr_t h;
+    memcpy(&h, buf, sizeof(h));
+    if (memcmp(h.magic, ALOG_BIN_MAGIC, 4) != 0) return false;
+    if (h.version != ALOG_BIN_VERSION) return false;
+    if (h.record_size != sizeof(alog_bin_record_t)) return false;
+    if (h.block_size != ALOG_BIN_BLOCK_SIZE || h.header_size != ALOG_BIN_HEADER_SIZE) return false;
+
+    size_t crc_off = sizeof(h) + (size_t)h.field_count * sizeof(alog_bin_field_t);
+    if (crc_off + 4 > len || crc_off + 4 > ALOG_BIN_HEADER_SIZE) return false;
+
+    uint32_t crc;
+    memcpy(&crc, buf + crc_off, sizeof(crc));
+    if (crc != alog_crc32(0, buf, crc_off)) return false;
+
+    if (out) *out = h;
+    return true;
+}
+
+/* -------------------------------------------------------------------------- */
+/* Records                                                                    */
+/* -------------------------------------------------------------------------- */
+
+/* The product is exact in a double and rounds half to even, as the CSV
+ * columns do (ff_float), so an exported column prints what the device did. */
+static uint32_t q_u(float v, double per_unit, uint32_t max)
+{
+    if (!(v > 0.0f)) return 0;          // also catches NaN
+    double q = rint((double)v * per_unit);
+    return (q >= (double)max) ? max : (uint32_t)q;
+}
+
+static int32_t q_deg_e7(double deg)
+{
+    if (!isfinite(deg)) return 0;
+    return (int32_t)rint(deg * 1e7);        // the CSV's product and rounding, see q_u()
+}
+
+void alog_bin_pack(const activity_log_row_t *row, alog_bin_record_t *out)
+{
+    int64_t ms = row->session_time_us / 1000;
+
+    out->session_ms    = (ms < 0) ? 0 : (uint32_t)ms;
+    out->dist_dm       = q_u(row->total_distance_m, 10.0, UINT32_MAX);
+    out->lat_e7        = q_deg_e7(row->gps_lat);
+    out->lon_e7        = q_deg_e7(row->gps_lon);
+    out->speed_cmps    = (uint16_t)q_u(row->pace_500m_s > 0.0f ? 500.0f / row->pace_500m_s : 0.0f,
+                                       100.0, UINT16_MAX);
+    out->stroke_count  = (uint16_t)row->stroke_count;
+    out->power_dw      = (uint16_t)q_u(row->power_w, 10.0, UINT16_MAX);
+    out->drive_10ms    = (uint16_t)q_u(row->drive_time_s, 100.0, UINT16_MAX);
+    out->recovery_10ms = (uint16_t)q_u(row->recovery_time_s, 100.0, UINT16_MAX);
+    out->spm_x4        = (uint8_t)q_u(row->spm_instant, 4.0, UINT8_MAX);
+    out->reserved      = 0;
+}
+
+void alog_bin_unpack(const alog_bin_file_hdr_t *hdr, const alog_bin_record_t *rec,
+                     alog_bin_unpack_state_t *st, activity_log_row_t *out)
+{
+    memset(out, 0, sizeof(*out));
+
+    int64_t t_us = (int64_t)rec->session_ms * 1000;
+    out->session_time_us = t_us;
+    out->utc_us = hdr->start_utc_us + t_us + (t_us * hdr->rate_ppb) / 1000000000LL;
+
+    out->total_distance_m = (float)rec->dist_dm * 0.1f;
+    out->gps_lat = rec->lat_e7 * 1e-7;
+    out->gps_lon = rec->lon_e7 * 1e-7;
+
+    float speed = (float)rec->speed_cmps * 0.01f;
+    out->pace_500m_s = (speed > 0.1f) ? (500.0f / speed) : 0.0f;
+    out->spm_instant = (float)rec->spm_x4 * 0.25f;
+    out->power_w = (float)rec->power_dw * 0.1f;
+    out->drive_time_s = (float)rec->drive_10ms * 0.01f;
+    out->recovery_time_s = (float)rec->recovery_10ms * 0.01f;
+    out->recovery_ratio = (out->drive_time_s > 0.01f) ? (out->recovery_time_s / out->drive_time_s) : 0.0f;
+    out->stroke_length_m = (out->spm_instant > 0.0f) ? (speed * 60.0f / out->spm_instant) : 0.0f;
+
+    // Distance is integrated from speed, so the session average falls out of it
+    out->avg_speed_mps = (t_us > 0) ? (float)((double)out->total_distance_m / ((double)t_us * 1e-6)) : 0.0f;
+    out->avg_pace_500m_s = (out->avg_speed_mps > 0.1f) ? (500.0f / out->avg_speed_mps) : 0.0f;
+
+    // Unwrap the 16-bit stroke counter
+    if (st) {
+        if (!st->have_prev) {
+            st->stroke_count = rec->stroke_count;
+            st->have_prev = true;
+        } else {
+            uint16_t delta = (uint16_t)(rec->stroke_count - (uint16_t)st->stroke_count);
+            st->stroke_count += delta;
+        }
+        out->stroke_count = st->stroke_count;
+    } else {
+        out->stroke_count = rec->stroke_count;
+    }
+}
+
+/* -------------------------------------------------------------------------- */
+/* Block writer                                                               */
+/* -------------------------------------------------------------------------- */
+
+void alog_bin_writer_reset(alog_bin_writer_t *w, uint8_t *block_buf)
+{
+    memset(w, 0, sizeof(*w));
+    w->block = block_buf;
+    if (block_buf) memset(block_buf, 0, ALOG_BIN_BLOCK_SIZE);
+}
+
+bool alog_bin_writer_append(alog_bin_writer_t *w, const alog_bin_record_t *rec)
+{
+    uint8_t *dst = w->block + sizeof(alog_bin_block_hdr_t) + (size_t)w->count * sizeof(*rec);
+    memcpy(dst, rec, sizeof(*rec));
+    w->rec_crc = alog_crc32(w->rec_crc, dst, sizeof(*rec));
+    w->count++;
+    return w->count >= ALOG_BIN_RECORDS_PER_BLOCK;
+}
+
+void alog_bin_writer_seal(alog_bin_writer_t *w)
+{
+    alog_bin_block_hdr_t bh = {
+        .magic = ALOG_BIN_BLOCK_MAGIC,
+        .seq = w->seq,
+        .count = w->count,
+    };
+    bh.crc = alog_crc32(w->rec_crc, &bh, offsetof(alog_bin_block_hdr_t, crc));
+    memcpy(w->block, &bh, sizeof(bh));
+}
+
+int alog_bin_seal_block(uint8_t *blk, size_t len, uint32_t seq)
+{
+    size_t count = (len > sizeof(alog_bin_block_hdr_t))
+                       ? (len - sizeof(alog_bin_block_hdr_t)) / sizeof(alog_bin_record_t)
+                       : 0;
+    if (count > ALOG_BIN_RECORDS_PER_BLOCK) count = ALOG_BIN_RECORDS_PER_BLOCK;
+
+    alog_bin_block_hdr_t bh = {
+        .magic = ALOG_BIN_BLOCK_MAGIC,
+        .seq = seq,
+        .count = (uint16_t)count,
+    };
+    uint32_t crc = alog_crc32(0, blk + sizeof(bh), count * sizeof(alog_bin_record_t));
+    bh.crc = alog_crc32(crc, &bh, offsetof(alog_bin_block_hdr_t, crc));
+    memcpy(blk, &bh, sizeof(bh));
+    return (int)count;
+}
+
+void alog_bin_writer_next(alog_bin_writer_t *w)
+{
+    uint8_t *buf = w->block;
+    uint32_t seq = w->seq + 1;
+    alog_bin_writer_reset(w, buf);
+    w->seq = seq;
+}
+
+int alog_bin_check_block(const uint8_t *blk, size_t len, uint32_t expect_seq)
+{
+    if (!blk || len < sizeof(alog_bin_block_hdr_t)) return -1;
+
+    alog_bin_block_hdr_t bh;
+    memcpy(&bh, blk, sizeof(bh));
+    if (bh.magic != ALOG_BIN_BLOCK_MAGIC || bh.seq != expect_seq) return -1;
+    if (bh.count > ALOG_BIN_RECORDS_PER_BLOCK) return -1;
+
+    size_t rec_bytes = (size_t)bh.count * sizeof(alog_bin_record_t);
+    if (sizeof(bh) + rec_bytes > len) return -1;
+
+    uint32_t crc = alog_crc32(0, blk + sizeof(bh), rec_bytes);
+    crc = alog_crc32(crc, &bh, offsetof(alog_bin_block_hdr_t, crc));
+    return (crc == bh.crc) ? (int)bh.count : -1;
+}
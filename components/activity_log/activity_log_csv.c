@@ -0,0 +1,144 @@
+// components/activity_log/activity_log_csv.c
+#include "activity_log_csv.h"
+
+#include <string.h>
+
+#include "fastfmt.h"
+
+/* Copy a formatted string into a caller buffer of `len` bytes, truncating. */
+static void copy_out(char *buf, size_t len, const char *src, size_t n)
+{
+    if (!buf || len == 0)
+        return;
+    if (n >= len)
+        n = len - 1;
+    memcpy(buf, src, n);
+    buf[n] = '\0';
+}
+
+void alog_csv_format_time(int64_t utc_s, int32_t utc_offset_s, char *buf, size_t len)
+{
+    if (!buf || len < 20)
+        return;
+    char tmp[FF_DATETIME_MAX];
+    copy_out(buf, len, tmp, ff_datetime(tmp, utc_s + utc_offset_s));
+}
+
+void alog_csv_format_session_time(int64_t total_us, char *out, size_t len)
+{
+    char tmp[FF_HMS_MS_MAX];
+    copy_out(out, len, tmp, ff_hms_ms(tmp, total_us));
+}
+
+void alog_csv_format_pace(float seconds, char *buf, size_t len)
+{
+    char tmp[FF_PACE_MAX];
+    copy_out(buf, len, tmp, ff_pace(tmp, seconds));
+}
+
+void alog_csv_roll_init(alog_csv_roll_t *r)
+{
+    rolling_metrics_init(&r->rm, r->hist, ALOG_CSV_ROLL_HISTORY);
+    rolling_metrics_add_window(&r->rm, RM_WINDOW_DISTANCE, ALOG_ROLL_PACE_M);
+    rolling_metrics_add_window(&r->rm, RM_WINDOW_STROKES, ALOG_ROLL_RATE_STROKES);
+}
+
+void alog_csv_roll_fill(alog_csv_roll_t *r, activity_log_row_t *row)
+{
+    rolling_metrics_push(&r->rm, row->session_time_us, row->total_distance_m, row->power_w);
+
+    rm_result_t res;
+    rolling_metrics_get(&r->rm, 0, &res);
+    row->roll_pace_500m_s = res.pace_500m_s;
+    rolling_metrics_get(&r->rm, 1, &res);
+    row->roll_spm = res.spm;
+}
+
+size_t alog_csv_format_stroke(char *buf, size_t len, const activity_log_row_t *row, int32_t utc_offset_s)
+{
+    if (!buf || len < ALOG_CSV_STROKE_MAX)
+        return 0;
+
+    // Column order and precision follow ALOG_CSV_STROKE_HEADER
+    char *p = buf;
+    p += ff_datetime_ms(p, row->utc_us + (int64_t)utc_offset_s * 1000000);
+    *p++ = ',';
+    p += ff_hms_ms(p, row->session_time_us);
+    *p++ = ',';
+    p += ff_float(p, row->total_distance_m, 1);
+    *p++ = ',';
+    p += ff_pace(p, row->pace_500m_s);
+    *p++ = ',';
+    p += ff_float(p, row->spm_instant, 1);
+    *p++ = ',';
+    p += ff_pace(p, row->avg_pace_500m_s);
+    *p++ = ',';
+    p += ff_float(p, row->avg_speed_mps, 2);
+    *p++ = ',';
+    p += ff_float(p, row->stroke_length_m, 2);
+    *p++ = ',';
+    p += ff_u32(p, row->stroke_count);
+    *p++ = ',';
+    p += ff_double(p, row->gps_lat, 7);
+    *p++ = ',';
+    p += ff_double(p, row->gps_lon, 7);
+    *p++ = ',';
+    p += ff_float(p, row->power_w, 1);
+    *p++ = ',';
+    p += ff_float(p, row->drive_time_s, 2);
+    *p++ = ',';
+    p += ff_float(p, row->recovery_time_s, 2);
+    *p++ = ',';
+    p += ff_float(p, row->recovery_ratio, 2);
+    *p++ = ',';
+    p += ff_pace(p, row->roll_pace_500m_s);
+    *p++ = ',';
+    p += ff_float(p, row->roll_spm, 1);
+    *p++ = '\n';
+    *p = '\0';
+    return (size_t)(p - buf);
+}
+
+void alog_csv_write_stroke(FILE *f, const activity_log_row_t *row, int32_t utc_offset_s)
+{
+    char line[ALOG_CSV_STROKE_MAX];
+    size_t n = alog_csv_format_stroke(line, sizeof(line), row, utc_offset_s);
+    fwrite(line, 1, n, f);
+}
+
+void alog_csv_write_splits_preamble(FILE *f, int64_t start_utc_s, int32_t utc_offset_s,
+                                    alog_split_mode_t split_mode, float split_interval, uint32_t activity_id)
+{
+    char time_str[32];
+    alog_csv_format_time(start_utc_s, utc_offset_s, time_str, sizeof(time_str));
+
+    // Device settings, a blank separator row, then the data columns
+    fprintf(f, "Device Info,ESP32S3-BLE Rowing Speed Coach\n");
+    fprintf(f, "Session Start,%s\n", time_str);
+    fprintf(f, "Split Setting,%.0f %s\n", (double)split_interval,
+            split_mode == ALOG_SPLIT_TIME ? "seconds" : "meters");
+    fprintf(f, "Activity ID,%u\n", (unsigned int)activity_id);
+    fprintf(f, "\n");
+    fputs(ALOG_CSV_SPLITS_COLUMNS, f);
+}
+
+void alog_csv_write_split(FILE *f, const activity_log_split_row_t *row)
+{
+    char line[128];
+    char *p = line;
+    p += ff_i64(p, row->split_index);
+    *p++ = ',';
+    p += ff_float(p, row->total_dist_m, 0);
+    *p++ = ',';
+    p += ff_float(p, row->split_dist_m, 0);
+    *p++ = ',';
+    p += ff_hms_ms(p, (int64_t)((double)row->split_time_s * 1e6));
+    *p++ = ',';
+    p += ff_pace(p, row->split_pace_s);
+    *p++ = ',';
+    p += ff_float(p, row->avg_spm, 1);
+    *p++ = ',';
+    p += ff_u32(p, row->stroke_count);
+    *p++ = '\n';
+    fwrite(line, 1, (size_t)(p - line), f);
+}
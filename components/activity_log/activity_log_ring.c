@@ -0,0 +1,64 @@
+// components/activity_log/activity_log_ring.c
+#include "activity_log_ring.h"
+
+void alog_ring_init(activity_log_ring_t *r, activity_log_msg_t *slots, uint32_t capacity)
+{
+    r->slots = slots;
+    r->mask = capacity - 1;
+    atomic_init(&r->head, 0);
+    atomic_init(&r->tail, 0);
+    atomic_init(&r->dropped, 0);
+    r->high_water = 0;
+}
+
+bool alog_ring_push(activity_log_ring_t *r, const activity_log_msg_t *msg)
+{
+    uint32_t head = (uint32_t)atomic_load_explicit(&r->head, memory_order_relaxed);
+    uint32_t tail = (uint32_t)atomic_load_explicit(&r->tail, memory_order_acquire);
+    if (head - tail > r->mask) {
+        atomic_fetch_add_explicit(&r->dropped, 1, memory_order_relaxed);
+        return false;
+    }
+
+    r->slots[head & r->mask] = *msg;
+    atomic_store_explicit(&r->head, head + 1, memory_order_release);
+    return true;
+}
+
+uint32_t alog_ring_count(activity_log_ring_t *r)
+{
+    uint32_t head = (uint32_t)atomic_load_explicit(&r->head, memory_order_acquire);
+    uint32_t tail = (uint32_t)atomic_load_explicit(&r->tail, memory_order_acquire);
+    return head - tail;
+}
+
+uint32_t alog_ring_capacity(const activity_log_ring_t *r)
+{
+    return r->mask + 1;
+}
+
+uint32_t alog_ring_dropped(activity_log_ring_t *r)
+{
+    return (uint32_t)atomic_load_explicit(&r->dropped, memory_order_relaxed);
+}
+
+uint32_t alog_ring_peek(activity_log_ring_t *r, const activity_log_msg_t **first)
+{
+    uint32_t tail = (uint32_t)atomic_load_explicit(&r->tail, memory_order_relaxed);
+    uint32_t head = (uint32_t)atomic_load_explicit(&r->head, memory_order_acquire);
+    uint32_t n = head - tail;
+    if (n > r->high_water)
+        r->high_water = n;
+
+    // Stop at the wrap; the rest comes with the next peek
+    uint32_t idx = tail & r->mask;
+    uint32_t to_end = r->mask + 1 - idx;
+    *first = &r->slots[idx];
+    return (n < to_end) ? n : to_end;
+}
+
+void alog_ring_release(activity_log_ring_t *r, uint32_t n)
+{
+    uint32_t tail = (uint32_t)atomic_load_explicit(&r->tail, memory_order_relaxed);
+    atomic_store_explicit(&r->tail, tail + n, memory_order_release);
+}
@@ -0,0 +1,80 @@
+// components/activity_log/activity_log_split.c
+#include "activity_log_split.h"
+
+#include <string.h>
+
+void alog_split_init(alog_split_state_t *s, alog_split_mode_t mode, float interval)
+{
+    memset(s, 0, sizeof(*s));
+    s->mode = mode;
+    s->interval = interval;
+    s->next_index = 1;
+}
+
+/* Close the open split at (t_us, dist_m) and start the next one there. */
+static void close_at(alog_split_state_t *s, int64_t t_us, float dist_m, activity_log_split_row_t *out)
+{
+    float time_s = (float)(t_us - s->start_time_us) * 1e-6f;
+    float dist = dist_m - s->start_dist_m;
+
+    *out = (activity_log_split_row_t){
+        .split_index = s->next_index++,
+        .total_dist_m = dist_m,
+        .split_dist_m = dist,
+        .split_time_s = time_s,
+        // Pace = Time / (Dist / 500)
+        .split_pace_s = (dist > 0) ? time_s / (dist / 500.0f) : 0,
+        .avg_spm = s->strokes ? s->spm_sum / (float)s->strokes : 0,
+        .avg_power_w = s->strokes ? s->power_sum / (float)s->strokes : 0,
+        .stroke_count = s->strokes,
+    };
+
+    s->start_time_us = s->prev_time_us = t_us;
+    s->start_dist_m = s->prev_dist_m = dist_m;
+    s->strokes = 0;
+    s->spm_sum = 0;
+    s->power_sum = 0;
+}
+
+bool alog_split_sample(alog_split_state_t *s, int64_t session_time_us, float total_distance_m,
+                       activity_log_split_row_t *out)
+{
+    const int64_t t0 = s->prev_time_us;
+    const float d0 = s->prev_dist_m;
+
+    if (s->interval > 0 && s->mode == ALOG_SPLIT_DISTANCE) {
+        const float boundary = s->start_dist_m + s->interval;
+        if (total_distance_m >= boundary) {
+            // d0 < boundary <= d: time at which the boat passed the boundary
+            double frac = (total_distance_m > d0) ? (double)(boundary - d0) / (double)(total_distance_m - d0) : 1.0;
+            close_at(s, t0 + (int64_t)((double)(session_time_us - t0) * frac), boundary, out);
+            return true;
+        }
+    } else if (s->interval > 0) {
+        const int64_t boundary = s->start_time_us + (int64_t)((double)s->interval * 1e6);
+        if (session_time_us >= boundary) {
+            double frac = (session_time_us > t0) ? (double)(boundary - t0) / (double)(session_time_us - t0) : 1.0;
+            close_at(s, boundary, d0 + (float)((double)(total_distance_m - d0) * frac), out);
+            return true;
+        }
+    }
+
+    s->prev_time_us = session_time_us;
+    s->prev_dist_m = total_distance_m;
+    return false;
+}
+
+void alog_split_stroke(alog_split_state_t *s, float spm, float power_w)
+{
+    s->strokes++;
+    s->spm_sum += spm;
+    s->power_sum += power_w;
+}
+
+bool alog_split_finish(alog_split_state_t *s, activity_log_split_row_t *out)
+{
+    if (s->prev_time_us <= s->start_time_us && s->strokes == 0)
+        return false;
+    close_at(s, s->prev_time_us, s->prev_dist_m, out);
+    return true;
+}
@@ -0,0 +1,432 @@
+// components/activity_log/activity_raw.c
+#include "activity_raw.h"
+
+#include <fcntl.h>
+#include <math.h>
+#include <stddef.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/queue.h"
+#include "freertos/semphr.h"
+#include "esp_heap_caps.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "sdkconfig.h"
+
+#include "activity_log_bin.h"   // alog_crc32
+#include "activity_raw_codec.h"
+#include "sd_io_stats.h"
+#include "timebase.h"
+
+static const char *TAG = "activity_raw";
+
+#ifndef CONFIG_ACTIVITY_RAW_BUFFERS
+#define CONFIG_ACTIVITY_RAW_BUFFERS 2
+#endif
+#ifndef CONFIG_ACTIVITY_RAW_COMPRESS
+#define CONFIG_ACTIVITY_RAW_COMPRESS 0
+#endif
+#ifndef CONFIG_ACTIVITY_RAW_PREALLOC_MB
+#define CONFIG_ACTIVITY_RAW_PREALLOC_MB 0
+#endif
+#ifndef CONFIG_ACTIVITY_RAW_WRITER_CORE
+#define CONFIG_ACTIVITY_RAW_WRITER_CORE 1
+#endif
+
+#define RAW_NUM_BUFS        CONFIG_ACTIVITY_RAW_BUFFERS
+#define RAW_WRITER_PRIO     7
+#define RAW_WRITER_STACK    4096
+#define RAW_SYNC_EVERY      8       // fsync every 256 KB so the directory entry keeps up
+#define RAW_Q_STOP          0xFF
+
+/* Block bases sit this far before the record that opens the block, so a GPS
+ * update stamped with its (earlier) sentence start still gets a positive offset. */
+#define RAW_BASE_LEAD_US    2000000LL
+
+_Static_assert(sizeof(activity_raw_block_hdr_t) == 48, "raw block header layout changed");
+_Static_assert(sizeof(activity_raw_imu_rec_t) == 16, "raw IMU record layout changed");
+_Static_assert(sizeof(activity_raw_gps_rec_t) == 28, "raw GPS record layout changed");
+_Static_assert(ACTIVITY_RAW_BLOCK_SIZE % 512 == 0, "blocks must be whole sectors");
+_Static_assert(ACTIVITY_RAW_BLOCK_SIZE - sizeof(activity_raw_block_hdr_t) <= UINT16_MAX, "payload_len is 16 bits");
+
+typedef struct {
+    uint8_t *buf;
+    int64_t  base_us;           // copy of the header's base_mono_us
+    uint32_t len;               // bytes used, including the block header
+    uint16_t count;
+    raw_encoder_t enc;          // payload writer when s_encoding is RICE
+} raw_buf_t;
+
+static raw_buf_t s_bufs[RAW_NUM_BUFS];
+static int s_cur = -1;          // buffer being filled, -1 if none
+
+static QueueHandle_t s_free_q;
+static QueueHandle_t s_full_q;
+static SemaphoreHandle_t s_lock;
+static SemaphoreHandle_t s_done;
+
+static volatile bool s_running;
+static int s_fd = -1;
+static uint32_t s_seq;
+static activity_raw_encoding_t s_encoding;
+static activity_raw_config_t s_cfg;
+static activity_raw_stats_t s_stats;
+// s_stats is updated by producers and the writer task and read by anyone
+static portMUX_TYPE s_stats_lock = portMUX_INITIALIZER_UNLOCKED;
+
+/* -------------------------------------------------------------------------- */
+/* Blocks (producer side, s_lock held)                                        */
+/* -------------------------------------------------------------------------- */
+
+static void block_begin(raw_buf_t *b, int64_t t_us)
+{
+    t_us -= RAW_BASE_LEAD_US;
+    activity_raw_block_hdr_t h = {
+        .magic = ACTIVITY_RAW_BLOCK_MAGIC,
+        .version = ACTIVITY_RAW_VERSION,
+        .encoding = (uint8_t)s_encoding,
+        .seq = s_seq,
+        .dropped_blocks = s_stats.dropped_blocks,
+        .base_mono_us = t_us,
+        .base_utc_us = timebase_to_utc_us(t_us),
+        .accel_scale = s_cfg.accel_scale,
+        .gyro_scale = s_cfg.gyro_scale,
+    };
+    memcpy(b->buf, &h, sizeof(h));
+    b->base_us = t_us;
+    b->len = sizeof(h);
+    b->count = 0;
+    if (s_encoding == ACTIVITY_RAW_ENC_RICE) {
+        raw_encoder_init(&b->enc, b->buf + sizeof(h), ACTIVITY_RAW_BLOCK_SIZE - sizeof(h));
+    }
+}
+
+/* Hand the fill buffer to the writer, or drop its contents if none is free. */
+static void block_finish(void)
+{
+    raw_buf_t *b = &s_bufs[s_cur];
+    uint8_t next;
+
+    if (xQueueReceive(s_free_q, &next, 0) == pdTRUE) {
+        uint8_t idx = (uint8_t)s_cur;
+        xQueueSend(s_full_q, &idx, 0);      // cannot fail: the queue holds every buffer
+        s_seq++;
+        s_cur = next;
+    } else {
+        // Writer is behind on every buffer: reuse this one, keep the sequence number
+        taskENTER_CRITICAL(&s_stats_lock);
+        s_stats.dropped_blocks++;
+        s_stats.dropped_samples += b->count;
+        taskEXIT_CRITICAL(&s_stats_lock);
+    }
+}
+
+static raw_buf_t *block_next(int64_t t_us)
+{
+    block_finish();
+    raw_buf_t *b = &s_bufs[s_cur];
+    block_begin(b, t_us);
+    return b;
+}
+
+/* Fill buffer with an open block that can time-stamp a record at `t_us`. */
+static raw_buf_t *block_for(int64_t t_us, size_t len)
+{
+    raw_buf_t *b = &s_bufs[s_cur];
+
+    if (b->count == 0) {
+        block_begin(b, t_us);
+        return b;
+    }
+
+    int64_t off = t_us - b->base_us;
+    bool full = (s_encoding == ACTIVITY_RAW_ENC_NONE) && (b->len + len > ACTIVITY_RAW_BLOCK_SIZE);
+    if (full || off < 0 || off > ACTIVITY_RAW_TOFF_MAX) {
+        b = block_next(t_us);
+    }
+    return b;
+}
+
+static void put_imu_locked(int64_t t_us, const int16_t raw[6])
+{
+    raw_buf_t *b = block_for(t_us, sizeof(activity_raw_imu_rec_t));
+
+    if (s_encoding == ACTIVITY_RAW_ENC_RICE) {
+        if (!raw_encoder_put_imu(&b->enc, (uint32_t)(t_us - b->base_us), raw)) {
+            b = block_next(t_us);
+            raw_encoder_put_imu(&b->enc, (uint32_t)(t_us - b->base_us), raw);
+        }
+    } else {
+        activity_raw_imu_rec_t r = {
+            .tag_toff = ACTIVITY_RAW_TAG_WORD(ACTIVITY_RAW_TAG_IMU, (uint32_t)(t_us - b->base_us)),
+            .ax = raw[0], .ay = raw[1], .az = raw[2],
+            .gx = raw[3], .gy = raw[4], .gz = raw[5],
+        };
+        memcpy(b->buf + b->len, &r, sizeof(r));
+        b->len += sizeof(r);
+    }
+    b->count++;
+    taskENTER_CRITICAL(&s_stats_lock);
+    s_stats.samples++;
+    taskEXIT_CRITICAL(&s_stats_lock);
+}
+
+/* Any record other than an IMU sample; its first word is the tag/offset. */
+static void put_other_locked(int64_t t_us, activity_raw_tag_t tag, void *rec, size_t len)
+{
+    raw_buf_t *b = block_for(t_us, len);
+    uint32_t word = ACTIVITY_RAW_TAG_WORD(tag, (uint32_t)(t_us - b->base_us));
+    memcpy(rec, &word, sizeof(word));
+
+    if (s_encoding == ACTIVITY_RAW_ENC_RICE) {
+        if (!raw_encoder_put_other(&b->enc, rec, len)) {
+            b = block_next(t_us);
+            word = ACTIVITY_RAW_TAG_WORD(tag, (uint32_t)(t_us - b->base_us));
+            memcpy(rec, &word, sizeof(word));
+            raw_encoder_put_other(&b->enc, rec, len);
+        }
+    } else {
+        memcpy(b->buf + b->len, rec, len);
+        b->len += len;
+    }
+    b->count++;
+    taskENTER_CRITICAL(&s_stats_lock);
+    s_stats.samples++;
+    taskEXIT_CRITICAL(&s_stats_lock);
+}
+
+static void block_seal(raw_buf_t *b)
+{
+    activity_raw_block_hdr_t h;
+    memcpy(&h, b->buf, sizeof(h));
+    h.payload_len = (uint16_t)(b->len - sizeof(h));
+    h.count = b->count;
+    memcpy(b->buf, &h, sizeof(h));
+}
+
+/* -------------------------------------------------------------------------- */
+/* Writer task                                                                */
+/* -------------------------------------------------------------------------- */
+
+static void raw_writer_task(void *arg)
+{
+    (void)arg;
+    uint32_t since_sync = 0;
+
+    for (;;) {
+        uint8_t idx;
+        if (xQueueReceive(s_full_q, &idx, portMAX_DELAY) != pdTRUE) continue;
+        if (idx == RAW_Q_STOP) break;
+
+        raw_buf_t *b = &s_bufs[idx];
+        if (s_encoding == ACTIVITY_RAW_ENC_RICE) {
+            b->len = sizeof(activity_raw_block_hdr_t) + raw_encoder_finish(&b->enc);
+        }
+
+        // Header fields and CRC are filled here to keep the sampling core's share to a memcpy
+        block_seal(b);
+        activity_raw_block_hdr_t h;
+        memcpy(&h, b->buf, sizeof(h));
+        uint32_t crc = alog_crc32(0, b->buf + sizeof(h), b->len - sizeof(h));
+        h.crc = alog_crc32(crc, &h, offsetof(activity_raw_block_hdr_t, crc));
+        memcpy(b->buf, &h, sizeof(h));
+        memset(b->buf + b->len, 0, ACTIVITY_RAW_BLOCK_SIZE - b->len);
+
+        int64_t t0 = sd_io_begin();
+        ssize_t n = write(s_fd, b->buf, ACTIVITY_RAW_BLOCK_SIZE);
+        uint32_t dt = (uint32_t)(esp_timer_get_time() - t0);
+        sd_io_end(SD_IO_WRITE, t0, ACTIVITY_RAW_BLOCK_SIZE, n == ACTIVITY_RAW_BLOCK_SIZE);
+
+        taskENTER_CRITICAL(&s_stats_lock);
+        if (n > 0) s_stats.file_bytes += (uint32_t)n;
+        if (n != ACTIVITY_RAW_BLOCK_SIZE) s_stats.write_errors++;
+        else s_stats.blocks_written++;
+        if (dt > s_stats.max_write_us) s_stats.max_write_us = dt;
+        taskEXIT_CRITICAL(&s_stats_lock);
+        if (n != ACTIVITY_RAW_BLOCK_SIZE) ESP_LOGE(TAG, "block %lu write failed (%d)", (unsigned long)h.seq, (int)n);
+
+        if (++since_sync >= RAW_SYNC_EVERY) {
+            t0 = sd_io_begin();
+            int r = fsync(s_fd);
+            sd_io_end(SD_IO_SYNC, t0, 0, r == 0);
+            since_sync = 0;
+        }
+
+        xQueueSend(s_free_q, &idx, portMAX_DELAY);
+    }
+
+    xSemaphoreGive(s_done);
+    vTaskDelete(NULL);
+}
+
+/* -------------------------------------------------------------------------- */
+/* Public API                                                                 */
+/* -------------------------------------------------------------------------- */
+
+static void free_buffers(void)
+{
+    for (int i = 0; i < RAW_NUM_BUFS; i++) {
+        heap_caps_free(s_bufs[i].buf);
+        s_bufs[i].buf = NULL;
+    }
+}
+
+esp_err_t activity_raw_start(const char *path, const activity_raw_config_t *cfg)
+{
+    if (!path || !cfg) return ESP_ERR_INVALID_ARG;
+    if (s_running) return ESP_ERR_INVALID_STATE;
+
+    if (!s_lock) {
+        s_lock = xSemaphoreCreateMutex();
+        s_done = xSemaphoreCreateBinary();
+        s_free_q = xQueueCreate(RAW_NUM_BUFS, sizeof(uint8_t));
+        s_full_q = xQueueCreate(RAW_NUM_BUFS + 1, sizeof(uint8_t));
+        if (!s_lock || !s_done || !s_free_q || !s_full_q) return ESP_ERR_NO_MEM;
+    }
+
+    // Internal, DMA-capable and cache-line aligned: the SD driver can then
+    // transfer straight from the buffer without bouncing.
+    for (int i = 0; i < RAW_NUM_BUFS; i++) {
+        s_bufs[i].buf = heap_caps_aligned_alloc(64, ACTIVITY_RAW_BLOCK_SIZE,
+                                                MALLOC_CAP_DMA | MALLOC_CAP_INTERNAL);
+        if (!s_bufs[i].buf) {
+            s_bufs[i].buf = heap_caps_aligned_alloc(64, ACTIVITY_RAW_BLOCK_SIZE, MALLOC_CAP_8BIT);
+        }
+        if (!s_bufs[i].buf) {
+            ESP_LOGE(TAG, "no memory for %d x %d B buffers", RAW_NUM_BUFS, ACTIVITY_RAW_BLOCK_SIZE);
+            free_buffers();
+            return ESP_ERR_NO_MEM;
+        }
+    }
+
+    s_fd = open(path, O_WRONLY | O_CREAT | O_TRUNC, 0664);
+    if (s_fd < 0) {
+        ESP_LOGE(TAG, "open %s failed", path);
+        free_buffers();
+        return ESP_FAIL;
+    }
+
+    // Allocate the cluster chain now; stop() truncates to what was written
+    if (CONFIG_ACTIVITY_RAW_PREALLOC_MB > 0) {
+        off_t end = (off_t)CONFIG_ACTIVITY_RAW_PREALLOC_MB * 1024 * 1024;
+        uint8_t zero = 0;
+        if (lseek(s_fd, end - 1, SEEK_SET) < 0 || write(s_fd, &zero, 1) != 1) {
+            ESP_LOGW(TAG, "preallocate %d MB failed", CONFIG_ACTIVITY_RAW_PREALLOC_MB);
+        }
+        lseek(s_fd, 0, SEEK_SET);
+    }
+
+    xQueueReset(s_free_q);
+    xQueueReset(s_full_q);
+    xSemaphoreTake(s_done, 0);
+    for (uint8_t i = 1; i < RAW_NUM_BUFS; i++) {
+        xQueueSend(s_free_q, &i, 0);
+    }
+    s_cur = 0;
+    s_bufs[0].count = 0;
+    s_seq = 0;
+    s_encoding = CONFIG_ACTIVITY_RAW_COMPRESS ? ACTIVITY_RAW_ENC_RICE : ACTIVITY_RAW_ENC_NONE;
+    s_cfg = *cfg;
+    taskENTER_CRITICAL(&s_stats_lock);
+    memset(&s_stats, 0, sizeof(s_stats));
+    taskEXIT_CRITICAL(&s_stats_lock);
+
+    if (xTaskCreatePinnedToCore(raw_writer_task, "raw_writer", RAW_WRITER_STACK, NULL,
+                                RAW_WRITER_PRIO, NULL, CONFIG_ACTIVITY_RAW_WRITER_CORE) != pdPASS) {
+        close(s_fd);
+        s_fd = -1;
+        free_buffers();
+        return ESP_ERR_NO_MEM;
+    }
+
+    s_running = true;
+    ESP_LOGI(TAG, "Raw capture -> %s (%d x %d KB)", path, RAW_NUM_BUFS, ACTIVITY_RAW_BLOCK_SIZE / 1024);
+    return ESP_OK;
+}
+
+esp_err_t activity_raw_stop(void)
+{
+    if (!s_running) return ESP_OK;
+
+    xSemaphoreTake(s_lock, portMAX_DELAY);
+    s_running = false;
+    if (s_bufs[s_cur].count > 0) {
+        uint8_t idx = (uint8_t)s_cur;
+        xQueueSend(s_full_q, &idx, portMAX_DELAY);
+    }
+    s_cur = -1;
+    xSemaphoreGive(s_lock);
+
+    uint8_t stop = RAW_Q_STOP;
+    xQueueSend(s_full_q, &stop, portMAX_DELAY);
+    xSemaphoreTake(s_done, portMAX_DELAY);
+
+    if (ftruncate(s_fd, (off_t)s_stats.file_bytes) != 0) {
+        ESP_LOGW(TAG, "truncate failed");
+    }
+    fsync(s_fd);
+    close(s_fd);
+    s_fd = -1;
+    free_buffers();
+
+    ESP_LOGI(TAG, "Raw capture stopped: %lu samples, %lu blocks, %lu dropped (%lu samples), max write %lu us",
+             (unsigned long)s_stats.samples, (unsigned long)s_stats.blocks_written,
+             (unsigned long)s_stats.dropped_blocks, (unsigned long)s_stats.dropped_samples,
+             (unsigned long)s_stats.max_write_us);
+    return ESP_OK;
+}
+
+bool activity_raw_is_running(void)
+{
+    return s_running;
+}
+
+void activity_raw_push_imu(int64_t t_us, const int16_t raw[6])
+{
+    if (!s_running || !raw) return;
+
+    xSemaphoreTake(s_lock, portMAX_DELAY);
+    if (s_running) put_imu_locked(t_us, raw);
+    xSemaphoreGive(s_lock);
+}
+
+static uint16_t q_u16(float v, float per_unit)
+{
+    if (isnan(v) || v < 0.0f) return UINT16_MAX;
+    float q = v * per_unit + 0.5f;
+    return (q >= (float)(UINT16_MAX - 1)) ? (UINT16_MAX - 1) : (uint16_t)q;
+}
+
+void activity_raw_push_gps(int64_t t_us, const activity_raw_gps_t *gps)
+{
+    if (!s_running || !gps) return;
+
+    activity_raw_gps_rec_t r = {
+        .lat_e7 = gps->valid_fix ? (int32_t)lround(gps->lat_deg * 1e7) : 0,
+        .lon_e7 = gps->valid_fix ? (int32_t)lround(gps->lon_deg * 1e7) : 0,
+        .utc_s = gps->valid_time ? (uint32_t)(gps->utc_us / 1000000) : 0,
+        .utc_ms = gps->valid_time ? (uint16_t)((gps->utc_us / 1000) % 1000) : 0,
+        .speed_cmps = q_u16(gps->speed_mps, 100.0f),
+        .course_cdeg = q_u16(gps->course_deg, 100.0f),
+        .hdop_x10 = q_u16(gps->hdop, 10.0f),
+        .sats = (int8_t)gps->sats,
+        .fix_quality = (int8_t)gps->fix_quality,
+        .flags = (gps->valid_fix ? ACTIVITY_RAW_GPS_FIX : 0) | (gps->valid_time ? ACTIVITY_RAW_GPS_TIME : 0),
+    };
+
+    xSemaphoreTake(s_lock, portMAX_DELAY);
+    if (s_running) put_other_locked(t_us, ACTIVITY_RAW_TAG_GPS, &r, sizeof(r));
+    xSemaphoreGive(s_lock);
+}
+
+void activity_raw_get_stats(activity_raw_stats_t *out)
+{
+    if (!out) return;
+    taskENTER_CRITICAL(&s_stats_lock);
+    *out = s_stats;
+    out->running = s_running;
+    taskEXIT_CRITICAL(&s_stats_lock);
+}
@@ -0,0 +1,277 @@
+// components/activity_log/activity_raw_codec.c
+#include "activity_raw_codec.h"
+#include "activity_raw_format.h"
+
+#include <string.h>
+
+#define RICE_QMAX       24              // unary run that marks an escape
+#define RICE_ESC_BITS   32
+#define RICE_KMAX       24
+#define RICE_N_MAX      64              // halve the running sums at this count
+#define RICE_A_INIT     16
+#define COST_SHIFT      4               // prediction cost decay: 1/16 per sample
+#define COST_MAX        (1u << 20)      // cap per-sample cost so outliers do not stick
+
+#define CH_TIME         0
+
+// Worst case for one IMU record: flag + 7 escaped residuals
+#define IMU_MAX_BITS    (1 + RAW_CODEC_CHANNELS * (RICE_QMAX + RICE_ESC_BITS))
+
+/* -------------------------------------------------------------------------- */
+/* Shared model                                                               */
+/* -------------------------------------------------------------------------- */
+
+static inline uint32_t zigzag(int32_t v)
+{
+    return ((uint32_t)v << 1) ^ (uint32_t)(v >> 31);
+}
+
+static inline int32_t unzigzag(uint32_t u)
+{
+    return (int32_t)(u >> 1) ^ -(int32_t)(u & 1);
+}
+
+static void state_reset(raw_codec_state_t *st)
+{
+    memset(st, 0, sizeof(*st));
+    for (int i = 0; i < RAW_CODEC_CHANNELS; i++) {
+        st->ch[i].a = RICE_A_INIT;
+        st->ch[i].n = 1;
+    }
+}
+
+static inline int rice_k(const raw_codec_chan_t *c)
+{
+    int k = 0;
+    while (k < RICE_KMAX && (c->n << k) < c->a) k++;
+    return k;
+}
+
+/* Prediction for the next value, given how many samples this block has seen. */
+static inline int32_t predict(const raw_codec_chan_t *c, uint32_t n_imu)
+{
+    if (n_imu >= 3 && c->e2 < c->e1) return 2 * c->p1 - c->p2;
+    return c->p1;
+}
+
+/* Fold the true value into the channel's model (both sides run this). */
+static void chan_update(raw_codec_chan_t *c, uint32_t n_imu, int32_t x, uint32_t code)
+{
+    if (n_imu >= 1) {
+        uint32_t z1 = zigzag(x - c->p1);
+        c->e1 += (z1 > COST_MAX ? COST_MAX : z1) - (c->e1 >> COST_SHIFT);
+    }
+    if (n_imu >= 2) {
+        uint32_t z2 = zigzag(x - (2 * c->p1 - c->p2));
+        c->e2 += (z2 > COST_MAX ? COST_MAX : z2) - (c->e2 >> COST_SHIFT);
+    }
+
+    if (n_imu >= 1) {
+        c->a += (code > (1u << 24)) ? (1u << 24) : code;
+        if (++c->n >= RICE_N_MAX) {
+            c->a >>= 1;
+            c->n >>= 1;
+        }
+    }
+
+    c->p2 = c->p1;
+    c->p1 = x;
+}
+
+/* -------------------------------------------------------------------------- */
+/* Encoder                                                                    */
+/* -------------------------------------------------------------------------- */
+
+static inline void put_bits(raw_encoder_t *e, uint32_t v, int n)
+{
+    e->acc = (e->acc << n) | (n == 32 ? v : (v & ((1u << n) - 1u)));
+    e->nacc += n;
+    while (e->nacc >= 8) {
+        e->nacc -= 8;
+        e->out[e->pos++] = (uint8_t)(e->acc >> e->nacc);
+    }
+}
+
+static inline void put_ones(raw_encoder_t *e, int n)
+{
+    while (n > 0) {
+        int m = n > 24 ? 24 : n;
+        put_bits(e, (1u << m) - 1u, m);
+        n -= m;
+    }
+}
+
+static void put_rice(raw_encoder_t *e, raw_codec_chan_t *c, uint32_t u)
+{
+    int k = rice_k(c);
+    uint32_t q = u >> k;
+    if (q < RICE_QMAX) {
+        put_ones(e, (int)q);
+        put_bits(e, 0, 1);
+        if (k) put_bits(e, u, k);
+    } else {
+        put_ones(e, RICE_QMAX);
+        put_bits(e, u, RICE_ESC_BITS);
+    }
+}
+
+static inline size_t bytes_free(const raw_encoder_t *e)
+{
+    return e->cap - e->pos - 1;         // one byte for bits still in acc
+}
+
+void raw_encoder_init(raw_encoder_t *e, uint8_t *out, size_t cap)
+{
+    e->out = out;
+    e->cap = cap;
+    e->pos = 0;
+    e->acc = 0;
+    e->nacc = 0;
+    state_reset(&e->st);
+}
+
+bool raw_encoder_put_imu(raw_encoder_t *e, uint32_t toff, const int16_t v[6])
+{
+    if (bytes_free(e) < (IMU_MAX_BITS + 7) / 8) return false;
+
+    raw_codec_state_t *st = &e->st;
+    int32_t x[RAW_CODEC_CHANNELS] = { (int32_t)toff, v[0], v[1], v[2], v[3], v[4], v[5] };
+
+    put_bits(e, 0, 1);
+
+    if (st->n_imu == 0) {
+        // Keyframe
+        put_bits(e, toff, ACTIVITY_RAW_TOFF_BITS);
+        for (int i = 1; i < RAW_CODEC_CHANNELS; i++) put_bits(e, (uint16_t)x[i], 16);
+        for (int i = 0; i < RAW_CODEC_CHANNELS; i++) chan_update(&st->ch[i], 0, x[i], 0);
+    } else {
+        for (int i = 0; i < RAW_CODEC_CHANNELS; i++) {
+            raw_codec_chan_t *c = &st->ch[i];
+            uint32_t u = zigzag(x[i] - predict(c, st->n_imu));
+            put_rice(e, c, u);
+            chan_update(c, st->n_imu, x[i], u);
+        }
+    }
+    st->n_imu++;
+    return true;
+}
+
+bool raw_encoder_put_other(raw_encoder_t *e, const void *rec, size_t len)
+{
+    if (len > UINT8_MAX || bytes_free(e) < len + 2) return false;
+
+    put_bits(e, 1, 1);
+    put_bits(e, (uint32_t)len, 8);
+    const uint8_t *p = (const uint8_t *)rec;
+    for (size_t i = 0; i < len; i++) put_bits(e, p[i], 8);
+    return true;
+}
+
+size_t raw_encoder_finish(raw_encoder_t *e)
+{
+    if (e->nacc > 0) put_bits(e, 0, 8 - e->nacc);
+    return e->pos;
+}
+
+/* -------------------------------------------------------------------------- */
+/* Decoder                                                                    */
+/* -------------------------------------------------------------------------- */
+
+static inline size_t bits_left(const raw_decoder_t *d)
+{
+    return (d->len - d->pos) * 8 + (size_t)d->nacc;
+}
+
+static inline bool get_bits(raw_decoder_t *d, int n, uint32_t *v)
+{
+    while (d->nacc < n) {
+        if (d->pos >= d->len) return false;
+        d->acc = (d->acc << 8) | d->in[d->pos++];
+        d->nacc += 8;
+    }
+    d->nacc -= n;
+    *v = (uint32_t)(d->acc >> d->nacc) & (n == 32 ? 0xFFFFFFFFu : ((1u << n) - 1u));
+    return true;
+}
+
+static bool get_rice(raw_decoder_t *d, const raw_codec_chan_t *c, uint32_t *u)
+{
+    uint32_t q = 0, bit;
+    for (;;) {
+        if (!get_bits(d, 1, &bit)) return false;
+        if (!bit) break;
+        if (++q == RICE_QMAX) return get_bits(d, RICE_ESC_BITS, u);
+    }
+
+    int k = rice_k(c);
+    uint32_t low = 0;
+    if (k && !get_bits(d, k, &low)) return false;
+    *u = (q << k) | low;
+    return true;
+}
+
+void raw_decoder_init(raw_decoder_t *d, const uint8_t *in, size_t len)
+{
+    d->in = in;
+    d->len = len;
+    d->pos = 0;
+    d->acc = 0;
+    d->nacc = 0;
+    state_reset(&d->st);
+}
+
+int raw_decoder_next(raw_decoder_t *d, void *out, size_t cap)
+{
+    // The shortest record is 8 bits; anything less is end padding
+    if (bits_left(d) < 8) return 0;
+
+    uint32_t flag;
+    if (!get_bits(d, 1, &flag)) return -1;
+
+    if (flag) {
+        uint32_t len;
+        if (!get_bits(d, 8, &len) || len > cap) return -1;
+        uint8_t *p = (uint8_t *)out;
+        for (uint32_t i = 0; i < len; i++) {
+            uint32_t b;
+            if (!get_bits(d, 8, &b)) return -1;
+            p[i] = (uint8_t)b;
+        }
+        return (int)len;
+    }
+
+    if (cap < sizeof(activity_raw_imu_rec_t)) return -1;
+
+    raw_codec_state_t *st = &d->st;
+    int32_t x[RAW_CODEC_CHANNELS];
+
+    if (st->n_imu == 0) {
+        uint32_t v;
+        if (!get_bits(d, ACTIVITY_RAW_TOFF_BITS, &v)) return -1;
+        x[0] = (int32_t)v;
+        for (int i = 1; i < RAW_CODEC_CHANNELS; i++) {
+            if (!get_bits(d, 16, &v)) return -1;
+            x[i] = (int16_t)v;
+        }
+        for (int i = 0; i < RAW_CODEC_CHANNELS; i++) chan_update(&st->ch[i], 0, x[i], 0);
+    } else {
+        for (int i = 0; i < RAW_CODEC_CHANNELS; i++) {
+            raw_codec_chan_t *c = &st->ch[i];
+            uint32_t u;
+            if (!get_rice(d, c, &u)) return -1;
+            x[i] = predict(c, st->n_imu) + unzigzag(u);
+            chan_update(c, st->n_imu, x[i], u);
+        }
+    }
+    st->n_imu++;
+
+    if (x[CH_TIME] < 0 || (uint32_t)x[CH_TIME] > ACTIVITY_RAW_TOFF_MAX) return -1;
+
+    activity_raw_imu_rec_t r = {
+        .tag_toff = ACTIVITY_RAW_TAG_WORD(ACTIVITY_RAW_TAG_IMU, (uint32_t)x[CH_TIME]),
+        .ax = (int16_t)x[1], .ay = (int16_t)x[2], .az = (int16_t)x[3],
+        .gx = (int16_t)x[4], .gy = (int16_t)x[5], .gz = (int16_t)x[6],
+    };
+    memcpy(out, &r, sizeof(r));
+    return (int)sizeof(r);
+}
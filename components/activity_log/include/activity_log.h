@@ -7,35 +7,22 @@
 #include <time.h>
 #include "sd_mmc_helper.h" 
 #include "esp_err.h"
+#include "activity_log_types.h"
+#include "activity_log_bin.h"
+#include "activity_log_ring.h"
+#include "activity_log_split.h"
+#include "fit_writer.h"
 
-// Struct for Split Data (The "Summary Row")
-typedef struct {
-    int split_index;          
-    float total_dist_m;       
-    float split_dist_m;       
-    float split_time_s;       
-    float split_pace_s;       
-    float avg_spm;            
-} activity_log_split_row_t;
-
-// Existing Stroke Row
-typedef struct {
-    time_t rtc_time;
-    float session_time_s;
-    float total_distance_m;
-    float pace_500m_s;
-    float spm_instant;
-    float avg_pace_500m_s;
-    float avg_speed_mps;
-    float stroke_length_m;
-    uint32_t stroke_count;
-    double gps_lat;
-    double gps_lon;
-    float power_w;
-    float drive_time_s;
-    float recovery_time_s;
-    float recovery_ratio;
-} activity_log_row_t;
+/* File names are "<filename_base><suffix>" below the mount point */
+#define ACTIVITY_LOG_SUFFIX_STROKES_CSV "_Strokes.csv"
+#define ACTIVITY_LOG_SUFFIX_STROKES_BIN "_Strokes.bin"
+#define ACTIVITY_LOG_SUFFIX_SPLITS      "_Splits.csv"
+#define ACTIVITY_LOG_SUFFIX_FIT         ".fit"
+
+typedef enum {
+    ACTIVITY_LOG_FORMAT_CSV = 0,    // <base>_Strokes.csv, one fprintf per stroke
+    ACTIVITY_LOG_FORMAT_BINARY,     // <base>_Strokes.bin, see activity_log_bin.h
+} activity_log_format_t;
 
 // Main Log Handle
 typedef struct {
@@ -43,21 +30,83 @@ typedef struct {
     FILE *f_main;             // <--- Updated
     FILE *f_splits;           // <--- Updated
     char filename_base[128];   
-    uint32_t flush_every_n;   
-    uint32_t pending;         
     char rel_path[96];        // kept for backward compat if needed
 
-    float split_interval_m;      // Configured interval (e.g. 1000m)
-    float last_split_dist_m;     // Distance when last split occurred
-    float last_split_time_s;     // Time when last split occurred
-    int   next_split_index;      // 1, 2, 3...
+    char *batch;                 // CSV rows formatted since the last commit (CONFIG_ACTIVITY_LOG_IO_BUF_KB)
+    size_t batch_len;
+    bool splits_dirty;           // split rows not flushed yet
+
+    alog_split_mode_t split_mode;
+    float split_interval;        // m or s, see split_mode (e.g. 1000m)
+    int32_t utc_offset_s;        // Local time offset the CSV timestamps use
+
+    activity_log_format_t format;
+    alog_bin_writer_t bin;        // Block being filled (binary format)
+    alog_bin_file_hdr_t bin_hdr;  // Fixed part of the file header
+    bool bin_hdr_dirty;           // Header must be rewritten on the next flush
+
+    bool fit_enabled;             // Also write <base>.fit (see fit_writer.h)
+    FILE *f_fit;
+    fit_writer_t fit;
 } activity_log_t;
 
 void activity_log_init(activity_log_t *log);
 esp_err_t activity_log_start(activity_log_t *log, sd_mmc_helper_t *sd, time_t start_time, uint32_t session_id);
 esp_err_t activity_log_stop(activity_log_t *log);
+
+/* Rows and splits are buffered (CSV rows in `batch`, binary rows in the
+ * current block) until activity_log_commit() writes them with one write
+ * per file. */
 esp_err_t activity_log_append(activity_log_t *log, const activity_log_row_t *row);
+esp_err_t activity_log_commit(activity_log_t *log);
+
+/* Take everything waiting in `ring` (activity_log_msg_t in sample order),
+ * append it and commit once. Messages are discarded while no log is open.
+ * Returns how many were taken. */
+uint32_t activity_log_drain(activity_log_t *log, activity_log_ring_t *ring);
+/* Write a split closed by the split engine, and a FIT lap for it. */
 esp_err_t activity_log_append_split(activity_log_t *log, const activity_log_split_row_t *row);
+/* Write the split still open at session end (alog_split_finish), before
+ * activity_log_stop(), which closes its FIT lap. */
+esp_err_t activity_log_append_last_split(activity_log_t *log, const activity_log_split_row_t *row);
+
+/* Configure automatic splits (e.g., every 500m). 0 selects the 1000 m default. */
+void activity_log_set_split_interval(activity_log_t *log, uint32_t interval_m);
+
+/* Time-based splits instead (e.g., every 120 s). */
+void activity_log_set_split_time(activity_log_t *log, uint32_t interval_s);
+
+/* Reset a split engine to the configured splits. The logger only writes
+ * the splits; the owner of the sample stream runs the engine (see
+ * activity_log_split.h) and hands closed splits to activity_log_append_split(). */
+void activity_log_split_init(const activity_log_t *log, alog_split_state_t *s);
+
+/* Select the stroke file format for the next activity_log_start(). Default CSV. */
+void activity_log_set_format(activity_log_t *log, activity_log_format_t format);
+
+/* Also stream a FIT activity file next to the stroke log from the next
+ * activity_log_start(). Default off. */
+void activity_log_set_fit(activity_log_t *log, bool enabled);
+
+/* Bytes of the stroke/splits files that hold real data. The stroke file is
+ * preallocated (CONFIG_ACTIVITY_LOG_PREALLOC_KB), so its size on the card is
+ * larger until activity_log_stop() truncates it. */
+long activity_log_main_length(const activity_log_t *log);
+long activity_log_splits_length(const activity_log_t *log);
+
+/* Flush and fsync the log files so everything appended so far survives a power cut. */
+esp_err_t activity_log_sync(activity_log_t *log);
+
+/* Write the header of a binary stroke log's last block if it has none:
+ * the block open when power was cut, its records written but its header
+ * only due when it closed. Call after truncating to the journaled length. */
+esp_err_t activity_log_seal_tail(const char *bin_path);
+
+/* Convert a binary stroke log to the same CSV the CSV format writes.
+ * Damaged blocks are skipped. */
+esp_err_t activity_log_export_csv(const char *bin_path, const char *csv_path);
 
-/* Configure automatic splits (e.g., every 500m). 0 to disable. */
-void activity_log_set_split_interval(activity_log_t *log, uint32_t interval_m);
\ No newline at end of file
+/* Encode a binary stroke log as the FIT file the session would have
+ * streamed, laps replayed from its split settings. Damaged blocks are
+ * skipped. */
+esp_err_t activity_log_export_fit(const char *bin_path, const char *fit_path);
@@ -0,0 +1,167 @@
+// components/activity_log/include/activity_log_bin.h
+#pragma once
+
+/*
+ * Binary stroke log ("<base>_Strokes.bin").
+ *
+ * Layout (all little-endian):
+ *
+ *   [file header, ALOG_BIN_HEADER_SIZE bytes]
+ *       alog_bin_file_hdr_t
+ *       field_count x alog_bin_field_t   (describes alog_bin_record_t)
+ *       uint32 crc32 of everything above
+ *       zero padding
+ *   [block 0][block 1]...                (ALOG_BIN_BLOCK_SIZE each, last may be short)
+ *       alog_bin_block_hdr_t
+ *       count x alog_bin_record_t
+ *
+ * Blocks live at fixed offsets, so any block can be read and CRC-checked on
+ * its own. While a session runs, the block being filled gets its records
+ * appended at each commit but its header only when it closes, so until
+ * then its header on the card is not valid (alog_bin_seal_block()). The
+ * writer appends with a memcpy; CSV is produced by an export step
+ * (activity_log_export_csv() on the device, the host converter off it).
+ *
+ * Columns the CSV derives (paces, average speed, stroke length, recovery
+ * ratio) are not stored; alog_bin_unpack() rebuilds them.
+ *
+ * Plain C only: this header and activity_log_bin.c build on the host too.
+ */
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "activity_log_types.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define ALOG_BIN_MAGIC          "RCSL"
+#define ALOG_BIN_BLOCK_MAGIC    0x42534352u     // "RCSB"
+#define ALOG_BIN_VERSION        2
+
+#define ALOG_BIN_HEADER_SIZE    512
+#define ALOG_BIN_BLOCK_SIZE     4096
+#define ALOG_BIN_FIELD_NAME_LEN 12
+
+typedef enum {
+    ALOG_FT_U8 = 1,
+    ALOG_FT_U16,
+    ALOG_FT_U32,
+    ALOG_FT_I32,
+} alog_bin_field_type_t;
+
+/* One stroke, 28 bytes. Field order keeps every member naturally aligned.
+ * Power, drive and recovery are kept at the resolution the CSV prints them
+ * with, so an export writes the values the device had. */
+typedef struct {
+    uint32_t session_ms;        // session time, ms
+    uint32_t dist_dm;           // total distance, 0.1 m
+    int32_t  lat_e7;            // 1e-7 deg, 0 = no fix
+    int32_t  lon_e7;            // 1e-7 deg, 0 = no fix
+    uint16_t speed_cmps;        // instantaneous speed, cm/s
+    uint16_t stroke_count;      // low 16 bits; readers unwrap (only ever grows)
+    uint16_t power_dw;          // power, 0.1 W
+    uint16_t drive_10ms;        // drive time, 10 ms
+    uint16_t recovery_10ms;     // recovery time, 10 ms
+    uint8_t  spm_x4;            // 0.25 spm
+    uint8_t  reserved;          // 0
+} alog_bin_record_t;
+
+typedef struct {
+    char     magic[4];          // ALOG_BIN_MAGIC
+    uint16_t version;
+    uint16_t header_size;       // ALOG_BIN_HEADER_SIZE
+    uint16_t block_size;        // ALOG_BIN_BLOCK_SIZE
+    uint16_t record_size;       // sizeof(alog_bin_record_t)
+    uint16_t field_count;
+    uint16_t split_mode;        // alog_split_mode_t (0 = distance in files before it existed)
+    uint32_t session_id;
+    uint32_t split_interval;    // m, or s for time splits
+    int64_t  start_utc_us;      // timebase UTC at session_ms == 0
+    int32_t  utc_offset_s;      // local time offset used by the device
+    int32_t  rate_ppb;          // timebase rate: utc = start + t * (1 + rate * 1e-9)
+} alog_bin_file_hdr_t;
+
+typedef struct {
+    char     name[ALOG_BIN_FIELD_NAME_LEN];
+    uint8_t  type;              // alog_bin_field_type_t
+    uint8_t  offset;            // byte offset in the record
+    uint16_t reserved;
+    float    scale;             // value = raw * scale
+} alog_bin_field_t;
+
+typedef struct {
+    uint32_t magic;             // ALOG_BIN_BLOCK_MAGIC
+    uint32_t seq;               // block index in the file
+    uint16_t count;             // valid records in this block
+    uint16_t reserved;
+    uint32_t crc;               // crc32(records) continued over bytes 0..11 of this header
+} alog_bin_block_hdr_t;
+
+#define ALOG_BIN_RECORDS_PER_BLOCK \
+    ((ALOG_BIN_BLOCK_SIZE - sizeof(alog_bin_block_hdr_t)) / sizeof(alog_bin_record_t))
+
+/* Block being filled. The buffer is ALOG_BIN_BLOCK_SIZE bytes, owned by the caller. */
+typedef struct {
+    uint8_t  *block;
+    uint32_t  seq;              // index of the block being filled
+    uint16_t  count;            // records in the current block
+    uint16_t  flushed;          // records of the current block already written out
+    uint32_t  rec_crc;          // running crc32 over the current block's records
+} alog_bin_writer_t;
+
+/* Reader state carried between records (stroke count unwrap). */
+typedef struct {
+    uint32_t stroke_count;
+    bool     have_prev;
+} alog_bin_unpack_state_t;
+
+uint32_t alog_crc32(uint32_t crc, const void *buf, size_t len);
+
+/* Build the 512-byte file header (incl. field table and CRC) into `out`. */
+void alog_bin_build_header(const alog_bin_file_hdr_t *hdr, uint8_t out[ALOG_BIN_HEADER_SIZE]);
+
+/* Validate magic/version/CRC and copy the fixed part out. Returns false if unusable. */
+bool alog_bin_parse_header(const uint8_t *buf, size_t len, alog_bin_file_hdr_t *out);
+
+/* Field table as written into headers (for tools that want names/scales). */
+const alog_bin_field_t *alog_bin_fields(size_t *count);
+
+void alog_bin_pack(const activity_log_row_t *row, alog_bin_record_t *out);
+void alog_bin_unpack(const alog_bin_file_hdr_t *hdr, const alog_bin_record_t *rec,
+                     alog_bin_unpack_state_t *st, activity_log_row_t *out);
+
+void alog_bin_writer_reset(alog_bin_writer_t *w, uint8_t *block_buf);
+/* Append one record; returns true when the block is full and must be written. */
+bool alog_bin_writer_append(alog_bin_writer_t *w, const alog_bin_record_t *rec);
+/* Refresh the block header (count + CRC) before the block is written. */
+void alog_bin_writer_seal(alog_bin_writer_t *w);
+/* Build the header of a block read back without a valid one: every whole
+ * record in `len` counts. Returns the record count. */
+int alog_bin_seal_block(uint8_t *blk, size_t len, uint32_t seq);
+/* Start the next block after a full one has been written. */
+void alog_bin_writer_next(alog_bin_writer_t *w);
+
+/* File offset of block `seq`. */
+static inline long alog_bin_block_offset(uint32_t seq)
+{
+    return (long)ALOG_BIN_HEADER_SIZE + (long)seq * ALOG_BIN_BLOCK_SIZE;
+}
+
+/*
+ * Check one block read from the file (`len` may be short for the last one).
+ * Returns the number of valid records, or -1 if the block is damaged.
+ */
+int alog_bin_check_block(const uint8_t *blk, size_t len, uint32_t expect_seq);
+
+static inline const alog_bin_record_t *alog_bin_block_records(const uint8_t *blk)
+{
+    return (const alog_bin_record_t *)(blk + sizeof(alog_bin_block_hdr_t));
+}
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,71 @@
+// components/activity_log/include/activity_log_csv.h
+#pragma once
+
+/*
+ * Text layouts of "<base>_Strokes.csv" and "<base>_Splits.csv".
+ *
+ * Times are printed in local time as utc + utc_offset_s, so the device and the
+ * host converter produce the same bytes whatever the host's TZ is.
+ *
+ * Plain C only: the host tools link this file.
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+
+#include "activity_log_split.h"
+#include "activity_log_types.h"
+#include "rolling_metrics.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define ALOG_CSV_STROKE_HEADER \
+    "Global Time,Session Time,Distance (m),Pace (/500m),SPM,Avg Pace (/500m),Average Speed (m/s)," \
+    "Stroke Length (m),Stroke Count,gps_lat,gps_lon,Power (W),Drive Time (s),Recovery Time (s),Recovery Ratio," \
+    "Pace Last 500m (/500m),SPM Last 10\n"
+
+#define ALOG_CSV_SPLITS_COLUMNS \
+    "Split #,Total Dist (m),Split Dist (m),Split Time,Avg Pace (/500m),Avg SPM,Strokes\n"
+
+/* "YYYY-MM-DD HH:MM:SS" (len >= 20) */
+void alog_csv_format_time(int64_t utc_s, int32_t utc_offset_s, char *buf, size_t len);
+
+/* "HH:MM:SS.mmm" */
+void alog_csv_format_session_time(int64_t total_us, char *buf, size_t len);
+
+/* "MM:SS.s", or "--:--.-" outside (0, 3600] s */
+void alog_csv_format_pace(float seconds, char *buf, size_t len);
+
+/* Longest line alog_csv_format_stroke() produces, newline included */
+#define ALOG_CSV_STROKE_MAX 384
+
+/*
+ * Rebuilds the rolling columns for rows read back from a binary log (which
+ * does not store them). Feed every row in order.
+ */
+#define ALOG_CSV_ROLL_HISTORY 128
+
+typedef struct {
+    rolling_metrics_t rm;
+    rm_sample_t hist[ALOG_CSV_ROLL_HISTORY];
+} alog_csv_roll_t;
+
+void alog_csv_roll_init(alog_csv_roll_t *r);
+void alog_csv_roll_fill(alog_csv_roll_t *r, activity_log_row_t *row);
+
+/* Format one stroke line into buf. Returns its length, 0 if it does not fit. */
+size_t alog_csv_format_stroke(char *buf, size_t len, const activity_log_row_t *row, int32_t utc_offset_s);
+
+void alog_csv_write_stroke(FILE *f, const activity_log_row_t *row, int32_t utc_offset_s);
+
+/* Metadata lines and the column header that open a splits file. */
+void alog_csv_write_splits_preamble(FILE *f, int64_t start_utc_s, int32_t utc_offset_s,
+                                    alog_split_mode_t split_mode, float split_interval, uint32_t activity_id);
+
+void alog_csv_write_split(FILE *f, const activity_log_split_row_t *row);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,57 @@
+// components/activity_log/include/activity_log_ring.h
+#pragma once
+
+/*
+ * Single-producer / single-consumer ring of activity_log_msg_t between the
+ * sampling task and the logger task.
+ *
+ * The producer copies a message into the next free slot and publishes it
+ * with one atomic store; nothing blocks and no kernel object is involved.
+ * The consumer takes the whole backlog as (at most two) contiguous runs of
+ * slots and processes them in place, so a batch costs one pass over the
+ * ring instead of a queue receive per row. A push into a full ring is
+ * dropped and counted.
+ *
+ * Several consumer contexts are fine as long as they are serialised (the
+ * logger holds s_log_mutex around every drain).
+ *
+ * Plain C11 only: the host tools link this file.
+ */
+
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "activity_log_types.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct {
+    activity_log_msg_t *slots;
+    uint32_t mask;              // capacity - 1 (capacity is a power of two)
+    atomic_uint_fast32_t head;  // next slot the producer writes
+    atomic_uint_fast32_t tail;  // next slot the consumer reads
+    atomic_uint_fast32_t dropped;
+    uint32_t high_water;        // most messages ever waiting (consumer side)
+} activity_log_ring_t;
+
+/* `capacity` must be a power of two. */
+void alog_ring_init(activity_log_ring_t *r, activity_log_msg_t *slots, uint32_t capacity);
+
+/* Producer. False (and counted) if the ring is full. */
+bool alog_ring_push(activity_log_ring_t *r, const activity_log_msg_t *msg);
+
+uint32_t alog_ring_count(activity_log_ring_t *r);
+uint32_t alog_ring_capacity(const activity_log_ring_t *r);
+uint32_t alog_ring_dropped(activity_log_ring_t *r);
+
+/* Consumer: the oldest contiguous run of waiting messages. Returns its
+ * length (0 if empty); call alog_ring_release() once they are consumed. */
+uint32_t alog_ring_peek(activity_log_ring_t *r, const activity_log_msg_t **first);
+void alog_ring_release(activity_log_ring_t *r, uint32_t n);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,67 @@
+// components/activity_log/include/activity_log_split.h
+#pragma once
+
+/*
+ * Distance or time splits over a session. The device feeds it every sensor
+ * sample (stroke_task, 200 Hz) and every catch; the host converter replays
+ * it over the stroke rows of a binary log to rebuild splits/laps.
+ *
+ * The open split keeps running sums only, so a sample or a stroke costs the
+ * same at any split length. The boundary is placed where the line between
+ * two samples crosses it, so split times are not quantised to the sample
+ * (or stroke) period.
+ *
+ * Plain C only: the host tools link this file.
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "activity_log_types.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef enum {
+    ALOG_SPLIT_DISTANCE = 0,    // interval in meters
+    ALOG_SPLIT_TIME,            // interval in seconds
+} alog_split_mode_t;
+
+typedef struct {
+    alog_split_mode_t mode;
+    float   interval;           // m or s; 0 disables splits
+    int     next_index;         // 1, 2, 3...
+
+    // Where the open split started
+    int64_t start_time_us;      // session time
+    float   start_dist_m;
+
+    // Last sample seen (or the boundary just closed)
+    int64_t prev_time_us;
+    float   prev_dist_m;
+
+    // Running sums over the open split
+    uint32_t strokes;
+    float   spm_sum;
+    float   power_sum;
+} alog_split_state_t;
+
+void alog_split_init(alog_split_state_t *s, alog_split_mode_t mode, float interval);
+
+/* Feed one sample (session time, total distance). Returns true and fills
+ * `out` when the segment since the previous sample crosses a boundary. At
+ * most one split closes per call: feeding the same sample again returns
+ * the next one, if a jump crossed several. */
+bool alog_split_sample(alog_split_state_t *s, int64_t session_time_us, float total_distance_m,
+                       activity_log_split_row_t *out);
+
+/* Count a catch into the open split. Feed its sample first. */
+void alog_split_stroke(alog_split_state_t *s, float spm, float power_w);
+
+/* The open split at session end. False if it is empty. */
+bool alog_split_finish(alog_split_state_t *s, activity_log_split_row_t *out);
+
+#ifdef __cplusplus
+}
+#endif
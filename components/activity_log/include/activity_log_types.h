@@ -0,0 +1,62 @@
+// components/activity_log/include/activity_log_types.h
+#pragma once
+
+/*
+ * Row types shared by the on-device logger and the log readers.
+ * Plain C only (no ESP-IDF headers) so host tools can include it.
+ */
+
+#include <stdint.h>
+
+// Struct for Split Data (The "Summary Row")
+typedef struct {
+    int split_index;          
+    float total_dist_m;       
+    float split_dist_m;       
+    float split_time_s;       
+    float split_pace_s;       
+    float avg_spm;            // mean of the split's stroke rates
+    float avg_power_w;
+    uint32_t stroke_count;    // strokes in this split
+} activity_log_split_row_t;
+
+// Existing Stroke Row
+typedef struct {
+    int64_t utc_us;           // absolute time of the catch (timebase UTC)
+    int64_t session_time_us;  // monotonic time since session start
+    float total_distance_m;
+    float pace_500m_s;
+    float spm_instant;
+    float avg_pace_500m_s;
+    float avg_speed_mps;
+    float stroke_length_m;
+    uint32_t stroke_count;
+    double gps_lat;
+    double gps_lon;
+    float power_w;
+    float drive_time_s;
+    float recovery_time_s;
+    float recovery_ratio;
+    float roll_pace_500m_s;   // pace over the last ALOG_ROLL_PACE_M meters (0 until two strokes)
+    float roll_spm;           // rate over the last ALOG_ROLL_RATE_STROKES strokes
+} activity_log_row_t;
+
+// Windows of the rolling columns (rolling_metrics). Fixed, so a log read
+// back on the host gets the same columns the device would have written.
+#define ALOG_ROLL_PACE_M        500
+#define ALOG_ROLL_RATE_STROKES  10
+
+// One entry of the logger's input ring: a stroke row or a closed split,
+// kept in sample order
+typedef enum {
+    ACTIVITY_LOG_MSG_STROKE = 0,
+    ACTIVITY_LOG_MSG_SPLIT,
+} activity_log_msg_kind_t;
+
+typedef struct {
+    uint8_t kind;             // activity_log_msg_kind_t
+    union {
+        activity_log_row_t row;
+        activity_log_split_row_t split;
+    };
+} activity_log_msg_t;
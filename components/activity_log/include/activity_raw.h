@@ -0,0 +1,64 @@
+// components/activity_log/include/activity_raw.h
+#pragma once
+
+/*
+ * Raw capture: timestamped IMU samples and GPS updates written to SD as-is,
+ * for offline analysis of the stroke algorithm.
+ *
+ * Producers append into the current ACTIVITY_RAW_BLOCK_SIZE block under a
+ * short lock. Full blocks are handed to a writer task (pinned to the core
+ * that is not sampling) through a queue, which issues one 32 KB write() per
+ * block at a block-aligned file offset. While the writer is stalled (FAT
+ * cluster allocation, card busy) the other buffers keep filling; if every
+ * buffer is full the oldest unwritten data in the fill buffer is dropped and
+ * counted, and the next block header carries the running drop count.
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "esp_err.h"
+#include "activity_raw_format.h"
+
+typedef struct {
+    float accel_scale;          // m/s^2 per LSB (written into every block header)
+    float gyro_scale;           // rad/s per LSB
+} activity_raw_config_t;
+
+/* One GPS update in engineering units; converted to activity_raw_gps_rec_t. */
+typedef struct {
+    bool    valid_fix;
+    bool    valid_time;
+    double  lat_deg;
+    double  lon_deg;
+    float   speed_mps;          // NAN if not present
+    float   course_deg;         // NAN if not present
+    float   hdop;               // NAN if unknown
+    int     sats;               // -1 if unknown
+    int     fix_quality;        // -1 if unknown
+    int64_t utc_us;             // GNSS time (Unix us), valid when valid_time
+} activity_raw_gps_t;
+
+typedef struct {
+    bool     running;
+    uint32_t blocks_written;
+    uint32_t dropped_blocks;    // blocks discarded because no buffer was free
+    uint32_t dropped_samples;   // records inside those blocks
+    uint32_t write_errors;
+    uint32_t samples;           // records accepted
+    uint32_t max_write_us;      // slowest single block write
+    uint32_t file_bytes;        // bytes of real data in the (preallocated) file
+} activity_raw_stats_t;
+
+/* Open `path` and start the writer task. Buffers are allocated here. */
+esp_err_t activity_raw_start(const char *path, const activity_raw_config_t *cfg);
+
+/* Flush the partial block, wait for the writer and close the file. */
+esp_err_t activity_raw_stop(void);
+
+bool activity_raw_is_running(void);
+
+/* Producers. Cheap no-ops while capture is off. t_us is esp_timer time. */
+void activity_raw_push_imu(int64_t t_us, const int16_t raw[6]);
+void activity_raw_push_gps(int64_t t_us, const activity_raw_gps_t *gps);
+
+void activity_raw_get_stats(activity_raw_stats_t *out);
@@ -0,0 +1,83 @@
+// components/activity_log/include/activity_raw_codec.h
+#pragma once
+
+/*
+ * Bit-packed payload for raw capture blocks (ACTIVITY_RAW_ENC_RICE).
+ *
+ * Each record starts with one bit: 0 = IMU sample, 1 = any other record.
+ *
+ *   IMU    time offset and six axes, each coded as a prediction residual:
+ *          time uses the previous interval (delta of delta), each axis picks
+ *          first- or second-order prediction, whichever has been cheaper
+ *          lately. Residuals are zigzagged and Rice coded with a parameter
+ *          adapted from the running mean, escaping to 32 raw bits for
+ *          outliers. The first IMU sample of a block is a keyframe (raw
+ *          28-bit offset + 16-bit axes), so every block decodes on its own.
+ *   other  8-bit length, then the record bytes verbatim.
+ *
+ * Encoder and decoder run the same adaptation, so nothing but the residuals
+ * is stored. Plain C only: the host tools link this file.
+ */
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define RAW_CODEC_CHANNELS  7           // time + 6 axes
+
+typedef struct {
+    int32_t  p1, p2;                    // previous two values
+    uint32_t a;                         // Rice: running sum of codes
+    uint32_t n;                         //       and their count
+    uint32_t e1, e2;                    // decayed cost of 1st/2nd-order prediction
+} raw_codec_chan_t;
+
+typedef struct {
+    uint32_t n_imu;                     // IMU samples since the keyframe
+    raw_codec_chan_t ch[RAW_CODEC_CHANNELS];
+} raw_codec_state_t;
+
+typedef struct {
+    uint8_t *out;
+    size_t   cap;                       // bytes available at out
+    size_t   pos;                       // whole bytes written
+    uint64_t acc;                       // pending bits (low nacc bits valid)
+    int      nacc;
+    raw_codec_state_t st;
+} raw_encoder_t;
+
+typedef struct {
+    const uint8_t *in;
+    size_t   len;
+    size_t   pos;
+    uint64_t acc;
+    int      nacc;
+    raw_codec_state_t st;
+} raw_decoder_t;
+
+void raw_encoder_init(raw_encoder_t *e, uint8_t *out, size_t cap);
+
+/* Append a record. Both return false (and write nothing) if the worst-case
+ * size no longer fits; the caller then closes the block. */
+bool raw_encoder_put_imu(raw_encoder_t *e, uint32_t toff, const int16_t v[6]);
+bool raw_encoder_put_other(raw_encoder_t *e, const void *rec, size_t len);
+
+/* Pad the last byte and return the payload size in bytes. */
+size_t raw_encoder_finish(raw_encoder_t *e);
+
+void raw_decoder_init(raw_decoder_t *d, const uint8_t *in, size_t len);
+
+/*
+ * Decode the next record into `out` in its uncompressed layout
+ * (activity_raw_imu_rec_t for IMU samples). Returns the record size,
+ * 0 at the end of the payload, or -1 if the data is corrupt.
+ */
+int raw_decoder_next(raw_decoder_t *d, void *out, size_t cap);
+
+#ifdef __cplusplus
+}
+#endif
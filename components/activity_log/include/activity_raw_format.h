@@ -0,0 +1,94 @@
+// components/activity_log/include/activity_raw_format.h
+#pragma once
+
+/*
+ * Raw capture file ("<base>_Raw.bin").
+ *
+ * The file is a plain sequence of ACTIVITY_RAW_BLOCK_SIZE blocks; there is no
+ * file header. Every block starts with activity_raw_block_hdr_t and is followed
+ * by payload_len bytes of tagged records. Records are 4-byte multiples; each one
+ * starts with a uint32 holding the tag (top 4 bits) and the sample time as an
+ * offset in us from the block's base_mono_us (low 28 bits).
+ *
+ * With ACTIVITY_RAW_ENC_RICE the payload is a bitstream instead; decoding
+ * it with raw_decoder_next() yields the same records.
+ *
+ * Multi-byte fields are little-endian. Record fields are not 8-byte aligned
+ * inside a block, so copy them out with memcpy.
+ *
+ * Plain C only: tools read these files on the host.
+ */
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define ACTIVITY_RAW_FILE_SUFFIX    "_Raw.bin"
+#define ACTIVITY_RAW_BLOCK_SIZE     32768               // 64 sectors
+#define ACTIVITY_RAW_BLOCK_MAGIC    0x42524352u         // "RCRB"
+#define ACTIVITY_RAW_VERSION        1
+
+typedef enum {
+    ACTIVITY_RAW_ENC_NONE = 0,      // records stored as-is
+    ACTIVITY_RAW_ENC_RICE = 1,      // bit-packed, see activity_raw_codec.h
+} activity_raw_encoding_t;
+
+typedef enum {
+    ACTIVITY_RAW_TAG_END = 0,       // zero padding after the last record
+    ACTIVITY_RAW_TAG_IMU = 1,
+    ACTIVITY_RAW_TAG_GPS = 2,
+} activity_raw_tag_t;
+
+#define ACTIVITY_RAW_TOFF_BITS      28
+#define ACTIVITY_RAW_TOFF_MAX       ((1u << ACTIVITY_RAW_TOFF_BITS) - 1u)
+#define ACTIVITY_RAW_TAG_WORD(tag, toff) (((uint32_t)(tag) << ACTIVITY_RAW_TOFF_BITS) | ((toff) & ACTIVITY_RAW_TOFF_MAX))
+#define ACTIVITY_RAW_WORD_TAG(w)    ((uint32_t)(w) >> ACTIVITY_RAW_TOFF_BITS)
+#define ACTIVITY_RAW_WORD_TOFF(w)   ((uint32_t)(w) & ACTIVITY_RAW_TOFF_MAX)
+
+typedef struct {
+    uint32_t magic;             // ACTIVITY_RAW_BLOCK_MAGIC
+    uint16_t version;
+    uint8_t  encoding;          // activity_raw_encoding_t
+    uint8_t  flags;             // reserved, 0
+    uint32_t seq;               // block index in the file
+    uint32_t dropped_blocks;    // blocks lost since capture start (before this one)
+    int64_t  base_mono_us;      // esp_timer time that record offsets count from (before the first record)
+    int64_t  base_utc_us;       // timebase UTC at base_mono_us, 0 if not synced
+    uint16_t payload_len;       // record bytes after this header
+    uint16_t count;             // records in the block
+    float    accel_scale;       // m/s^2 per IMU LSB
+    float    gyro_scale;        // rad/s per IMU LSB
+    uint32_t crc;               // crc32(payload) continued over bytes 0..43 of this header
+} activity_raw_block_hdr_t;
+
+/* Raw six-axis sample as read from the IMU (16 bytes). */
+typedef struct {
+    uint32_t tag_toff;          // ACTIVITY_RAW_TAG_IMU
+    int16_t  ax, ay, az;
+    int16_t  gx, gy, gz;
+} activity_raw_imu_rec_t;
+
+#define ACTIVITY_RAW_GPS_FIX    0x01    // position valid
+#define ACTIVITY_RAW_GPS_TIME   0x02    // utc_s/utc_ms valid
+
+/* One NMEA update (28 bytes). Time offset is the '$' of the sentence. */
+typedef struct {
+    uint32_t tag_toff;          // ACTIVITY_RAW_TAG_GPS
+    int32_t  lat_e7;
+    int32_t  lon_e7;
+    uint32_t utc_s;             // GNSS time, Unix seconds
+    uint16_t utc_ms;
+    uint16_t speed_cmps;        // 0xFFFF if not present
+    uint16_t course_cdeg;       // 0.01 deg, 0xFFFF if not present
+    uint16_t hdop_x10;          // 0xFFFF if unknown
+    int8_t   sats;              // -1 if unknown
+    int8_t   fix_quality;       // -1 if unknown
+    uint8_t  flags;             // ACTIVITY_RAW_GPS_*
+    uint8_t  reserved;
+} activity_raw_gps_rec_t;
+
+#ifdef __cplusplus
+}
+#endif
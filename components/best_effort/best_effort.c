@@ -0,0 +1,135 @@
+// components/best_effort/best_effort.c
+#include "best_effort.h"
+
+#include <string.h>
+
+const best_effort_target_t best_effort_targets[BEST_EFFORT_COUNT] = {
+    [BEST_EFFORT_500M] = { "500m", false, 500.0f },
+    [BEST_EFFORT_1K]   = { "1k",   false, 1000.0f },
+    [BEST_EFFORT_2K]   = { "2k",   false, 2000.0f },
+    [BEST_EFFORT_1MIN] = { "1min", true,  60.0f },
+};
+
+static inline const best_effort_point_t *at(const best_effort_t *be, uint32_t seq)
+{
+    return &be->pts[seq & be->mask];
+}
+
+void best_effort_init(best_effort_t *be, best_effort_point_t *pts, uint32_t capacity)
+{
+    memset(be, 0, sizeof(*be));
+    be->pts = pts;
+    be->mask = capacity - 1;
+}
+
+void best_effort_reset(best_effort_t *be)
+{
+    best_effort_point_t *pts = be->pts;
+    uint32_t mask = be->mask;
+    memset(be, 0, sizeof(*be));
+    be->pts = pts;
+    be->mask = mask;
+}
+
+/* The stretch of `span` meters ending at `z`, with its far edge between a and b. */
+static float distance_time_s(const best_effort_point_t *a, const best_effort_point_t *b,
+                             const best_effort_point_t *z, float span)
+{
+    float edge = z->dist_m - span;
+    float seg = b->dist_m - a->dist_m;
+    float frac = (seg > 0.0f) ? (edge - a->dist_m) / seg : 0.0f;
+    float t_edge_ms = (float)(b->t_ms - a->t_ms) * frac;
+    return ((float)(z->t_ms - a->t_ms) - t_edge_ms) * 1e-3f;
+}
+
+/* The stretch of `span_ms` ending at `z`, with its far edge between a and b. */
+static float time_distance_m(const best_effort_point_t *a, const best_effort_point_t *b,
+                             const best_effort_point_t *z, uint32_t span_ms)
+{
+    uint32_t edge = z->t_ms - span_ms;
+    uint32_t seg = b->t_ms - a->t_ms;
+    float frac = seg ? (float)(edge - a->t_ms) / (float)seg : 0.0f;
+    return z->dist_m - (a->dist_m + frac * (b->dist_m - a->dist_m));
+}
+
+static bool push_point(best_effort_t *be, uint32_t t_ms, float dist_m)
+{
+    const uint32_t seq = be->next;
+    const uint32_t cap = be->mask + 1;
+
+    // The slot about to be reused may still be some target's start; that
+    // target loses the stretches that no longer fit
+    for (int k = 0; k < BEST_EFFORT_COUNT; k++) {
+        if (seq - be->start[k] >= cap) be->start[k] = seq - cap + 1;
+    }
+
+    best_effort_point_t *z = &be->pts[seq & be->mask];
+    z->t_ms = t_ms;
+    z->dist_m = dist_m;
+    be->next = seq + 1;
+
+    bool improved = false;
+    for (int k = 0; k < BEST_EFFORT_COUNT; k++) {
+        const best_effort_target_t *tg = &best_effort_targets[k];
+        uint32_t s = be->start[k];
+
+        if (tg->is_time) {
+            const uint32_t span_ms = (uint32_t)(tg->span * 1000.0f);
+            while (s + 1 < seq && z->t_ms - at(be, s + 1)->t_ms >= span_ms) s++;
+            be->start[k] = s;
+            if (s == seq || z->t_ms - at(be, s)->t_ms < span_ms) continue;
+
+            float d = time_distance_m(at(be, s), at(be, s + 1), z, span_ms);
+            if (d > be->best[k]) {
+                be->best[k] = d;
+                be->best_end_ms[k] = z->t_ms;
+                improved = true;
+            }
+        } else {
+            while (s + 1 < seq && z->dist_m - at(be, s + 1)->dist_m >= tg->span) s++;
+            be->start[k] = s;
+            if (s == seq || z->dist_m - at(be, s)->dist_m < tg->span) continue;
+
+            float t = distance_time_s(at(be, s), at(be, s + 1), z, tg->span);
+            if (t > 0.0f && (be->best[k] == 0.0f || t < be->best[k])) {
+                be->best[k] = t;
+                be->best_end_ms[k] = z->t_ms;
+                improved = true;
+            }
+        }
+    }
+    return improved;
+}
+
+bool best_effort_update(best_effort_t *be, int64_t t_us, float dist_m)
+{
+    if (t_us < 0) t_us = 0;
+    const uint32_t t_ms = (t_us / 1000 > UINT32_MAX) ? UINT32_MAX : (uint32_t)(t_us / 1000);
+
+    be->tail = (best_effort_point_t){ .t_ms = t_ms, .dist_m = dist_m };
+    be->have_tail = true;
+
+    if (be->next > 0) {
+        const best_effort_point_t *last = at(be, be->next - 1);
+        if (dist_m - last->dist_m < BEST_EFFORT_STEP_M && t_ms - last->t_ms < BEST_EFFORT_STEP_MS)
+            return false;
+    }
+    return push_point(be, t_ms, dist_m);
+}
+
+bool best_effort_finish(best_effort_t *be)
+{
+    if (!be->have_tail) return false;
+    be->have_tail = false;
+
+    if (be->next > 0) {
+        const best_effort_point_t *last = at(be, be->next - 1);
+        if (be->tail.t_ms == last->t_ms && be->tail.dist_m == last->dist_m) return false;
+    }
+    return push_point(be, be->tail.t_ms, be->tail.dist_m);
+}
+
+void best_effort_get(const best_effort_t *be, float out[BEST_EFFORT_COUNT])
+{
+    memcpy(out, be->best, sizeof(be->best));
+}
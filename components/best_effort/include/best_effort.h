@@ -0,0 +1,82 @@
+// components/best_effort/include/best_effort.h
+#pragma once
+
+/*
+ * Best efforts over a session: fastest 500 m, 1 km and 2 km, and the
+ * longest distance covered in one minute.
+ *
+ * The input is the session's cumulative (time, distance) stream, fed as
+ * often as it changes (every sample on the device, every stroke row when
+ * a log is reprocessed). It is thinned to a point every BEST_EFFORT_STEP_M
+ * meters, or every BEST_EFFORT_STEP_MS when the boat is slower, into a
+ * ring that all targets share. Each target is a two-pointer window over
+ * that ring: a new point moves the target's start forward past the points
+ * it no longer needs and checks the stretch that ends here, so a point
+ * costs amortised O(1) per target and memory is the ring. The far edge of
+ * each stretch is interpolated between two points, so a 500 m effort is
+ * exactly 500 m.
+ *
+ * Plain C only: the host tools link this file.
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define BEST_EFFORT_STEP_M      5.0f    // thinning: a point per 5 m ...
+#define BEST_EFFORT_STEP_MS     2000    // ... or per 2 s, whichever comes first
+
+typedef enum {
+    BEST_EFFORT_500M = 0,
+    BEST_EFFORT_1K,
+    BEST_EFFORT_2K,
+    BEST_EFFORT_1MIN,
+    BEST_EFFORT_COUNT,
+} best_effort_id_t;
+
+typedef struct {
+    const char *name;           // "500m", "1k", ...
+    bool  is_time;              // span in seconds (best = meters), else in meters (best = seconds)
+    float span;
+} best_effort_target_t;
+
+extern const best_effort_target_t best_effort_targets[BEST_EFFORT_COUNT];
+
+typedef struct {
+    uint32_t t_ms;              // session time
+    float    dist_m;            // cumulative distance
+} best_effort_point_t;
+
+typedef struct {
+    best_effort_point_t *pts;
+    uint32_t mask;              // capacity - 1 (capacity is a power of two)
+    uint32_t next;              // seq of the next kept point
+    best_effort_point_t tail;   // newest input, kept or not
+    bool     have_tail;
+    uint32_t start[BEST_EFFORT_COUNT];      // seq of each target's oldest point
+    float    best[BEST_EFFORT_COUNT];       // 0 = not reached yet
+    uint32_t best_end_ms[BEST_EFFORT_COUNT];
+} best_effort_t;
+
+/* `capacity` must be a power of two; `pts` holds that many points. */
+void best_effort_init(best_effort_t *be, best_effort_point_t *pts, uint32_t capacity);
+
+/* Forget the track and the results (new session). */
+void best_effort_reset(best_effort_t *be);
+
+/* Session time and distance so far; neither may go backwards. Returns true
+ * when a best improved. */
+bool best_effort_update(best_effort_t *be, int64_t t_us, float dist_m);
+
+/* End of session: the newest input counts even if thinning skipped it. */
+bool best_effort_finish(best_effort_t *be);
+
+/* Fastest time (s) for distance targets, longest distance (m) for time targets. */
+void best_effort_get(const best_effort_t *be, float out[BEST_EFFORT_COUNT]);
+
+#ifdef __cplusplus
+}
+#endif
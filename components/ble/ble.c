@@ -1,6 +1,9 @@
 #include <string.h>
 #include "esp_log.h"
 #include "esp_err.h"
+#include "esp_timer.h"
+#include "sdkconfig.h"
+#include "freertos/FreeRTOS.h"
 
 #include "nimble/nimble_port.h"
 #include "nimble/nimble_port_freertos.h"
@@ -11,6 +14,15 @@
 #include "services/gatt/ble_svc_gatt.h"
 
 #include "ble.h"
+#include "ble_boats.h"
+#include "ble_ftms.h"
+#include "ble_link.h"
+#include "ble_peers.h"
+#include "ble_rowing.h"
+#include "ble_scan_sched.h"
+#include "ble_scan_table.h"
+#include "ble_sensors.h"
+#include "ble_xfer.h"
 
 static const char *TAG = "ble_app";
 
@@ -21,16 +33,17 @@ static char s_dev_name[BLE_NAME_MAX_LEN] = "ESP32S3-BLE";
 /* -------------------------------------------------------------------------- */
 
 static uint8_t s_own_addr_type;
-static int s_conn_handle = 0; // 0 means “no connection” for us
-
-typedef struct
-{
-    ble_device_t dev;
-    bool used;
-} ble_device_entry_t;
-
-static ble_device_entry_t s_devices[BLE_MAX_DEVICES];
-static int s_device_count = 0;
+static int s_conn_handle = 0; // 0 means “no connection” for us (central role only)
+static bool s_adv_wanted = false;   // keep advertising while peripheral slots are free
+static int s_periph_conns = 0;      // centrals connected to us
+static uint8_t s_broadcast_hz = 0;  // boat broadcast: advert data refreshed this often, 0 = off
+static bool s_observing = false;    // scanning for boat broadcasts
+static struct ble_npl_callout s_broadcast_timer;
+
+/* Scan results: the host task feeds them, the UI reads them */
+static ble_scan_table_t s_devices;
+static portMUX_TYPE s_devices_lock = portMUX_INITIALIZER_UNLOCKED;
+static struct ble_npl_callout s_devlist_timer;
 
 /* UI callbacks */
 static ble_device_list_changed_cb_t s_devlist_cb = NULL;
@@ -40,7 +53,6 @@ static ble_rx_cb_t s_rx_cb = NULL;
 /* Forward declarations */
 static void ble_host_task(void *param);
 static int ble_gap_event(struct ble_gap_event *event, void *arg);
-static esp_err_t ble_scan_internal_start(void);
 static esp_err_t ble_advertise_internal_start(void);
 
 /* -------------------------------------------------------------------------- */
@@ -49,102 +61,43 @@ static esp_err_t ble_advertise_internal_start(void);
 
 static void devices_clear(void)
 {
-    memset(s_devices, 0, sizeof(s_devices));
-    s_device_count = 0;
+    taskENTER_CRITICAL(&s_devices_lock);
+    ble_scan_table_clear(&s_devices);
+    taskEXIT_CRITICAL(&s_devices_lock);
+    ble_npl_callout_reset(&s_devlist_timer, ble_npl_time_ms_to_ticks32(CONFIG_BLE_SCAN_UI_PERIOD_MS));
 }
 
-static bool addr_equal(const ble_addr_t *a, const ble_addr_t *b)
+static void devices_add(const struct ble_gap_disc_desc *disc)
 {
-    if (a->type != b->type)
+    taskENTER_CRITICAL(&s_devices_lock);
+    bool added = ble_scan_table_feed(&s_devices, disc->addr.val, disc->addr.type, disc->rssi,
+                                     disc->data, disc->length_data, esp_timer_get_time());
+    taskEXIT_CRITICAL(&s_devices_lock);
+
+    if (added)
     {
-        return false;
+        ESP_LOGD(TAG, "Found device addr_type=%d, rssi=%d", disc->addr.type, disc->rssi);
+    }
+    if (!ble_npl_callout_is_active(&s_devlist_timer))
+    {
+        ble_npl_callout_reset(&s_devlist_timer, ble_npl_time_ms_to_ticks32(CONFIG_BLE_SCAN_UI_PERIOD_MS));
     }
-    return (memcmp(a->val, b->val, 6) == 0);
 }
 
-static void devices_add(const struct ble_gap_disc_desc *disc,
-                        const uint8_t *name, uint8_t name_len)
+/* Tell the UI about list changes at most every CONFIG_BLE_SCAN_UI_PERIOD_MS,
+ * however many reports came in. Armed by the first report after a tick. */
+static void devlist_tick(struct ble_npl_event *ev)
 {
-    // Check if already in list
-    for (int i = 0; i < BLE_MAX_DEVICES; ++i)
-    {
-        if (!s_devices[i].used)
-        {
-            continue;
-        }
-        ble_addr_t existing = {
-            .type = s_devices[i].dev.addr_type,
-        };
-        memcpy(existing.val, s_devices[i].dev.addr, 6);
+    (void)ev;
 
-        if (addr_equal(&existing, &disc->addr))
-        {
-            // Update RSSI and name if needed
-            s_devices[i].dev.rssi = disc->rssi;
-            if (name && name_len > 0)
-            {
-                uint8_t copy_len = name_len;
-                if (copy_len >= BLE_NAME_MAX_LEN)
-                {
-                    copy_len = BLE_NAME_MAX_LEN - 1;
-                }
-                memcpy(s_devices[i].dev.name, name, copy_len);
-                s_devices[i].dev.name[copy_len] = '\0';
-            }
-            if (s_devlist_cb)
-            {
-                s_devlist_cb();
-            }
-            return;
-        }
-    }
+    taskENTER_CRITICAL(&s_devices_lock);
+    bool changed = ble_scan_table_take_dirty(&s_devices);
+    taskEXIT_CRITICAL(&s_devices_lock);
 
-    // Add new device if there is space
-    for (int i = 0; i < BLE_MAX_DEVICES; ++i)
+    if (changed && s_devlist_cb)
     {
-        if (!s_devices[i].used)
-        {
-            s_devices[i].used = true;
-
-            s_devices[i].dev.addr_type = disc->addr.type;
-            memcpy(s_devices[i].dev.addr, disc->addr.val, 6);
-            s_devices[i].dev.rssi = disc->rssi;
-
-            if (name && name_len > 0)
-            {
-                uint8_t copy_len = name_len;
-                if (copy_len >= BLE_NAME_MAX_LEN)
-                {
-                    copy_len = BLE_NAME_MAX_LEN - 1;
-                }
-                memcpy(s_devices[i].dev.name, name, copy_len);
-                s_devices[i].dev.name[copy_len] = '\0';
-            }
-            else
-            {
-                strncpy(s_devices[i].dev.name, "Unknown", BLE_NAME_MAX_LEN);
-                s_devices[i].dev.name[BLE_NAME_MAX_LEN - 1] = '\0';
-            }
-
-            if (s_device_count < i + 1)
-            {
-                s_device_count = i + 1;
-            }
-
-            ESP_LOGI(TAG, "Found device %s, addr_type=%d, rssi=%d",
-                     s_devices[i].dev.name,
-                     s_devices[i].dev.addr_type,
-                     s_devices[i].dev.rssi);
-
-            if (s_devlist_cb)
-            {
-                s_devlist_cb();
-            }
-            return;
-        }
+        s_devlist_cb();
     }
-
-    ESP_LOGW(TAG, "Device list full, ignoring new device");
 }
 
 /* -------------------------------------------------------------------------- */
@@ -154,33 +107,33 @@ static void devices_add(const struct ble_gap_disc_desc *disc,
 static int ble_gap_event(struct ble_gap_event *event, void *arg)
 {
     (void)arg;
-    int rc;
+
+    // Link policy first: services set modes on connections it tracks
+    ble_link_on_gap_event(event);
+    // A known sensor that dropped out is initiated to before the scheduler
+    // looks, so it does not start a scan in between
+    ble_peers_on_gap_event(event);
+    ble_scan_sched_on_gap_event(event);
+
+    // Services that track connections (subscriptions, MTU, interval)
+    ble_rowing_on_gap_event(event);
+    ble_ftms_on_gap_event(event);
+    ble_xfer_on_gap_event(event);
+    ble_sensors_on_gap_event(event);
 
     switch (event->type)
     {
     case BLE_GAP_EVENT_DISC:
     {
         const struct ble_gap_disc_desc *disc = &event->disc;
-        struct ble_hs_adv_fields fields;
-        memset(&fields, 0, sizeof(fields));
 
-        rc = ble_hs_adv_parse_fields(&fields, disc->data, disc->length_data);
-        if (rc != 0)
+        // Boats' broadcasts go to their own table, not the device list
+        if (s_observing && ble_boats_on_disc(disc))
         {
-            ESP_LOGW(TAG, "Failed to parse adv fields; rc=%d", rc);
             return 0;
         }
 
-        const uint8_t *name = NULL;
-        uint8_t name_len = 0;
-
-        if (fields.name && fields.name_len > 0)
-        {
-            name = fields.name;
-            name_len = fields.name_len;
-        }
-
-        devices_add(disc, name, name_len);
+        devices_add(disc);
         return 0;
     }
 
@@ -195,8 +148,22 @@ static int ble_gap_event(struct ble_gap_event *event, void *arg)
     case BLE_GAP_EVENT_CONNECT:
         if (event->connect.status == 0)
         {
-            ESP_LOGI(TAG, "Connection established; handle=%d",
-                     event->connect.conn_handle);
+            struct ble_gap_conn_desc desc;
+            bool central = ble_gap_conn_find(event->connect.conn_handle, &desc) == 0 &&
+                           desc.role == BLE_GAP_ROLE_MASTER;
+            ESP_LOGI(TAG, "Connection established; handle=%d (%s)",
+                     event->connect.conn_handle, central ? "central" : "peripheral");
+            if (!central)
+            {
+                // A phone or coach app connected to us: let the next one in too
+                s_periph_conns++;
+                if ((s_adv_wanted && s_periph_conns < CONFIG_BT_NIMBLE_MAX_CONNECTIONS) || s_broadcast_hz)
+                {
+                    ble_advertise_internal_start();
+                }
+                return 0;
+            }
+            // ble_sensors runs the link: BULK for discovery, LIVE once subscribed
             s_conn_handle = event->connect.conn_handle;
             if (s_conn_state_cb)
             {
@@ -211,23 +178,39 @@ static int ble_gap_event(struct ble_gap_event *event, void *arg)
             {
                 s_conn_state_cb(false);
             }
-            // Optionally restart scanning
-            ble_scan_internal_start();
+            // The scan scheduler resumes scanning
         }
         return 0;
 
     case BLE_GAP_EVENT_DISCONNECT:
-        ESP_LOGI(TAG, "Disconnected; reason=%d", event->disconnect.reason);
+        ESP_LOGI(TAG, "Disconnected; handle=%d reason=%d",
+                 event->disconnect.conn.conn_handle, event->disconnect.reason);
+        if (event->disconnect.conn.role != BLE_GAP_ROLE_MASTER)
+        {
+            if (s_periph_conns > 0)
+            {
+                s_periph_conns--;
+            }
+            if (s_adv_wanted || s_broadcast_hz)
+            {
+                ble_advertise_internal_start();
+            }
+            return 0;
+        }
         s_conn_handle = 0;
         if (s_conn_state_cb)
         {
             s_conn_state_cb(false);
         }
-        // Restart scanning so the user can pick another device
-        ble_scan_internal_start();
+        // The scan scheduler resumes scanning so the user can pick another device
         return 0;
 
     case BLE_GAP_EVENT_NOTIFY_RX:
+        // Sensor measurements are parsed in place; anything else goes to the raw callback
+        if (ble_sensors_on_notify(event))
+        {
+            return 0;
+        }
         if (s_rx_cb)
         {
             // Forward raw data to app (GATT client logic to be added later)
@@ -254,40 +237,133 @@ static int ble_gap_event(struct ble_gap_event *event, void *arg)
 }
 
 /* -------------------------------------------------------------------------- */
-/* Scanning                                                                   */
+/* Advertising                                                                */
 /* -------------------------------------------------------------------------- */
 
-static esp_err_t ble_scan_internal_start(void)
+static int adv_set_data(void)
 {
-    if (!ble_hs_synced())
+    struct ble_hs_adv_fields fields;
+    memset(&fields, 0, sizeof(fields));
+
+    // FTMS apps filter on the service UUID and its service data (machine type)
+    static const ble_uuid16_t ftms_uuid = BLE_UUID16_INIT(BLE_FTMS_UUID16);
+    fields.uuids16 = &ftms_uuid;
+    fields.num_uuids16 = 1;
+    fields.uuids16_is_complete = 1;
+    fields.svc_data_uuid16 = ble_ftms_adv_svc_data;
+    fields.svc_data_uuid16_len = BLE_FTMS_ADV_SVC_DATA_LEN;
+    fields.flags = BLE_HS_ADV_F_DISC_GEN | BLE_HS_ADV_F_BREDR_UNSUP;
+
+    // Use our GAP device name in the advertising payload, shortened to what
+    // is left of the 31 bytes (flags 3, UUID 4, service data 7, name header 2)
+    const size_t name_room = BLE_HS_ADV_MAX_SZ - 3 - 4 - (2 + BLE_FTMS_ADV_SVC_DATA_LEN) - 2;
+    fields.name = (uint8_t *)s_dev_name;
+    fields.name_len = strlen(s_dev_name);
+    fields.name_is_complete = 1;
+    if (fields.name_len > name_room)
     {
-        ESP_LOGW(TAG, "Cannot start scan: host not synced yet");
-        return ESP_FAIL;
+        fields.name_len = name_room;
+        fields.name_is_complete = 0;
     }
 
-    int rc;
-    struct ble_gap_disc_params params;
+    int rc = ble_gap_adv_set_fields(&fields);
+    if (rc != 0)
+    {
+        ESP_LOGE(TAG, "ble_gap_adv_set_fields failed; rc=%d", rc);
+        return rc;
+    }
 
-    memset(&params, 0, sizeof(params));
-    params.itvl = 0;   // use stack default
-    params.window = 0; // use stack default
-    params.filter_policy = 0;
-    params.limited = 0;
-    params.passive = 0; // active scan (request scan responses)
-    params.filter_duplicates = 1;
+    // The rowing service UUID does not fit next to the name; it goes in the scan response
+    static ble_uuid128_t rowing_uuid = { .u.type = BLE_UUID_TYPE_128 };
+    memcpy(rowing_uuid.value, ble_rowing_svc_uuid128, sizeof(rowing_uuid.value));
 
-    devices_clear();
+    struct ble_hs_adv_fields rsp;
+    memset(&rsp, 0, sizeof(rsp));
+    rsp.uuids128 = &rowing_uuid;
+    rsp.num_uuids128 = 1;
+    rsp.uuids128_is_complete = 1;
 
-    rc = ble_gap_disc(s_own_addr_type, BLE_HS_FOREVER, &params,
-                      ble_gap_event, NULL);
+    rc = ble_gap_adv_rsp_set_fields(&rsp);
     if (rc != 0)
     {
-        ESP_LOGE(TAG, "Error initiating GAP discovery; rc=%d", rc);
-        return ESP_FAIL;
+        ESP_LOGE(TAG, "ble_gap_adv_rsp_set_fields failed; rc=%d", rc);
+        return rc;
     }
 
-    ESP_LOGI(TAG, "Scan started");
-    return ESP_OK;
+    return 0;
+}
+
+static int adv_set_broadcast_sample(void)
+{
+    uint8_t mfg[BLE_BOAT_ADV_LEN];
+
+    struct ble_hs_adv_fields fields;
+    memset(&fields, 0, sizeof(fields));
+    fields.flags = BLE_HS_ADV_F_DISC_GEN | BLE_HS_ADV_F_BREDR_UNSUP;
+    fields.mfg_data = mfg;
+    fields.mfg_data_len = ble_boats_adv_payload(mfg);   // 0 until the first sample
+
+    int rc = ble_gap_adv_set_fields(&fields);
+    if (rc != 0)
+    {
+        ESP_LOGE(TAG, "ble_gap_adv_set_fields failed; rc=%d", rc);
+    }
+    return rc;
+}
+
+/* Broadcasting: the live sample fills the advert (ble_boat_adv.h); FTMS and
+ * the name move to the scan response. The rowing service UUID is left out:
+ * apps find the device through FTMS or its name. */
+static int adv_set_broadcast_data(void)
+{
+    int rc = adv_set_broadcast_sample();
+    if (rc != 0)
+    {
+        return rc;
+    }
+
+    struct ble_hs_adv_fields rsp;
+    memset(&rsp, 0, sizeof(rsp));
+
+    static const ble_uuid16_t ftms_uuid = BLE_UUID16_INIT(BLE_FTMS_UUID16);
+    rsp.uuids16 = &ftms_uuid;
+    rsp.num_uuids16 = 1;
+    rsp.uuids16_is_complete = 1;
+    rsp.svc_data_uuid16 = ble_ftms_adv_svc_data;
+    rsp.svc_data_uuid16_len = BLE_FTMS_ADV_SVC_DATA_LEN;
+
+    const size_t name_room = BLE_HS_ADV_MAX_SZ - 4 - (2 + BLE_FTMS_ADV_SVC_DATA_LEN) - 2;
+    rsp.name = (uint8_t *)s_dev_name;
+    rsp.name_len = strlen(s_dev_name);
+    rsp.name_is_complete = 1;
+    if (rsp.name_len > name_room)
+    {
+        rsp.name_len = name_room;
+        rsp.name_is_complete = 0;
+    }
+
+    rc = ble_gap_adv_rsp_set_fields(&rsp);
+    if (rc != 0)
+    {
+        ESP_LOGE(TAG, "ble_gap_adv_rsp_set_fields failed; rc=%d", rc);
+    }
+    return rc;
+}
+
+/* Put the newest sample in the running advert. Updating the data does not
+ * restart advertising, so scanners keep hearing it at the advert interval. */
+static void broadcast_tick(struct ble_npl_event *ev)
+{
+    (void)ev;
+    if (!s_broadcast_hz)
+    {
+        return;
+    }
+    if (ble_gap_adv_active())
+    {
+        adv_set_broadcast_sample();
+    }
+    ble_npl_callout_reset(&s_broadcast_timer, ble_npl_time_ms_to_ticks32(1000 / s_broadcast_hz));
 }
 
 static esp_err_t ble_advertise_internal_start(void)
@@ -298,22 +374,15 @@ static esp_err_t ble_advertise_internal_start(void)
         return ESP_FAIL;
     }
 
-    // If we were scanning as central, stop first (adv + scan can't run together)
-    ble_stop_scan();
-
-    struct ble_hs_adv_fields fields;
-    memset(&fields, 0, sizeof(fields));
-
-    // Use our GAP device name in the advertising payload
-    fields.name = (uint8_t *)s_dev_name;
-    fields.name_len = strlen(s_dev_name);
-    fields.name_is_complete = 1;
-    fields.flags = BLE_HS_ADV_F_DISC_GEN | BLE_HS_ADV_F_BREDR_UNSUP;
+    // Already advertising (e.g. broadcast only, now connectable again): restart with the new data and mode
+    if (ble_gap_adv_active())
+    {
+        ble_gap_adv_stop();
+    }
 
-    int rc = ble_gap_adv_set_fields(&fields);
+    int rc = s_broadcast_hz ? adv_set_broadcast_data() : adv_set_data();
     if (rc != 0)
     {
-        ESP_LOGE(TAG, "ble_gap_adv_set_fields failed; rc=%d", rc);
         return ESP_FAIL;
     }
 
@@ -321,6 +390,18 @@ static esp_err_t ble_advertise_internal_start(void)
     memset(&adv_params, 0, sizeof(adv_params));
     adv_params.conn_mode = BLE_GAP_CONN_MODE_UND; // connectable
     adv_params.disc_mode = BLE_GAP_DISC_MODE_GEN; // general discoverable
+    if (s_broadcast_hz)
+    {
+        // 100-150 ms: a few adverts per sample, so one lost to a collision
+        // is made up before the next. Connectable only while phones are
+        // invited (ble_start_advertising) and slots are left.
+        adv_params.itvl_min = BLE_GAP_ADV_ITVL_MS(100);
+        adv_params.itvl_max = BLE_GAP_ADV_ITVL_MS(150);
+        if (!s_adv_wanted || s_periph_conns >= CONFIG_BT_NIMBLE_MAX_CONNECTIONS)
+        {
+            adv_params.conn_mode = BLE_GAP_CONN_MODE_NON;
+        }
+    }
 
     rc = ble_gap_adv_start(s_own_addr_type,
                            NULL, // own address
@@ -334,7 +415,8 @@ static esp_err_t ble_advertise_internal_start(void)
         return ESP_FAIL;
     }
 
-    ESP_LOGI(TAG, "Advertising as '%s'", s_dev_name);
+    ESP_LOGI(TAG, "Advertising as '%s'%s", s_dev_name, s_broadcast_hz ? " (boat broadcast)" : "");
+    ble_scan_sched_update();    // background scanning pauses while we advertise
     return ESP_OK;
 }
 /* -------------------------------------------------------------------------- */
@@ -367,8 +449,24 @@ static void on_sync(void)
              addr_val[5], addr_val[4], addr_val[3],
              addr_val[2], addr_val[1], addr_val[0]);
 
-    // After sync → start scanning
-    ble_start_scan();
+    // After sync → straight to known sensors through the accept list, or
+    // scan (a burst, then in the background) if there are none
+    bool reconnecting = ble_peers_reconnect(s_own_addr_type, ble_gap_event) == ESP_OK;
+    ble_scan_sched_on_sync(s_own_addr_type);
+    if (reconnecting)
+    {
+        ble_scan_sched_set_background(true);
+    }
+    else
+    {
+        ble_start_scan();
+    }
+
+    // A broadcast asked for before the host was up starts now
+    if (s_broadcast_hz)
+    {
+        ble_advertise_internal_start();
+    }
 }
 
 static void nimble_host_config_init(void)
@@ -404,6 +502,16 @@ esp_err_t ble_app_init(void)
     // Initialize GAP / GATT services
     ble_svc_gap_init();
     ble_svc_gatt_init();
+    ble_link_init();
+    ble_scan_sched_init(ble_gap_event);
+    ble_boats_init();
+    ble_peers_init();
+    ble_npl_callout_init(&s_broadcast_timer, nimble_port_get_dflt_eventq(), broadcast_tick, NULL);
+    ble_npl_callout_init(&s_devlist_timer, nimble_port_get_dflt_eventq(), devlist_tick, NULL);
+    if (ble_rowing_init() != ESP_OK || ble_ftms_init() != ESP_OK || ble_xfer_init() != ESP_OK)
+    {
+        return ESP_FAIL;
+    }
 
     ble_set_device_name(s_dev_name);
 
@@ -418,24 +526,29 @@ esp_err_t ble_app_init(void)
 
 esp_err_t ble_start_scan(void)
 {
-    return ble_scan_internal_start();
+    if (!ble_hs_synced())
+    {
+        ESP_LOGW(TAG, "Cannot start scan: host not synced yet");
+        return ESP_FAIL;
+    }
+
+    // The user is picking a device: stop waiting for the known ones
+    ble_peers_cancel_reconnect();
+    devices_clear();
+    ble_scan_sched_set_background(true);
+    ble_scan_sched_burst();
+    return ESP_OK;
 }
 
 esp_err_t ble_stop_scan(void)
 {
-    int rc = ble_gap_disc_cancel();
-    if (rc != 0 && rc != BLE_HS_EALREADY)
-    {
-        ESP_LOGE(TAG, "Failed to cancel scan; rc=%d", rc);
-        return ESP_FAIL;
-    }
-    ESP_LOGI(TAG, "Scan stopped");
+    ble_scan_sched_set_background(false);
     return ESP_OK;
 }
 
 int ble_get_device_count(void)
 {
-    return s_device_count;
+    return s_devices.count;
 }
 
 bool ble_get_device(int index, ble_device_t *out)
@@ -445,18 +558,10 @@ bool ble_get_device(int index, ble_device_t *out)
         return false;
     }
 
-    if (index < 0 || index >= BLE_MAX_DEVICES)
-    {
-        return false;
-    }
-
-    if (!s_devices[index].used)
-    {
-        return false;
-    }
-
-    *out = s_devices[index].dev;
-    return true;
+    taskENTER_CRITICAL(&s_devices_lock);
+    bool ok = ble_scan_table_get(&s_devices, index, out);
+    taskEXIT_CRITICAL(&s_devices_lock);
+    return ok;
 }
 
 esp_err_t ble_connect_to_index(int index)
@@ -479,13 +584,17 @@ esp_err_t ble_connect_to_index(int index)
     };
     memcpy(peer_addr.val, dev.addr, 6);
 
+    // Short interval while discovery and subscription run (ble_sensors.h)
     struct ble_gap_conn_params conn_params;
-    memset(&conn_params, 0, sizeof(conn_params));
-    // Leave 0 to let stack use defaults, or customize here if you want.
+    ble_link_conn_params(BLE_LINK_BULK, &conn_params);
 
+    // Initiating and scanning do not run together; the scheduler resumes
+    // once the connection is up or has failed
+    ble_gap_disc_cancel();
     int rc = ble_gap_connect(s_own_addr_type, &peer_addr,
                              BLE_HS_FOREVER, &conn_params,
                              ble_gap_event, NULL);
+    ble_scan_sched_update();
     if (rc != 0)
     {
         ESP_LOGE(TAG, "Failed to start connect; rc=%d", rc);
@@ -512,14 +621,6 @@ esp_err_t ble_disconnect(void)
     return ESP_OK;
 }
 
-esp_err_t ble_send(const uint8_t *data, uint16_t len)
-{
-    (void)data;
-    (void)len;
-    // Placeholder: you’ll add GATT write/notify logic here later.
-    return ESP_ERR_NOT_SUPPORTED;
-}
-
 esp_err_t ble_set_device_name(const char *name)
 {
     if (!name)
@@ -549,11 +650,18 @@ const char *ble_get_device_name(void)
 
 esp_err_t ble_start_advertising(void)
 {
+    s_adv_wanted = true;
     return ble_advertise_internal_start();
 }
 
 esp_err_t ble_stop_advertising(void)
 {
+    s_adv_wanted = false;
+    if (s_broadcast_hz)
+    {
+        // Keep broadcasting, no longer connectable
+        return ble_advertise_internal_start();
+    }
     int rc = ble_gap_adv_stop();
     if (rc != 0 && rc != BLE_HS_EALREADY)
     {
@@ -561,8 +669,71 @@ esp_err_t ble_stop_advertising(void)
         return ESP_FAIL;
     }
     ESP_LOGI(TAG, "Advertising stopped");
+    ble_scan_sched_update();
+    return ESP_OK;
+}
+esp_err_t ble_start_broadcast(uint8_t hz)
+{
+    if (hz < 1)
+    {
+        hz = 1;
+    }
+    if (hz > 4)
+    {
+        hz = 4;
+    }
+    if (!s_broadcast_hz)
+    {
+        // Keeps stroke_task publishing samples with nobody subscribed
+        ble_rowing_add_listeners(1);
+    }
+    s_broadcast_hz = hz;
+    ble_npl_callout_reset(&s_broadcast_timer, ble_npl_time_ms_to_ticks32(1000 / hz));
+    return ble_advertise_internal_start();
+}
+
+esp_err_t ble_stop_broadcast(void)
+{
+    if (!s_broadcast_hz)
+    {
+        return ESP_OK;
+    }
+    s_broadcast_hz = 0;
+    ble_npl_callout_stop(&s_broadcast_timer);
+    ble_rowing_add_listeners(-1);
+    if (s_adv_wanted)
+    {
+        return ble_advertise_internal_start();
+    }
+    int rc = ble_gap_adv_stop();
+    if (rc != 0 && rc != BLE_HS_EALREADY)
+    {
+        ESP_LOGE(TAG, "ble_gap_adv_stop failed; rc=%d", rc);
+        return ESP_FAIL;
+    }
+    ble_scan_sched_update();
     return ESP_OK;
 }
+
+esp_err_t ble_start_observing(void)
+{
+    s_observing = true;
+    ble_boats_clear();
+    ble_scan_sched_set_observing(true);
+    return ESP_OK;
+}
+
+esp_err_t ble_stop_observing(void)
+{
+    if (!s_observing)
+    {
+        return ESP_OK;
+    }
+    s_observing = false;
+    ble_scan_sched_set_observing(false);
+    return ESP_OK;
+}
+
 /* -------------------------------------------------------------------------- */
 /* Callback registration                                                      */
 /* -------------------------------------------------------------------------- */
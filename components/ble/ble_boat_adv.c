@@ -0,0 +1,170 @@
+// components/ble/ble_boat_adv.c
+#include "ble_boat_adv.h"
+
+#include <string.h>
+
+#define SLOT_MASK   (BLE_BOATS_SLOTS - 1)
+#define AD_MFG_DATA 0xFF
+#define FRAME_LEN   (BLE_ROWING_HDR_LEN + BLE_ROWING_SAMPLE_LEN)
+
+_Static_assert((BLE_BOATS_SLOTS & SLOT_MASK) == 0, "BLE_BOATS_SLOTS must be a power of two");
+_Static_assert(BLE_BOATS_SLOTS >= 2 * BLE_BOATS_MAX, "keep the index at most half full");
+_Static_assert(BLE_BOATS_MAX < 255, "slots hold the boat index + 1 in a byte");
+
+/* -------------------------------------------------------------------------- */
+/* Advertising data                                                           */
+/* -------------------------------------------------------------------------- */
+
+size_t ble_boat_adv_encode(uint8_t *out, uint8_t seq, const ble_rowing_sample_t *s)
+{
+    out[0] = BLE_BOAT_ADV_COMPANY & 0xFF;
+    out[1] = BLE_BOAT_ADV_COMPANY >> 8;
+    out[2] = BLE_BOAT_ADV_MAGIC;
+    return 3 + ble_rowing_frame_encode(out + 3, seq, s, 1);
+}
+
+const uint8_t *ble_boat_adv_find(const uint8_t *data, size_t len)
+{
+    // AD structures: length (type + value), type, value
+    size_t i = 0;
+    while (i + 1 < len) {
+        size_t n = data[i];
+        if (n == 0 || i + 1 + n > len) return NULL;
+        const uint8_t *ad = data + i + 1;
+        if (ad[0] == AD_MFG_DATA && n - 1 == BLE_BOAT_ADV_LEN && ad[1] == (BLE_BOAT_ADV_COMPANY & 0xFF) &&
+            ad[2] == (BLE_BOAT_ADV_COMPANY >> 8) && ad[3] == BLE_BOAT_ADV_MAGIC)
+            return ad + 4;
+        i += 1 + n;
+    }
+    return NULL;
+}
+
+/* -------------------------------------------------------------------------- */
+/* Table                                                                      */
+/* -------------------------------------------------------------------------- */
+
+static uint32_t addr_hash(const uint8_t addr[6], uint8_t type)
+{
+    uint32_t lo = (uint32_t)addr[0] | (uint32_t)addr[1] << 8 | (uint32_t)addr[2] << 16 | (uint32_t)addr[3] << 24;
+    uint32_t hi = (uint32_t)addr[4] | (uint32_t)addr[5] << 8 | (uint32_t)type << 16;
+    return ((lo ^ (hi * 0x85EBCA6Bu)) * 0x9E3779B1u) >> 16;
+}
+
+static bool is_stale(const ble_boat_table_t *t, const ble_boat_t *b, int64_t now_us)
+{
+    return now_us - b->last_us > t->stale_us;
+}
+
+void ble_boat_table_init(ble_boat_table_t *t, int64_t stale_us)
+{
+    memset(t, 0, sizeof(*t));
+    t->stale_us = stale_us;
+    t->compact_us = INT64_MIN / 2;
+}
+
+/* Probe to the key or an empty slot. Slots are only emptied all at once
+ * (compact), so the key cannot sit past one; the first stale boat on the way
+ * is offered for reuse. */
+static ble_boat_t *lookup(ble_boat_table_t *t, const uint8_t addr[6], uint8_t type, int64_t now_us, int *empty,
+                          ble_boat_t **reuse)
+{
+    uint32_t h = addr_hash(addr, type);
+    *empty = -1;
+    *reuse = NULL;
+    for (int i = 0; i < BLE_BOATS_SLOTS; i++, h++) {
+        uint8_t s = t->slots[h & SLOT_MASK];
+        if (s == 0) {
+            *empty = (int)(h & SLOT_MASK);
+            return NULL;
+        }
+        ble_boat_t *c = &t->boats[s - 1];
+        if (c->addr_type == type && memcmp(c->addr, addr, 6) == 0) return c;
+        if (!*reuse && is_stale(t, c, now_us)) *reuse = c;
+    }
+    return NULL;
+}
+
+/* Every entry handed out and none stale on the new boat's path: drop the
+ * stale boats (keeping the others in order) and rebuild the index. O(MAX),
+ * so at most once per BLE_BOATS_COMPACT_US while the table stays full. */
+static bool compact(ble_boat_table_t *t, int64_t now_us)
+{
+    if (now_us - t->compact_us < BLE_BOATS_COMPACT_US) return false;
+    t->compact_us = now_us;
+
+    int n = 0;
+    for (int i = 0; i < t->used; i++) {
+        if (!is_stale(t, &t->boats[i], now_us)) t->boats[n++] = t->boats[i];
+    }
+    if (n == t->used) return false;
+
+    t->used = n;
+    memset(t->slots, 0, sizeof(t->slots));
+    for (int i = 0; i < n; i++) {
+        uint32_t h = addr_hash(t->boats[i].addr, t->boats[i].addr_type);
+        while (t->slots[h & SLOT_MASK]) h++;
+        t->slots[h & SLOT_MASK] = (uint8_t)(i + 1);
+    }
+    t->compactions++;
+    return true;
+}
+
+bool ble_boat_table_feed(ble_boat_table_t *t, const uint8_t addr[6], uint8_t addr_type, int8_t rssi,
+                         const uint8_t *data, size_t len, int64_t now_us)
+{
+    const uint8_t *frame = ble_boat_adv_find(data, len);
+    if (!frame) return false;
+    t->adverts++;
+
+    int empty;
+    ble_boat_t *reuse;
+    ble_boat_t *b = lookup(t, addr, addr_type, now_us, &empty, &reuse);
+
+    if (!b) {
+        if (!reuse && t->used == BLE_BOATS_MAX && compact(t, now_us)) lookup(t, addr, addr_type, now_us, &empty, &reuse);
+        if (reuse) {
+            b = reuse;
+        } else if (empty >= 0 && t->used < BLE_BOATS_MAX) {
+            b = &t->boats[t->used++];
+            t->slots[empty] = (uint8_t)t->used;
+        } else {
+            t->full++;
+            return true;
+        }
+        memset(b, 0, sizeof(*b));
+        memcpy(b->addr, addr, 6);
+        b->addr_type = addr_type;
+        b->first_us = now_us;
+        b->seq = (uint8_t)(frame[1] - 1);   // so the first frame counts as new
+        t->generation++;
+    }
+
+    b->rssi = rssi;
+    b->last_us = now_us;
+    b->adverts++;
+
+    // Repeats of the sample already held cost nothing more
+    const uint8_t seq = frame[1];
+    if (seq == b->seq && b->updates) return true;
+
+    uint8_t first;
+    ble_rowing_sample_t s;
+    memset(&s, 0, sizeof(s));
+    if (ble_rowing_frame_decode(frame, FRAME_LEN, &first, &s, 1) != 1) return true;
+
+    if (b->updates) b->missed += (uint8_t)(seq - b->seq - 1);
+    b->seq = seq;
+    b->sample = s;
+    b->updates++;
+    t->generation++;
+    return true;
+}
+
+int ble_boat_table_snapshot(const ble_boat_table_t *t, ble_boat_t *out, int max, int64_t now_us)
+{
+    int n = 0;
+    for (int i = 0; i < t->used && n < max; i++) {
+        if (!is_stale(t, &t->boats[i], now_us)) out[n++] = t->boats[i];
+    }
+    return n;
+}
@@ -0,0 +1,93 @@
+// components/ble/ble_boats.c
+#include "ble_boats.h"
+
+#include <string.h>
+
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "sdkconfig.h"
+
+#include "host/ble_hs.h"
+
+#include "ble_rowing.h"
+
+#ifndef CONFIG_BLE_BOAT_STALE_S
+#define CONFIG_BLE_BOAT_STALE_S 10
+#endif
+
+// The host task feeds, the UI task reads
+static ble_boat_table_t s_table;
+static StaticSemaphore_t s_lock_buf;
+static SemaphoreHandle_t s_lock;
+
+// Broadcaster: the sample last advertised and its sequence number
+static ble_rowing_sample_t s_adv_sample;
+static uint8_t s_adv_seq;
+static bool s_adv_have;
+
+static void lock(void)
+{
+    xSemaphoreTake(s_lock, portMAX_DELAY);
+}
+
+static void unlock(void)
+{
+    xSemaphoreGive(s_lock);
+}
+
+void ble_boats_init(void)
+{
+    s_lock = xSemaphoreCreateMutexStatic(&s_lock_buf);
+    ble_boat_table_init(&s_table, (int64_t)CONFIG_BLE_BOAT_STALE_S * 1000000);
+}
+
+void ble_boats_clear(void)
+{
+    lock();
+    uint32_t g = s_table.generation;
+    ble_boat_table_init(&s_table, (int64_t)CONFIG_BLE_BOAT_STALE_S * 1000000);
+    s_table.generation = g + 1;     // readers holding the old list see it go
+    unlock();
+}
+
+uint32_t ble_boats_generation(void)
+{
+    lock();
+    uint32_t g = s_table.generation;
+    unlock();
+    return g;
+}
+
+int ble_boats_get(ble_boat_t *out, int max)
+{
+    lock();
+    int n = ble_boat_table_snapshot(&s_table, out, max, esp_timer_get_time());
+    unlock();
+    return n;
+}
+
+bool ble_boats_on_disc(const struct ble_gap_disc_desc *disc)
+{
+    // Most reports are not boats: look before taking the lock
+    if (!ble_boat_adv_find(disc->data, disc->length_data)) return false;
+
+    lock();
+    ble_boat_table_feed(&s_table, disc->addr.val, disc->addr.type, disc->rssi, disc->data, disc->length_data,
+                        esp_timer_get_time());
+    unlock();
+    return true;
+}
+
+size_t ble_boats_adv_payload(uint8_t out[BLE_BOAT_ADV_LEN])
+{
+    ble_rowing_sample_t s;
+    if (!ble_rowing_latest(&s)) return 0;
+
+    if (!s_adv_have || memcmp(&s, &s_adv_sample, sizeof(s)) != 0) {
+        s_adv_sample = s;
+        s_adv_seq++;
+        s_adv_have = true;
+    }
+    return ble_boat_adv_encode(out, s_adv_seq, &s_adv_sample);
+}
@@ -0,0 +1,221 @@
+// components/ble/ble_ftms_svc.c
+#include "ble_ftms.h"
+
+#include <string.h>
+
+#include "esp_log.h"
+#include "sdkconfig.h"
+
+#include "host/ble_hs.h"
+#include "nimble/nimble_npl.h"
+#include "nimble/nimble_port.h"
+
+#include "ble_link.h"
+#include "ble_rowing.h"
+#include "ftms_rower.h"
+
+static const char *TAG = "ble_ftms";
+
+#ifndef CONFIG_BT_NIMBLE_MAX_CONNECTIONS
+#define CONFIG_BT_NIMBLE_MAX_CONNECTIONS 3
+#endif
+
+#define MAX_CONNS           CONFIG_BT_NIMBLE_MAX_CONNECTIONS
+#define NOTIFY_PERIOD_MS    1000
+
+// Power is sent while a power meter is connected (ble_sensors.h)
+#define FTMS_FEATURES       (FTMS_FEATURE_CADENCE | FTMS_FEATURE_TOTAL_DISTANCE | FTMS_FEATURE_PACE | \
+                             FTMS_FEATURE_ELAPSED_TIME | FTMS_FEATURE_POWER)
+
+static const ble_uuid16_t k_svc_uuid = BLE_UUID16_INIT(BLE_FTMS_UUID16);
+static const ble_uuid16_t k_feature_uuid = BLE_UUID16_INIT(0x2ACC);
+static const ble_uuid16_t k_rower_data_uuid = BLE_UUID16_INIT(0x2AD1);
+
+const uint8_t ble_ftms_adv_svc_data[BLE_FTMS_ADV_SVC_DATA_LEN] = {
+    BLE_FTMS_UUID16 & 0xFF, BLE_FTMS_UUID16 >> 8,
+    0x01,                   // fitness machine available
+    0x10, 0x00,             // rower
+};
+
+typedef struct {
+    bool     used;
+    bool     subscribed;
+    uint16_t handle;
+    ftms_rower_enc_t enc;
+    uint32_t frames;
+    uint32_t bytes;
+} ftms_conn_t;
+
+// Host task only
+static ftms_conn_t s_conns[MAX_CONNS];
+static uint16_t s_rower_data_handle;
+static struct ble_npl_callout s_tx_timer;
+static bool s_tx_running;
+
+static int chr_access(uint16_t conn_handle, uint16_t attr_handle, struct ble_gatt_access_ctxt *ctxt, void *arg);
+
+static const struct ble_gatt_svc_def k_svcs[] = {
+    {
+        .type = BLE_GATT_SVC_TYPE_PRIMARY,
+        .uuid = &k_svc_uuid.u,
+        .characteristics = (struct ble_gatt_chr_def[]){
+            {
+                .uuid = &k_feature_uuid.u,
+                .access_cb = chr_access,
+                .flags = BLE_GATT_CHR_F_READ,
+            },
+            {
+                .uuid = &k_rower_data_uuid.u,
+                .access_cb = chr_access,
+                .flags = BLE_GATT_CHR_F_NOTIFY,
+                .val_handle = &s_rower_data_handle,
+            },
+            { 0 },
+        },
+    },
+    { 0 },
+};
+
+static ftms_conn_t *conn_find(uint16_t handle)
+{
+    for (int i = 0; i < MAX_CONNS; i++) {
+        if (s_conns[i].used && s_conns[i].handle == handle) return &s_conns[i];
+    }
+    return NULL;
+}
+
+static ftms_conn_t *conn_add(uint16_t handle)
+{
+    ftms_conn_t *c = conn_find(handle);
+    for (int i = 0; !c && i < MAX_CONNS; i++) {
+        if (!s_conns[i].used) c = &s_conns[i];
+    }
+    if (!c) return NULL;
+
+    *c = (ftms_conn_t){ .used = true, .handle = handle };
+    return c;
+}
+
+static bool any_subscribed(void)
+{
+    for (int i = 0; i < MAX_CONNS; i++) {
+        if (s_conns[i].used && s_conns[i].subscribed) return true;
+    }
+    return false;
+}
+
+static void tx_tick(struct ble_npl_event *ev)
+{
+    (void)ev;
+
+    ble_rowing_sample_t s;
+    if (ble_rowing_latest(&s)) {
+        const ftms_rower_values_t v = {
+            .spm = s.spm,
+            .stroke_count = s.stroke_count,
+            .distance_m = s.distance_m,
+            .pace_500m_s = s.pace_500m_s,
+            .avg_pace_500m_s = s.avg_pace_500m_s,
+            .power_w = s.power_w,
+            .elapsed_s = s.t_ms / 1000,
+        };
+
+        for (int i = 0; i < MAX_CONNS; i++) {
+            ftms_conn_t *c = &s_conns[i];
+            if (!c->used || !c->subscribed) continue;
+
+            // Encode into a copy: a refused notify must not count as sent
+            ftms_rower_enc_t enc = c->enc;
+            uint8_t buf[FTMS_ROWER_MAX_LEN];
+            size_t len = ftms_rower_encode(&enc, &v, buf);
+            if (len == 0) continue;
+
+            struct os_mbuf *om = ble_hs_mbuf_from_flat(buf, len);
+            if (!om || ble_gatts_notify_custom(c->handle, s_rower_data_handle, om) != 0) continue;
+            c->enc = enc;
+            c->frames++;
+            c->bytes += len;
+        }
+    }
+
+    if (any_subscribed())
+        ble_npl_callout_reset(&s_tx_timer, ble_npl_time_ms_to_ticks32(NOTIFY_PERIOD_MS));
+    else
+        s_tx_running = false;
+}
+
+static void set_subscribed(ftms_conn_t *c, bool on)
+{
+    if (on == c->subscribed) return;
+    c->subscribed = on;
+    ble_rowing_add_listeners(on ? 1 : -1);
+    ble_link_set(c->handle, BLE_LINK_USER_FTMS, on ? BLE_LINK_LIVE : BLE_LINK_IDLE);
+    if (on) ftms_rower_enc_reset(&c->enc);
+
+    if (on && !s_tx_running) {
+        s_tx_running = true;
+        ble_npl_callout_reset(&s_tx_timer, ble_npl_time_ms_to_ticks32(NOTIFY_PERIOD_MS));
+    }
+}
+
+static int chr_access(uint16_t conn_handle, uint16_t attr_handle, struct ble_gatt_access_ctxt *ctxt, void *arg)
+{
+    (void)conn_handle;
+    (void)attr_handle;
+    (void)arg;
+
+    if (ctxt->op != BLE_GATT_ACCESS_OP_READ_CHR) return BLE_ATT_ERR_UNLIKELY;
+
+    // Fitness machine features, then target setting features (none)
+    const uint32_t features = FTMS_FEATURES;
+    const uint8_t buf[8] = {
+        (uint8_t)features, (uint8_t)(features >> 8), (uint8_t)(features >> 16), (uint8_t)(features >> 24),
+    };
+    return os_mbuf_append(ctxt->om, buf, sizeof(buf)) == 0 ? 0 : BLE_ATT_ERR_INSUFFICIENT_RES;
+}
+
+esp_err_t ble_ftms_init(void)
+{
+    ble_npl_callout_init(&s_tx_timer, nimble_port_get_dflt_eventq(), tx_tick, NULL);
+
+    int rc = ble_gatts_count_cfg(k_svcs);
+    if (rc == 0) rc = ble_gatts_add_svcs(k_svcs);
+    if (rc != 0) {
+        ESP_LOGE(TAG, "Failed to register FTMS; rc=%d", rc);
+        return ESP_FAIL;
+    }
+    return ESP_OK;
+}
+
+void ble_ftms_on_gap_event(const struct ble_gap_event *event)
+{
+    ftms_conn_t *c;
+
+    switch (event->type) {
+    case BLE_GAP_EVENT_DISCONNECT:
+        c = conn_find(event->disconnect.conn.conn_handle);
+        if (c) {
+            if (c->frames)
+                ESP_LOGI(TAG, "conn %d: %lu Rower Data frames, %lu bytes", c->handle,
+                         (unsigned long)c->frames, (unsigned long)c->bytes);
+            set_subscribed(c, false);
+            memset(c, 0, sizeof(*c));
+        }
+        break;
+
+    case BLE_GAP_EVENT_SUBSCRIBE:
+        if (event->subscribe.attr_handle != s_rower_data_handle) break;
+        c = conn_find(event->subscribe.conn_handle);
+        if (!c) c = conn_add(event->subscribe.conn_handle);
+        if (!c) {
+            ESP_LOGW(TAG, "No slot for connection %d", event->subscribe.conn_handle);
+            break;
+        }
+        set_subscribed(c, event->subscribe.cur_notify);
+        ESP_LOGI(TAG, "conn %d %s Rower Data", c->handle, c->subscribed ? "subscribed to" : "unsubscribed from");
+        break;
+
+    default:
+        break;
+    }
+}
@@ -0,0 +1,355 @@
+// components/ble/ble_link.c
+#include "ble_link.h"
+
+#include <string.h>
+
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "sdkconfig.h"
+
+#include "host/ble_hs.h"
+#include "nimble/nimble_npl.h"
+#include "nimble/nimble_port.h"
+
+static const char *TAG = "ble_link";
+
+#ifndef CONFIG_BT_NIMBLE_MAX_CONNECTIONS
+#define CONFIG_BT_NIMBLE_MAX_CONNECTIONS 3
+#endif
+
+#define MAX_CONNS           CONFIG_BT_NIMBLE_MAX_CONNECTIONS
+#define SETTLE_US           (5 * 1000000)   // after connecting: let discovery run at the phone's interval
+#define BUSY_RETRY_US       (1 * 1000000)   // another parameter procedure was running
+
+typedef struct {
+    uint16_t itvl_min;          // 1.25 ms
+    uint16_t itvl_max;
+    uint16_t latency;           // connection events the peripheral may skip
+    uint16_t timeout;           // 10 ms
+} link_params_t;
+
+/*
+ * [mode][0] is asked for first, [mode][1] if that is refused. The second
+ * sets keep to what phones commonly accept: interval >= 15 ms, max >= min
+ * + 15 ms, max * (latency + 1) <= 2 s, timeout 2..6 s and more than three
+ * times max * (latency + 1).
+ */
+static const link_params_t k_params[BLE_LINK_MODE_COUNT][2] = {
+    [BLE_LINK_IDLE] = { { 240, 400, 2, 600 }, { 80, 160, 0, 600 } },
+    [BLE_LINK_LIVE] = { { 24, 40, 4, 600 },   { 24, 48, 0, 500 } },
+    [BLE_LINK_BULK] = { { 6, 12, 0, 400 },    { 12, 24, 0, 400 } },
+};
+
+typedef struct {
+    bool     used;
+    uint16_t handle;
+    uint8_t  modes[BLE_LINK_USER_COUNT];
+    ble_link_mode_t want;       // the most demanding of modes[]
+    ble_link_mode_t applied;    // what the link runs in (or we gave up asking for)
+    ble_link_mode_t asked;      // in flight when `requesting`
+    bool     settled;           // false until we first set the parameters
+    bool     requesting;
+    uint8_t  attempt;           // index into k_params[mode]
+    int64_t  due_us;            // do not ask before
+    int64_t  since_us;          // `applied` since
+    uint32_t mode_ms[BLE_LINK_MODE_COUNT];
+    uint16_t updates;
+    uint16_t refused;
+} link_conn_t;
+
+// Host task only
+static link_conn_t s_conns[MAX_CONNS];
+static struct ble_npl_callout s_timer;
+
+static const char *phy_name(uint8_t phy)
+{
+    switch (phy) {
+    case BLE_HCI_LE_PHY_1M: return "1M";
+    case BLE_HCI_LE_PHY_2M: return "2M";
+    case BLE_HCI_LE_PHY_CODED: return "coded";
+    default: return "?";
+    }
+}
+
+static link_conn_t *conn_find(uint16_t handle)
+{
+    for (int i = 0; i < MAX_CONNS; i++) {
+        if (s_conns[i].used && s_conns[i].handle == handle) return &s_conns[i];
+    }
+    return NULL;
+}
+
+/* The mode whose parameters (either set) a link came up with, or IDLE. */
+static ble_link_mode_t mode_of(const struct ble_gap_conn_desc *d)
+{
+    for (int m = BLE_LINK_MODE_COUNT - 1; m > BLE_LINK_IDLE; m--) {
+        for (int a = 0; a < 2; a++) {
+            const link_params_t *p = &k_params[m][a];
+            if (d->conn_itvl >= p->itvl_min && d->conn_itvl <= p->itvl_max && d->conn_latency == p->latency)
+                return (ble_link_mode_t)m;
+        }
+    }
+    return BLE_LINK_IDLE;
+}
+
+static void log_achieved(const link_conn_t *c, const char *why)
+{
+    struct ble_gap_conn_desc d;
+    if (ble_gap_conn_find(c->handle, &d) != 0) return;
+    uint8_t tx = 0, rx = 0;
+    ble_gap_read_le_phy(c->handle, &tx, &rx);
+    const unsigned itvl_us = d.conn_itvl * 1250u;
+    ESP_LOGI(TAG, "conn %d %s: %s, interval %u.%02u ms, latency %u, timeout %u ms, PHY %s/%s, MTU %u", c->handle,
+             why, ble_link_mode_name(c->applied), itvl_us / 1000, (itvl_us % 1000) / 10, d.conn_latency,
+             d.supervision_timeout * 10u, phy_name(tx), phy_name(rx), ble_att_mtu(c->handle));
+}
+
+static void set_applied(link_conn_t *c, ble_link_mode_t mode)
+{
+    const int64_t now = esp_timer_get_time();
+    c->mode_ms[c->applied] += (uint32_t)((now - c->since_us) / 1000);
+    c->since_us = now;
+    c->applied = mode;
+    c->settled = true;
+}
+
+static void arm_timer(void)
+{
+    const int64_t now = esp_timer_get_time();
+    int64_t next = INT64_MAX;
+    for (int i = 0; i < MAX_CONNS; i++) {
+        const link_conn_t *c = &s_conns[i];
+        if (c->used && !c->requesting && (!c->settled || c->want != c->applied) && c->due_us < next)
+            next = c->due_us;
+    }
+    if (next == INT64_MAX) return;
+    int64_t ms = (next > now) ? (next - now) / 1000 + 1 : 1;
+    ble_npl_callout_reset(&s_timer, ble_npl_time_ms_to_ticks32((uint32_t)ms));
+}
+
+/* PHY and, for bulk, data length and MTU. These have no "refused" path
+ * worth handling: the link runs on whatever the peer settles for. */
+static void request_phy(const link_conn_t *c, ble_link_mode_t mode)
+{
+    const uint8_t phys = (mode == BLE_LINK_IDLE) ? BLE_GAP_LE_PHY_ANY_MASK : BLE_GAP_LE_PHY_2M_MASK;
+    int rc = ble_gap_set_prefered_le_phy(c->handle, phys, phys, BLE_GAP_LE_PHY_CODED_ANY);
+    if (rc != 0) ESP_LOGD(TAG, "conn %d: PHY request failed; rc=%d", c->handle, rc);
+
+    if (mode != BLE_LINK_BULK) return;
+
+    // 251-byte link-layer payloads; 2120 us is the longest such packet on the 1M PHY
+    rc = ble_gap_set_data_len(c->handle, 251, 2120);
+    if (rc != 0) ESP_LOGD(TAG, "conn %d: data length request failed; rc=%d", c->handle, rc);
+
+    // The client normally raises the MTU itself; ask in case it did not
+    if (ble_att_mtu(c->handle) <= BLE_ATT_MTU_DFLT) ble_gattc_exchange_mtu(c->handle, NULL, NULL);
+}
+
+static void link_apply(link_conn_t *c)
+{
+    if (c->requesting || (c->settled && c->want == c->applied)) return;
+    if (esp_timer_get_time() < c->due_us) {
+        arm_timer();
+        return;
+    }
+
+    const link_params_t *p = &k_params[c->want][c->attempt];
+    struct ble_gap_upd_params up = {
+        .itvl_min = p->itvl_min,
+        .itvl_max = p->itvl_max,
+        .latency = p->latency,
+        .supervision_timeout = p->timeout,
+    };
+
+    if (c->attempt == 0) request_phy(c, c->want);
+
+    int rc = ble_gap_update_params(c->handle, &up);
+    if (rc == 0) {
+        c->requesting = true;
+        c->asked = c->want;
+        c->updates++;
+        return;
+    }
+    if (rc == BLE_HS_EALREADY || rc == BLE_HS_EBUSY) {
+        c->due_us = esp_timer_get_time() + BUSY_RETRY_US;
+        arm_timer();
+        return;
+    }
+
+    // Could not even ask (controller or host refused): treat as a refusal
+    ESP_LOGW(TAG, "conn %d: %s update not sent; rc=%d", c->handle, ble_link_mode_name(c->want), rc);
+    c->refused++;
+    set_applied(c, c->want);
+}
+
+static void timer_tick(struct ble_npl_event *ev)
+{
+    (void)ev;
+    for (int i = 0; i < MAX_CONNS; i++) {
+        if (s_conns[i].used) link_apply(&s_conns[i]);
+    }
+}
+
+static void conn_update_done(link_conn_t *c, int status)
+{
+    if (!c->requesting) {
+        // The peer changed the parameters on its own; we do not fight it
+        if (status == 0) log_achieved(c, "peer update");
+        return;
+    }
+    c->requesting = false;
+
+    if (status == 0) {
+        c->attempt = 0;
+        set_applied(c, c->asked);
+        log_achieved(c, c->asked == c->want ? "now" : "was");
+    } else {
+        c->refused++;
+        if (c->asked != c->want) {
+            c->attempt = 0;     // moved on meanwhile: the new mode gets its own first try
+        } else if (c->attempt == 0) {
+            ESP_LOGW(TAG, "conn %d: %s parameters refused (status %d), trying the fallback", c->handle,
+                     ble_link_mode_name(c->asked), status);
+            c->attempt = 1;
+        } else {
+            ESP_LOGW(TAG, "conn %d: %s fallback refused too (status %d), keeping the current parameters",
+                     c->handle, ble_link_mode_name(c->asked), status);
+            c->attempt = 0;
+            set_applied(c, c->asked);
+            log_achieved(c, "kept");
+        }
+    }
+
+    // The wanted mode may have moved while the update was in flight
+    link_apply(c);
+}
+
+/* -------------------------------------------------------------------------- */
+/* Public API                                                                 */
+/* -------------------------------------------------------------------------- */
+
+void ble_link_init(void)
+{
+    ble_npl_callout_init(&s_timer, nimble_port_get_dflt_eventq(), timer_tick, NULL);
+}
+
+void ble_link_set(uint16_t conn, ble_link_user_t user, ble_link_mode_t mode)
+{
+    link_conn_t *c = conn_find(conn);
+    if (!c || user >= BLE_LINK_USER_COUNT || mode >= BLE_LINK_MODE_COUNT) return;
+
+    c->modes[user] = (uint8_t)mode;
+    ble_link_mode_t want = BLE_LINK_IDLE;
+    for (int i = 0; i < BLE_LINK_USER_COUNT; i++) {
+        if (c->modes[i] > want) want = (ble_link_mode_t)c->modes[i];
+    }
+    if (want == c->want) return;
+
+    c->want = want;
+    c->attempt = 0;
+    // Demand goes out at once; a drop to a slower mode waits out the settle time if it is running
+    if (want > c->applied) c->due_us = 0;
+    link_apply(c);
+}
+
+ble_link_mode_t ble_link_mode(uint16_t conn)
+{
+    const link_conn_t *c = conn_find(conn);
+    return c ? c->applied : BLE_LINK_IDLE;
+}
+
+const char *ble_link_mode_name(ble_link_mode_t mode)
+{
+    switch (mode) {
+    case BLE_LINK_IDLE: return "idle";
+    case BLE_LINK_LIVE: return "live";
+    case BLE_LINK_BULK: return "bulk";
+    default: return "?";
+    }
+}
+
+void ble_link_conn_params(ble_link_mode_t mode, struct ble_gap_conn_params *out)
+{
+    if (mode >= BLE_LINK_MODE_COUNT) mode = BLE_LINK_IDLE;
+    const link_params_t *p = &k_params[mode][0];
+    *out = (struct ble_gap_conn_params){
+        .scan_itvl = 0x0010,            // 10 ms: the peer is advertising, find it quickly
+        .scan_window = 0x0010,
+        .itvl_min = p->itvl_min,
+        .itvl_max = p->itvl_max,
+        .latency = p->latency,
+        .supervision_timeout = p->timeout,
+        .min_ce_len = 0,
+        .max_ce_len = 0,
+    };
+}
+
+void ble_link_on_gap_event(const struct ble_gap_event *event)
+{
+    link_conn_t *c;
+
+    switch (event->type) {
+    case BLE_GAP_EVENT_CONNECT:
+        if (event->connect.status != 0) break;
+        c = conn_find(event->connect.conn_handle);
+        for (int i = 0; !c && i < MAX_CONNS; i++) {
+            if (!s_conns[i].used) c = &s_conns[i];
+        }
+        if (!c) break;
+        *c = (link_conn_t){
+            .used = true,
+            .handle = event->connect.conn_handle,
+            // Whatever the link came up with counts as idle; after the settle
+            // time it gets the idle parameters unless someone needs more
+            .want = BLE_LINK_IDLE,
+            .applied = BLE_LINK_IDLE,
+            .due_us = esp_timer_get_time() + SETTLE_US,
+            .since_us = esp_timer_get_time(),
+        };
+        // As central we chose the parameters (ble_link_conn_params): the link
+        // is in that mode already and asking for it again would cost an
+        // update. It still drops to idle after the settle time unless a
+        // user keeps it up.
+        struct ble_gap_conn_desc d;
+        const bool central = ble_gap_conn_find(c->handle, &d) == 0 && d.role == BLE_GAP_ROLE_MASTER;
+        if (central) {
+            c->applied = mode_of(&d);
+            c->settled = c->applied != BLE_LINK_IDLE;
+        }
+        log_achieved(c, "connected");
+        // Arms the timer for the end of the settle time
+        link_apply(c);
+        break;
+
+    case BLE_GAP_EVENT_DISCONNECT:
+        c = conn_find(event->disconnect.conn.conn_handle);
+        if (!c) break;
+        set_applied(c, c->applied);
+        ESP_LOGI(TAG, "conn %d: idle %lu s, live %lu s, bulk %lu s; %u updates asked, %u refused", c->handle,
+                 (unsigned long)(c->mode_ms[BLE_LINK_IDLE] / 1000), (unsigned long)(c->mode_ms[BLE_LINK_LIVE] / 1000),
+                 (unsigned long)(c->mode_ms[BLE_LINK_BULK] / 1000), c->updates, c->refused);
+        memset(c, 0, sizeof(*c));
+        break;
+
+    case BLE_GAP_EVENT_CONN_UPDATE:
+        c = conn_find(event->conn_update.conn_handle);
+        if (c) conn_update_done(c, event->conn_update.status);
+        break;
+
+    case BLE_GAP_EVENT_PHY_UPDATE_COMPLETE:
+        if (event->phy_updated.status == 0)
+            ESP_LOGI(TAG, "conn %d: PHY %s/%s", event->phy_updated.conn_handle, phy_name(event->phy_updated.tx_phy),
+                     phy_name(event->phy_updated.rx_phy));
+        break;
+
+#ifdef BLE_GAP_EVENT_DATA_LEN_CHG
+    case BLE_GAP_EVENT_DATA_LEN_CHG:
+        ESP_LOGI(TAG, "conn %d: data length tx %u rx %u", event->data_len_chg.conn_handle,
+                 event->data_len_chg.max_tx_octets, event->data_len_chg.max_rx_octets);
+        break;
+#endif
+
+    default:
+        break;
+    }
+}
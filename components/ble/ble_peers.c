@@ -0,0 +1,248 @@
+// components/ble/ble_peers.c
+#include "ble_peers.h"
+
+#include <string.h>
+
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "nvs.h"
+#include "sdkconfig.h"
+
+#include "host/ble_hs.h"
+
+#include "ble_link.h"
+#include "ble_scan_sched.h"
+
+static const char *TAG = "ble_peers";
+
+#ifndef CONFIG_BLE_PEERS_RECONNECT_S
+#define CONFIG_BLE_PEERS_RECONNECT_S 30
+#endif
+
+#define NVS_NAMESPACE   "ble_peers"
+#define NVS_KEY         "peers"
+#define INIT_SCAN       0x0030      // 30 ms of every 30 ms while initiating
+
+static ble_peer_t s_peers[BLE_PEERS_MAX];
+static int s_count;
+
+static uint8_t s_own_addr_type;
+static int (*s_cb)(struct ble_gap_event *event, void *arg);
+static bool s_pending;              // accept-list connection initiated, not completed
+
+// Written on the host task, read by any
+static ble_peers_timing_t s_timing;
+static portMUX_TYPE s_lock = portMUX_INITIALIZER_UNLOCKED;
+
+static const char *const k_kind_name[BLE_SENSOR_COUNT] = {
+    [BLE_SENSOR_HR] = "heart rate",
+    [BLE_SENSOR_POWER] = "power",
+};
+
+static esp_err_t save(void)
+{
+    nvs_handle_t handle;
+    esp_err_t err = nvs_open(NVS_NAMESPACE, NVS_READWRITE, &handle);
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "NVS Open Failed: %s", esp_err_to_name(err));
+        return err;
+    }
+    err = s_count ? nvs_set_blob(handle, NVS_KEY, s_peers, s_count * sizeof(s_peers[0]))
+                  : nvs_erase_key(handle, NVS_KEY);
+    if (err == ESP_ERR_NVS_NOT_FOUND) err = ESP_OK;
+    if (err == ESP_OK) err = nvs_commit(handle);
+    nvs_close(handle);
+    if (err != ESP_OK) ESP_LOGW(TAG, "Cannot save known peers: %s", esp_err_to_name(err));
+    return err;
+}
+
+static int find(const uint8_t addr[6], uint8_t addr_type)
+{
+    for (int i = 0; i < s_count; i++) {
+        if (s_peers[i].addr_type == addr_type && memcmp(s_peers[i].addr, addr, 6) == 0) return i;
+    }
+    return -1;
+}
+
+esp_err_t ble_peers_init(void)
+{
+    s_count = 0;
+    nvs_handle_t handle;
+    esp_err_t err = nvs_open(NVS_NAMESPACE, NVS_READONLY, &handle);
+    if (err == ESP_ERR_NVS_NOT_FOUND) return ESP_OK;    // first boot
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "NVS Open Failed: %s", esp_err_to_name(err));
+        return err;
+    }
+
+    size_t len = sizeof(s_peers);
+    err = nvs_get_blob(handle, NVS_KEY, s_peers, &len);
+    nvs_close(handle);
+    if (err == ESP_OK && len % sizeof(s_peers[0]) == 0) {
+        s_count = (int)(len / sizeof(s_peers[0]));
+    } else if (err != ESP_ERR_NVS_NOT_FOUND) {
+        ESP_LOGW(TAG, "Ignoring the known-peer cache: %s", esp_err_to_name(err));
+    }
+    ESP_LOGI(TAG, "%d known sensor(s)", s_count);
+    return ESP_OK;
+}
+
+int ble_peers_count(void)
+{
+    return s_count;
+}
+
+bool ble_peers_get(int index, ble_peer_t *out)
+{
+    if (index < 0 || index >= s_count) return false;
+    *out = s_peers[index];
+    return true;
+}
+
+void ble_peers_remember(const uint8_t addr[6], uint8_t addr_type, ble_sensor_kind_t kind)
+{
+    ble_peer_t p = { .addr_type = addr_type, .kinds = (uint8_t)(1u << kind) };
+    memcpy(p.addr, addr, 6);
+
+    int i = find(addr, addr_type);
+    if (i == 0 && (s_peers[0].kinds & p.kinds)) return;     // nothing new, spare the flash
+    if (i < 0) {
+        // The oldest drops off the end when the cache is full
+        i = s_count < BLE_PEERS_MAX ? s_count++ : BLE_PEERS_MAX - 1;
+    } else {
+        p.kinds |= s_peers[i].kinds;
+    }
+    memmove(&s_peers[1], &s_peers[0], i * sizeof(s_peers[0]));
+    s_peers[0] = p;
+    ESP_LOGI(TAG, "Remembering %02X:%02X:%02X:%02X:%02X:%02X for %s",
+             addr[5], addr[4], addr[3], addr[2], addr[1], addr[0], k_kind_name[kind]);
+    save();
+}
+
+esp_err_t ble_peers_forget(void)
+{
+    s_count = 0;
+    esp_err_t err = save();
+    // Nothing left to reconnect to: background scanning may resume
+    ble_scan_sched_update();
+    return err;
+}
+
+esp_err_t ble_peers_reconnect(uint8_t own_addr_type, int (*cb)(struct ble_gap_event *event, void *arg))
+{
+    s_own_addr_type = own_addr_type;
+    s_cb = cb;
+
+    const int64_t now_us = esp_timer_get_time();
+    taskENTER_CRITICAL(&s_lock);
+    if (!s_timing.sync_us) s_timing.sync_us = now_us;
+    taskEXIT_CRITICAL(&s_lock);
+
+    if (s_count == 0) return ESP_ERR_NOT_FOUND;
+    if (s_pending || ble_gap_conn_active()) return ESP_ERR_INVALID_STATE;
+
+    ble_addr_t list[BLE_PEERS_MAX];
+    for (int i = 0; i < s_count; i++) {
+        list[i].type = s_peers[i].addr_type;
+        memcpy(list[i].val, s_peers[i].addr, 6);
+    }
+    int rc = ble_gap_wl_set(list, (uint8_t)s_count);
+    if (rc != 0) {
+        ESP_LOGW(TAG, "Cannot load the accept list; rc=%d", rc);
+        return ESP_FAIL;
+    }
+
+    // The peer is advertising right now if it is ours: listen all the time,
+    // and a short interval while discovery and subscription run
+    struct ble_gap_conn_params params;
+    ble_link_conn_params(BLE_LINK_BULK, &params);
+    params.scan_itvl = INIT_SCAN;
+    params.scan_window = INIT_SCAN;
+
+    // No peer address: the controller connects to the first accept-list match
+    ble_gap_disc_cancel();
+    rc = ble_gap_connect(own_addr_type, NULL, CONFIG_BLE_PEERS_RECONNECT_S * 1000, &params, cb, NULL);
+    if (rc != 0) {
+        ESP_LOGW(TAG, "Cannot initiate to known sensors; rc=%d", rc);
+        return ESP_FAIL;
+    }
+    s_pending = true;
+
+    taskENTER_CRITICAL(&s_lock);
+    s_timing.start_us = now_us;
+    s_timing.connect_us = 0;
+    memset(s_timing.ready_us, 0, sizeof(s_timing.ready_us));
+    taskEXIT_CRITICAL(&s_lock);
+    ESP_LOGI(TAG, "Reconnecting to %d known sensor(s), %lld ms after boot", s_count, (long long)(now_us / 1000));
+    return ESP_OK;
+}
+
+void ble_peers_cancel_reconnect(void)
+{
+    if (s_pending && ble_gap_conn_active()) ble_gap_conn_cancel();
+}
+
+void ble_peers_on_gap_event(const struct ble_gap_event *event)
+{
+    switch (event->type) {
+    case BLE_GAP_EVENT_CONNECT: {
+        if (!s_pending) break;
+        struct ble_gap_conn_desc desc;
+        if (event->connect.status == 0 && (ble_gap_conn_find(event->connect.conn_handle, &desc) != 0 ||
+                                           desc.role != BLE_GAP_ROLE_MASTER))
+            break;                  // a phone connected to us meanwhile
+        s_pending = false;
+        if (event->connect.status != 0) {
+            ESP_LOGI(TAG, "No known sensor connected; status=%d", event->connect.status);
+            break;
+        }
+        const int64_t now_us = esp_timer_get_time();
+        taskENTER_CRITICAL(&s_lock);
+        s_timing.connect_us = now_us;
+        taskEXIT_CRITICAL(&s_lock);
+        const uint8_t *a = desc.peer_id_addr.val;
+        ESP_LOGI(TAG, "Known sensor %02X:%02X:%02X:%02X:%02X:%02X connected %lld ms after boot (%lld ms initiating)",
+                 a[5], a[4], a[3], a[2], a[1], a[0], (long long)(now_us / 1000),
+                 (long long)((now_us - s_timing.start_us) / 1000));
+        break;
+    }
+    case BLE_GAP_EVENT_DISCONNECT: {
+        const struct ble_gap_conn_desc *c = &event->disconnect.conn;
+        if (c->role != BLE_GAP_ROLE_MASTER ||
+            event->disconnect.reason == BLE_HS_HCI_ERR(BLE_ERR_CONN_TERM_LOCAL) ||
+            find(c->peer_id_addr.val, c->peer_id_addr.type) < 0)
+            break;
+        // Out of range or switched off: wait for it to come back
+        ble_peers_reconnect(s_own_addr_type, s_cb);
+        break;
+    }
+    default:
+        break;
+    }
+}
+
+void ble_peers_on_ready(ble_sensor_kind_t kind)
+{
+    if ((unsigned)kind >= BLE_SENSOR_COUNT) return;
+    const int64_t now_us = esp_timer_get_time();
+
+    taskENTER_CRITICAL(&s_lock);
+    const bool first = s_timing.connect_us && !s_timing.ready_us[kind];
+    if (first) s_timing.ready_us[kind] = now_us;
+    const ble_peers_timing_t t = s_timing;
+    taskEXIT_CRITICAL(&s_lock);
+
+    if (first) {
+        ESP_LOGI(TAG, "%s ready %lld ms after boot (sync %lld, initiating %lld, connected %lld)",
+                 k_kind_name[kind], (long long)(now_us / 1000), (long long)(t.sync_us / 1000),
+                 (long long)(t.start_us / 1000), (long long)(t.connect_us / 1000));
+    }
+}
+
+void ble_peers_timing(ble_peers_timing_t *out)
+{
+    taskENTER_CRITICAL(&s_lock);
+    *out = s_timing;
+    taskEXIT_CRITICAL(&s_lock);
+}
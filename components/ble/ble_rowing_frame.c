@@ -0,0 +1,157 @@
+// components/ble/ble_rowing_frame.c
+#include "ble_rowing_frame.h"
+
+#include <math.h>
+#include <string.h>
+
+#define RING_MASK (BLE_ROWING_RING_LEN - 1)
+
+_Static_assert((BLE_ROWING_RING_LEN & RING_MASK) == 0, "BLE_ROWING_RING_LEN must be a power of two");
+
+/* -------------------------------------------------------------------------- */
+/* Encoding                                                                   */
+/* -------------------------------------------------------------------------- */
+
+/* x * scale rounded, clamped to [0, max]; NaN is 0. */
+static uint32_t quant(float x, float scale, uint32_t max)
+{
+    float v = x * scale + 0.5f;
+    if (!(v > 0.0f)) return 0;
+    if (v >= (float)max) return max;
+    return (uint32_t)v;
+}
+
+static uint8_t *put_le(uint8_t *p, uint32_t v, int bytes)
+{
+    for (int i = 0; i < bytes; i++) *p++ = (uint8_t)(v >> (8 * i));
+    return p;
+}
+
+static uint32_t get_le(const uint8_t *p, int bytes)
+{
+    uint32_t v = 0;
+    for (int i = 0; i < bytes; i++) v |= (uint32_t)p[i] << (8 * i);
+    return v;
+}
+
+int ble_rowing_frame_capacity(uint16_t mtu)
+{
+    // A notification carries MTU - 3 bytes (opcode and handle)
+    int room = (int)mtu - 3 - BLE_ROWING_HDR_LEN;
+    int n = (room > 0) ? room / BLE_ROWING_SAMPLE_LEN : 0;
+    return (n > BLE_ROWING_MAX_SAMPLES) ? BLE_ROWING_MAX_SAMPLES : n;
+}
+
+size_t ble_rowing_frame_encode(uint8_t *out, uint8_t first_seq, const ble_rowing_sample_t *samples, int n)
+{
+    if (n < 0) n = 0;
+    if (n > BLE_ROWING_MAX_SAMPLES) n = BLE_ROWING_MAX_SAMPLES;
+
+    uint8_t *p = out;
+    *p++ = (uint8_t)(BLE_ROWING_FRAME_VERSION << 4 | n);
+    *p++ = first_seq;
+
+    for (int i = 0; i < n; i++) {
+        const ble_rowing_sample_t *s = &samples[i];
+        uint32_t drive = quant(s->drive_time_s, 100.0f, 0xFFF);
+        uint32_t recovery = quant(s->recovery_time_s, 100.0f, 0xFFF);
+
+        p = put_le(p, s->t_ms, 4);
+        p = put_le(p, quant(s->spm, 10.0f, 0xFFFF), 2);
+        p = put_le(p, quant(s->pace_500m_s, 10.0f, 0xFFFF), 2);
+        p = put_le(p, quant(s->speed_mps, 1000.0f, 0xFFFF), 2);
+        p = put_le(p, quant(s->distance_m, 10.0f, 0xFFFFFF), 3);
+        p = put_le(p, s->stroke_count & 0xFFFF, 2);
+        p = put_le(p, drive | recovery << 12, 3);
+    }
+    return (size_t)(p - out);
+}
+
+int ble_rowing_frame_decode(const uint8_t *buf, size_t len, uint8_t *first_seq,
+                            ble_rowing_sample_t *out, int max)
+{
+    if (len < BLE_ROWING_HDR_LEN || (buf[0] >> 4) != BLE_ROWING_FRAME_VERSION) return -1;
+
+    int n = buf[0] & 0x0F;
+    if (len < BLE_ROWING_HDR_LEN + (size_t)n * BLE_ROWING_SAMPLE_LEN) return -1;
+    if (first_seq) *first_seq = buf[1];
+
+    const uint8_t *p = buf + BLE_ROWING_HDR_LEN;
+    for (int i = 0; i < n && i < max; i++, p += BLE_ROWING_SAMPLE_LEN) {
+        uint32_t times = get_le(p + 15, 3);
+        out[i] = (ble_rowing_sample_t){
+            .t_ms = get_le(p, 4),
+            .spm = (float)get_le(p + 4, 2) * 0.1f,
+            .pace_500m_s = (float)get_le(p + 6, 2) * 0.1f,
+            .speed_mps = (float)get_le(p + 8, 2) * 0.001f,
+            .distance_m = (float)get_le(p + 10, 3) * 0.1f,
+            .stroke_count = get_le(p + 13, 2),
+            .drive_time_s = (float)(times & 0xFFF) * 0.01f,
+            .recovery_time_s = (float)(times >> 12) * 0.01f,
+        };
+    }
+    return n;
+}
+
+/* -------------------------------------------------------------------------- */
+/* Ring                                                                       */
+/* -------------------------------------------------------------------------- */
+
+void ble_rowing_ring_init(ble_rowing_ring_t *r)
+{
+    memset(r, 0, sizeof(*r));
+    for (int i = 0; i < BLE_ROWING_RING_LEN; i++) atomic_init(&r->slots[i].seq, 0);
+    atomic_init(&r->head, 0);
+}
+
+void ble_rowing_ring_push(ble_rowing_ring_t *r, const ble_rowing_sample_t *s)
+{
+    uint32_t seq = (uint32_t)atomic_load_explicit(&r->head, memory_order_relaxed);
+    ble_rowing_slot_t *slot = &r->slots[seq & RING_MASK];
+
+    // Readers that see 0 (or a different seq) know the slot is not theirs
+    atomic_store_explicit(&slot->seq, 0, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+    slot->sample = *s;
+    atomic_store_explicit(&slot->seq, seq + 1, memory_order_release);
+    atomic_store_explicit(&r->head, seq + 1, memory_order_release);
+}
+
+uint32_t ble_rowing_ring_head(ble_rowing_ring_t *r)
+{
+    return (uint32_t)atomic_load_explicit(&r->head, memory_order_acquire);
+}
+
+int ble_rowing_ring_read(ble_rowing_ring_t *r, uint32_t *cursor, ble_rowing_sample_t *out, int max,
+                         uint32_t *first_seq)
+{
+    const uint32_t head = ble_rowing_ring_head(r);
+    uint32_t cur = *cursor;
+
+    if (head - cur > BLE_ROWING_RING_LEN) cur = head - BLE_ROWING_RING_LEN;
+    if (max <= 0) return 0;
+    if (head - cur > (uint32_t)max) cur = head - (uint32_t)max;
+
+    int n = 0;
+    uint32_t first = cur;
+    for (; cur != head; cur++) {
+        const ble_rowing_slot_t *slot = &r->slots[cur & RING_MASK];
+        bool ok = atomic_load_explicit(&slot->seq, memory_order_acquire) == cur + 1;
+        if (ok) {
+            out[n] = slot->sample;
+            atomic_thread_fence(memory_order_acquire);
+            ok = atomic_load_explicit(&slot->seq, memory_order_relaxed) == cur + 1;
+        }
+        if (!ok) {
+            // Overwritten while we read: everything older is gone too
+            n = 0;
+            first = cur + 1;
+            continue;
+        }
+        n++;
+    }
+
+    *cursor = head;
+    if (first_seq) *first_seq = first;
+    return n;
+}
@@ -0,0 +1,335 @@
+// components/ble/ble_rowing_svc.c
+#include "ble_rowing.h"
+
+#include <stdatomic.h>
+#include <string.h>
+
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "sdkconfig.h"
+
+#include "host/ble_hs.h"
+#include "nimble/nimble_npl.h"
+#include "nimble/nimble_port.h"
+
+#include "ble_link.h"
+
+static const char *TAG = "ble_rowing";
+
+#ifndef CONFIG_BLE_ROWING_RATE_HZ
+#define CONFIG_BLE_ROWING_RATE_HZ 10
+#endif
+#ifndef CONFIG_BT_NIMBLE_MAX_CONNECTIONS
+#define CONFIG_BT_NIMBLE_MAX_CONNECTIONS 3
+#endif
+
+#define MAX_CONNS CONFIG_BT_NIMBLE_MAX_CONNECTIONS
+
+/* f7b0000x-5d2c-4c1e-8a5b-2f6e9d3c1a40: 1 service, 2 data, 3 rate */
+#define ROWING_UUID(n) \
+    BLE_UUID128_INIT(0x40, 0x1a, 0x3c, 0x9d, 0x6e, 0x2f, 0x5b, 0x8a, 0x1e, 0x4c, 0x2c, 0x5d, n, 0x00, 0xb0, 0xf7)
+
+static const ble_uuid128_t k_svc_uuid = ROWING_UUID(0x01);
+static const ble_uuid128_t k_data_uuid = ROWING_UUID(0x02);
+static const ble_uuid128_t k_rate_uuid = ROWING_UUID(0x03);
+
+const uint8_t ble_rowing_svc_uuid128[16] = {
+    0x40, 0x1a, 0x3c, 0x9d, 0x6e, 0x2f, 0x5b, 0x8a, 0x1e, 0x4c, 0x2c, 0x5d, 0x01, 0x00, 0xb0, 0xf7,
+};
+
+typedef struct {
+    bool     used;
+    bool     subscribed;
+    uint16_t handle;
+    uint16_t mtu;
+    uint32_t itvl_us;           // connection interval: at most one frame per interval
+    uint32_t cursor;            // next ring seq this connection has not seen
+    int64_t  last_tx_us;
+    uint32_t frames;
+    uint32_t skipped;           // samples never sent (MTU too small for the backlog, or lapped)
+    uint32_t busy;              // notifies refused for lack of buffers
+} rowing_conn_t;
+
+// Connection table and timer: host task only
+static rowing_conn_t s_conns[MAX_CONNS];
+static uint16_t s_data_handle;
+static struct ble_npl_callout s_tx_timer;
+static bool s_tx_running;
+
+// Shared with stroke_task
+static ble_rowing_ring_t s_ring;
+static atomic_int s_subscribers;
+static atomic_int s_listeners;      // s_subscribers plus other services' subscribers
+static atomic_uint s_period_us = 1000000 / CONFIG_BLE_ROWING_RATE_HZ;
+static int64_t s_last_publish_us;   // stroke_task only
+
+static int chr_access(uint16_t conn_handle, uint16_t attr_handle, struct ble_gatt_access_ctxt *ctxt, void *arg);
+
+static const struct ble_gatt_svc_def k_svcs[] = {
+    {
+        .type = BLE_GATT_SVC_TYPE_PRIMARY,
+        .uuid = &k_svc_uuid.u,
+        .characteristics = (struct ble_gatt_chr_def[]){
+            {
+                .uuid = &k_data_uuid.u,
+                .access_cb = chr_access,
+                .flags = BLE_GATT_CHR_F_READ | BLE_GATT_CHR_F_NOTIFY,
+                .val_handle = &s_data_handle,
+            },
+            {
+                .uuid = &k_rate_uuid.u,
+                .access_cb = chr_access,
+                .flags = BLE_GATT_CHR_F_READ | BLE_GATT_CHR_F_WRITE,
+            },
+            { 0 },
+        },
+    },
+    { 0 },
+};
+
+/* -------------------------------------------------------------------------- */
+/* Connections                                                                */
+/* -------------------------------------------------------------------------- */
+
+static rowing_conn_t *conn_find(uint16_t handle)
+{
+    for (int i = 0; i < MAX_CONNS; i++) {
+        if (s_conns[i].used && s_conns[i].handle == handle) return &s_conns[i];
+    }
+    return NULL;
+}
+
+static void conn_refresh_itvl(rowing_conn_t *c)
+{
+    struct ble_gap_conn_desc desc;
+    if (ble_gap_conn_find(c->handle, &desc) == 0) c->itvl_us = (uint32_t)desc.conn_itvl * 1250;
+}
+
+static rowing_conn_t *conn_add(uint16_t handle)
+{
+    rowing_conn_t *c = conn_find(handle);
+    for (int i = 0; !c && i < MAX_CONNS; i++) {
+        if (!s_conns[i].used) c = &s_conns[i];
+    }
+    if (!c) return NULL;
+
+    *c = (rowing_conn_t){ .used = true, .handle = handle, .mtu = ble_att_mtu(handle) };
+    conn_refresh_itvl(c);
+    return c;
+}
+
+static void update_subscribers(void)
+{
+    int n = 0;
+    for (int i = 0; i < MAX_CONNS; i++) n += s_conns[i].used && s_conns[i].subscribed;
+    int old = atomic_exchange(&s_subscribers, n);
+    atomic_fetch_add(&s_listeners, n - old);
+
+    if (n > 0 && !s_tx_running) {
+        s_tx_running = true;
+        ble_npl_callout_reset(&s_tx_timer, ble_npl_time_ms_to_ticks32(atomic_load(&s_period_us) / 1000));
+    }
+    // With nobody left the timer simply does not re-arm
+}
+
+/* -------------------------------------------------------------------------- */
+/* Sending                                                                    */
+/* -------------------------------------------------------------------------- */
+
+static void send_frame(rowing_conn_t *c, int64_t now_us)
+{
+    int cap = ble_rowing_frame_capacity(c->mtu);
+    if (cap == 0) return;
+
+    ble_rowing_sample_t smp[BLE_ROWING_MAX_SAMPLES];
+    uint32_t cursor = c->cursor, first;
+    int n = ble_rowing_ring_read(&s_ring, &cursor, smp, cap, &first);
+    if (n == 0) return;
+
+    uint8_t buf[BLE_ROWING_HDR_LEN + BLE_ROWING_MAX_SAMPLES * BLE_ROWING_SAMPLE_LEN];
+    size_t len = ble_rowing_frame_encode(buf, (uint8_t)first, smp, n);
+
+    // Out of mbufs: keep the backlog, the next interval sends it coalesced
+    struct os_mbuf *om = ble_hs_mbuf_from_flat(buf, len);
+    if (!om || ble_gatts_notify_custom(c->handle, s_data_handle, om) != 0) {
+        c->busy++;
+        return;
+    }
+
+    c->skipped += first - c->cursor;
+    c->cursor = cursor;
+    c->last_tx_us = now_us;
+    c->frames++;
+}
+
+static void tx_tick(struct ble_npl_event *ev)
+{
+    (void)ev;
+    const uint32_t period_us = atomic_load(&s_period_us);
+    const int64_t now_us = esp_timer_get_time();
+
+    for (int i = 0; i < MAX_CONNS; i++) {
+        rowing_conn_t *c = &s_conns[i];
+        if (!c->used || !c->subscribed) continue;
+        // One frame per connection event; half a tick of slack so a tick
+        // landing just early does not skip a whole interval
+        if (now_us - c->last_tx_us + period_us / 2 < c->itvl_us) continue;
+        send_frame(c, now_us);
+    }
+
+    if (atomic_load(&s_subscribers) > 0)
+        ble_npl_callout_reset(&s_tx_timer, ble_npl_time_ms_to_ticks32(period_us / 1000));
+    else
+        s_tx_running = false;
+}
+
+/* -------------------------------------------------------------------------- */
+/* GATT access                                                                */
+/* -------------------------------------------------------------------------- */
+
+static int chr_access(uint16_t conn_handle, uint16_t attr_handle, struct ble_gatt_access_ctxt *ctxt, void *arg)
+{
+    (void)conn_handle;
+    (void)arg;
+
+    if (attr_handle == s_data_handle) {
+        if (ctxt->op != BLE_GATT_ACCESS_OP_READ_CHR) return BLE_ATT_ERR_UNLIKELY;
+
+        // The newest sample as a one-sample frame
+        ble_rowing_sample_t s;
+        int n = ble_rowing_latest(&s) ? 1 : 0;
+        uint8_t buf[BLE_ROWING_HDR_LEN + BLE_ROWING_SAMPLE_LEN];
+        size_t len = ble_rowing_frame_encode(buf, (uint8_t)(ble_rowing_ring_head(&s_ring) - 1), &s, n);
+        return os_mbuf_append(ctxt->om, buf, len) == 0 ? 0 : BLE_ATT_ERR_INSUFFICIENT_RES;
+    }
+
+    // Rate
+    if (ctxt->op == BLE_GATT_ACCESS_OP_READ_CHR) {
+        uint8_t hz = ble_rowing_get_rate_hz();
+        return os_mbuf_append(ctxt->om, &hz, 1) == 0 ? 0 : BLE_ATT_ERR_INSUFFICIENT_RES;
+    }
+    if (ctxt->op == BLE_GATT_ACCESS_OP_WRITE_CHR) {
+        uint8_t hz;
+        uint16_t len = 0;
+        if (OS_MBUF_PKTLEN(ctxt->om) != 1 || ble_hs_mbuf_to_flat(ctxt->om, &hz, 1, &len) != 0)
+            return BLE_ATT_ERR_INVALID_ATTR_VALUE_LEN;
+        if (hz == 0 || hz > BLE_ROWING_MAX_RATE_HZ) return BLE_ATT_ERR_VALUE_NOT_ALLOWED;
+        ble_rowing_set_rate_hz(hz);
+        return 0;
+    }
+    return BLE_ATT_ERR_UNLIKELY;
+}
+
+/* -------------------------------------------------------------------------- */
+/* Public API                                                                 */
+/* -------------------------------------------------------------------------- */
+
+esp_err_t ble_rowing_init(void)
+{
+    ble_rowing_ring_init(&s_ring);
+    ble_npl_callout_init(&s_tx_timer, nimble_port_get_dflt_eventq(), tx_tick, NULL);
+
+    int rc = ble_gatts_count_cfg(k_svcs);
+    if (rc == 0) rc = ble_gatts_add_svcs(k_svcs);
+    if (rc != 0) {
+        ESP_LOGE(TAG, "Failed to register rowing service; rc=%d", rc);
+        return ESP_FAIL;
+    }
+    return ESP_OK;
+}
+
+bool ble_rowing_due(int64_t now_us)
+{
+    if (atomic_load_explicit(&s_listeners, memory_order_relaxed) <= 0) return false;
+    if (now_us - s_last_publish_us < (int64_t)atomic_load_explicit(&s_period_us, memory_order_relaxed)) return false;
+
+    s_last_publish_us = now_us;
+    return true;
+}
+
+void ble_rowing_publish(const ble_rowing_sample_t *s)
+{
+    ble_rowing_ring_push(&s_ring, s);
+}
+
+bool ble_rowing_latest(ble_rowing_sample_t *out)
+{
+    uint32_t head = ble_rowing_ring_head(&s_ring);
+    uint32_t cursor = head - 1, first;
+    return head && ble_rowing_ring_read(&s_ring, &cursor, out, 1, &first) == 1;
+}
+
+void ble_rowing_add_listeners(int delta)
+{
+    atomic_fetch_add(&s_listeners, delta);
+}
+
+void ble_rowing_set_rate_hz(uint8_t hz)
+{
+    if (hz < 1) hz = 1;
+    if (hz > BLE_ROWING_MAX_RATE_HZ) hz = BLE_ROWING_MAX_RATE_HZ;
+    atomic_store(&s_period_us, 1000000u / hz);
+    ESP_LOGI(TAG, "Telemetry at %u Hz", (unsigned)hz);
+}
+
+uint8_t ble_rowing_get_rate_hz(void)
+{
+    return (uint8_t)(1000000u / atomic_load(&s_period_us));
+}
+
+int ble_rowing_subscriber_count(void)
+{
+    return atomic_load(&s_subscribers);
+}
+
+void ble_rowing_on_gap_event(const struct ble_gap_event *event)
+{
+    rowing_conn_t *c;
+
+    switch (event->type) {
+    case BLE_GAP_EVENT_CONNECT:
+        if (event->connect.status == 0 && !conn_add(event->connect.conn_handle))
+            ESP_LOGW(TAG, "No slot for connection %d", event->connect.conn_handle);
+        break;
+
+    case BLE_GAP_EVENT_DISCONNECT:
+        c = conn_find(event->disconnect.conn.conn_handle);
+        if (c) {
+            if (c->frames)
+                ESP_LOGI(TAG, "conn %d: %lu frames, %lu samples skipped, %lu busy", c->handle,
+                         (unsigned long)c->frames, (unsigned long)c->skipped, (unsigned long)c->busy);
+            memset(c, 0, sizeof(*c));
+            update_subscribers();
+        }
+        break;
+
+    case BLE_GAP_EVENT_SUBSCRIBE:
+        if (event->subscribe.attr_handle != s_data_handle) break;
+        c = conn_find(event->subscribe.conn_handle);
+        if (!c) c = conn_add(event->subscribe.conn_handle);
+        if (!c) break;
+        if (event->subscribe.cur_notify && !c->subscribed) {
+            c->cursor = ble_rowing_ring_head(&s_ring);      // live data only, no history
+            c->last_tx_us = 0;
+        }
+        c->subscribed = event->subscribe.cur_notify;
+        ble_link_set(c->handle, BLE_LINK_USER_ROWING, c->subscribed ? BLE_LINK_LIVE : BLE_LINK_IDLE);
+        ESP_LOGI(TAG, "conn %d %s (MTU %u, interval %lu us)", c->handle,
+                 c->subscribed ? "subscribed" : "unsubscribed", (unsigned)c->mtu, (unsigned long)c->itvl_us);
+        update_subscribers();
+        break;
+
+    case BLE_GAP_EVENT_MTU:
+        c = conn_find(event->mtu.conn_handle);
+        if (c) c->mtu = event->mtu.value;
+        break;
+
+    case BLE_GAP_EVENT_CONN_UPDATE:
+        c = conn_find(event->conn_update.conn_handle);
+        if (c) conn_refresh_itvl(c);
+        break;
+
+    default:
+        break;
+    }
+}
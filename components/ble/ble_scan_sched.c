@@ -0,0 +1,222 @@
+// components/ble/ble_scan_sched.c
+#include "ble_scan_sched.h"
+
+#include <string.h>
+
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "sdkconfig.h"
+
+#include "host/ble_hs.h"
+#include "nimble/nimble_npl.h"
+#include "nimble/nimble_port.h"
+
+#include "ble_peers.h"
+
+static const char *TAG = "ble_scan";
+
+#ifndef CONFIG_BLE_SCAN_BG_INTERVAL_MS
+#define CONFIG_BLE_SCAN_BG_INTERVAL_MS 1280
+#endif
+#ifndef CONFIG_BLE_SCAN_BG_WINDOW_MS
+#define CONFIG_BLE_SCAN_BG_WINDOW_MS 30
+#endif
+#ifndef CONFIG_BLE_SCAN_BURST_S
+#define CONFIG_BLE_SCAN_BURST_S 10
+#endif
+
+#define SCAN_UNITS(ms)      ((ms) * 1000 / 625)     // interval and window count 0.625 ms
+#define RETRY_MS            1000                    // ble_gap_disc() refused (busy)
+
+typedef struct {
+    uint16_t itvl;
+    uint16_t window;
+    uint8_t  passive;
+    uint8_t  filter_duplicates;
+} scan_params_t;
+
+_Static_assert(CONFIG_BLE_SCAN_BG_WINDOW_MS <= CONFIG_BLE_SCAN_BG_INTERVAL_MS,
+               "the background scan window cannot exceed its interval");
+
+static const scan_params_t k_params[BLE_SCAN_STATE_COUNT] = {
+    [BLE_SCAN_BACKGROUND] = { SCAN_UNITS(CONFIG_BLE_SCAN_BG_INTERVAL_MS), SCAN_UNITS(CONFIG_BLE_SCAN_BG_WINDOW_MS), 0, 1 },
+    [BLE_SCAN_BURST] = { SCAN_UNITS(60), SCAN_UNITS(60), 0, 1 },
+    // Boats' data is all in the advert, and every advert is wanted (ble_boats.h)
+    [BLE_SCAN_OBSERVE] = { SCAN_UNITS(100), SCAN_UNITS(90), 1, 0 },
+};
+
+static int (*s_cb)(struct ble_gap_event *event, void *arg);
+static uint8_t s_own_addr_type;
+static bool s_synced;
+static bool s_background;
+static bool s_observing;
+static int64_t s_burst_until_us;
+static int s_conns;
+static struct ble_npl_callout s_timer;
+
+// Stats are read from other tasks
+static ble_scan_stats_t s_stats;
+static int64_t s_since_us;
+static portMUX_TYPE s_lock = portMUX_INITIALIZER_UNLOCKED;
+
+const char *ble_scan_state_name(ble_scan_state_t state)
+{
+    switch (state) {
+    case BLE_SCAN_OFF: return "off";
+    case BLE_SCAN_BACKGROUND: return "background";
+    case BLE_SCAN_BURST: return "burst";
+    case BLE_SCAN_OBSERVE: return "observe";
+    default: return "?";
+    }
+}
+
+static uint64_t radio_share(ble_scan_state_t state, uint64_t us)
+{
+    if (state == BLE_SCAN_OFF) return 0;
+    return us * k_params[state].window / k_params[state].itvl;
+}
+
+/* Close the current state's time up to `now_us` (under s_lock). */
+static void account(int64_t now_us)
+{
+    const uint64_t d = (uint64_t)(now_us - s_since_us);
+    s_stats.wall_us[s_stats.state] += d;
+    s_stats.radio_us[s_stats.state] += radio_share(s_stats.state, d);
+    s_since_us = now_us;
+}
+
+static ble_scan_state_t wanted(int64_t now_us)
+{
+    // Initiating a connection and scanning do not run together
+    if (!s_synced || ble_gap_conn_active()) return BLE_SCAN_OFF;
+    if (s_observing) return BLE_SCAN_OBSERVE;
+    if (now_us < s_burst_until_us) return BLE_SCAN_BURST;
+    if (!s_background || s_conns > 0 || ble_gap_adv_active()) return BLE_SCAN_OFF;
+
+    // Known sensors are reconnected to through the accept list, not searched for
+    if (ble_peers_count() > 0) return BLE_SCAN_OFF;
+    return BLE_SCAN_BACKGROUND;
+}
+
+static void apply(void)
+{
+    const int64_t now_us = esp_timer_get_time();
+    const ble_scan_state_t from = s_stats.state;
+    const ble_scan_state_t want = wanted(now_us);
+
+    if (want == from && (want == BLE_SCAN_OFF || ble_gap_disc_active())) return;
+
+    if (ble_gap_disc_active()) ble_gap_disc_cancel();
+    ble_scan_state_t now_state = BLE_SCAN_OFF;
+    if (want != BLE_SCAN_OFF) {
+        const scan_params_t *k = &k_params[want];
+        struct ble_gap_disc_params params;
+        memset(&params, 0, sizeof(params));
+        params.itvl = k->itvl;
+        params.window = k->window;
+        params.passive = k->passive;
+        params.filter_duplicates = k->filter_duplicates;
+
+        int rc = ble_gap_disc(s_own_addr_type, BLE_HS_FOREVER, &params, s_cb, NULL);
+        if (rc == 0) {
+            now_state = want;
+        } else {
+            ESP_LOGW(TAG, "Cannot start %s scan; rc=%d", ble_scan_state_name(want), rc);
+            ble_npl_callout_reset(&s_timer, ble_npl_time_ms_to_ticks32(RETRY_MS));
+        }
+    }
+
+    taskENTER_CRITICAL(&s_lock);
+    account(now_us);
+    s_stats.state = now_state;
+    if (now_state != BLE_SCAN_OFF) s_stats.starts++;
+    taskEXIT_CRITICAL(&s_lock);
+
+    if (now_state == BLE_SCAN_BURST) {
+        ble_npl_callout_reset(&s_timer, ble_npl_time_ms_to_ticks32((uint32_t)((s_burst_until_us - now_us) / 1000) + 1));
+    }
+
+    if (now_state != from) {
+        uint64_t wall = 0, radio = 0;
+        for (int i = BLE_SCAN_BACKGROUND; i < BLE_SCAN_STATE_COUNT; i++) {
+            wall += s_stats.wall_us[i];
+            radio += s_stats.radio_us[i];
+        }
+        ESP_LOGI(TAG, "Scan %s -> %s; radio %.1f s of %.1f s scanning, %.1f%% of uptime",
+                 ble_scan_state_name(from), ble_scan_state_name(now_state), radio / 1e6, wall / 1e6,
+                 now_us > 0 ? 100.0 * (double)radio / (double)now_us : 0.0);
+    }
+}
+
+static void timer_tick(struct ble_npl_event *ev)
+{
+    (void)ev;
+    apply();
+}
+
+void ble_scan_sched_on_sync(uint8_t own_addr_type)
+{
+    s_own_addr_type = own_addr_type;
+    s_synced = true;
+    apply();
+}
+
+void ble_scan_sched_set_background(bool on)
+{
+    s_background = on;
+    if (!on) s_burst_until_us = 0;
+    apply();
+}
+
+void ble_scan_sched_burst(void)
+{
+    s_burst_until_us = esp_timer_get_time() + (int64_t)CONFIG_BLE_SCAN_BURST_S * 1000000;
+    apply();
+}
+
+void ble_scan_sched_set_observing(bool on)
+{
+    s_observing = on;
+    apply();
+}
+
+void ble_scan_sched_update(void)
+{
+    apply();
+}
+
+void ble_scan_sched_on_gap_event(const struct ble_gap_event *event)
+{
+    switch (event->type) {
+    case BLE_GAP_EVENT_CONNECT:
+        if (event->connect.status == 0) s_conns++;
+        apply();
+        break;
+    case BLE_GAP_EVENT_DISCONNECT:
+        if (s_conns > 0) s_conns--;
+        apply();
+        break;
+    case BLE_GAP_EVENT_ADV_COMPLETE:
+    case BLE_GAP_EVENT_DISC_COMPLETE:
+        apply();
+        break;
+    default:
+        break;
+    }
+}
+
+void ble_scan_sched_stats(ble_scan_stats_t *out)
+{
+    taskENTER_CRITICAL(&s_lock);
+    account(esp_timer_get_time());
+    *out = s_stats;
+    taskEXIT_CRITICAL(&s_lock);
+}
+
+void ble_scan_sched_init(int (*cb)(struct ble_gap_event *event, void *arg))
+{
+    s_cb = cb;
+    s_since_us = esp_timer_get_time();
+    ble_npl_callout_init(&s_timer, nimble_port_get_dflt_eventq(), timer_tick, NULL);
+}
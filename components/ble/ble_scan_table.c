@@ -0,0 +1,156 @@
+// components/ble/ble_scan_table.c
+#include "ble_scan_table.h"
+
+#include <string.h>
+
+#define SLOT_MASK       (BLE_SCAN_SLOTS - 1)
+#define AD_NAME_SHORT   0x08
+#define AD_NAME_FULL    0x09
+
+_Static_assert((BLE_SCAN_SLOTS & SLOT_MASK) == 0, "BLE_SCAN_SLOTS must be a power of two");
+_Static_assert(BLE_SCAN_SLOTS >= 2 * BLE_MAX_DEVICES, "keep the index at most half full");
+_Static_assert(BLE_MAX_DEVICES < 255, "slots hold the entry index + 1 in a byte");
+
+static uint32_t home(const uint8_t addr[6], uint8_t type)
+{
+    uint32_t lo = (uint32_t)addr[0] | (uint32_t)addr[1] << 8 | (uint32_t)addr[2] << 16 | (uint32_t)addr[3] << 24;
+    uint32_t hi = (uint32_t)addr[4] | (uint32_t)addr[5] << 8 | (uint32_t)type << 16;
+    return (((lo ^ (hi * 0x85EBCA6Bu)) * 0x9E3779B1u) >> 16) & SLOT_MASK;
+}
+
+/* The device name in raw advertising data, if any. */
+static const uint8_t *find_name(const uint8_t *data, size_t len, size_t *name_len)
+{
+    size_t i = 0;
+    while (i + 1 < len) {
+        size_t n = data[i];
+        if (n == 0 || i + 1 + n > len) return NULL;
+        if (data[i + 1] == AD_NAME_FULL || data[i + 1] == AD_NAME_SHORT) {
+            *name_len = n - 1;
+            return data + i + 2;
+        }
+        i += 1 + n;
+    }
+    return NULL;
+}
+
+/* Take slot `i` out of the index, moving later entries of the run back so
+ * that every key stays reachable from its home slot. */
+static void slot_remove(ble_scan_table_t *t, uint32_t i)
+{
+    uint32_t j = i;
+    for (;;) {
+        j = (j + 1) & SLOT_MASK;
+        if (!t->slots[j]) break;
+        const ble_device_t *d = &t->e[t->slots[j] - 1].dev;
+        uint32_t k = home(d->addr, d->addr_type);
+        // Movable unless its home lies cyclically in (i, j]
+        if (((j - k) & SLOT_MASK) >= ((j - i) & SLOT_MASK)) {
+            t->slots[i] = t->slots[j];
+            i = j;
+        }
+    }
+    t->slots[i] = 0;
+}
+
+/* The least recently heard entry makes way. */
+static int evict(ble_scan_table_t *t)
+{
+    int oldest = 0;
+    for (int i = 1; i < BLE_MAX_DEVICES; i++) {
+        if (t->e[i].last_us < t->e[oldest].last_us) oldest = i;
+    }
+    const ble_device_t *d = &t->e[oldest].dev;
+    uint32_t s = home(d->addr, d->addr_type);
+    while (t->slots[s] != oldest + 1) s = (s + 1) & SLOT_MASK;
+    slot_remove(t, s);
+    t->evictions++;
+    return oldest;
+}
+
+static void set_name(ble_scan_table_t *t, ble_scan_entry_t *e, const uint8_t *name, size_t len)
+{
+    if (len >= BLE_NAME_MAX_LEN) len = BLE_NAME_MAX_LEN - 1;
+    if (strncmp(e->dev.name, (const char *)name, len) == 0 && e->dev.name[len] == '\0') return;
+    memcpy(e->dev.name, name, len);
+    e->dev.name[len] = '\0';
+    t->dirty = true;
+}
+
+void ble_scan_table_clear(ble_scan_table_t *t)
+{
+    memset(t, 0, sizeof(*t));
+    t->dirty = true;
+}
+
+bool ble_scan_table_feed(ble_scan_table_t *t, const uint8_t addr[6], uint8_t addr_type, int8_t rssi,
+                         const uint8_t *data, size_t len, int64_t now_us)
+{
+    t->reports++;
+
+    uint32_t s = home(addr, addr_type);
+    ble_scan_entry_t *e = NULL;
+    while (t->slots[s]) {
+        ble_scan_entry_t *c = &t->e[t->slots[s] - 1];
+        if (c->dev.addr_type == addr_type && memcmp(c->dev.addr, addr, 6) == 0) {
+            e = c;
+            break;
+        }
+        s = (s + 1) & SLOT_MASK;
+    }
+
+    size_t name_len = 0;
+    const uint8_t *name = find_name(data, len, &name_len);
+
+    if (e) {
+        e->last_us = now_us;
+        e->reports++;
+        e->rssi_q4 += (int16_t)((rssi * 16 - e->rssi_q4) / 4);
+        int shown = e->rssi_q4 / 16;
+        if (shown - e->dev.rssi >= BLE_SCAN_RSSI_REDRAW_DB || e->dev.rssi - shown >= BLE_SCAN_RSSI_REDRAW_DB) {
+            e->dev.rssi = (int8_t)shown;
+            t->dirty = true;
+        }
+        if (name && name_len) set_name(t, e, name, name_len);
+        return false;
+    }
+
+    int idx;
+    if (t->count < BLE_MAX_DEVICES) {
+        idx = t->count++;
+    } else {
+        idx = evict(t);
+        // The removal may have shifted the run this key probes: find its empty slot again
+        s = home(addr, addr_type);
+        while (t->slots[s]) s = (s + 1) & SLOT_MASK;
+    }
+    t->slots[s] = (uint8_t)(idx + 1);
+
+    e = &t->e[idx];
+    memset(e, 0, sizeof(*e));
+    e->used = true;
+    memcpy(e->dev.addr, addr, 6);
+    e->dev.addr_type = addr_type;
+    e->dev.rssi = rssi;
+    e->rssi_q4 = (int16_t)(rssi * 16);
+    e->last_us = now_us;
+    e->reports = 1;
+    if (name && name_len) set_name(t, e, name, name_len);
+    else strcpy(e->dev.name, "Unknown");
+    t->dirty = true;
+    return true;
+}
+
+bool ble_scan_table_take_dirty(ble_scan_table_t *t)
+{
+    bool d = t->dirty;
+    t->dirty = false;
+    return d;
+}
+
+bool ble_scan_table_get(const ble_scan_table_t *t, int index, ble_device_t *out)
+{
+    if (index < 0 || index >= t->count || !t->e[index].used) return false;
+    *out = t->e[index].dev;
+    return true;
+}
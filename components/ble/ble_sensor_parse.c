@@ -0,0 +1,85 @@
+// components/ble/ble_sensor_parse.c
+#include "ble_sensor_parse.h"
+
+#include <string.h>
+
+#define HR_F_U16        (1u << 0)
+#define HR_F_CONTACT    (3u << 1)   // supported and detected
+#define HR_F_NO_CONTACT (2u << 1)   // supported, not detected
+#define HR_F_ENERGY     (1u << 3)
+#define HR_F_RR         (1u << 4)
+
+#define CP_F_BALANCE    (1u << 0)
+#define CP_F_TORQUE     (1u << 2)
+#define CP_F_WHEEL      (1u << 4)
+#define CP_F_CRANK      (1u << 5)
+
+static bool rd_u8(ble_sensor_rd_t *rd, uint8_t *v)
+{
+    while (rd->left == 0) {
+        if (!rd->next || !rd->next(&rd->seg, &rd->p, &rd->left)) return false;
+    }
+    *v = *rd->p++;
+    rd->left--;
+    return true;
+}
+
+static bool rd_u16(ble_sensor_rd_t *rd, uint16_t *v)
+{
+    uint8_t lo, hi;
+    if (!rd_u8(rd, &lo) || !rd_u8(rd, &hi)) return false;
+    *v = (uint16_t)(lo | hi << 8);
+    return true;
+}
+
+static bool rd_skip(ble_sensor_rd_t *rd, int n)
+{
+    uint8_t b;
+    while (n-- > 0) {
+        if (!rd_u8(rd, &b)) return false;
+    }
+    return true;
+}
+
+bool ble_hr_meas_parse(ble_sensor_rd_t *rd, ble_hr_meas_t *out)
+{
+    memset(out, 0, sizeof(*out));
+
+    uint8_t flags;
+    if (!rd_u8(rd, &flags)) return false;
+    if (flags & HR_F_U16) {
+        if (!rd_u16(rd, &out->bpm)) return false;
+    } else {
+        uint8_t b;
+        if (!rd_u8(rd, &b)) return false;
+        out->bpm = b;
+    }
+    out->contact = (flags & HR_F_CONTACT) != HR_F_NO_CONTACT;
+
+    if ((flags & HR_F_ENERGY) && !rd_skip(rd, 2)) return false;
+    if (flags & HR_F_RR) {
+        uint16_t rr;
+        while (rd_u16(rd, &rr)) {
+            out->rr_last = rr;
+            out->rr_count++;
+        }
+    }
+    return true;
+}
+
+bool ble_cp_meas_parse(ble_sensor_rd_t *rd, ble_cp_meas_t *out)
+{
+    memset(out, 0, sizeof(*out));
+
+    uint16_t flags, power;
+    if (!rd_u16(rd, &flags) || !rd_u16(rd, &power)) return false;
+    out->power_w = (int16_t)power;
+
+    if (!(flags & CP_F_CRANK)) return true;
+    if ((flags & CP_F_BALANCE) && !rd_skip(rd, 1)) return false;
+    if ((flags & CP_F_TORQUE) && !rd_skip(rd, 2)) return false;
+    if ((flags & CP_F_WHEEL) && !rd_skip(rd, 6)) return false;
+    if (!rd_u16(rd, &out->crank_revs) || !rd_u16(rd, &out->crank_time)) return false;
+    out->has_crank = true;
+    return true;
+}
@@ -0,0 +1,252 @@
+// components/ble/ble_sensors.c
+#include "ble_sensors.h"
+
+#include <string.h>
+
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+
+#include "host/ble_hs.h"
+
+#include "ble_link.h"
+#include "ble_peers.h"
+#include "ble_sensor_parse.h"
+
+static const char *TAG = "ble_sensors";
+
+#define UUID_CCCD   0x2902
+
+/* One measurement characteristic to find and subscribe to */
+typedef struct {
+    const char *name;
+    uint16_t svc_uuid;
+    uint16_t chr_uuid;
+    uint16_t start, end;            // service handle range, 0 = not on this peer
+    uint16_t val_handle;
+    uint16_t cccd;
+} sensor_chr_t;
+
+static uint16_t s_conn = BLE_HS_CONN_HANDLE_NONE;
+static sensor_chr_t s_chr[BLE_SENSOR_COUNT];
+static uint8_t s_seen;              // kinds measured on this connection
+static int64_t s_conn_us;           // connected at (esp_timer time)
+
+static const sensor_chr_t k_chr[BLE_SENSOR_COUNT] = {
+    [BLE_SENSOR_HR] = { .name = "heart rate", .svc_uuid = 0x180D, .chr_uuid = 0x2A37 },
+    [BLE_SENSOR_POWER] = { .name = "cycling power", .svc_uuid = 0x1818, .chr_uuid = 0x2A63 },
+};
+
+// Written on the host task, read by stroke_task
+static ble_sensor_reading_t s_latest[BLE_SENSOR_COUNT];
+static portMUX_TYPE s_lock = portMUX_INITIALIZER_UNLOCKED;
+
+static void setup_next(int i);
+
+/* Discovery and subscription are over (whatever they found): the short
+ * BULK interval has done its job, LIVE carries the measurements. */
+static void setup_done(void)
+{
+    uint8_t subscribed = 0;
+    for (int i = 0; i < BLE_SENSOR_COUNT; i++) {
+        if (s_chr[i].val_handle) subscribed |= 1u << i;
+    }
+    ESP_LOGI(TAG, "Sensor setup done %lld ms after connecting; heart rate %s, power %s",
+             (long long)((esp_timer_get_time() - s_conn_us) / 1000),
+             (subscribed & (1u << BLE_SENSOR_HR)) ? "subscribed" : "none",
+             (subscribed & (1u << BLE_SENSOR_POWER)) ? "subscribed" : "none");
+    ble_link_set(s_conn, BLE_LINK_USER_CENTRAL, BLE_LINK_LIVE);
+}
+
+/* -------------------------------------------------------------------------- */
+/* Discovery: services, then per sensor its characteristic and CCCD          */
+/* -------------------------------------------------------------------------- */
+
+static int on_subscribed(uint16_t conn, const struct ble_gatt_error *error, struct ble_gatt_attr *attr, void *arg)
+{
+    (void)attr;
+    const int i = (int)(intptr_t)arg;
+    if (conn != s_conn) return 0;
+    if (error->status == 0) {
+        ESP_LOGI(TAG, "Subscribed to %s", s_chr[i].name);
+        // Found straight away next boot (ble_peers.h)
+        struct ble_gap_conn_desc desc;
+        if (ble_gap_conn_find(conn, &desc) == 0) {
+            ble_peers_remember(desc.peer_id_addr.val, desc.peer_id_addr.type, (ble_sensor_kind_t)i);
+        }
+    } else {
+        ESP_LOGW(TAG, "Subscribing to %s failed; status=%d", s_chr[i].name, error->status);
+        s_chr[i].val_handle = 0;
+    }
+    setup_next(i + 1);
+    return 0;
+}
+
+static int on_dsc(uint16_t conn, const struct ble_gatt_error *error, uint16_t chr_val_handle,
+                  const struct ble_gatt_dsc *dsc, void *arg)
+{
+    (void)chr_val_handle;
+    const int i = (int)(intptr_t)arg;
+    if (conn != s_conn) return 0;
+    sensor_chr_t *c = &s_chr[i];
+
+    if (error->status == 0) {
+        if (!c->cccd && ble_uuid_u16(&dsc->uuid.u) == UUID_CCCD) c->cccd = dsc->handle;
+        return 0;
+    }
+    if (error->status == BLE_HS_EDONE && c->cccd) {
+        static const uint8_t notify_on[2] = { 0x01, 0x00 };
+        if (ble_gattc_write_flat(conn, c->cccd, notify_on, sizeof(notify_on), on_subscribed, arg) == 0) return 0;
+    }
+    c->val_handle = 0;
+    setup_next(i + 1);
+    return 0;
+}
+
+static int on_chr(uint16_t conn, const struct ble_gatt_error *error, const struct ble_gatt_chr *chr, void *arg)
+{
+    const int i = (int)(intptr_t)arg;
+    if (conn != s_conn) return 0;
+    sensor_chr_t *c = &s_chr[i];
+
+    if (error->status == 0) {
+        if (!c->val_handle && (chr->properties & BLE_GATT_CHR_PROP_NOTIFY)) c->val_handle = chr->val_handle;
+        return 0;
+    }
+    // The CCCD sits between the value and the end of the service
+    if (error->status == BLE_HS_EDONE && c->val_handle &&
+        ble_gattc_disc_all_dscs(conn, c->val_handle, c->end, on_dsc, arg) == 0)
+        return 0;
+    c->val_handle = 0;
+    setup_next(i + 1);
+    return 0;
+}
+
+static int on_svc(uint16_t conn, const struct ble_gatt_error *error, const struct ble_gatt_svc *svc, void *arg)
+{
+    (void)arg;
+    if (conn != s_conn) return 0;
+
+    if (error->status == 0) {
+        const uint16_t uuid = ble_uuid_u16(&svc->uuid.u);
+        for (int i = 0; i < BLE_SENSOR_COUNT; i++) {
+            if (uuid == s_chr[i].svc_uuid) {
+                s_chr[i].start = svc->start_handle;
+                s_chr[i].end = svc->end_handle;
+            }
+        }
+        return 0;
+    }
+    if (error->status != BLE_HS_EDONE) {
+        ESP_LOGW(TAG, "Service discovery failed; status=%d", error->status);
+        setup_done();
+        return 0;
+    }
+    setup_next(0);
+    return 0;
+}
+
+/* Set up sensor `i` or the next one the peer has. */
+static void setup_next(int i)
+{
+    for (; i < BLE_SENSOR_COUNT; i++) {
+        sensor_chr_t *c = &s_chr[i];
+        if (!c->start) continue;
+        const ble_uuid16_t uuid = BLE_UUID16_INIT(c->chr_uuid);
+        if (ble_gattc_disc_chrs_by_uuid(s_conn, c->start, c->end, &uuid.u, on_chr, (void *)(intptr_t)i) == 0) return;
+        ESP_LOGW(TAG, "Cannot discover %s", c->name);
+    }
+    setup_done();
+}
+
+/* -------------------------------------------------------------------------- */
+/* Notifications                                                              */
+/* -------------------------------------------------------------------------- */
+
+static bool mbuf_next(const void **seg, const uint8_t **p, uint16_t *len)
+{
+    const struct os_mbuf *om = SLIST_NEXT((const struct os_mbuf *)*seg, om_next);
+    if (!om) return false;
+    *seg = om;
+    *p = om->om_data;
+    *len = om->om_len;
+    return true;
+}
+
+static void publish(ble_sensor_kind_t kind, float value, int64_t t_us)
+{
+    taskENTER_CRITICAL(&s_lock);
+    s_latest[kind] = (ble_sensor_reading_t){ .value = value, .t_us = t_us };
+    taskEXIT_CRITICAL(&s_lock);
+
+    if (!(s_seen & (1u << kind))) {
+        s_seen |= 1u << kind;
+        ble_peers_on_ready(kind);
+    }
+}
+
+bool ble_sensors_on_notify(const struct ble_gap_event *event)
+{
+    const uint16_t handle = event->notify_rx.attr_handle;
+    if (event->notify_rx.conn_handle != s_conn || !handle) return false;
+
+    const struct os_mbuf *om = event->notify_rx.om;
+    if (!om) return false;
+    ble_sensor_rd_t rd = { .seg = om, .p = om->om_data, .left = om->om_len, .next = mbuf_next };
+    const int64_t now_us = esp_timer_get_time();
+
+    if (handle == s_chr[BLE_SENSOR_HR].val_handle) {
+        ble_hr_meas_t m;
+        if (ble_hr_meas_parse(&rd, &m) && m.contact && m.bpm) publish(BLE_SENSOR_HR, m.bpm, now_us);
+        return true;
+    }
+    if (handle == s_chr[BLE_SENSOR_POWER].val_handle) {
+        ble_cp_meas_t m;
+        if (ble_cp_meas_parse(&rd, &m)) publish(BLE_SENSOR_POWER, m.power_w, now_us);
+        return true;
+    }
+    return false;
+}
+
+bool ble_sensors_latest(ble_sensor_kind_t kind, int64_t max_age_us, ble_sensor_reading_t *out)
+{
+    if ((unsigned)kind >= BLE_SENSOR_COUNT) return false;
+    taskENTER_CRITICAL(&s_lock);
+    *out = s_latest[kind];
+    taskEXIT_CRITICAL(&s_lock);
+    return out->t_us != 0 && esp_timer_get_time() - out->t_us <= max_age_us;
+}
+
+/* -------------------------------------------------------------------------- */
+/* Connections                                                                */
+/* -------------------------------------------------------------------------- */
+
+void ble_sensors_on_gap_event(const struct ble_gap_event *event)
+{
+    switch (event->type) {
+    case BLE_GAP_EVENT_CONNECT: {
+        struct ble_gap_conn_desc desc;
+        if (event->connect.status != 0 || ble_gap_conn_find(event->connect.conn_handle, &desc) != 0 ||
+            desc.role != BLE_GAP_ROLE_MASTER)
+            break;
+        s_conn = event->connect.conn_handle;
+        s_conn_us = esp_timer_get_time();
+        memcpy(s_chr, k_chr, sizeof(s_chr));
+        s_seen = 0;
+        // Discovery and subscription take a round trip each: run them at the short interval
+        ble_link_set(s_conn, BLE_LINK_USER_CENTRAL, BLE_LINK_BULK);
+        int rc = ble_gattc_disc_all_svcs(s_conn, on_svc, NULL);
+        if (rc != 0) {
+            ESP_LOGW(TAG, "Service discovery did not start; rc=%d", rc);
+            setup_done();
+        }
+        break;
+    }
+    case BLE_GAP_EVENT_DISCONNECT:
+        // Readings stay and age out (ble_sensors_latest)
+        if (event->disconnect.conn.conn_handle == s_conn) s_conn = BLE_HS_CONN_HANDLE_NONE;
+        break;
+    default:
+        break;
+    }
+}
@@ -0,0 +1,276 @@
+// components/ble/ble_xfer_proto.c
+#include "ble_xfer_proto.h"
+
+#include <string.h>
+
+static uint8_t *put_le(uint8_t *p, uint32_t v, int bytes)
+{
+    for (int i = 0; i < bytes; i++) *p++ = (uint8_t)(v >> (8 * i));
+    return p;
+}
+
+static uint32_t get_le(const uint8_t *p, int bytes)
+{
+    uint32_t v = 0;
+    for (int i = 0; i < bytes; i++) v |= (uint32_t)p[i] << (8 * i);
+    return v;
+}
+
+/* -------------------------------------------------------------------------- */
+/* CRC                                                                        */
+/* -------------------------------------------------------------------------- */
+
+// The log files' CRC-32 (IEEE, reflected), a nibble at a time: 64 bytes of table
+uint32_t ble_xfer_crc32(uint32_t crc, const void *buf, size_t len)
+{
+    static const uint32_t k_tab[16] = {
+        0x00000000, 0x1DB71064, 0x3B6E20C8, 0x26D930AC, 0x76DC4190, 0x6B6B51F4, 0x4DB26158, 0x5005713C,
+        0xEDB88320, 0xF00F9344, 0xD6D6A3E8, 0xCB61B38C, 0x9B64C2B0, 0x86D3D2D4, 0xA00AE278, 0xBDBDF21C,
+    };
+    const uint8_t *p = (const uint8_t *)buf;
+    crc = ~crc;
+    while (len--) {
+        crc ^= *p++;
+        crc = k_tab[crc & 0x0F] ^ (crc >> 4);
+        crc = k_tab[crc & 0x0F] ^ (crc >> 4);
+    }
+    return ~crc;
+}
+
+/* -------------------------------------------------------------------------- */
+/* Messages                                                                   */
+/* -------------------------------------------------------------------------- */
+
+size_t ble_xfer_req_encode(const ble_xfer_req_t *r, uint8_t *out)
+{
+    uint8_t *p = out;
+    *p++ = r->op;
+    switch (r->op) {
+    case BLE_XFER_OP_LIST:
+        p = put_le(p, r->first, 2);
+        *p++ = r->max;
+        break;
+    case BLE_XFER_OP_OPEN:
+        p = put_le(p, r->id, 4);
+        *p++ = r->file;
+        p = put_le(p, r->offset, 4);
+        p = put_le(p, r->window, 2);
+        break;
+    case BLE_XFER_OP_ACK:
+    case BLE_XFER_OP_REWIND:
+        p = put_le(p, r->offset, 4);
+        break;
+    default:
+        break;
+    }
+    return (size_t)(p - out);
+}
+
+bool ble_xfer_req_parse(const uint8_t *buf, size_t len, ble_xfer_req_t *out)
+{
+    if (len < 1) return false;
+    memset(out, 0, sizeof(*out));
+    out->op = buf[0];
+
+    switch (out->op) {
+    case BLE_XFER_OP_LIST:
+        if (len != 4) return false;
+        out->first = (uint16_t)get_le(buf + 1, 2);
+        out->max = buf[3];
+        return true;
+    case BLE_XFER_OP_OPEN:
+        if (len != 12) return false;
+        out->id = get_le(buf + 1, 4);
+        out->file = buf[5];
+        out->offset = get_le(buf + 6, 4);
+        out->window = (uint16_t)get_le(buf + 10, 2);
+        return out->file < BLE_XFER_FILE_COUNT;
+    case BLE_XFER_OP_ACK:
+    case BLE_XFER_OP_REWIND:
+        if (len != 5) return false;
+        out->offset = get_le(buf + 1, 4);
+        return true;
+    case BLE_XFER_OP_CLOSE:
+        return len == 1;
+    default:
+        return false;
+    }
+}
+
+size_t ble_xfer_list_entry_encode(uint16_t index, const ble_xfer_session_t *s, uint8_t *out)
+{
+    float dm = s->distance_m * 10.0f + 0.5f;
+    uint8_t *p = out;
+    *p++ = BLE_XFER_OP_LIST_ENTRY;
+    p = put_le(p, index, 2);
+    p = put_le(p, s->id, 4);
+    p = put_le(p, (uint32_t)(s->start_utc_us / 1000000), 4);
+    p = put_le(p, s->duration_ms, 4);
+    p = put_le(p, (dm > 0.0f && dm < 4.0e9f) ? (uint32_t)dm : 0, 4);
+    return (size_t)(p - out);
+}
+
+size_t ble_xfer_list_end_encode(uint16_t count, uint8_t *out)
+{
+    out[0] = BLE_XFER_OP_LIST_END;
+    put_le(out + 1, count, 2);
+    return 3;
+}
+
+size_t ble_xfer_open_rsp_encode(ble_xfer_status_t st, uint32_t size, uint32_t offset, uint16_t chunk, uint8_t *out)
+{
+    uint8_t *p = out;
+    *p++ = BLE_XFER_OP_OPEN_RSP;
+    *p++ = (uint8_t)st;
+    p = put_le(p, size, 4);
+    p = put_le(p, offset, 4);
+    p = put_le(p, chunk, 2);
+    return (size_t)(p - out);
+}
+
+size_t ble_xfer_end_encode(ble_xfer_status_t st, uint32_t acked, uint8_t *out)
+{
+    out[0] = BLE_XFER_OP_END;
+    out[1] = (uint8_t)st;
+    put_le(out + 2, acked, 4);
+    return 6;
+}
+
+/* -------------------------------------------------------------------------- */
+/* Chunks                                                                     */
+/* -------------------------------------------------------------------------- */
+
+uint16_t ble_xfer_chunk_max(uint16_t mtu)
+{
+    if (mtu <= 3 + BLE_XFER_CHUNK_OVERHEAD) return 0;
+    uint16_t n = (uint16_t)(mtu - 3 - BLE_XFER_CHUNK_OVERHEAD);
+    return (n > BLE_XFER_MAX_CHUNK) ? BLE_XFER_MAX_CHUNK : n;
+}
+
+size_t ble_xfer_chunk_seal(uint8_t *out, uint32_t offset, size_t len)
+{
+    put_le(out, offset, 4);
+    put_le(out + 4 + len, ble_xfer_crc32(0, out, 4 + len), 4);
+    return len + BLE_XFER_CHUNK_OVERHEAD;
+}
+
+int ble_xfer_chunk_open(const uint8_t *buf, size_t len, uint32_t *offset, const uint8_t **payload)
+{
+    if (len <= BLE_XFER_CHUNK_OVERHEAD) return -1;
+    size_t n = len - BLE_XFER_CHUNK_OVERHEAD;
+    if (get_le(buf + 4 + n, 4) != ble_xfer_crc32(0, buf, 4 + n)) return -1;
+
+    *offset = get_le(buf, 4);
+    *payload = buf + 4;
+    return (int)n;
+}
+
+/* -------------------------------------------------------------------------- */
+/* Sender                                                                     */
+/* -------------------------------------------------------------------------- */
+
+void ble_xfer_tx_start(ble_xfer_tx_t *t, uint32_t size, uint32_t offset, uint16_t chunk, uint32_t window)
+{
+    memset(t, 0, sizeof(*t));
+    t->size = size;
+    t->next = t->acked = (offset < size) ? offset : size;
+    t->chunk = chunk ? chunk : 1;
+    t->window = window ? window : BLE_XFER_DEFAULT_WINDOW;
+}
+
+uint16_t ble_xfer_tx_next(const ble_xfer_tx_t *t, uint32_t *offset)
+{
+    if (t->next >= t->size) return 0;
+
+    uint32_t left = t->size - t->next;
+    uint16_t len = (left < t->chunk) ? (uint16_t)left : t->chunk;
+    // One chunk always goes, whatever the window, so a small one cannot stall
+    uint32_t in_flight = t->next - t->acked;
+    if (in_flight > 0 && in_flight + len > t->window) return 0;
+
+    *offset = t->next;
+    return len;
+}
+
+void ble_xfer_tx_sent(ble_xfer_tx_t *t, uint16_t len)
+{
+    t->next += len;
+}
+
+void ble_xfer_tx_ack(ble_xfer_tx_t *t, uint32_t offset)
+{
+    if (offset > t->acked && offset <= t->next) t->acked = offset;
+}
+
+void ble_xfer_tx_rewind(ble_xfer_tx_t *t, uint32_t offset)
+{
+    if (offset < t->acked || offset > t->next) return;
+    t->acked = t->next = offset;
+    t->rewinds++;
+}
+
+bool ble_xfer_tx_done(const ble_xfer_tx_t *t)
+{
+    return t->acked >= t->size;
+}
+
+/* -------------------------------------------------------------------------- */
+/* Receiver                                                                   */
+/* -------------------------------------------------------------------------- */
+
+void ble_xfer_rx_start(ble_xfer_rx_t *r, uint32_t size, uint32_t offset, uint32_t window)
+{
+    memset(r, 0, sizeof(*r));
+    r->size = size;
+    r->next = r->acked = offset;
+    if (!window) window = BLE_XFER_DEFAULT_WINDOW;
+    r->ack_every = (window / 2) ? window / 2 : 1;
+}
+
+ble_xfer_rx_result_t ble_xfer_rx_chunk(ble_xfer_rx_t *r, const uint8_t *buf, size_t len,
+                                        const uint8_t **payload, uint16_t *payload_len)
+{
+    uint32_t off;
+    int n = ble_xfer_chunk_open(buf, len, &off, payload);
+    if (n < 0) {
+        // Its offset cannot be trusted either: always ask again from what we have
+        r->bad++;
+        r->rewind_due = true;
+        return BLE_XFER_RX_BAD;
+    }
+
+    if (off != r->next || off + (uint32_t)n > r->size) {
+        // Already had it, or a chunk went missing before it: one REWIND per loss,
+        // the rest of the window in flight is dropped until the resend arrives
+        r->dropped++;
+        if (off > r->next && !r->rewind_sent) r->rewind_due = true;
+        return BLE_XFER_RX_DROP;
+    }
+
+    r->next += (uint32_t)n;
+    r->rewind_sent = false;
+    *payload_len = (uint16_t)n;
+    return BLE_XFER_RX_DATA;
+}
+
+size_t ble_xfer_rx_reply(ble_xfer_rx_t *r, uint8_t *out)
+{
+    ble_xfer_req_t q = { .offset = r->next };
+
+    if (r->rewind_due) {
+        r->rewind_due = false;
+        r->rewind_sent = true;
+        q.op = BLE_XFER_OP_REWIND;
+    } else if (r->next - r->acked >= r->ack_every || (r->next >= r->size && r->acked < r->size)) {
+        q.op = BLE_XFER_OP_ACK;
+    } else {
+        return 0;
+    }
+    r->acked = r->next;
+    return ble_xfer_req_encode(&q, out);
+}
+
+bool ble_xfer_rx_done(const ble_xfer_rx_t *r)
+{
+    return r->next >= r->size;
+}
@@ -0,0 +1,338 @@
+// components/ble/ble_xfer_svc.c
+#include "ble_xfer.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "sdkconfig.h"
+
+#include "host/ble_hs.h"
+#include "nimble/nimble_npl.h"
+#include "nimble/nimble_port.h"
+
+#include "ble_link.h"
+
+static const char *TAG = "ble_xfer";
+
+#ifndef CONFIG_BLE_XFER_READ_BUF_KB
+#define CONFIG_BLE_XFER_READ_BUF_KB 8
+#endif
+
+#define LIST_MAX            32          // entries per LIST request
+#define RETRY_MS            10          // a refused notify with nothing in flight to complete
+#define PATH_MAX_LEN        160
+
+/* f7b0001x-5d2c-4c1e-8a5b-2f6e9d3c1a40: 0 service, 1 control, 2 data (next to the rowing service) */
+#define XFER_UUID(n) \
+    BLE_UUID128_INIT(0x40, 0x1a, 0x3c, 0x9d, 0x6e, 0x2f, 0x5b, 0x8a, 0x1e, 0x4c, 0x2c, 0x5d, n, 0x00, 0xb0, 0xf7)
+
+static const ble_uuid128_t k_svc_uuid = XFER_UUID(0x10);
+static const ble_uuid128_t k_ctrl_uuid = XFER_UUID(0x11);
+static const ble_uuid128_t k_data_uuid = XFER_UUID(0x12);
+
+typedef struct {
+    bool     active;
+    uint16_t conn;
+    FILE    *f;
+    char    *iobuf;
+    uint32_t pos;               // file position after the last read
+    ble_xfer_tx_t tx;
+    uint32_t pend_off;          // chunk read and sealed but refused by the stack
+    uint16_t pend_len;
+    int64_t  start_us;
+    uint32_t start_off;
+    uint32_t chunks;
+    uint32_t busy;
+} xfer_t;
+
+// Host task only
+static xfer_t s_x;
+
+static const ble_xfer_source_t *s_src;
+static uint16_t s_ctrl_handle;
+static uint16_t s_data_handle;
+static struct ble_npl_callout s_retry_timer;
+static uint8_t s_chunk[BLE_XFER_MAX_CHUNK + BLE_XFER_CHUNK_OVERHEAD];
+
+static int chr_access(uint16_t conn_handle, uint16_t attr_handle, struct ble_gatt_access_ctxt *ctxt, void *arg);
+
+static const struct ble_gatt_svc_def k_svcs[] = {
+    {
+        .type = BLE_GATT_SVC_TYPE_PRIMARY,
+        .uuid = &k_svc_uuid.u,
+        .characteristics = (struct ble_gatt_chr_def[]){
+            {
+                .uuid = &k_ctrl_uuid.u,
+                .access_cb = chr_access,
+                .flags = BLE_GATT_CHR_F_WRITE | BLE_GATT_CHR_F_WRITE_NO_RSP | BLE_GATT_CHR_F_NOTIFY,
+                .val_handle = &s_ctrl_handle,
+            },
+            {
+                .uuid = &k_data_uuid.u,
+                .access_cb = chr_access,
+                .flags = BLE_GATT_CHR_F_NOTIFY,
+                .val_handle = &s_data_handle,
+            },
+            { 0 },
+        },
+    },
+    { 0 },
+};
+
+static int notify_ctrl(uint16_t conn, const uint8_t *buf, size_t len)
+{
+    struct os_mbuf *om = ble_hs_mbuf_from_flat(buf, len);
+    return om ? ble_gatts_notify_custom(conn, s_ctrl_handle, om) : BLE_HS_ENOMEM;
+}
+
+/* -------------------------------------------------------------------------- */
+/* Transfer                                                                   */
+/* -------------------------------------------------------------------------- */
+
+static void xfer_close(ble_xfer_status_t st, bool tell)
+{
+    if (!s_x.active) return;
+
+    const uint32_t bytes = s_x.tx.acked - s_x.start_off;
+    const int64_t us = esp_timer_get_time() - s_x.start_us;
+    uint8_t tx_phy = 0, rx_phy = 0;
+    ble_gap_read_le_phy(s_x.conn, &tx_phy, &rx_phy);
+    ESP_LOGI(TAG, "conn %d: %lu bytes in %lld ms (%.1f KB/s), %lu chunks, %lu busy, %lu rewinds, "
+             "MTU %u, PHY %uM, status %d",
+             s_x.conn, (unsigned long)bytes, (long long)(us / 1000),
+             us > 0 ? (double)bytes * 1e6 / 1024.0 / (double)us : 0.0, (unsigned long)s_x.chunks,
+             (unsigned long)s_x.busy, (unsigned long)s_x.tx.rewinds, (unsigned)ble_att_mtu(s_x.conn),
+             (unsigned)tx_phy, (int)st);
+
+    if (tell) {
+        uint8_t buf[8];
+        notify_ctrl(s_x.conn, buf, ble_xfer_end_encode(st, s_x.tx.acked, buf));
+    }
+
+    ble_npl_callout_stop(&s_retry_timer);
+    ble_link_set(s_x.conn, BLE_LINK_USER_XFER, BLE_LINK_IDLE);
+    if (s_x.f) fclose(s_x.f);
+    free(s_x.iobuf);
+    memset(&s_x, 0, sizeof(s_x));
+}
+
+/* Send chunks until the window is full or the stack runs out of buffers;
+ * the next notify-complete event (or the retry timer) comes back here. */
+static void xfer_pump(void)
+{
+    while (s_x.active) {
+        uint32_t off;
+        uint16_t len = ble_xfer_tx_next(&s_x.tx, &off);
+        if (len == 0) return;
+
+        if (s_x.pend_len != len || s_x.pend_off != off) {
+            s_x.pend_len = 0;
+            if (s_x.pos != off && fseek(s_x.f, (long)off, SEEK_SET) != 0) {
+                xfer_close(BLE_XFER_ERR_IO, true);
+                return;
+            }
+            if (fread(s_chunk + 4, 1, len, s_x.f) != len) {
+                ESP_LOGE(TAG, "Read failed at %lu", (unsigned long)off);
+                xfer_close(BLE_XFER_ERR_IO, true);
+                return;
+            }
+            s_x.pos = off + len;
+            ble_xfer_chunk_seal(s_chunk, off, len);
+            s_x.pend_off = off;
+            s_x.pend_len = len;
+        }
+
+        struct os_mbuf *om = ble_hs_mbuf_from_flat(s_chunk, len + BLE_XFER_CHUNK_OVERHEAD);
+        if (!om || ble_gatts_notify_custom(s_x.conn, s_data_handle, om) != 0) {
+            s_x.busy++;
+            ble_npl_callout_reset(&s_retry_timer, ble_npl_time_ms_to_ticks32(RETRY_MS));
+            return;
+        }
+        s_x.pend_len = 0;
+        ble_xfer_tx_sent(&s_x.tx, len);
+        s_x.chunks++;
+    }
+}
+
+static void retry_tick(struct ble_npl_event *ev)
+{
+    (void)ev;
+    xfer_pump();
+}
+
+static ble_xfer_status_t xfer_open(uint16_t conn, const ble_xfer_req_t *q, uint32_t *size)
+{
+    if (s_x.active && s_x.conn != conn) return BLE_XFER_ERR_BUSY;
+    xfer_close(BLE_XFER_OK, false);     // a new OPEN replaces this connection's transfer
+
+    char path[PATH_MAX_LEN];
+    if (!s_src || !s_src->path(q->id, (ble_xfer_file_t)q->file, path, sizeof(path))) return BLE_XFER_ERR_NOT_FOUND;
+
+    FILE *f = fopen(path, "rb");
+    if (!f) return BLE_XFER_ERR_NOT_FOUND;
+
+    // Before any other operation on the stream, or stdio ignores it
+    char *iobuf = malloc(CONFIG_BLE_XFER_READ_BUF_KB * 1024);
+    if (iobuf) setvbuf(f, iobuf, _IOFBF, CONFIG_BLE_XFER_READ_BUF_KB * 1024);
+
+    ble_xfer_status_t st = BLE_XFER_OK;
+    long end = (fseek(f, 0, SEEK_END) == 0) ? ftell(f) : -1;
+    if (end < 0)
+        st = BLE_XFER_ERR_IO;
+    else if (q->offset > (uint32_t)end)
+        st = BLE_XFER_ERR_OFFSET;
+    else if (fseek(f, (long)q->offset, SEEK_SET) != 0)
+        st = BLE_XFER_ERR_IO;
+    if (st != BLE_XFER_OK) {
+        fclose(f);
+        free(iobuf);
+        return st;
+    }
+    *size = (uint32_t)end;
+
+    s_x = (xfer_t){
+        .active = true,
+        .conn = conn,
+        .f = f,
+        .iobuf = iobuf,
+        .pos = q->offset,
+        .start_us = esp_timer_get_time(),
+        .start_off = q->offset,
+    };
+    ble_xfer_tx_start(&s_x.tx, *size, q->offset, ble_xfer_chunk_max(ble_att_mtu(conn)), q->window);
+    ESP_LOGI(TAG, "conn %d: session %lu file %u from %lu of %lu", conn, (unsigned long)q->id,
+             (unsigned)q->file, (unsigned long)q->offset, (unsigned long)*size);
+    return BLE_XFER_OK;
+}
+
+static void list_sessions(uint16_t conn, const ble_xfer_req_t *q)
+{
+    int count = s_src ? s_src->count() : 0;
+    int max = (q->max == 0 || q->max > LIST_MAX) ? LIST_MAX : q->max;
+    uint8_t buf[BLE_XFER_LIST_ENTRY_LEN];
+
+    // Stops early if the stack runs out of buffers; the client asks again from where it got to
+    for (int i = q->first; i < count && i < q->first + max; i++) {
+        ble_xfer_session_t s;
+        if (!s_src->get(i, &s)) break;
+        if (notify_ctrl(conn, buf, ble_xfer_list_entry_encode((uint16_t)i, &s, buf)) != 0) break;
+    }
+    notify_ctrl(conn, buf, ble_xfer_list_end_encode((uint16_t)count, buf));
+}
+
+/* -------------------------------------------------------------------------- */
+/* GATT access                                                                */
+/* -------------------------------------------------------------------------- */
+
+static int chr_access(uint16_t conn_handle, uint16_t attr_handle, struct ble_gatt_access_ctxt *ctxt, void *arg)
+{
+    (void)arg;
+
+    if (attr_handle != s_ctrl_handle || ctxt->op != BLE_GATT_ACCESS_OP_WRITE_CHR) return BLE_ATT_ERR_UNLIKELY;
+
+    uint8_t buf[16];
+    uint16_t len = 0;
+    ble_xfer_req_t q;
+    if (OS_MBUF_PKTLEN(ctxt->om) > sizeof(buf) || ble_hs_mbuf_to_flat(ctxt->om, buf, sizeof(buf), &len) != 0 ||
+        !ble_xfer_req_parse(buf, len, &q))
+        return BLE_ATT_ERR_INVALID_ATTR_VALUE_LEN;
+
+    const bool ours = s_x.active && s_x.conn == conn_handle;
+
+    switch (q.op) {
+    case BLE_XFER_OP_LIST:
+        list_sessions(conn_handle, &q);
+        break;
+
+    case BLE_XFER_OP_OPEN: {
+        uint32_t size = 0;
+        ble_xfer_status_t st = xfer_open(conn_handle, &q, &size);
+        uint8_t rsp[16];
+        notify_ctrl(conn_handle, rsp, ble_xfer_open_rsp_encode(st, size, q.offset, st == BLE_XFER_OK ? s_x.tx.chunk : 0, rsp));
+        if (st != BLE_XFER_OK) break;
+        ble_link_set(conn_handle, BLE_LINK_USER_XFER, BLE_LINK_BULK);
+        if (ble_xfer_tx_done(&s_x.tx))
+            xfer_close(BLE_XFER_OK, true);      // empty file, or opened at its end
+        else
+            xfer_pump();
+        break;
+    }
+
+    case BLE_XFER_OP_ACK:
+    case BLE_XFER_OP_REWIND:
+        if (!ours) break;
+        if (q.op == BLE_XFER_OP_ACK)
+            ble_xfer_tx_ack(&s_x.tx, q.offset);
+        else
+            ble_xfer_tx_rewind(&s_x.tx, q.offset);
+        if (ble_xfer_tx_done(&s_x.tx))
+            xfer_close(BLE_XFER_OK, true);
+        else
+            xfer_pump();
+        break;
+
+    case BLE_XFER_OP_CLOSE:
+        if (ours) xfer_close(BLE_XFER_OK, true);
+        break;
+    }
+    return 0;
+}
+
+/* -------------------------------------------------------------------------- */
+/* Public API                                                                 */
+/* -------------------------------------------------------------------------- */
+
+esp_err_t ble_xfer_init(void)
+{
+    ble_npl_callout_init(&s_retry_timer, nimble_port_get_dflt_eventq(), retry_tick, NULL);
+
+    // Offer the largest MTU; chunks grow with it
+    ble_att_set_preferred_mtu(BLE_ATT_MTU_MAX);
+
+    int rc = ble_gatts_count_cfg(k_svcs);
+    if (rc == 0) rc = ble_gatts_add_svcs(k_svcs);
+    if (rc != 0) {
+        ESP_LOGE(TAG, "Failed to register transfer service; rc=%d", rc);
+        return ESP_FAIL;
+    }
+    return ESP_OK;
+}
+
+void ble_xfer_set_source(const ble_xfer_source_t *src)
+{
+    s_src = src;
+}
+
+bool ble_xfer_active(void)
+{
+    return s_x.active;
+}
+
+void ble_xfer_on_gap_event(const struct ble_gap_event *event)
+{
+    switch (event->type) {
+    case BLE_GAP_EVENT_DISCONNECT:
+        // The client resumes with OPEN at the offset it has
+        if (s_x.active && s_x.conn == event->disconnect.conn.conn_handle) xfer_close(BLE_XFER_ERR_IO, false);
+        break;
+
+    case BLE_GAP_EVENT_MTU:
+        if (s_x.active && s_x.conn == event->mtu.conn_handle) {
+            uint16_t chunk = ble_xfer_chunk_max(event->mtu.value);
+            if (chunk) s_x.tx.chunk = chunk;
+        }
+        break;
+
+    case BLE_GAP_EVENT_NOTIFY_TX:
+        // A notification left: room in the stack's buffers for the next chunk
+        if (s_x.active && event->notify_tx.conn_handle == s_x.conn && event->notify_tx.attr_handle == s_data_handle)
+            xfer_pump();
+        break;
+
+    default:
+        break;
+    }
+}
@@ -0,0 +1,126 @@
+// components/ble/ftms_rower.c
+#include "ftms_rower.h"
+
+#include <math.h>
+#include <string.h>
+
+// Fields this encoder never sends, with their sizes, so the decoder can step over them
+#define F_RESISTANCE    (1u << 7)
+#define F_AVG_POWER     (1u << 6)
+#define F_ENERGY        (1u << 8)
+#define F_HEART_RATE    (1u << 9)
+#define F_MET           (1u << 10)
+#define F_REMAINING     (1u << 12)
+#define F_KNOWN         0x1FFFu
+
+/* x rounded and clamped to [0, max]; NaN and negatives are 0. */
+static uint32_t quant(float x, uint32_t max)
+{
+    float v = x + 0.5f;
+    if (!(v > 0.0f)) return 0;
+    if (v >= (float)max) return max;
+    return (uint32_t)v;
+}
+
+static uint8_t *put_le(uint8_t *p, uint32_t v, int bytes)
+{
+    for (int i = 0; i < bytes; i++) *p++ = (uint8_t)(v >> (8 * i));
+    return p;
+}
+
+static uint32_t get_le(const uint8_t *p, int bytes)
+{
+    uint32_t v = 0;
+    for (int i = 0; i < bytes; i++) v |= (uint32_t)p[i] << (8 * i);
+    return v;
+}
+
+void ftms_rower_enc_reset(ftms_rower_enc_t *e)
+{
+    memset(e, 0, sizeof(*e));
+}
+
+size_t ftms_rower_encode(ftms_rower_enc_t *e, const ftms_rower_values_t *v, uint8_t *out)
+{
+    // On-air values first: a change below the field's resolution is no change
+    const uint8_t spm_half = (uint8_t)quant(v->spm * 2.0f, 0xFF);
+    const uint16_t strokes = (uint16_t)v->stroke_count;
+    const uint32_t distance = quant(v->distance_m, 0xFFFFFF);
+    const uint16_t pace = (uint16_t)quant(v->pace_500m_s, 0xFFFF);
+    const uint16_t avg_pace = (uint16_t)quant(v->avg_pace_500m_s, 0xFFFF);
+    const uint16_t elapsed = (v->elapsed_s > 0xFFFF) ? 0xFFFF : (uint16_t)v->elapsed_s;
+    const bool has_power = isfinite(v->power_w);
+    const int16_t power = !has_power ? 0 : (v->power_w >= 32767.0f) ? 32767 : (int16_t)lrintf(fmaxf(v->power_w, -32768.0f));
+
+    const bool all = !e->primed;
+    uint16_t flags = 0;
+    if (!(all || spm_half != e->spm_half || strokes != e->strokes)) flags |= FTMS_ROWER_F_MORE_DATA;
+    if (all || distance != e->distance_m) flags |= FTMS_ROWER_F_DISTANCE;
+    if (all || pace != e->pace_s) flags |= FTMS_ROWER_F_PACE;
+    if (all || avg_pace != e->avg_pace_s) flags |= FTMS_ROWER_F_AVG_PACE;
+    if (has_power && (all || !(e->present & FTMS_ROWER_F_POWER) || power != e->power_w)) flags |= FTMS_ROWER_F_POWER;
+    if (all || elapsed != e->elapsed_s) flags |= FTMS_ROWER_F_ELAPSED;
+
+    if (flags == FTMS_ROWER_F_MORE_DATA) return 0;
+
+    uint8_t *p = put_le(out, flags, 2);
+    if (!(flags & FTMS_ROWER_F_MORE_DATA)) {
+        *p++ = spm_half;
+        p = put_le(p, strokes, 2);
+    }
+    if (flags & FTMS_ROWER_F_DISTANCE) p = put_le(p, distance, 3);
+    if (flags & FTMS_ROWER_F_PACE) p = put_le(p, pace, 2);
+    if (flags & FTMS_ROWER_F_AVG_PACE) p = put_le(p, avg_pace, 2);
+    if (flags & FTMS_ROWER_F_POWER) p = put_le(p, (uint16_t)power, 2);
+    if (flags & FTMS_ROWER_F_ELAPSED) p = put_le(p, elapsed, 2);
+
+    e->primed = true;
+    e->present |= (uint16_t)(flags & ~FTMS_ROWER_F_MORE_DATA);
+    e->spm_half = spm_half;
+    e->strokes = strokes;
+    e->distance_m = distance;
+    e->pace_s = pace;
+    e->avg_pace_s = avg_pace;
+    if (has_power) e->power_w = power;
+    e->elapsed_s = elapsed;
+    return (size_t)(p - out);
+}
+
+int ftms_rower_decode(const uint8_t *buf, size_t len, ftms_rower_values_t *out)
+{
+    if (len < 2) return -1;
+    const uint16_t flags = (uint16_t)get_le(buf, 2);
+    if (flags & ~F_KNOWN) return -1;
+
+    // Field sizes in flag order; bit 0 is inverted and carries two fields
+    static const struct { uint16_t bit; uint8_t size; } k_fields[] = {
+        { FTMS_ROWER_F_MORE_DATA, 3 }, { FTMS_ROWER_F_AVG_RATE, 1 }, { FTMS_ROWER_F_DISTANCE, 3 },
+        { FTMS_ROWER_F_PACE, 2 },      { FTMS_ROWER_F_AVG_PACE, 2 }, { FTMS_ROWER_F_POWER, 2 },
+        { F_AVG_POWER, 2 },            { F_RESISTANCE, 2 },          { F_ENERGY, 5 },
+        { F_HEART_RATE, 1 },           { F_MET, 1 },                 { FTMS_ROWER_F_ELAPSED, 2 },
+        { F_REMAINING, 2 },
+    };
+
+    const uint8_t *p = buf + 2, *end = buf + len;
+    for (size_t i = 0; i < sizeof(k_fields) / sizeof(k_fields[0]); i++) {
+        const uint16_t bit = k_fields[i].bit;
+        const bool present = (bit == FTMS_ROWER_F_MORE_DATA) ? !(flags & bit) : (flags & bit) != 0;
+        if (!present) continue;
+        if (end - p < k_fields[i].size) return -1;
+
+        switch (bit) {
+        case FTMS_ROWER_F_MORE_DATA:
+            out->spm = (float)p[0] * 0.5f;
+            out->stroke_count = get_le(p + 1, 2);
+            break;
+        case FTMS_ROWER_F_DISTANCE: out->distance_m = (float)get_le(p, 3); break;
+        case FTMS_ROWER_F_PACE: out->pace_500m_s = (float)get_le(p, 2); break;
+        case FTMS_ROWER_F_AVG_PACE: out->avg_pace_500m_s = (float)get_le(p, 2); break;
+        case FTMS_ROWER_F_POWER: out->power_w = (float)(int16_t)get_le(p, 2); break;
+        case FTMS_ROWER_F_ELAPSED: out->elapsed_s = get_le(p, 2); break;
+        default: break;
+        }
+        p += k_fields[i].size;
+    }
+    return flags;
+}
@@ -32,7 +32,9 @@ typedef void (*ble_rx_cb_t)(const uint8_t *data, uint16_t len);
 esp_err_t ble_app_init(void);
 
 /**
- * @brief Start scanning for BLE devices.
+ * @brief Start scanning for BLE devices: the list is cleared, a burst at
+ *        full duty follows, then a low duty background scan while nothing
+ *        is connected or advertising (ble_scan_sched.h).
  *
  * If the host is not yet synced, this returns ESP_FAIL; however
  * ble_app_init() already starts a scan automatically after sync.
@@ -40,7 +42,7 @@ esp_err_t ble_app_init(void);
 esp_err_t ble_start_scan(void);
 
 /**
- * @brief Stop scanning.
+ * @brief Stop scanning (the burst and the background scan).
  */
 esp_err_t ble_stop_scan(void);
 
@@ -75,16 +77,32 @@ const char * ble_get_device_name(void);
 /**
  * @brief Start/stop peripheral advertising so phones (nRF Connect, etc.)
  *        can see and connect to this ESP32.
+ *
+ * Advertising resumes after each connection while peripheral slots are
+ * left, so several centrals can follow the rowing service (ble_rowing.h).
  */
 esp_err_t ble_start_advertising(void);
 esp_err_t ble_stop_advertising(void);
 
 /**
- * @brief Send data to peer (placeholder for later GATT implementation).
+ * @brief Boat broadcast: put the live sample in the advert (ble_boat_adv.h)
+ *        for any number of listeners, no connection needed.
+ *
+ * The advert data is refreshed `hz` times a second (1..4) from the latest
+ * rowing sample. Phones can still connect while ble_start_advertising() is
+ * in force and slots are left; otherwise the advert is broadcast only.
+ */
+esp_err_t ble_start_broadcast(uint8_t hz);
+esp_err_t ble_stop_broadcast(void);
+
+/**
+ * @brief Observe other boats' broadcasts (ble_boats.h).
  *
- * For now this is just a stub returning ESP_ERR_NOT_SUPPORTED.
+ * Switches the scan to passive with duplicates reported, so every advert
+ * reaches the boat table (see ble_scan_sched.h).
  */
-esp_err_t ble_send(const uint8_t *data, uint16_t len);
+esp_err_t ble_start_observing(void);
+esp_err_t ble_stop_observing(void);
 
 /* UI callback registration */
 
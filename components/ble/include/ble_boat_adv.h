@@ -0,0 +1,94 @@
+// components/ble/include/ble_boat_adv.h
+#pragma once
+
+/*
+ * Multi-boat broadcast: the live telemetry frame in an advertisement, and
+ * the observer's table of boats heard.
+ *
+ * A broadcasting boat puts one sample, framed exactly as on the Rowing
+ * Data characteristic (ble_rowing_frame.h), in manufacturer-specific data:
+ *
+ *   u16 company 0xFFFF (no company: test / internal use)
+ *   u8  0x52 ('R')
+ *   20  frame: header (version, count = 1, sequence) and one sample
+ *
+ * 25 bytes with the AD header, 28 with the flags: a legacy advertisement
+ * holds it. The sequence number changes with every new sample, so the
+ * repeats a scanner hears between updates are recognised and skipped.
+ *
+ * The observer table is keyed by advertiser address: an open-addressed
+ * index of BLE_BOATS_SLOTS over BLE_BOATS_MAX boats, never more than half
+ * full, so an advert costs one hash and a probe or two. A boat not heard
+ * for `stale_us` is dropped from snapshots and its entry goes to the next
+ * new boat that probes past it; once every entry is handed out, the stale
+ * ones are swept out together. Nothing is called back per advert: readers
+ * compare `generation`, which moves when a boat appears or sends a new
+ * sample.
+ *
+ * Plain C only: host tools can link this file. No locking; the caller
+ * serialises feed() and snapshot().
+ */
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "ble_rowing_frame.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define BLE_BOAT_ADV_COMPANY        0xFFFF
+#define BLE_BOAT_ADV_MAGIC          0x52
+#define BLE_BOAT_ADV_LEN            (2 + 1 + BLE_ROWING_HDR_LEN + BLE_ROWING_SAMPLE_LEN)   // manufacturer data
+
+#define BLE_BOATS_MAX               64
+#define BLE_BOATS_SLOTS             128     // power of two, twice BLE_BOATS_MAX
+#define BLE_BOATS_COMPACT_US        1000000 // full table: how often stale boats are swept out
+
+typedef struct {
+    uint8_t  addr[6];
+    uint8_t  addr_type;
+    int8_t   rssi;              // last advert
+    uint8_t  seq;               // of `sample`
+    int64_t  first_us;
+    int64_t  last_us;           // last advert
+    uint32_t adverts;
+    uint32_t updates;           // samples taken
+    uint32_t missed;            // samples skipped over (sequence gaps)
+    ble_rowing_sample_t sample;
+} ble_boat_t;
+
+typedef struct {
+    ble_boat_t boats[BLE_BOATS_MAX];
+    uint8_t  slots[BLE_BOATS_SLOTS];    // boat index + 1, 0 = empty
+    int      used;                      // boats[] entries handed out
+    int64_t  stale_us;
+    uint32_t generation;
+    uint32_t adverts;                   // boat adverts fed
+    uint32_t full;                      // new boats turned away, all entries live
+    uint32_t compactions;               // stale boats swept out of a full table
+    int64_t  compact_us;
+} ble_boat_table_t;
+
+/* Manufacturer data (company ID first, as NimBLE's mfg_data wants it) into
+ * `out` (BLE_BOAT_ADV_LEN bytes). Returns the length. */
+size_t ble_boat_adv_encode(uint8_t *out, uint8_t seq, const ble_rowing_sample_t *s);
+
+/* Look for a boat frame in raw advertising data. Returns the frame's
+ * start (BLE_ROWING_HDR_LEN + BLE_ROWING_SAMPLE_LEN bytes) or NULL. */
+const uint8_t *ble_boat_adv_find(const uint8_t *data, size_t len);
+
+void ble_boat_table_init(ble_boat_table_t *t, int64_t stale_us);
+
+/* One advertising report. Returns true if it came from a boat. */
+bool ble_boat_table_feed(ble_boat_table_t *t, const uint8_t addr[6], uint8_t addr_type, int8_t rssi,
+                         const uint8_t *data, size_t len, int64_t now_us);
+
+/* Boats heard within the stale time, in table order (stable while they
+ * stay). Returns the count. */
+int ble_boat_table_snapshot(const ble_boat_table_t *t, ble_boat_t *out, int max, int64_t now_us);
+
+#ifdef __cplusplus
+}
+#endif
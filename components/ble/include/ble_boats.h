@@ -0,0 +1,47 @@
+// components/ble/include/ble_boats.h
+#pragma once
+
+/*
+ * The boats heard while observing (ble_start_observing()): each broadcasting
+ * boat's latest sample, kept by ble_boat_adv.c's table.
+ *
+ * The scan runs without duplicate filtering so every advert reaches the
+ * table; a boat's repeats between samples are dropped there, and nothing
+ * calls the UI back per advert. A display polls ble_boats_generation() and
+ * takes a snapshot when it has moved.
+ */
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "ble_boat_adv.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Called once from ble_app_init(). */
+void ble_boats_init(void);
+
+/* Forget every boat (the observer starting afresh). */
+void ble_boats_clear(void);
+
+/* Changes when a boat appears or sends a new sample. */
+uint32_t ble_boats_generation(void);
+
+/* The boats heard within CONFIG_BLE_BOAT_STALE_S. Returns the count. */
+int ble_boats_get(ble_boat_t *out, int max);
+
+/* Broadcaster side: the manufacturer data for the next advert, from the
+ * latest live sample (ble_rowing_latest). The sequence number moves only
+ * when the sample does. Returns 0 before there is a sample. */
+size_t ble_boats_adv_payload(uint8_t out[BLE_BOAT_ADV_LEN]);
+
+/* ble.c hands every advertising report here while observing (host task).
+ * Returns true if it was a boat's. */
+struct ble_gap_disc_desc;
+bool ble_boats_on_disc(const struct ble_gap_disc_desc *disc);
+
+#ifdef __cplusplus
+}
+#endif
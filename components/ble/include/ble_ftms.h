@@ -0,0 +1,40 @@
+// components/ble/include/ble_ftms.h
+#pragma once
+
+/*
+ * Fitness Machine Service (0x1826) as a rower, so standard training apps
+ * see the boat without knowing the custom telemetry service:
+ *   Fitness Machine Feature  (read)    0x2ACC
+ *   Rower Data               (notify)  0x2AD1, fields as in ftms_rower.h
+ *
+ * Once a second the newest published telemetry sample is encoded for each
+ * subscribed connection, carrying only the fields that changed since that
+ * connection's last notification; nothing is sent when nothing changed.
+ * Subscribers count as telemetry listeners (ble_rowing_add_listeners), so
+ * stroke_task publishes while only FTMS apps are connected.
+ */
+
+#include <stdint.h>
+#include "esp_err.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define BLE_FTMS_UUID16             0x1826
+
+/* Service data for the advertisement (FTMS 3.1.1): UUID, flags (machine
+ * available), machine type (rower). */
+#define BLE_FTMS_ADV_SVC_DATA_LEN   5
+extern const uint8_t ble_ftms_adv_svc_data[BLE_FTMS_ADV_SVC_DATA_LEN];
+
+/* Register the service. ble_app_init() calls this before the host starts. */
+esp_err_t ble_ftms_init(void);
+
+/* ble.c forwards disconnect and subscribe events here (host task). */
+struct ble_gap_event;
+void ble_ftms_on_gap_event(const struct ble_gap_event *event);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,70 @@
+// components/ble/include/ble_link.h
+#pragma once
+
+/*
+ * Connection parameter and PHY policy.
+ *
+ * Each service says what it needs from a connection (ble_link_set); the
+ * link gets the most demanding of those modes:
+ *
+ *   IDLE  300-500 ms, latency 2        connected, nothing flowing
+ *   LIVE  30-50 ms, latency 4, 2M PHY  telemetry notifications, sensors
+ *   BULK  7.5-15 ms, no latency,       file transfer; also asks for full
+ *         2M PHY                       data length and a larger MTU
+ *
+ * A peer that refuses a mode's parameters is asked once more with a more
+ * conservative set (within what phones commonly accept); if that is
+ * refused too the link stays as it is until the mode changes again. A
+ * freshly connected link is left alone for a few seconds so service
+ * discovery runs at the phone's chosen interval. A link we initiated
+ * starts in the mode whose parameters it was opened with
+ * (ble_link_conn_params). Every change the link goes through is logged
+ * with the interval, latency, timeout and PHY it ended up with, and the
+ * time spent in each mode is logged on disconnect.
+ *
+ * Host task only.
+ */
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef enum {
+    BLE_LINK_IDLE = 0,
+    BLE_LINK_LIVE,
+    BLE_LINK_BULK,
+    BLE_LINK_MODE_COUNT,
+} ble_link_mode_t;
+
+typedef enum {
+    BLE_LINK_USER_ROWING = 0,
+    BLE_LINK_USER_FTMS,
+    BLE_LINK_USER_XFER,
+    BLE_LINK_USER_CENTRAL,          // a peripheral we connected to for its data
+    BLE_LINK_USER_COUNT,
+} ble_link_user_t;
+
+/* `user` needs `mode` from connection `conn` (BLE_LINK_IDLE: nothing). */
+void ble_link_set(uint16_t conn, ble_link_user_t user, ble_link_mode_t mode);
+
+/* The mode connection `conn` is being run in. */
+ble_link_mode_t ble_link_mode(uint16_t conn);
+
+const char *ble_link_mode_name(ble_link_mode_t mode);
+
+/* Parameters for ble_gap_connect() when we connect as central. */
+struct ble_gap_conn_params;
+void ble_link_conn_params(ble_link_mode_t mode, struct ble_gap_conn_params *out);
+
+/* ble.c forwards every GAP event here first (host task). */
+struct ble_gap_event;
+void ble_link_on_gap_event(const struct ble_gap_event *event);
+
+/* Called once from ble_app_init(). */
+void ble_link_init(void);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,83 @@
+// components/ble/include/ble_peers.h
+#pragma once
+
+/*
+ * Known sensors: every peripheral whose heart rate or power we subscribed
+ * to (ble_sensors.h) is kept in NVS, newest first, so the next boot does
+ * not start from an empty device list.
+ *
+ * At sync ble.c calls ble_peers_reconnect(): the cached addresses go into
+ * the controller's filter accept list and one connection is initiated to
+ * whichever of them advertises first, scanning continuously and asking for
+ * the BULK connection interval so discovery and subscription take a few
+ * round trips of 7.5-15 ms; ble_sensors holds BULK until it has
+ * subscribed, then asks ble_link for LIVE and logs how long setup took.
+ * A known sensor that drops out (not one we hung up on) is reconnected the
+ * same way. Phones connect to us and are not cached.
+ *
+ * Latency from boot (esp_timer time) to sync, to the connection and to the
+ * first measurement of each kind is logged and kept (ble_peers_timing).
+ *
+ * Host task, except where noted.
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "esp_err.h"
+
+#include "ble_sensors.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define BLE_PEERS_MAX 4
+
+typedef struct {
+    uint8_t addr[6];
+    uint8_t addr_type;
+    uint8_t kinds;                  // bit (1 << ble_sensor_kind_t) per measurement seen
+} ble_peer_t;
+
+typedef struct {
+    int64_t sync_us;                // host synced
+    int64_t start_us;               // accept-list connection initiated, 0 = never
+    int64_t connect_us;             // ...and established, 0 = not (yet)
+    int64_t ready_us[BLE_SENSOR_COUNT];     // first measurement after it, 0 = none
+} ble_peers_timing_t;
+
+/* Load the cache; called once from ble_app_init() after NVS is up. */
+esp_err_t ble_peers_init(void);
+
+int ble_peers_count(void);
+bool ble_peers_get(int index, ble_peer_t *out);
+
+/* A sensor of `kind` at this address was subscribed to: move it to the
+ * front and save if anything changed. */
+void ble_peers_remember(const uint8_t addr[6], uint8_t addr_type, ble_sensor_kind_t kind);
+
+/* Drop every cached peer (NVS included); background scanning, paused while
+ * any are known (ble_scan_sched.h), may resume. */
+esp_err_t ble_peers_forget(void);
+
+/* Initiate to the cached peers through the accept list. ESP_ERR_NOT_FOUND
+ * if there are none; the callback receives the connection's GAP events. */
+struct ble_gap_event;
+esp_err_t ble_peers_reconnect(uint8_t own_addr_type, int (*cb)(struct ble_gap_event *event, void *arg));
+
+/* Give up a pending accept-list connection (the user is picking a device). */
+void ble_peers_cancel_reconnect(void);
+
+/* ble.c forwards every GAP event here. */
+void ble_peers_on_gap_event(const struct ble_gap_event *event);
+
+/* ble_sensors: the first measurement of `kind` on this connection arrived. */
+void ble_peers_on_ready(ble_sensor_kind_t kind);
+
+/* Any task. */
+void ble_peers_timing(ble_peers_timing_t *out);
+
+#ifdef __cplusplus
+}
+#endif
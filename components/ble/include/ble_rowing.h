@@ -0,0 +1,65 @@
+// components/ble/include/ble_rowing.h
+#pragma once
+
+/*
+ * Live rowing telemetry GATT service.
+ *
+ * One custom primary service with two characteristics:
+ *   Rowing Data  (read, notify)  frames as in ble_rowing_frame.h
+ *   Rate         (read, write)   u8, samples per second, 1..BLE_ROWING_MAX_RATE_HZ
+ *
+ * stroke_task asks ble_rowing_due() on every sample and, once per rate
+ * period while anybody listens, hands the values to ble_rowing_publish(),
+ * which puts them in a ring and returns; it never waits on the stack. On
+ * the NimBLE host task a timer at the same rate serves each subscribed
+ * connection at most once per connection interval: everything that
+ * arrived since its last notification goes out as one frame, cut to what
+ * the connection's MTU holds (newest first). A connection whose notify
+ * fails for lack of buffers keeps its backlog for the next interval.
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "esp_err.h"
+#include "ble_rowing_frame.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define BLE_ROWING_MAX_RATE_HZ  20
+
+/* 128-bit UUIDs, little endian as they go on air. */
+extern const uint8_t ble_rowing_svc_uuid128[16];
+
+/* Register the service. ble_app_init() calls this before the host starts. */
+esp_err_t ble_rowing_init(void);
+
+/* stroke_task: true once per rate period while anybody listens; the
+ * caller then builds a sample and publishes it. */
+bool ble_rowing_due(int64_t now_us);
+void ble_rowing_publish(const ble_rowing_sample_t *s);
+
+/* The newest published sample. False before the first one. */
+bool ble_rowing_latest(ble_rowing_sample_t *out);
+
+/* Other services reading the samples (FTMS) count their subscribers in,
+ * so publishing goes on while only they listen. */
+void ble_rowing_add_listeners(int delta);
+
+/* Samples per second, clamped to 1..BLE_ROWING_MAX_RATE_HZ. Also written
+ * by centrals through the Rate characteristic. */
+void ble_rowing_set_rate_hz(uint8_t hz);
+uint8_t ble_rowing_get_rate_hz(void);
+
+/* Connections with notifications enabled. */
+int ble_rowing_subscriber_count(void);
+
+/* ble.c forwards connect, disconnect, subscribe, MTU and connection update
+ * events here (host task). */
+struct ble_gap_event;
+void ble_rowing_on_gap_event(const struct ble_gap_event *event);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,101 @@
+// components/ble/include/ble_rowing_frame.h
+#pragma once
+
+/*
+ * Wire format of the live rowing telemetry characteristic, and the ring
+ * that carries samples from stroke_task to the BLE host task.
+ *
+ * A notification is a 2-byte header and up to 15 samples of 18 bytes,
+ * oldest first, as many as the connection's ATT MTU allows: one sample
+ * fits the default 23-byte MTU, 13 fit 247. All fields little endian:
+ *
+ *   header  u8  version << 4 | sample count
+ *           u8  sequence number of the first sample (mod 256)
+ *   sample  u32 session time, ms
+ *           u16 stroke rate, 0.1 spm
+ *           u16 pace, 0.1 s/500 m (0 = not moving)
+ *           u16 speed, mm/s
+ *           u24 distance, 0.1 m
+ *           u16 stroke count (wraps)
+ *           u24 drive time (low 12 bits) and recovery time (high 12 bits), 10 ms
+ *
+ * Values saturate at their field's maximum. A gap in the sequence numbers
+ * means samples were skipped (the link could not keep up); the newest are
+ * always sent.
+ *
+ * Plain C only: host tools can link this file.
+ */
+
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define BLE_ROWING_FRAME_VERSION    1
+#define BLE_ROWING_HDR_LEN          2
+#define BLE_ROWING_SAMPLE_LEN       18
+#define BLE_ROWING_MAX_SAMPLES      15      // count is a nibble
+#define BLE_ROWING_RING_LEN         32      // samples between stroke_task and the host (power of two)
+
+typedef struct {
+    uint32_t t_ms;              // session time
+    float spm;
+    float pace_500m_s;          // 0 when not moving
+    float speed_mps;
+    float distance_m;
+    uint32_t stroke_count;
+    float drive_time_s;
+    float recovery_time_s;
+    // Not in the frame; for the other services reading the ring (FTMS)
+    float avg_pace_500m_s;
+    float power_w;              // NAN without a power source
+} ble_rowing_sample_t;
+
+/* Samples that fit one notification at this ATT MTU (0 if none). */
+int ble_rowing_frame_capacity(uint16_t mtu);
+
+/* Header plus `n` samples into `out` (BLE_ROWING_HDR_LEN + n *
+ * BLE_ROWING_SAMPLE_LEN bytes). Returns the length. */
+size_t ble_rowing_frame_encode(uint8_t *out, uint8_t first_seq, const ble_rowing_sample_t *samples, int n);
+
+/* Inverse of the above. Returns the sample count, or -1 if the frame is
+ * malformed or newer than this decoder. */
+int ble_rowing_frame_decode(const uint8_t *buf, size_t len, uint8_t *first_seq,
+                            ble_rowing_sample_t *out, int max);
+
+/*
+ * One producer (stroke_task), any number of readers each with its own
+ * cursor (one per subscribed connection). The producer never waits: a
+ * reader that falls BLE_ROWING_RING_LEN samples behind skips ahead.
+ */
+typedef struct {
+    ble_rowing_sample_t sample;
+    atomic_uint_fast32_t seq;   // seq + 1 of the sample held, 0 while it is written
+} ble_rowing_slot_t;
+
+typedef struct {
+    ble_rowing_slot_t slots[BLE_ROWING_RING_LEN];
+    atomic_uint_fast32_t head;  // seq of the next sample
+} ble_rowing_ring_t;
+
+void ble_rowing_ring_init(ble_rowing_ring_t *r);
+
+/* Producer. */
+void ble_rowing_ring_push(ble_rowing_ring_t *r, const ble_rowing_sample_t *s);
+
+/* Seq of the next sample to be pushed. */
+uint32_t ble_rowing_ring_head(ble_rowing_ring_t *r);
+
+/* Reader: copy out up to `max` samples from `*cursor` on, advancing it.
+ * Starts from the newest `max` when more are waiting, and past anything
+ * overwritten. Returns the count; `*first_seq` is the seq of out[0]. */
+int ble_rowing_ring_read(ble_rowing_ring_t *r, uint32_t *cursor, ble_rowing_sample_t *out, int max,
+                         uint32_t *first_seq);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,79 @@
+// components/ble/include/ble_scan_sched.h
+#pragma once
+
+/*
+ * Scan scheduler: owns ble_gap_disc() and runs the scan in one of these
+ * duty cycles, re-deciding whenever connections, advertising or a request
+ * change:
+ *
+ *   OBSERVE     90 ms every 100 ms, passive,   boat broadcasts (ble_boats.h)
+ *               duplicates reported
+ *   BURST       continuous, active             for CONFIG_BLE_SCAN_BURST_S
+ *                                              after the user asks to scan
+ *   BACKGROUND  CONFIG_BLE_SCAN_BG_WINDOW_MS   keeps the device list fresh
+ *               every ..._INTERVAL_MS, active  at a few percent of the radio
+ *   OFF
+ *
+ * Background scanning pauses while any connection is up (a pending
+ * accept-list reconnect included), while we are advertising and while
+ * ble_peers knows a sensor: known sensors are reconnected to through the
+ * accept list, not searched for. Observing and bursts run regardless.
+ *
+ * Radio time is accounted as scan time x window / interval per duty
+ * cycle, logged on every change and available from ble_scan_sched_stats().
+ *
+ * Host task, except where noted.
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef enum {
+    BLE_SCAN_OFF = 0,
+    BLE_SCAN_BACKGROUND,
+    BLE_SCAN_BURST,
+    BLE_SCAN_OBSERVE,
+    BLE_SCAN_STATE_COUNT,
+} ble_scan_state_t;
+
+typedef struct {
+    ble_scan_state_t state;
+    uint64_t wall_us[BLE_SCAN_STATE_COUNT];     // time spent in each state
+    uint64_t radio_us[BLE_SCAN_STATE_COUNT];    // of it, receiving
+    uint32_t starts;                            // ble_gap_disc() calls
+} ble_scan_stats_t;
+
+/* Called once from ble_app_init(); reports go to `cb`. */
+struct ble_gap_event;
+void ble_scan_sched_init(int (*cb)(struct ble_gap_event *event, void *arg));
+
+/* The host synced and our address type is known: scheduling starts. */
+void ble_scan_sched_on_sync(uint8_t own_addr_type);
+
+/* Background scanning wanted at all (ble_start_scan / ble_stop_scan). */
+void ble_scan_sched_set_background(bool on);
+
+/* The user asked to scan: full duty for a while. */
+void ble_scan_sched_burst(void);
+
+/* Boat observer (ble_start_observing). */
+void ble_scan_sched_set_observing(bool on);
+
+/* Something the decision depends on changed outside a GAP event
+ * (advertising started or stopped). */
+void ble_scan_sched_update(void);
+
+void ble_scan_sched_on_gap_event(const struct ble_gap_event *event);
+
+/* Totals so far, the current state included. Any task. */
+void ble_scan_sched_stats(ble_scan_stats_t *out);
+
+const char *ble_scan_state_name(ble_scan_state_t state);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,62 @@
+// components/ble/include/ble_scan_table.h
+#pragma once
+
+/*
+ * The scan's device list (ble_get_device): BLE_MAX_DEVICES entries found
+ * through an open-addressed index on the address, so an advertising report
+ * costs a hash and a probe or two rather than a pass over the list.
+ *
+ * RSSI is smoothed (1/4 of each report) and only a move of
+ * BLE_SCAN_RSSI_REDRAW_DB in the smoothed value counts as a change, as do a
+ * new device and a new name; repeats of what is shown change nothing. A
+ * change only sets `dirty`: ble.c tells the UI at most every
+ * CONFIG_BLE_SCAN_UI_PERIOD_MS. When the list is full the device heard
+ * longest ago makes way for the new one, at the same index.
+ *
+ * Plain C only: host tools can link this file. No locking; the caller
+ * serialises access.
+ */
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "ble.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define BLE_SCAN_SLOTS              64      // power of two, at least twice BLE_MAX_DEVICES
+#define BLE_SCAN_RSSI_REDRAW_DB     4
+
+typedef struct {
+    ble_device_t dev;           // dev.rssi: smoothed, as last reported
+    bool     used;
+    int16_t  rssi_q4;           // smoothed RSSI, 1/16 dB
+    int64_t  last_us;
+    uint32_t reports;
+} ble_scan_entry_t;
+
+typedef struct {
+    ble_scan_entry_t e[BLE_MAX_DEVICES];
+    uint8_t  slots[BLE_SCAN_SLOTS];     // entry index + 1, 0 = empty
+    int      count;                     // entries ever used (ble_get_device_count)
+    bool     dirty;                     // changed since ble_scan_table_take_dirty()
+    uint32_t reports;
+    uint32_t evictions;
+} ble_scan_table_t;
+
+void ble_scan_table_clear(ble_scan_table_t *t);
+
+/* One advertising report. Returns true if it added a device. */
+bool ble_scan_table_feed(ble_scan_table_t *t, const uint8_t addr[6], uint8_t addr_type, int8_t rssi,
+                         const uint8_t *data, size_t len, int64_t now_us);
+
+/* True if the list changed since the last call. */
+bool ble_scan_table_take_dirty(ble_scan_table_t *t);
+
+bool ble_scan_table_get(const ble_scan_table_t *t, int index, ble_device_t *out);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,62 @@
+// components/ble/include/ble_sensor_parse.h
+#pragma once
+
+/*
+ * Heart Rate and Cycling Power measurement parsing, read in place from a
+ * chain of buffer segments (a NimBLE mbuf chain in the firmware), so a
+ * notification is never copied out first.
+ *
+ *   Heart Rate Measurement (0x2A37)
+ *     u8  flags: bit 0 value is u16, bit 1-2 sensor contact, bit 3 energy
+ *         expended present, bit 4 RR intervals present
+ *     u8/u16 heart rate, bpm
+ *
+ *   Cycling Power Measurement (0x2A63)
+ *     u16 flags
+ *     s16 instantaneous power, W
+ *     then optional fields by flag; crank revolution data (bit 5: u16
+ *     cumulative revolutions, u16 last event time in 1/1024 s) follows
+ *     pedal power balance (bit 0, u8), accumulated torque (bit 2, u16)
+ *     and wheel revolution data (bit 4, u32 + u16)
+ *
+ * Plain C only: host tools can link this file.
+ */
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* A reader over segments: `next` moves `seg` on and returns the next
+ * segment's bytes, false at the end of the chain. */
+typedef struct {
+    const void    *seg;
+    const uint8_t *p;
+    uint16_t       left;            // bytes left in this segment
+    bool (*next)(const void **seg, const uint8_t **p, uint16_t *len);
+} ble_sensor_rd_t;
+
+typedef struct {
+    uint16_t bpm;
+    bool     contact;               // false only when the sensor reports no skin contact
+    uint8_t  rr_count;              // RR intervals in this measurement
+    uint16_t rr_last;               // newest, 1/1024 s
+} ble_hr_meas_t;
+
+typedef struct {
+    int16_t  power_w;
+    bool     has_crank;
+    uint16_t crank_revs;            // cumulative (wraps)
+    uint16_t crank_time;            // last crank event, 1/1024 s (wraps)
+} ble_cp_meas_t;
+
+/* False if the measurement is shorter than its flags say. */
+bool ble_hr_meas_parse(ble_sensor_rd_t *rd, ble_hr_meas_t *out);
+bool ble_cp_meas_parse(ble_sensor_rd_t *rd, ble_cp_meas_t *out);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,57 @@
+// components/ble/include/ble_sensors.h
+#pragma once
+
+/*
+ * Central client for external sensors: once we connect to a peripheral
+ * (ble_connect_to_index), its Heart Rate (0x180D) and Cycling Power
+ * (0x1818) services are discovered and their measurement characteristics
+ * subscribed to. Oarlock power meters speak Cycling Power. The link runs
+ * at BULK (ble_link.h) while that takes its round trips and drops to
+ * LIVE once it is done; the time from connecting to done is logged.
+ *
+ * Notifications are parsed straight out of the mbuf chain
+ * (ble_sensor_parse.h) and the newest value of each kind is kept with the
+ * time it arrived; stroke_task reads them with ble_sensors_latest().
+ * Sensors subscribed to are remembered and reconnected to at the next
+ * boot (ble_peers.h).
+ *
+ * One sensor connection at a time: ble.c runs a single central link, so a
+ * heart-rate strap and a separate power meter cannot both be used; the
+ * one connected last wins, and at boot whichever known sensor advertises
+ * first. A device offering both services gives both. Heart rate goes to
+ * the data page, power to the data page, the logs and the telemetry.
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef enum {
+    BLE_SENSOR_HR = 0,              // bpm
+    BLE_SENSOR_POWER,               // W
+    BLE_SENSOR_COUNT,
+} ble_sensor_kind_t;
+
+typedef struct {
+    float   value;
+    int64_t t_us;                   // esp_timer time of the notification
+} ble_sensor_reading_t;
+
+/* The newest reading of `kind` if it is at most `max_age_us` old. Any task. */
+bool ble_sensors_latest(ble_sensor_kind_t kind, int64_t max_age_us, ble_sensor_reading_t *out);
+
+/* ble.c forwards every GAP event here (host task); connects as central
+ * start discovery. */
+struct ble_gap_event;
+void ble_sensors_on_gap_event(const struct ble_gap_event *event);
+
+/* BLE_GAP_EVENT_NOTIFY_RX: true if it was a sensor measurement (parsed and
+ * kept), false to hand it on. */
+bool ble_sensors_on_notify(const struct ble_gap_event *event);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,54 @@
+// components/ble/include/ble_xfer.h
+#pragma once
+
+/*
+ * Session log download service: lists the sessions on the card and streams
+ * their files, protocol as in ble_xfer_proto.h. Two characteristics:
+ *   Control  (write, write without response, notify)  requests and replies
+ *   Data     (notify)                                 file chunks
+ *
+ * One transfer at a time. Opening a file puts the link in bulk mode (see
+ * ble_link.h: 2M PHY, full link-layer packets, a larger ATT MTU and a short
+ * connection interval); chunks are then sent on the NimBLE host task as fast
+ * as the window and the stack's buffers allow, and the next one goes out as
+ * soon as a notification completes. The file is read through a
+ * CONFIG_BLE_XFER_READ_BUF_KB stdio buffer so the card sees few large reads.
+ *
+ * The sessions come from the application (ble_xfer_set_source), so this
+ * component does not depend on the activity index or the card layout.
+ */
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "esp_err.h"
+#include "ble_xfer_proto.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct {
+    /* Sessions available, and session `i` with 0 the newest. */
+    int  (*count)(void);
+    bool (*get)(int i, ble_xfer_session_t *out);
+    /* Path of one of session `id`'s files; false if it has none of that kind. */
+    bool (*path)(uint32_t id, ble_xfer_file_t file, char *out, size_t len);
+} ble_xfer_source_t;
+
+/* Register the service. ble_app_init() calls this before the host starts. */
+esp_err_t ble_xfer_init(void);
+
+/* `src` must outlive the service. Until it is set LIST reports no sessions. */
+void ble_xfer_set_source(const ble_xfer_source_t *src);
+
+/* A file transfer is running. */
+bool ble_xfer_active(void);
+
+/* ble.c forwards disconnect, MTU and notify-complete events here (host task). */
+struct ble_gap_event;
+void ble_xfer_on_gap_event(const struct ble_gap_event *event);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,176 @@
+// components/ble/include/ble_xfer_proto.h
+#pragma once
+
+/*
+ * Session file transfer over BLE: framing and flow control.
+ *
+ * The client writes requests to the Control characteristic and gets the
+ * replies as Control notifications; file bytes come as Data notifications.
+ * All fields little endian.
+ *
+ *   LIST    01  u16 first (0 = newest)  u8 max
+ *     ->    81  u16 index  u32 id  u32 start (unix s)  u32 duration ms  u32 distance 0.1 m
+ *               one per session, newest first, then
+ *     ->    82  u16 sessions on the card
+ *   OPEN    02  u32 id  u8 file  u32 offset  u16 window (bytes in flight, 0 = default)
+ *     ->    83  u8 status  u32 file size  u32 offset  u16 chunk payload
+ *               then Data chunks from `offset` on (the payload size follows
+ *               the MTU if that changes; every chunk carries its offset)
+ *   ACK     03  u32 offset: every byte below arrived intact
+ *   REWIND  04  u32 offset: a chunk failed its CRC or went missing; resend from here
+ *   CLOSE   05
+ *     ->    84  u8 status  u32 bytes acknowledged
+ *               when the whole file is acknowledged, on CLOSE, or on an error
+ *
+ *   Data chunk  u32 offset  payload  u32 crc32(offset and payload)
+ *
+ * The device keeps at most `window` unacknowledged bytes in flight and
+ * sends more as ACKs come in, so the client's buffers bound the transfer
+ * rather than the link. A dropped connection loses nothing: the client
+ * opens the file again at the offset it has.
+ *
+ * Plain C only: host tools can link this file.
+ */
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define BLE_XFER_OP_LIST            0x01
+#define BLE_XFER_OP_OPEN            0x02
+#define BLE_XFER_OP_ACK             0x03
+#define BLE_XFER_OP_REWIND          0x04
+#define BLE_XFER_OP_CLOSE           0x05
+#define BLE_XFER_OP_LIST_ENTRY      0x81
+#define BLE_XFER_OP_LIST_END        0x82
+#define BLE_XFER_OP_OPEN_RSP        0x83
+#define BLE_XFER_OP_END             0x84
+
+#define BLE_XFER_LIST_ENTRY_LEN     19
+#define BLE_XFER_CHUNK_OVERHEAD     8       // offset + crc
+#define BLE_XFER_MAX_CHUNK          (512 - 3 - BLE_XFER_CHUNK_OVERHEAD)    // payload at the largest ATT MTU
+#define BLE_XFER_DEFAULT_WINDOW     8192
+
+typedef enum {
+    BLE_XFER_FILE_STROKES = 0,      // <base>_Strokes.bin, or .csv when that is what was logged
+    BLE_XFER_FILE_SPLITS,
+    BLE_XFER_FILE_FIT,
+    BLE_XFER_FILE_RAW,
+    BLE_XFER_FILE_COUNT,
+} ble_xfer_file_t;
+
+typedef enum {
+    BLE_XFER_OK = 0,
+    BLE_XFER_ERR_NOT_FOUND,
+    BLE_XFER_ERR_OFFSET,            // past the end of the file
+    BLE_XFER_ERR_BUSY,              // another connection is transferring
+    BLE_XFER_ERR_IO,
+    BLE_XFER_ERR_REQUEST,           // malformed or out of place
+} ble_xfer_status_t;
+
+typedef struct {
+    uint8_t  op;
+    uint32_t id;                    // OPEN
+    uint8_t  file;                  // OPEN
+    uint32_t offset;                // OPEN, ACK, REWIND
+    uint16_t window;                // OPEN
+    uint16_t first;                 // LIST
+    uint8_t  max;                   // LIST
+} ble_xfer_req_t;
+
+typedef struct {
+    uint32_t id;
+    int64_t  start_utc_us;
+    uint32_t duration_ms;
+    float    distance_m;
+} ble_xfer_session_t;
+
+uint32_t ble_xfer_crc32(uint32_t crc, const void *buf, size_t len);
+
+/* Requests. Encode returns the length; parse returns false if malformed. */
+size_t ble_xfer_req_encode(const ble_xfer_req_t *r, uint8_t *out);
+bool ble_xfer_req_parse(const uint8_t *buf, size_t len, ble_xfer_req_t *out);
+
+/* Replies. */
+size_t ble_xfer_list_entry_encode(uint16_t index, const ble_xfer_session_t *s, uint8_t *out);
+size_t ble_xfer_list_end_encode(uint16_t count, uint8_t *out);
+size_t ble_xfer_open_rsp_encode(ble_xfer_status_t st, uint32_t size, uint32_t offset, uint16_t chunk, uint8_t *out);
+size_t ble_xfer_end_encode(ble_xfer_status_t st, uint32_t acked, uint8_t *out);
+
+/* Chunk payload that fits one notification at this ATT MTU. */
+uint16_t ble_xfer_chunk_max(uint16_t mtu);
+
+/* Wrap `len` payload bytes already at out + 4 into a chunk. Returns its length. */
+size_t ble_xfer_chunk_seal(uint8_t *out, uint32_t offset, size_t len);
+
+/* Check a chunk. Returns the payload length, or -1 on a bad CRC or length. */
+int ble_xfer_chunk_open(const uint8_t *buf, size_t len, uint32_t *offset, const uint8_t **payload);
+
+/*
+ * Sender: which bytes go next. Nothing blocks; the caller asks for the next
+ * chunk, sends it, and reports it sent. A chunk the link refuses is simply
+ * asked for again.
+ */
+typedef struct {
+    uint32_t size;
+    uint32_t next;                  // first byte not yet sent
+    uint32_t acked;                 // every byte below arrived
+    uint32_t window;                // bytes allowed in flight
+    uint16_t chunk;                 // payload per chunk
+    uint32_t rewinds;
+} ble_xfer_tx_t;
+
+void ble_xfer_tx_start(ble_xfer_tx_t *t, uint32_t size, uint32_t offset, uint16_t chunk, uint32_t window);
+
+/* Payload length of the next chunk (0 when the window is full or all is
+ * sent), its offset in `*offset`. */
+uint16_t ble_xfer_tx_next(const ble_xfer_tx_t *t, uint32_t *offset);
+void ble_xfer_tx_sent(ble_xfer_tx_t *t, uint16_t len);
+
+/* ACK from the client; offsets outside [acked, next] are ignored. */
+void ble_xfer_tx_ack(ble_xfer_tx_t *t, uint32_t offset);
+
+/* REWIND from the client: resend from `offset` (also acknowledges below it). */
+void ble_xfer_tx_rewind(ble_xfer_tx_t *t, uint32_t offset);
+
+bool ble_xfer_tx_done(const ble_xfer_tx_t *t);
+
+/*
+ * Receiver: takes chunks in order, and says when to ACK or REWIND. Chunks
+ * that arrive after a bad one are dropped until the resent one comes, so
+ * one REWIND is sent per loss.
+ */
+typedef struct {
+    uint32_t size;
+    uint32_t next;                  // first byte not yet received
+    uint32_t acked;                 // last ACK sent
+    uint32_t ack_every;             // bytes between ACKs
+    bool     rewind_sent;
+    bool     rewind_due;
+    uint32_t bad;                   // chunks that failed their CRC
+    uint32_t dropped;               // out of order (after a loss) or repeated
+} ble_xfer_rx_t;
+
+typedef enum {
+    BLE_XFER_RX_DATA,               // payload is the next bytes of the file
+    BLE_XFER_RX_DROP,               // not the chunk expected; a REWIND may be due
+    BLE_XFER_RX_BAD,                // failed its CRC; a REWIND is due
+} ble_xfer_rx_result_t;
+
+/* `window` as sent in OPEN; ACKs go out every half window. */
+void ble_xfer_rx_start(ble_xfer_rx_t *r, uint32_t size, uint32_t offset, uint32_t window);
+ble_xfer_rx_result_t ble_xfer_rx_chunk(ble_xfer_rx_t *r, const uint8_t *buf, size_t len,
+                                        const uint8_t **payload, uint16_t *payload_len);
+
+/* The control write the receiver owes now (ACK or REWIND), or 0 for none. */
+size_t ble_xfer_rx_reply(ble_xfer_rx_t *r, uint8_t *out);
+
+bool ble_xfer_rx_done(const ble_xfer_rx_t *r);
+
+#ifdef __cplusplus
+}
+#endif
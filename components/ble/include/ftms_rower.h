@@ -0,0 +1,89 @@
+// components/ble/include/ftms_rower.h
+#pragma once
+
+/*
+ * Fitness Machine Service (FTMS 1.0) Rower Data encoder.
+ *
+ * A Rower Data notification is a 16-bit flags field followed by the fields
+ * the flags announce, in flag order. This encoder keeps what it last sent
+ * to one connection and puts in only the fields whose value (at the
+ * resolution FTMS carries) changed since, so a steady boat costs a few
+ * bytes a second. The first frame after ftms_rower_enc_reset() carries
+ * every field that has a value.
+ *
+ * Fields used (FTMS 4.8):
+ *   bit 0  More Data: 0 = Stroke Rate (u8, 0.5/min) and Stroke Count (u16) present
+ *   bit 2  Total Distance        u24, m
+ *   bit 3  Instantaneous Pace    u16, s/500 m
+ *   bit 4  Average Pace          u16, s/500 m
+ *   bit 5  Instantaneous Power   s16, W
+ *   bit 11 Elapsed Time          u16, s
+ *
+ * The longest frame is 16 bytes, inside the 20 a default MTU allows.
+ *
+ * Plain C only: host tools can link this file.
+ */
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define FTMS_ROWER_MAX_LEN          16
+
+#define FTMS_ROWER_F_MORE_DATA      (1u << 0)
+#define FTMS_ROWER_F_AVG_RATE       (1u << 1)
+#define FTMS_ROWER_F_DISTANCE       (1u << 2)
+#define FTMS_ROWER_F_PACE           (1u << 3)
+#define FTMS_ROWER_F_AVG_PACE       (1u << 4)
+#define FTMS_ROWER_F_POWER          (1u << 5)
+#define FTMS_ROWER_F_ELAPSED        (1u << 11)
+
+/* Fitness Machine Feature bits this device reports (FTMS 4.3.1.1). */
+#define FTMS_FEATURE_CADENCE        (1u << 1)
+#define FTMS_FEATURE_TOTAL_DISTANCE (1u << 2)
+#define FTMS_FEATURE_PACE           (1u << 5)
+#define FTMS_FEATURE_ELAPSED_TIME   (1u << 12)
+#define FTMS_FEATURE_POWER          (1u << 14)
+
+typedef struct {
+    float    spm;
+    uint32_t stroke_count;
+    float    distance_m;
+    float    pace_500m_s;       // 0 when not moving
+    float    avg_pace_500m_s;
+    float    power_w;           // NAN when there is no power source
+    uint32_t elapsed_s;
+} ftms_rower_values_t;
+
+/* Last values sent to one connection, as they went on air. */
+typedef struct {
+    bool     primed;
+    uint16_t present;           // flags of the fields sent at least once
+    uint8_t  spm_half;
+    uint16_t strokes;
+    uint32_t distance_m;
+    uint16_t pace_s;
+    uint16_t avg_pace_s;
+    int16_t  power_w;
+    uint16_t elapsed_s;
+} ftms_rower_enc_t;
+
+/* The next frame carries every field (new subscriber). */
+void ftms_rower_enc_reset(ftms_rower_enc_t *e);
+
+/* The fields that changed, into `out` (FTMS_ROWER_MAX_LEN bytes). Returns
+ * the length, or 0 when nothing changed and no notification is needed. */
+size_t ftms_rower_encode(ftms_rower_enc_t *e, const ftms_rower_values_t *v, uint8_t *out);
+
+/* Parse a Rower Data value: fields present get their value in `out`, the
+ * rest are left alone. Returns the flags, or -1 if the frame is short or
+ * uses fields this parser does not know. */
+int ftms_rower_decode(const uint8_t *buf, size_t len, ftms_rower_values_t *out);
+
+#ifdef __cplusplus
+}
+#endif
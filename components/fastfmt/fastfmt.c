@@ -0,0 +1,348 @@
+// components/fastfmt/fastfmt.c
+#include "fastfmt.h"
+
+#include <math.h>
+#include <stdbool.h>
+#include <string.h>
+
+static const uint32_t k_pow10[10] = {
+    1u, 10u, 100u, 1000u, 10000u, 100000u, 1000000u, 10000000u, 100000000u, 1000000000u,
+};
+
+/* Exactly `width` digits of v (v < 10^width), no NUL. */
+static void put_digits(char *out, uint32_t v, int width)
+{
+    for (int i = width - 1; i >= 0; i--) {
+        out[i] = (char)('0' + v % 10u);
+        v /= 10u;
+    }
+}
+
+/* Significant digits of v, no NUL. Divisions stay 32-bit. */
+static size_t put_u32(char *out, uint32_t v)
+{
+    char tmp[10];
+    size_t n = 0;
+    do {
+        tmp[n++] = (char)('0' + v % 10u);
+        v /= 10u;
+    } while (v);
+
+    for (size_t i = 0; i < n; i++)
+        out[i] = tmp[n - 1 - i];
+    return n;
+}
+
+/* 64-bit values are cut into 9-digit chunks so only the split needs a 64-bit division. */
+static size_t put_u64(char *out, uint64_t v)
+{
+    if (v <= UINT32_MAX)
+        return put_u32(out, (uint32_t)v);
+
+    size_t n = put_u64(out, v / 1000000000u);
+    put_digits(out + n, (uint32_t)(v % 1000000000u), 9);
+    return n + 9;
+}
+
+static size_t put_str(char *out, const char *s)
+{
+    size_t n = strlen(s);
+    memcpy(out, s, n + 1);
+    return n;
+}
+
+size_t ff_u32(char *out, uint32_t v)
+{
+    size_t n = put_u32(out, v);
+    out[n] = '\0';
+    return n;
+}
+
+size_t ff_i64(char *out, int64_t v)
+{
+    size_t n = 0;
+    uint64_t a = (uint64_t)v;
+    if (v < 0) {
+        out[n++] = '-';
+        a = 0 - a;
+    }
+    n += put_u64(out + n, a);
+    out[n] = '\0';
+    return n;
+}
+
+size_t ff_u32_pad(char *out, uint32_t v, int width)
+{
+    int digits = 1;
+    while (digits < 10 && v >= k_pow10[digits])
+        digits++;
+    if (digits < width)
+        digits = width;
+
+    put_digits(out, v, digits);
+    out[digits] = '\0';
+    return (size_t)digits;
+}
+
+size_t ff_fixed(char *out, int64_t scaled, int decimals)
+{
+    if (decimals <= 0)
+        return ff_i64(out, scaled);
+    if (decimals > 9)
+        decimals = 9;
+
+    size_t n = 0;
+    uint64_t a = (uint64_t)scaled;
+    if (scaled < 0) {
+        out[n++] = '-';
+        a = 0 - a;
+    }
+
+    const uint32_t p = k_pow10[decimals];
+    n += put_u64(out + n, a / p);
+    out[n++] = '.';
+    put_digits(out + n, (uint32_t)(a % p), decimals);
+    n += (size_t)decimals;
+    out[n] = '\0';
+    return n;
+}
+
+static size_t put_non_finite(char *out, int is_nan, int negative)
+{
+    return put_str(out, is_nan ? "nan" : negative ? "-inf" : "inf");
+}
+
+/* Round s to an integer like printf does: to nearest, ties to even. */
+static int64_t round_even(double s)
+{
+    int64_t r = (int64_t)s;
+    double f = s - (double)r;
+    if (f > 0.5 || (f == 0.5 && (r & 1)))
+        r++;
+    else if (f < -0.5 || (f == -0.5 && (r & 1)))
+        r--;
+    return r;
+}
+
+#define SCALED_LIMIT 9000000000000000000ull     // 9e18, still an int64
+
+/*
+ * |v| * 10^decimals rounded like printf (to nearest, ties to even on the
+ * exact value), for finite v and decimals 0..7. The float is taken apart
+ * into its 24-bit mantissa and binary exponent, so the product is an
+ * integer below 2^48 and no floating-point arithmetic is done: the ESP32-S3
+ * FPU is single precision, and double would mean soft-float calls.
+ * Returns false when the result reaches SCALED_LIMIT.
+ */
+static bool scale_float(float v, int decimals, uint64_t *out)
+{
+    uint32_t bits;
+    memcpy(&bits, &v, sizeof(bits));
+    uint32_t man = bits & 0x7FFFFFu;
+    int exp = (int)((bits >> 23) & 0xFFu);
+    if (exp == 0)
+        exp = 1;            // subnormal: no implicit bit
+    else
+        man |= 0x800000u;
+
+    // |v| = man * 2^shift
+    const int shift = exp - 150;
+    const uint64_t m = (uint64_t)man * k_pow10[decimals];
+    if (shift >= 0) {
+        if (m != 0 && (shift >= 63 || m > (SCALED_LIMIT - 1) >> shift))
+            return false;
+        *out = m << shift;
+        return true;
+    }
+
+    // The bits shifted out decide the rounding; past 48 bits they are all of m, below a half
+    const int rs = -shift;
+    if (rs > 48) {
+        *out = 0;
+        return true;
+    }
+    uint64_t q = m >> rs;
+    const uint64_t rem = m - (q << rs);
+    const uint64_t half = 1ull << (rs - 1);
+    if (rem > half || (rem == half && (q & 1u)))
+        q++;
+    *out = q;
+    return true;
+}
+
+static size_t put_rounded(char *out, int64_t r, int negative, int decimals)
+{
+    // "-0.0" like printf for small negatives
+    if (r == 0 && negative) {
+        out[0] = '-';
+        return 1 + ff_fixed(out + 1, 0, decimals);
+    }
+    return ff_fixed(out, r, decimals);
+}
+
+size_t ff_float(char *out, float v, int decimals)
+{
+    if (!isfinite(v))
+        return put_non_finite(out, isnan(v), v < 0);
+    if (decimals < 0)
+        decimals = 0;
+    if (decimals > 7)
+        decimals = 7;
+
+    uint64_t r;
+    if (!scale_float(v, decimals, &r))
+        return put_non_finite(out, 0, v < 0);
+    return put_rounded(out, (v < 0) ? -(int64_t)r : (int64_t)r, v < 0, decimals);
+}
+
+size_t ff_double(char *out, double v, int decimals)
+{
+    if (!isfinite(v))
+        return put_non_finite(out, isnan(v), v < 0);
+    if (decimals < 0)
+        decimals = 0;
+    if (decimals > 9)
+        decimals = 9;
+
+    double s = v * (double)k_pow10[decimals];
+    if (fabs(s) >= 9.0e18)
+        return put_non_finite(out, 0, v < 0);
+    return put_rounded(out, round_even(s), v < 0, decimals);
+}
+
+/* Seconds (non-negative, below 4e8) to whole tenths, rounded like "%.1f". */
+static uint32_t tenths_of(float seconds)
+{
+    uint64_t t = 0;
+    scale_float(seconds, 1, &t);
+    return (uint32_t)t;
+}
+
+/* "MM:SS.t" from tenths of a second. */
+static size_t put_min_sec_tenths(char *out, uint32_t tenths)
+{
+    uint32_t min = tenths / 600u;
+    uint32_t rem = tenths % 600u;
+
+    size_t n = (min < 100u) ? (put_digits(out, min, 2), 2) : put_u32(out, min);
+    out[n++] = ':';
+    put_digits(out + n, rem / 10u, 2);
+    n += 2;
+    out[n++] = '.';
+    out[n++] = (char)('0' + rem % 10u);
+    out[n] = '\0';
+    return n;
+}
+
+size_t ff_pace(char *out, float seconds)
+{
+    if (!(seconds > 0.0f && seconds <= 3600.0f))
+        return put_str(out, "--:--.-");
+    return put_min_sec_tenths(out, tenths_of(seconds));
+}
+
+size_t ff_clock(char *out, float seconds)
+{
+    // Upper bound keeps the tenths inside 32 bits (about 11,000 hours)
+    if (!(seconds >= 0.0f && seconds < 4.0e8f))
+        return put_str(out, "--:--.-");
+
+    uint32_t tenths = tenths_of(seconds);
+    if (tenths < 36000u)
+        return put_min_sec_tenths(out, tenths);
+
+    uint32_t total = tenths / 10u;
+    size_t n = put_u32(out, total / 3600u);
+    out[n++] = ':';
+    put_digits(out + n, (total / 60u) % 60u, 2);
+    n += 2;
+    out[n++] = ':';
+    put_digits(out + n, total % 60u, 2);
+    n += 2;
+    out[n] = '\0';
+    return n;
+}
+
+size_t ff_hms_ms(char *out, int64_t us)
+{
+    uint64_t total_ms = (us > 0) ? (uint64_t)us / 1000u : 0;
+    uint32_t ms = (uint32_t)(total_ms % 1000u);
+    uint64_t total_s = total_ms / 1000u;
+    uint32_t sec_of_hour = (uint32_t)(total_s % 3600u);
+    uint64_t h = total_s / 3600u;
+
+    size_t n = (h < 100u) ? (put_digits(out, (uint32_t)h, 2), 2) : put_u64(out, h);
+    out[n++] = ':';
+    put_digits(out + n, sec_of_hour / 60u, 2);
+    n += 2;
+    out[n++] = ':';
+    put_digits(out + n, sec_of_hour % 60u, 2);
+    n += 2;
+    out[n++] = '.';
+    put_digits(out + n, ms, 3);
+    n += 3;
+    out[n] = '\0';
+    return n;
+}
+
+size_t ff_datetime(char *out, int64_t unix_s)
+{
+    int64_t days = unix_s / 86400;
+    int32_t sod = (int32_t)(unix_s % 86400);
+    if (sod < 0) {
+        sod += 86400;
+        days--;
+    }
+
+    // Civil date from a day count (H. Hinnant, "chrono-compatible low-level date algorithms")
+    int32_t z = (int32_t)days + 719468;
+    int32_t era = (z >= 0 ? z : z - 146096) / 146097;
+    uint32_t doe = (uint32_t)(z - era * 146097);
+    uint32_t yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+    uint32_t doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+    uint32_t mp = (5 * doy + 2) / 153;
+    uint32_t d = doy - (153 * mp + 2) / 5 + 1;
+    uint32_t m = (mp < 10) ? mp + 3 : mp - 9;
+    int32_t y = (int32_t)yoe + era * 400 + (m <= 2);
+
+    size_t n = 0;
+    if (y < 0) {
+        out[n++] = '-';
+        y = -y;
+    }
+    n += (y < 10000) ? (put_digits(out + n, (uint32_t)y, 4), 4) : put_u32(out + n, (uint32_t)y);
+    out[n++] = '-';
+    put_digits(out + n, m, 2);
+    n += 2;
+    out[n++] = '-';
+    put_digits(out + n, d, 2);
+    n += 2;
+    out[n++] = ' ';
+    put_digits(out + n, (uint32_t)sod / 3600u, 2);
+    n += 2;
+    out[n++] = ':';
+    put_digits(out + n, ((uint32_t)sod / 60u) % 60u, 2);
+    n += 2;
+    out[n++] = ':';
+    put_digits(out + n, (uint32_t)sod % 60u, 2);
+    n += 2;
+    out[n] = '\0';
+    return n;
+}
+
+size_t ff_datetime_ms(char *out, int64_t unix_us)
+{
+    int64_t s = unix_us / 1000000;
+    int32_t us = (int32_t)(unix_us % 1000000);
+    if (us < 0) {
+        us += 1000000;
+        s--;
+    }
+
+    size_t n = ff_datetime(out, s);
+    out[n++] = '.';
+    put_digits(out + n, (uint32_t)us / 1000u, 3);
+    n += 3;
+    out[n] = '\0';
+    return n;
+}
@@ -0,0 +1,69 @@
+// components/fastfmt/include/fastfmt.h
+#pragma once
+
+/*
+ * Number and time formatting for the log writers and the data page.
+ * Nothing here goes through printf: digits come from 32-bit integer
+ * division (64-bit values are split into 9-digit chunks first), and the
+ * stack use is a few bytes.
+ *
+ * ff_float(), ff_pace() and ff_clock() do no floating-point arithmetic:
+ * the float's mantissa and exponent are scaled as integers, so they round
+ * like printf (ties to even on the exact value) and print the same digits.
+ * ff_double() scales in double, which is soft-float on the ESP32-S3, and
+ * can differ in the last place when v * 10^decimals is not exact; it only
+ * prints GPS positions.
+ *
+ * Every function writes a NUL-terminated string at `out` and returns its
+ * length without the NUL. There is no length argument: size `out` with the
+ * FF_*_MAX constants (or more).
+ *
+ * Plain C only: the host tools link this file.
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define FF_INT_MAX      22      // int64 with sign, or a fixed-point value of the same range
+#define FF_PACE_MAX     8       // "MM:SS.t"
+#define FF_CLOCK_MAX    16      // "H:MM:SS" / "MM:SS.t"
+#define FF_HMS_MS_MAX   20      // "HH:MM:SS.mmm" (hours may grow)
+#define FF_DATETIME_MAX 24      // "YYYY-MM-DD HH:MM:SS.mmm"
+
+size_t ff_u32(char *out, uint32_t v);
+size_t ff_i64(char *out, int64_t v);
+
+/* v zero-padded to at least `width` digits. */
+size_t ff_u32_pad(char *out, uint32_t v, int width);
+
+/* scaled / 10^decimals with exactly `decimals` places: (-12345, 2) -> "-123.45". */
+size_t ff_fixed(char *out, int64_t scaled, int decimals);
+
+/* Like "%.*f" for decimals 0..7 (0..9 for double). "nan" / "inf" / "-inf"
+ * for non-finite values, and for values whose scaled form passes 9e18. */
+size_t ff_float(char *out, float v, int decimals);
+size_t ff_double(char *out, double v, int decimals);
+
+/* Pace "MM:SS.t", or "--:--.-" outside (0, 3600] s. */
+size_t ff_pace(char *out, float seconds);
+
+/* Data page clock: "MM:SS.t" under an hour, "H:MM:SS" from then on.
+ * "--:--.-" for negative, non-finite or absurdly large values. */
+size_t ff_clock(char *out, float seconds);
+
+/* "HH:MM:SS.mmm" from microseconds (negative counts as 0). */
+size_t ff_hms_ms(char *out, int64_t us);
+
+/* "YYYY-MM-DD HH:MM:SS" (proleptic Gregorian, no time zone applied). */
+size_t ff_datetime(char *out, int64_t unix_s);
+
+/* "YYYY-MM-DD HH:MM:SS.mmm" from microseconds. */
+size_t ff_datetime_ms(char *out, int64_t unix_us);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,451 @@
+// components/fit_writer/fit_writer.c
+#include "fit_writer.h"
+
+#include <math.h>
+#include <string.h>
+
+#define FIT_HEADER_SIZE     14
+#define FIT_PROTOCOL_VER    0x20        // 2.0
+#define FIT_PROFILE_VER     2132
+
+// Base types
+#define FIT_ENUM            0x00
+#define FIT_UINT8           0x02
+#define FIT_UINT16          0x84
+#define FIT_SINT32          0x85
+#define FIT_UINT32          0x86
+#define FIT_UINT32Z         0x8C
+
+// Global message numbers
+#define FIT_MESG_FILE_ID    0
+#define FIT_MESG_SESSION    18
+#define FIT_MESG_LAP        19
+#define FIT_MESG_RECORD     20
+#define FIT_MESG_EVENT      21
+#define FIT_MESG_ACTIVITY   34
+
+#define FIT_FIELD_TIMESTAMP 253
+#define FIT_FIELD_MSG_INDEX 254
+
+#define FIT_SPORT_ROWING    15
+#define FIT_INVALID_SINT32  0x7FFFFFFF
+
+typedef struct {
+    uint8_t num, size, type;
+} fit_field_t;
+
+/* Local message types; every definition is written once at begin. */
+enum { L_FILE_ID, L_EVENT, L_RECORD, L_LAP, L_SESSION, L_ACTIVITY };
+
+static const fit_field_t F_FILE_ID[] = {
+    { 0, 1, FIT_ENUM },             // type
+    { 1, 2, FIT_UINT16 },           // manufacturer
+    { 2, 2, FIT_UINT16 },           // product
+    { 3, 4, FIT_UINT32Z },          // serial_number
+    { 4, 4, FIT_UINT32 },           // time_created
+};
+
+static const fit_field_t F_EVENT[] = {
+    { FIT_FIELD_TIMESTAMP, 4, FIT_UINT32 },
+    { 0, 1, FIT_ENUM },             // event
+    { 1, 1, FIT_ENUM },             // event_type
+};
+
+static const fit_field_t F_RECORD[] = {
+    { FIT_FIELD_TIMESTAMP, 4, FIT_UINT32 },
+    { 0, 4, FIT_SINT32 },           // position_lat, semicircles
+    { 1, 4, FIT_SINT32 },           // position_long
+    { 5, 4, FIT_UINT32 },           // distance, 1/100 m
+    { 6, 2, FIT_UINT16 },           // speed, 1/1000 m/s
+    { 7, 2, FIT_UINT16 },           // power, W
+    { 4, 1, FIT_UINT8 },            // cadence, spm
+};
+
+static const fit_field_t F_LAP[] = {
+    { FIT_FIELD_TIMESTAMP, 4, FIT_UINT32 },
+    { 2, 4, FIT_UINT32 },           // start_time
+    { 7, 4, FIT_UINT32 },           // total_elapsed_time, ms
+    { 8, 4, FIT_UINT32 },           // total_timer_time, ms
+    { 9, 4, FIT_UINT32 },           // total_distance, 1/100 m
+    { 10, 4, FIT_UINT32 },          // total_cycles (strokes)
+    { FIT_FIELD_MSG_INDEX, 2, FIT_UINT16 },
+    { 13, 2, FIT_UINT16 },          // avg_speed
+    { 14, 2, FIT_UINT16 },          // max_speed
+    { 19, 2, FIT_UINT16 },          // avg_power
+    { 0, 1, FIT_ENUM },             // event = lap
+    { 1, 1, FIT_ENUM },             // event_type = stop
+    { 17, 1, FIT_UINT8 },           // avg_cadence
+    { 18, 1, FIT_UINT8 },           // max_cadence
+    { 24, 1, FIT_ENUM },            // lap_trigger
+    { 25, 1, FIT_ENUM },            // sport
+};
+
+static const fit_field_t F_SESSION[] = {
+    { FIT_FIELD_TIMESTAMP, 4, FIT_UINT32 },
+    { 2, 4, FIT_UINT32 },           // start_time
+    { 7, 4, FIT_UINT32 },           // total_elapsed_time
+    { 8, 4, FIT_UINT32 },           // total_timer_time
+    { 9, 4, FIT_UINT32 },           // total_distance
+    { 10, 4, FIT_UINT32 },          // total_cycles
+    { FIT_FIELD_MSG_INDEX, 2, FIT_UINT16 },
+    { 14, 2, FIT_UINT16 },          // avg_speed
+    { 15, 2, FIT_UINT16 },          // max_speed
+    { 20, 2, FIT_UINT16 },          // avg_power
+    { 25, 2, FIT_UINT16 },          // first_lap_index
+    { 26, 2, FIT_UINT16 },          // num_laps
+    { 0, 1, FIT_ENUM },             // event = session
+    { 1, 1, FIT_ENUM },             // event_type = stop
+    { 5, 1, FIT_ENUM },             // sport
+    { 6, 1, FIT_ENUM },             // sub_sport
+    { 18, 1, FIT_UINT8 },           // avg_cadence
+    { 19, 1, FIT_UINT8 },           // max_cadence
+    { 28, 1, FIT_ENUM },            // trigger = activity_end
+};
+
+static const fit_field_t F_ACTIVITY[] = {
+    { FIT_FIELD_TIMESTAMP, 4, FIT_UINT32 },
+    { 0, 4, FIT_UINT32 },           // total_timer_time
+    { 5, 4, FIT_UINT32 },           // local_timestamp
+    { 1, 2, FIT_UINT16 },           // num_sessions
+    { 2, 1, FIT_ENUM },             // type = manual
+    { 3, 1, FIT_ENUM },             // event = activity
+    { 4, 1, FIT_ENUM },             // event_type = stop
+};
+
+/* -------------------------------------------------------------------------- */
+/* CRC                                                                        */
+/* -------------------------------------------------------------------------- */
+
+uint16_t fit_crc16(uint16_t crc, const void *data, size_t len)
+{
+    static const uint16_t table[16] = {
+        0x0000, 0xCC01, 0xD801, 0x1400, 0xF001, 0x3C00, 0x2800, 0xE401,
+        0xA001, 0x6C00, 0x7800, 0xB401, 0x5000, 0x9C01, 0x8801, 0x4400,
+    };
+    const uint8_t *p = (const uint8_t *)data;
+    while (len--) {
+        uint8_t b = *p++;
+        uint16_t tmp = table[crc & 0xF];
+        crc = ((crc >> 4) & 0x0FFF) ^ tmp ^ table[b & 0xF];
+        tmp = table[crc & 0xF];
+        crc = ((crc >> 4) & 0x0FFF) ^ tmp ^ table[(b >> 4) & 0xF];
+    }
+    return crc;
+}
+
+static uint16_t gf2_times(const uint16_t mat[16], uint16_t vec)
+{
+    uint16_t sum = 0;
+    for (int i = 0; vec; vec >>= 1, i++)
+        if (vec & 1) sum ^= mat[i];
+    return sum;
+}
+
+/*
+ * CRC state after feeding `n` zero bytes from `crc`. With zero init and no
+ * final xor the CRC is linear, so crc(A || B) = shift(crc(A), |B|) ^ crc(B).
+ */
+static uint16_t crc_shift(uint16_t crc, uint32_t n)
+{
+    uint16_t m[16], sq[16];
+    const uint8_t zero = 0;
+    for (int i = 0; i < 16; i++)
+        m[i] = fit_crc16((uint16_t)(1u << i), &zero, 1);
+
+    while (n) {
+        if (n & 1) crc = gf2_times(m, crc);
+        n >>= 1;
+        if (n) {
+            for (int i = 0; i < 16; i++) sq[i] = gf2_times(m, m[i]);
+            memcpy(m, sq, sizeof(m));
+        }
+    }
+    return crc;
+}
+
+/* -------------------------------------------------------------------------- */
+/* Buffer                                                                     */
+/* -------------------------------------------------------------------------- */
+
+bool fit_writer_flush(fit_writer_t *w)
+{
+    if (w->len == 0 || w->error)
+        return !w->error;
+
+    w->crc = fit_crc16(w->crc, w->buf, w->len);
+    if (fwrite(w->buf, 1, w->len, w->f) != w->len)
+        w->error = true;
+    w->len = 0;
+    return !w->error;
+}
+
+static void emit(fit_writer_t *w, const uint8_t *msg, size_t n)
+{
+    if (w->len + n > sizeof(w->buf))
+        fit_writer_flush(w);
+    memcpy(w->buf + w->len, msg, n);
+    w->len += n;
+    w->data_size += (uint32_t)n;
+}
+
+static inline uint8_t *put_u8(uint8_t *p, uint8_t v)
+{
+    *p = v;
+    return p + 1;
+}
+
+static inline uint8_t *put_u16(uint8_t *p, uint16_t v)
+{
+    p[0] = (uint8_t)v;
+    p[1] = (uint8_t)(v >> 8);
+    return p + 2;
+}
+
+static inline uint8_t *put_u32(uint8_t *p, uint32_t v)
+{
+    p[0] = (uint8_t)v;
+    p[1] = (uint8_t)(v >> 8);
+    p[2] = (uint8_t)(v >> 16);
+    p[3] = (uint8_t)(v >> 24);
+    return p + 4;
+}
+
+static void define(fit_writer_t *w, uint8_t local, uint16_t global, const fit_field_t *f, uint8_t n)
+{
+    uint8_t msg[6 + 3 * 24];
+    uint8_t *p = msg;
+    p = put_u8(p, 0x40 | local);
+    p = put_u8(p, 0);                   // reserved
+    p = put_u8(p, 0);                   // little-endian
+    p = put_u16(p, global);
+    p = put_u8(p, n);
+    for (uint8_t i = 0; i < n; i++) {
+        p = put_u8(p, f[i].num);
+        p = put_u8(p, f[i].size);
+        p = put_u8(p, f[i].type);
+    }
+    emit(w, msg, (size_t)(p - msg));
+}
+
+#define DEFINE(w, local, global, f) define(w, local, global, f, (uint8_t)(sizeof(f) / sizeof(f[0])))
+
+/* -------------------------------------------------------------------------- */
+/* Values                                                                     */
+/* -------------------------------------------------------------------------- */
+
+static uint32_t fit_time(int64_t utc_us)
+{
+    return (uint32_t)(utc_us / 1000000 - FIT_EPOCH_UNIX);
+}
+
+static uint32_t scaled_u32(double v, double scale)
+{
+    return (v > 0) ? (uint32_t)lround(v * scale) : 0;
+}
+
+static uint16_t scaled_u16(double v, double scale)
+{
+    long x = (v > 0) ? lround(v * scale) : 0;
+    return (uint16_t)(x > 0xFFFE ? 0xFFFE : x);
+}
+
+static uint8_t clamp_u8(float v)
+{
+    long x = (v > 0) ? lroundf(v) : 0;
+    return (uint8_t)(x > 0xFE ? 0xFE : x);
+}
+
+static int32_t semicircles(double deg)
+{
+    return (int32_t)llround(deg * (2147483648.0 / 180.0));
+}
+
+static void totals_reset(fit_totals_t *t, int64_t start_utc_us, float start_distance_m)
+{
+    memset(t, 0, sizeof(*t));
+    t->start_utc_us = start_utc_us;
+    t->start_distance_m = start_distance_m;
+}
+
+static void totals_add(fit_totals_t *t, const fit_record_t *r)
+{
+    t->strokes++;
+    t->spm_sum += r->spm;
+    t->power_sum += r->power_w;
+    if (r->spm > t->max_spm) t->max_spm = r->spm;
+    if (r->speed_mps > t->max_speed_mps) t->max_speed_mps = r->speed_mps;
+}
+
+/* -------------------------------------------------------------------------- */
+/* Messages                                                                   */
+/* -------------------------------------------------------------------------- */
+
+static void put_event(fit_writer_t *w, int64_t utc_us, uint8_t event_type)
+{
+    uint8_t msg[7], *p = msg;
+    p = put_u8(p, L_EVENT);
+    p = put_u32(p, fit_time(utc_us));
+    p = put_u8(p, 0);                   // timer
+    p = put_u8(p, event_type);
+    emit(w, msg, (size_t)(p - msg));
+}
+
+bool fit_writer_begin(fit_writer_t *w, FILE *f, const fit_writer_config_t *cfg)
+{
+    memset(w, 0, sizeof(*w));
+    w->f = f;
+    w->cfg = *cfg;
+    w->last.utc_us = cfg->start_utc_us;
+    totals_reset(&w->lap, cfg->start_utc_us, 0);
+    totals_reset(&w->session, cfg->start_utc_us, 0);
+
+    // Placeholder; the real header is written by fit_writer_finish()
+    uint8_t hdr[FIT_HEADER_SIZE] = {0};
+    if (fwrite(hdr, 1, sizeof(hdr), f) != sizeof(hdr)) {
+        w->error = true;
+        return false;
+    }
+
+    DEFINE(w, L_FILE_ID, FIT_MESG_FILE_ID, F_FILE_ID);
+    DEFINE(w, L_EVENT, FIT_MESG_EVENT, F_EVENT);
+    DEFINE(w, L_RECORD, FIT_MESG_RECORD, F_RECORD);
+    DEFINE(w, L_LAP, FIT_MESG_LAP, F_LAP);
+    DEFINE(w, L_SESSION, FIT_MESG_SESSION, F_SESSION);
+    DEFINE(w, L_ACTIVITY, FIT_MESG_ACTIVITY, F_ACTIVITY);
+
+    uint8_t msg[16], *p = msg;
+    p = put_u8(p, L_FILE_ID);
+    p = put_u8(p, 4);                   // activity
+    p = put_u16(p, 255);                // development
+    p = put_u16(p, 1);
+    p = put_u32(p, cfg->serial ? cfg->serial : 1);
+    p = put_u32(p, fit_time(cfg->start_utc_us));
+    emit(w, msg, (size_t)(p - msg));
+
+    put_event(w, cfg->start_utc_us, 0); // start
+    return fit_writer_flush(w);
+}
+
+bool fit_writer_record(fit_writer_t *w, const fit_record_t *r)
+{
+    uint8_t msg[24], *p = msg;
+    p = put_u8(p, L_RECORD);
+    p = put_u32(p, fit_time(r->utc_us));
+    p = put_u32(p, (uint32_t)(r->has_fix ? semicircles(r->lat_deg) : FIT_INVALID_SINT32));
+    p = put_u32(p, (uint32_t)(r->has_fix ? semicircles(r->lon_deg) : FIT_INVALID_SINT32));
+    p = put_u32(p, scaled_u32(r->distance_m, 100.0));
+    p = put_u16(p, scaled_u16(r->speed_mps, 1000.0));
+    p = put_u16(p, scaled_u16(r->power_w, 1.0));
+    p = put_u8(p, clamp_u8(r->spm));
+    emit(w, msg, (size_t)(p - msg));
+
+    w->last = *r;
+    totals_add(&w->lap, r);
+    totals_add(&w->session, r);
+    return !w->error;
+}
+
+bool fit_writer_lap(fit_writer_t *w, fit_lap_trigger_t trigger)
+{
+    const fit_totals_t *t = &w->lap;
+    if (t->strokes == 0)
+        return !w->error;
+
+    double secs = (double)(w->last.utc_us - t->start_utc_us) * 1e-6;
+    double dist = w->last.distance_m - t->start_distance_m;
+    uint32_t ms = scaled_u32(secs, 1000.0);
+
+    uint8_t msg[48], *p = msg;
+    p = put_u8(p, L_LAP);
+    p = put_u32(p, fit_time(w->last.utc_us));
+    p = put_u32(p, fit_time(t->start_utc_us));
+    p = put_u32(p, ms);
+    p = put_u32(p, ms);
+    p = put_u32(p, scaled_u32(dist, 100.0));
+    p = put_u32(p, t->strokes);
+    p = put_u16(p, w->n_laps);
+    p = put_u16(p, scaled_u16(secs > 0 ? dist / secs : 0, 1000.0));
+    p = put_u16(p, scaled_u16(t->max_speed_mps, 1000.0));
+    p = put_u16(p, scaled_u16(t->power_sum / t->strokes, 1.0));
+    p = put_u8(p, 9);                   // lap
+    p = put_u8(p, 1);                   // stop
+    p = put_u8(p, clamp_u8(t->spm_sum / t->strokes));
+    p = put_u8(p, clamp_u8(t->max_spm));
+    p = put_u8(p, (uint8_t)trigger);
+    p = put_u8(p, FIT_SPORT_ROWING);
+    emit(w, msg, (size_t)(p - msg));
+
+    w->n_laps++;
+    totals_reset(&w->lap, w->last.utc_us, w->last.distance_m);
+    return !w->error;
+}
+
+bool fit_writer_finish(fit_writer_t *w)
+{
+    fit_writer_lap(w, FIT_LAP_TRIGGER_SESSION_END);
+    put_event(w, w->last.utc_us, 4);    // stop_all
+
+    const fit_totals_t *t = &w->session;
+    double secs = (double)(w->last.utc_us - t->start_utc_us) * 1e-6;
+    double dist = w->last.distance_m;
+    uint32_t ms = scaled_u32(secs, 1000.0);
+    uint32_t end = fit_time(w->last.utc_us);
+
+    uint8_t msg[48], *p = msg;
+    p = put_u8(p, L_SESSION);
+    p = put_u32(p, end);
+    p = put_u32(p, fit_time(t->start_utc_us));
+    p = put_u32(p, ms);
+    p = put_u32(p, ms);
+    p = put_u32(p, scaled_u32(dist, 100.0));
+    p = put_u32(p, t->strokes);
+    p = put_u16(p, 0);
+    p = put_u16(p, scaled_u16(secs > 0 ? dist / secs : 0, 1000.0));
+    p = put_u16(p, scaled_u16(t->max_speed_mps, 1000.0));
+    p = put_u16(p, scaled_u16(t->strokes ? t->power_sum / t->strokes : 0, 1.0));
+    p = put_u16(p, 0);                  // first_lap_index
+    p = put_u16(p, w->n_laps);
+    p = put_u8(p, 8);                   // session
+    p = put_u8(p, 1);                   // stop
+    p = put_u8(p, FIT_SPORT_ROWING);
+    p = put_u8(p, w->cfg.sub_sport);
+    p = put_u8(p, clamp_u8(t->strokes ? t->spm_sum / t->strokes : 0));
+    p = put_u8(p, clamp_u8(t->max_spm));
+    p = put_u8(p, 0);                   // activity_end
+    emit(w, msg, (size_t)(p - msg));
+
+    p = msg;
+    p = put_u8(p, L_ACTIVITY);
+    p = put_u32(p, end);
+    p = put_u32(p, ms);
+    p = put_u32(p, end + (uint32_t)w->cfg.utc_offset_s);
+    p = put_u16(p, 1);
+    p = put_u8(p, 0);                   // manual
+    p = put_u8(p, 26);                  // activity
+    p = put_u8(p, 1);                   // stop
+    emit(w, msg, (size_t)(p - msg));
+
+    if (!fit_writer_flush(w))
+        return false;
+
+    // Header now that the data size is known; its CRC goes in front of the running one
+    uint8_t hdr[FIT_HEADER_SIZE], *h = hdr;
+    h = put_u8(h, FIT_HEADER_SIZE);
+    h = put_u8(h, FIT_PROTOCOL_VER);
+    h = put_u16(h, FIT_PROFILE_VER);
+    h = put_u32(h, w->data_size);
+    memcpy(h, ".FIT", 4);
+    put_u16(h + 4, fit_crc16(0, hdr, 12));
+
+    uint16_t file_crc = crc_shift(fit_crc16(0, hdr, sizeof(hdr)), w->data_size) ^ w->crc;
+    uint8_t tail[2];
+    put_u16(tail, file_crc);
+
+    long end_off = (long)(FIT_HEADER_SIZE + w->data_size);
+    if (fseek(w->f, end_off, SEEK_SET) != 0 || fwrite(tail, 1, sizeof(tail), w->f) != sizeof(tail) ||
+        fseek(w->f, 0, SEEK_SET) != 0 || fwrite(hdr, 1, sizeof(hdr), w->f) != sizeof(hdr) ||
+        fseek(w->f, end_off + (long)sizeof(tail), SEEK_SET) != 0) {
+        w->error = true;
+    }
+    return !w->error;
+}
@@ -0,0 +1,119 @@
+// components/fit_writer/include/fit_writer.h
+#pragma once
+
+/*
+ * Streaming FIT activity encoder.
+ *
+ * Messages are encoded into a small fixed buffer inside fit_writer_t and
+ * written to the FILE when it fills, so the file is never held in RAM. All
+ * definition messages go out at begin; after that a stroke costs one
+ * 24-byte record message and a CRC update over it.
+ *
+ * The file CRC runs over the data as it is written. The header (which holds
+ * the data size) is only known at the end, so fit_writer_finish() rewrites
+ * it in place and folds its CRC in front of the running one with a CRC
+ * shift (O(log size), no read-back).
+ *
+ *   begin:   header placeholder, definitions, file_id, timer start
+ *   record:  one per stroke; also accumulates lap and session totals
+ *   lap:     closes the current lap
+ *   finish:  last lap, timer stop, session, activity, CRC, header
+ *
+ * A file that was never finished has a zero data size in its header.
+ * Session recovery rebuilds it from a binary stroke log
+ * (activity_log_export_fit) and deletes it otherwise.
+ *
+ * Plain C only: the host tools link this file.
+ */
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#ifndef FIT_WRITER_BUF_SIZE
+#define FIT_WRITER_BUF_SIZE     256
+#endif
+
+#define FIT_EPOCH_UNIX          631065600LL     // 1989-12-31T00:00:00Z
+
+typedef enum {
+    FIT_LAP_TRIGGER_MANUAL      = 0,
+    FIT_LAP_TRIGGER_TIME        = 1,
+    FIT_LAP_TRIGGER_DISTANCE    = 2,
+    FIT_LAP_TRIGGER_SESSION_END = 7,
+} fit_lap_trigger_t;
+
+typedef enum {
+    FIT_SUB_SPORT_GENERIC       = 0,    // on the water
+    FIT_SUB_SPORT_INDOOR_ROWING = 14,
+} fit_sub_sport_t;
+
+typedef struct {
+    uint32_t serial;            // file_id.serial_number; the session id works
+    int64_t  start_utc_us;      // session start (timer start event, file time_created)
+    int32_t  utc_offset_s;      // for activity.local_timestamp
+    uint8_t  sub_sport;         // fit_sub_sport_t
+} fit_writer_config_t;
+
+/* One stroke. */
+typedef struct {
+    int64_t utc_us;
+    float   distance_m;         // cumulative
+    float   speed_mps;
+    float   power_w;
+    float   spm;
+    bool    has_fix;
+    double  lat_deg;
+    double  lon_deg;
+} fit_record_t;
+
+/* Running totals for a lap or the whole session. */
+typedef struct {
+    int64_t  start_utc_us;
+    float    start_distance_m;
+    uint32_t strokes;
+    float    spm_sum;
+    float    max_spm;
+    float    power_sum;
+    float    max_speed_mps;
+} fit_totals_t;
+
+typedef struct {
+    FILE    *f;
+    uint8_t  buf[FIT_WRITER_BUF_SIZE];
+    size_t   len;               // bytes pending in buf
+    uint32_t data_size;         // bytes after the header, including pending ones
+    uint16_t crc;               // CRC of the data bytes so far (header excluded)
+    bool     error;
+
+    fit_writer_config_t cfg;
+    fit_record_t last;          // most recent record
+    fit_totals_t lap;
+    fit_totals_t session;
+    uint16_t n_laps;
+} fit_writer_t;
+
+/* Start a file on `f` (opened "wb", positioned at 0). Returns false on I/O error. */
+bool fit_writer_begin(fit_writer_t *w, FILE *f, const fit_writer_config_t *cfg);
+
+bool fit_writer_record(fit_writer_t *w, const fit_record_t *rec);
+
+/* Close the current lap at the last record. No-op if it has no strokes. */
+bool fit_writer_lap(fit_writer_t *w, fit_lap_trigger_t trigger);
+
+/* Push pending bytes to the FILE (the caller fflush()es/fsync()s it). */
+bool fit_writer_flush(fit_writer_t *w);
+
+/* Write the closing messages, CRC and final header. Does not close the FILE. */
+bool fit_writer_finish(fit_writer_t *w);
+
+uint16_t fit_crc16(uint16_t crc, const void *data, size_t len);
+
+#ifdef __cplusplus
+}
+#endif
@@ -22,6 +22,7 @@ static gps_gtu8_cb_t s_cb;
 static void *s_cb_user;
 
 static int s_uart = -1;
+static int64_t s_byte_us = 1042;   // one UART character (10 bits) at 9600 baud
 
 static bool nmea_checksum_ok(const char *line)
 {
@@ -70,7 +71,7 @@ static double dm_to_deg(const char *dm)
     return (double)deg + minutes / 60.0;
 }
 
-static bool parse_hhmmss(const char *s, int *hh, int *mm, int *ss)
+static bool parse_hhmmss(const char *s, int *hh, int *mm, int *ss, int *ms)
 {
     if (!s || strlen(s) < 6) return false;
     char buf[3] = {0};
@@ -78,6 +79,16 @@ static bool parse_hhmmss(const char *s, int *hh, int *mm, int *ss)
     buf[0] = s[0]; buf[1] = s[1]; *hh = atoi(buf);
     buf[0] = s[2]; buf[1] = s[3]; *mm = atoi(buf);
     buf[0] = s[4]; buf[1] = s[5]; *ss = atoi(buf);
+
+    // Optional fraction: ".s", ".ss" or ".sss"
+    *ms = 0;
+    if (s[6] == '.') {
+        int scale = 100;
+        for (const char *p = s + 7; *p >= '0' && *p <= '9' && scale > 0; p++) {
+            *ms += (*p - '0') * scale;
+            scale /= 10;
+        }
+    }
     return true;
 }
 
@@ -99,12 +110,13 @@ static void handle_rmc(char *fields[], int n, gps_fix_t *fix)
     if (n < 10) return;
 
     // time
-    int hh=0, mm=0, ss=0;
-    if (parse_hhmmss(fields[1], &hh, &mm, &ss)) {
+    int hh=0, mm=0, ss=0, ms=0;
+    if (parse_hhmmss(fields[1], &hh, &mm, &ss, &ms)) {
         fix->valid_time = true;
         fix->utc_tm.tm_hour = hh;
         fix->utc_tm.tm_min  = mm;
         fix->utc_tm.tm_sec  = ss;
+        fix->utc_ms = ms;
     }
 
     // status
@@ -158,7 +170,7 @@ static void handle_gga(char *fields[], int n, gps_fix_t *fix)
     if (fields[8] && fields[8][0]) fix->hdop = (float)strtod(fields[8], NULL);
 }
 
-static void parse_line(const char *line_in)
+static void parse_line(const char *line_in, int64_t line_start_us)
 {
     if (!line_in || line_in[0] != '$') return;
     if (!nmea_checksum_ok(line_in)) return;
@@ -172,7 +184,7 @@ static void parse_line(const char *line_in)
     upd.sats = -1;
     upd.fix_quality = -1;
     memset(&upd.utc_tm, 0, sizeof(upd.utc_tm));
-    upd.rx_time_us = esp_timer_get_time();
+    upd.rx_time_us = line_start_us;
 
     // Copy to mutable buffer
     char buf[128];
@@ -228,6 +240,8 @@ static void parse_line(const char *line_in)
         s_latest.utc_tm.tm_hour = upd.utc_tm.tm_hour;
         s_latest.utc_tm.tm_min  = upd.utc_tm.tm_min;
         s_latest.utc_tm.tm_sec  = upd.utc_tm.tm_sec;
+        s_latest.utc_ms = upd.utc_ms;
+        s_latest.utc_rx_time_us = upd.rx_time_us;
     }
     if (upd.valid_date) {
         s_latest.utc_tm.tm_year = upd.utc_tm.tm_year;
@@ -259,16 +273,24 @@ static void gps_task(void *arg)
     uint8_t rx[256];
     char line[160];
     int line_len = 0;
+    int64_t line_start_us = 0;
 
     while (1) {
-        int n = uart_read_bytes(s_uart, rx, sizeof(rx), pdMS_TO_TICKS(200));
+        // Short timeout: uart_read_bytes() returns on timeout with whatever
+        // arrived, which keeps the sentence timestamps within ~20 ms.
+        int n = uart_read_bytes(s_uart, rx, sizeof(rx), pdMS_TO_TICKS(20));
         if (n <= 0) continue;
+        int64_t chunk_end_us = esp_timer_get_time();
 
         for (int i = 0; i < n; i++) {
             char c = (char)rx[i];
+            if (c == '$') {
+                // Back-date to when this byte came off the wire
+                line_start_us = chunk_end_us - (int64_t)(n - i) * s_byte_us;
+            }
             if (c == '\n') {
                 line[line_len] = '\0';
-                if (line_len > 0) parse_line(line);
+                if (line_len > 0) parse_line(line, line_start_us);
                 line_len = 0;
             } else if (c != '\r') {
                 if (line_len < (int)sizeof(line) - 1) {
@@ -301,6 +323,7 @@ esp_err_t gps_gtu8_init(const gps_gtu8_config_t *cfg)
     xSemaphoreGive(s_lock);
 
     s_uart = cfg->uart_num;
+    if (cfg->baud > 0) s_byte_us = 10000000LL / cfg->baud;
 
     uart_config_t uc = {
         .baud_rate = cfg->baud,
@@ -36,9 +36,12 @@ typedef struct {
 
     // Time from GNSS (UTC)
     struct tm utc_tm;    // valid when valid_time && valid_date
+    int    utc_ms;       // fractional part of hhmmss.sss, 0 if not sent
 
-    // Local timestamp when this fix was parsed
+    // Local timestamp (esp_timer) of the '$' that started the sentence
     int64_t rx_time_us;
+    // rx_time_us of the sentence that last updated utc_tm (time discipline)
+    int64_t utc_rx_time_us;
 } gps_fix_t;
 
 typedef void (*gps_gtu8_cb_t)(const gps_fix_t *fix, void *user);
@@ -33,4 +33,7 @@ esp_err_t qmi8658_read_gyro(qmi8658_handle_t *imu,
 /* Single burst read for best timing */
 esp_err_t qmi8658_read_accel_gyro(qmi8658_handle_t *imu,
                                  float *ax_mps2, float *ay_mps2, float *az_mps2,
-                                 float *gx_rads, float *gy_rads, float *gz_rads);
\ No newline at end of file
+                                 float *gx_rads, float *gy_rads, float *gz_rads);
+
+/* Raw register counts {ax, ay, az, gx, gy, gz}; scale with accel_scale/gyro_scale */
+esp_err_t qmi8658_read_raw(qmi8658_handle_t *imu, int16_t raw[6]);
@@ -106,11 +106,9 @@ esp_err_t qmi8658_read_gyro(qmi8658_handle_t *imu,
     return qmi8658_read_accel_gyro(imu, NULL, NULL, NULL, gx_rads, gy_rads, gz_rads);
 }
 
-esp_err_t qmi8658_read_accel_gyro(qmi8658_handle_t *imu,
-                                  float *ax_mps2, float *ay_mps2, float *az_mps2,
-                                  float *gx_rads, float *gy_rads, float *gz_rads)
+esp_err_t qmi8658_read_raw(qmi8658_handle_t *imu, int16_t raw[6])
 {
-    if (!imu)
+    if (!imu || !raw)
         return ESP_ERR_INVALID_ARG;
 
     uint8_t buf[12];
@@ -118,12 +116,27 @@ esp_err_t qmi8658_read_accel_gyro(qmi8658_handle_t *imu,
     if (err != ESP_OK)
         return err;
 
-    int16_t raw_ax = (int16_t)((buf[1] << 8) | buf[0]);
-    int16_t raw_ay = (int16_t)((buf[3] << 8) | buf[2]);
-    int16_t raw_az = (int16_t)((buf[5] << 8) | buf[4]);
-    int16_t raw_gx = (int16_t)((buf[7] << 8) | buf[6]);
-    int16_t raw_gy = (int16_t)((buf[9] << 8) | buf[8]);
-    int16_t raw_gz = (int16_t)((buf[11] << 8) | buf[10]);
+    for (int i = 0; i < 6; i++)
+        raw[i] = (int16_t)((buf[2 * i + 1] << 8) | buf[2 * i]);
+
+    return ESP_OK;
+}
+
+esp_err_t qmi8658_read_accel_gyro(qmi8658_handle_t *imu,
+                                  float *ax_mps2, float *ay_mps2, float *az_mps2,
+                                  float *gx_rads, float *gy_rads, float *gz_rads)
+{
+    int16_t raw[6];
+    esp_err_t err = qmi8658_read_raw(imu, raw);
+    if (err != ESP_OK)
+        return err;
+
+    int16_t raw_ax = raw[0];
+    int16_t raw_ay = raw[1];
+    int16_t raw_az = raw[2];
+    int16_t raw_gx = raw[3];
+    int16_t raw_gy = raw[4];
+    int16_t raw_gz = raw[5];
 
     if (ax_mps2)
         *ax_mps2 = raw_ax * imu->accel_scale;
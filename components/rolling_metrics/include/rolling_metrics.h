@@ -0,0 +1,87 @@
+// components/rolling_metrics/include/rolling_metrics.h
+#pragma once
+
+/*
+ * Rolling windows over the strokes of a session: "pace over the last
+ * 500 m", "rate over the last 10 strokes", "pace over the last minute".
+ *
+ * Every catch is pushed once, as (session time, cumulative distance,
+ * stroke power), into a ring of the most recent strokes that all windows
+ * share. A window is just the index of its oldest stroke plus a running
+ * power sum over the strokes after it: a push moves each start forward
+ * past the strokes that fell out, so it costs amortised O(1) per window
+ * and memory is the ring, whatever the spans. Distance and time windows
+ * place their far edge between two strokes by interpolation, so a 500 m
+ * window covers exactly 500 m.
+ *
+ * Power sums are int64 milliwatts: strokes enter and leave a window as the
+ * same integer, so long sessions do not drift.
+ *
+ * Plain C only: the host tools link this file.
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define RM_MAX_WINDOWS 4
+
+typedef enum {
+    RM_WINDOW_STROKES = 0,      // span in strokes
+    RM_WINDOW_DISTANCE,         // span in meters
+    RM_WINDOW_TIME,             // span in seconds
+} rm_window_kind_t;
+
+typedef struct {
+    int64_t t_us;               // session time of the catch
+    float   dist_m;             // cumulative distance at the catch
+    int32_t power_mw;           // the stroke's power
+} rm_sample_t;
+
+typedef struct {
+    rm_window_kind_t kind;
+    float    span;
+    uint32_t start;             // seq of the oldest stroke the window reads
+    int64_t  power_sum_mw;      // strokes start+1 .. newest
+} rm_window_t;
+
+typedef struct {
+    rm_sample_t *hist;
+    uint32_t mask;              // capacity - 1 (capacity is a power of two)
+    uint32_t next;              // seq of the next push (= strokes pushed)
+    uint8_t  n_windows;
+    rm_window_t win[RM_MAX_WINDOWS];
+} rolling_metrics_t;
+
+typedef struct {
+    bool     full;              // the window covers its whole span
+    uint32_t strokes;           // stroke intervals inside the window
+    float    time_s;            // time covered
+    float    dist_m;            // distance covered
+    float    pace_500m_s;       // 0 without distance
+    float    speed_mps;
+    float    spm;               // strokes per minute over the window's strokes
+    float    power_w;           // mean power of those strokes
+} rm_result_t;
+
+/* `capacity` must be a power of two; `hist` holds that many samples. */
+void rolling_metrics_init(rolling_metrics_t *rm, rm_sample_t *hist, uint32_t capacity);
+
+/* Returns the window's index, or -1 when RM_MAX_WINDOWS are in use or span <= 0. */
+int rolling_metrics_add_window(rolling_metrics_t *rm, rm_window_kind_t kind, float span);
+
+/* Forget all strokes (new session); the windows stay. */
+void rolling_metrics_reset(rolling_metrics_t *rm);
+
+/* One catch. Session time and distance must not go backwards. */
+void rolling_metrics_push(rolling_metrics_t *rm, int64_t t_us, float dist_m, float power_w);
+
+/* False until the window holds two strokes. */
+bool rolling_metrics_get(const rolling_metrics_t *rm, int window, rm_result_t *out);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,160 @@
+// components/rolling_metrics/rolling_metrics.c
+#include "rolling_metrics.h"
+
+#include <string.h>
+
+static int32_t to_mw(float power_w)
+{
+    if (!(power_w > 0.0f))
+        return 0;
+    if (power_w >= 2.0e6f)
+        return INT32_MAX;
+    return (int32_t)(power_w * 1000.0f + 0.5f);
+}
+
+static inline const rm_sample_t *at(const rolling_metrics_t *rm, uint32_t seq)
+{
+    return &rm->hist[seq & rm->mask];
+}
+
+void rolling_metrics_init(rolling_metrics_t *rm, rm_sample_t *hist, uint32_t capacity)
+{
+    memset(rm, 0, sizeof(*rm));
+    rm->hist = hist;
+    rm->mask = capacity - 1;
+}
+
+int rolling_metrics_add_window(rolling_metrics_t *rm, rm_window_kind_t kind, float span)
+{
+    if (rm->n_windows >= RM_MAX_WINDOWS || !(span > 0.0f))
+        return -1;
+    rm->win[rm->n_windows] = (rm_window_t){
+        .kind = kind,
+        .span = span,
+        .start = rm->next ? rm->next - 1 : 0,
+    };
+    return rm->n_windows++;
+}
+
+void rolling_metrics_reset(rolling_metrics_t *rm)
+{
+    rm->next = 0;
+    for (int i = 0; i < rm->n_windows; i++) {
+        rm->win[i].start = 0;
+        rm->win[i].power_sum_mw = 0;
+    }
+}
+
+/* Drop the window's oldest stroke. */
+static inline void advance(const rolling_metrics_t *rm, rm_window_t *w)
+{
+    w->start++;
+    w->power_sum_mw -= at(rm, w->start)->power_mw;
+}
+
+/* Whether the window still covers its span without its oldest stroke. */
+static bool can_advance(const rolling_metrics_t *rm, const rm_window_t *w, const rm_sample_t *newest)
+{
+    const uint32_t last = rm->next - 1;
+    if (w->start >= last)
+        return false;
+
+    switch (w->kind) {
+    case RM_WINDOW_STROKES:
+        return (float)(last - w->start) > w->span;
+    case RM_WINDOW_DISTANCE:
+        return newest->dist_m - at(rm, w->start + 1)->dist_m >= w->span;
+    case RM_WINDOW_TIME:
+        return (float)(newest->t_us - at(rm, w->start + 1)->t_us) * 1e-6f >= w->span;
+    }
+    return false;
+}
+
+void rolling_metrics_push(rolling_metrics_t *rm, int64_t t_us, float dist_m, float power_w)
+{
+    const uint32_t seq = rm->next;
+    const uint32_t cap = rm->mask + 1;
+
+    // The slot about to be reused may still be some window's start
+    for (int i = 0; i < rm->n_windows; i++) {
+        rm_window_t *w = &rm->win[i];
+        while (seq - w->start >= cap)
+            advance(rm, w);
+    }
+
+    rm_sample_t *s = &rm->hist[seq & rm->mask];
+    s->t_us = t_us;
+    s->dist_m = dist_m;
+    s->power_mw = to_mw(power_w);
+    rm->next = seq + 1;
+
+    for (int i = 0; i < rm->n_windows; i++) {
+        rm_window_t *w = &rm->win[i];
+        if (seq == 0) {
+            w->start = 0;
+            w->power_sum_mw = 0;
+            continue;
+        }
+        w->power_sum_mw += s->power_mw;
+        while (can_advance(rm, w, s))
+            advance(rm, w);
+    }
+}
+
+bool rolling_metrics_get(const rolling_metrics_t *rm, int window, rm_result_t *out)
+{
+    memset(out, 0, sizeof(*out));
+    if (window < 0 || window >= rm->n_windows || rm->next == 0)
+        return false;
+
+    const rm_window_t *w = &rm->win[window];
+    const uint32_t last = rm->next - 1;
+    if (w->start >= last)
+        return false;
+
+    const rm_sample_t *a = at(rm, w->start);
+    const rm_sample_t *b = at(rm, w->start + 1);
+    const rm_sample_t *z = at(rm, last);
+
+    float t_s = (float)(z->t_us - a->t_us) * 1e-6f;
+    float d_m = z->dist_m - a->dist_m;
+    bool full = false;
+
+    switch (w->kind) {
+    case RM_WINDOW_STROKES:
+        full = (float)(last - w->start) >= w->span;
+        break;
+    case RM_WINDOW_DISTANCE:
+        if (d_m >= w->span) {
+            // Far edge between strokes a and b: time at which the boat was span meters back
+            float seg = b->dist_m - a->dist_m;
+            float frac = (seg > 0.0f) ? (d_m - w->span) / seg : 0.0f;
+            t_s -= frac * (float)(b->t_us - a->t_us) * 1e-6f;
+            d_m = w->span;
+            full = true;
+        }
+        break;
+    case RM_WINDOW_TIME:
+        if (t_s >= w->span) {
+            float seg = (float)(b->t_us - a->t_us) * 1e-6f;
+            float frac = (seg > 0.0f) ? (t_s - w->span) / seg : 0.0f;
+            d_m -= frac * (b->dist_m - a->dist_m);
+            t_s = w->span;
+            full = true;
+        }
+        break;
+    }
+
+    const uint32_t strokes = last - w->start;
+    const float stroke_span_s = (float)(z->t_us - a->t_us) * 1e-6f;
+
+    out->full = full;
+    out->strokes = strokes;
+    out->time_s = t_s;
+    out->dist_m = d_m;
+    out->speed_mps = (t_s > 0.0f) ? d_m / t_s : 0.0f;
+    out->pace_500m_s = (d_m > 0.0f) ? t_s * 500.0f / d_m : 0.0f;
+    out->spm = (stroke_span_s > 0.0f) ? (float)strokes * 60.0f / stroke_span_s : 0.0f;
+    out->power_w = (float)((double)w->power_sum_mw / (double)strokes) * 1e-3f;
+    return true;
+}
@@ -0,0 +1,156 @@
+// components/sd_mmc_helper/include/sd_io_stats.h
+#pragma once
+
+/*
+ * SD card write latency, as the writers see it.
+ *
+ * The log writers call the sd_io_* wrappers below instead of fopen /
+ * fwrite / fflush / fsync / fclose; the raw capture and the session
+ * journal, which write through descriptors, time their write() and
+ * fsync() with sd_io_begin() / sd_io_end(). Each call is timed and lands in a
+ * per-operation histogram (power-of-two millisecond buckets), a count of
+ * slow operations, the slowest few with their time and size, and the bytes
+ * written. From those a running health class says whether the card keeps
+ * up. Cards stall for 50-300 ms now and then (cluster allocation, wear
+ * levelling) and that is fine, so slow operations and stalls are also
+ * kept as counts that halve every SD_IO_HALF_LIFE_S, and the class is
+ * taken from those: a card that stalled for a second or more within the
+ * last minute or so, that keeps taking longer than SD_IO_SLOW_MS more
+ * often than about every 10 s, or that writes below SD_IO_MIN_BPS is SLOW;
+ * one that does so more often than about every 35 s is FAIR.
+ *
+ * A buffered fwrite() that only fills the stdio buffer takes microseconds;
+ * the card's time shows up in the call that spills the buffer, which is
+ * the latency the writer actually waits for.
+ *
+ * The counters are global, safe to update from any task, and cover the
+ * current session: activity_log_start() resets them.
+ */
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define SD_IO_HIST_BUCKETS  12      // <1 ms, 1-2, 2-4, ... 512-1024, >=1024 ms
+#define SD_IO_OUTLIERS      8       // slowest operations kept (of those >= 1 ms)
+#define SD_IO_SLOW_MS       250     // an operation this long counts as slow
+#define SD_IO_STALL_MS      1000    // one this long makes the card SLOW on its own
+#define SD_IO_MIN_BPS       (200u * 1024u)  // sustained write rate below this is SLOW
+#define SD_IO_MIN_OPS       16      // fewer operations than this: UNKNOWN
+#define SD_IO_HALF_LIFE_S   60      // recent_slow / recent_stalls halve this often
+#define SD_IO_RECENT_ONE    4096u   // one operation in recent_slow / recent_stalls
+#define SD_IO_FAIR_RECENT   3       // recent slow operations that make the card FAIR
+#define SD_IO_SLOW_RECENT   8       // ... and SLOW
+
+typedef enum {
+    SD_IO_OPEN = 0,
+    SD_IO_WRITE,
+    SD_IO_FLUSH,
+    SD_IO_SYNC,
+    SD_IO_CLOSE,
+    SD_IO_OP_COUNT,
+} sd_io_op_t;
+
+typedef enum {
+    SD_HEALTH_UNKNOWN = 0,      // not enough writes yet
+    SD_HEALTH_GOOD,             // nothing slow, or an occasional stall
+    SD_HEALTH_FAIR,             // slow operations every half minute or so
+    SD_HEALTH_SLOW,             // recent long stalls, frequent slow operations or low throughput
+    SD_HEALTH_FAILING,          // operations returned errors
+} sd_health_t;
+
+typedef struct {
+    uint32_t count;
+    uint32_t errors;
+    uint64_t total_us;
+    uint32_t max_us;
+    uint32_t hist[SD_IO_HIST_BUCKETS];
+} sd_io_op_stats_t;
+
+typedef struct {
+    uint8_t  op;                // sd_io_op_t
+    uint32_t us;
+    uint32_t bytes;
+    int64_t  at_us;             // esp_timer time the operation started
+} sd_io_outlier_t;
+
+typedef struct {
+    sd_io_op_stats_t op[SD_IO_OP_COUNT];
+    uint64_t bytes;             // handed to write operations
+    uint64_t busy_us;           // time spent in write, flush and sync
+    uint32_t slow;              // operations >= SD_IO_SLOW_MS
+    uint32_t recent_slow;       // the same, decayed (SD_IO_RECENT_ONE each)
+    uint32_t recent_stalls;     // operations >= SD_IO_STALL_MS, decayed
+    int64_t  recent_us;         // esp_timer time they are decayed to
+    uint32_t max_us;            // slowest operation of any kind
+    uint8_t  n_outliers;
+    sd_io_outlier_t outliers[SD_IO_OUTLIERS];   // slowest first
+    int64_t  since_us;          // esp_timer time of the last reset
+} sd_io_stats_t;
+
+/* Account one operation of `us` microseconds in `s` (not locked: for a
+ * private struct, e.g. a card probe). */
+void sd_io_stats_add(sd_io_stats_t *s, sd_io_op_t op, uint32_t us, size_t bytes, bool ok, int64_t at_us);
+
+/* Decay recent_slow / recent_stalls in `s` to `now_us`. */
+void sd_io_stats_decay(sd_io_stats_t *s, int64_t now_us);
+
+/* The global counters; sd_io_stats_get() decays its copy to now. */
+int64_t sd_io_begin(void);
+void sd_io_end(sd_io_op_t op, int64_t t0, size_t bytes, bool ok);
+void sd_io_stats_get(sd_io_stats_t *out);
+void sd_io_stats_reset(void);
+
+/* Write throughput over the time the card was busy, bytes/s. */
+uint32_t sd_io_bytes_per_s(const sd_io_stats_t *s);
+sd_health_t sd_io_health(const sd_io_stats_t *s);
+const char *sd_io_health_name(sd_health_t h);
+const char *sd_io_op_name(sd_io_op_t op);
+
+/* "SD Card,..." lines for a CSV summary. */
+void sd_io_stats_write_csv(FILE *f, const sd_io_stats_t *s);
+
+/* Timed stdio calls. */
+static inline FILE *sd_io_fopen(const char *path, const char *mode)
+{
+    int64_t t0 = sd_io_begin();
+    FILE *f = fopen(path, mode);
+    sd_io_end(SD_IO_OPEN, t0, 0, f != NULL);
+    return f;
+}
+
+static inline size_t sd_io_fwrite(const void *buf, size_t size, size_t n, FILE *f)
+{
+    int64_t t0 = sd_io_begin();
+    size_t done = fwrite(buf, size, n, f);
+    sd_io_end(SD_IO_WRITE, t0, size * n, done == n);
+    return done;
+}
+
+static inline int sd_io_fflush(FILE *f)
+{
+    int64_t t0 = sd_io_begin();
+    int r = fflush(f);
+    sd_io_end(SD_IO_FLUSH, t0, 0, r == 0);
+    return r;
+}
+
+/* fflush + fsync. */
+int sd_io_fsync(FILE *f);
+
+static inline int sd_io_fclose(FILE *f)
+{
+    int64_t t0 = sd_io_begin();
+    int r = fclose(f);
+    sd_io_end(SD_IO_CLOSE, t0, 0, r == 0);
+    return r;
+}
+
+#ifdef __cplusplus
+}
+#endif
@@ -3,6 +3,7 @@
 #include <stdbool.h>
 #include "esp_err.h"
 #include "sdmmc_cmd.h"
+#include "sd_io_stats.h"
 
 /**
  * Simple wrapper around SDMMC + FATFS mount for the Waveshare ESP32-S3
@@ -49,3 +50,10 @@ esp_err_t sd_mmc_helper_write_text(sd_mmc_helper_t *sd,
                                    const char *relative_path,
                                    const char *data,
                                    bool append);
+
+/**
+ * Time `kb` KB of 4 KB writes (fsync every 32 KB) to a scratch file and
+ * classify the card from them. The scratch file is removed; the global
+ * sd_io_* counters are left alone.
+ */
+esp_err_t sd_mmc_helper_probe(sd_mmc_helper_t *sd, uint32_t kb, sd_io_stats_t *out);
@@ -0,0 +1,205 @@
+// components/sd_mmc_helper/sd_io_stats.c
+#include "sd_io_stats.h"
+
+#include <string.h>
+#include <unistd.h>
+
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+
+static sd_io_stats_t s_stats;
+static portMUX_TYPE s_lock = portMUX_INITIALIZER_UNLOCKED;
+
+static const char *const k_op_names[SD_IO_OP_COUNT] = {
+    [SD_IO_OPEN] = "open", [SD_IO_WRITE] = "write", [SD_IO_FLUSH] = "flush",
+    [SD_IO_SYNC] = "sync", [SD_IO_CLOSE] = "close",
+};
+
+static const char *const k_health_names[] = {
+    [SD_HEALTH_UNKNOWN] = "unknown", [SD_HEALTH_GOOD] = "good", [SD_HEALTH_FAIR] = "fair",
+    [SD_HEALTH_SLOW] = "slow",       [SD_HEALTH_FAILING] = "failing",
+};
+
+/* 0 for < 1 ms, then one bucket per power of two of milliseconds. */
+static int bucket_of(uint32_t us)
+{
+    uint32_t ms = us / 1000;
+    if (ms == 0) return 0;
+    int b = 32 - __builtin_clz(ms);     // 1 ms -> 1, 2-3 ms -> 2, ...
+    return (b < SD_IO_HIST_BUCKETS) ? b : SD_IO_HIST_BUCKETS - 1;
+}
+
+// 2^(-1 / 60) in Q16: the recent counts lose this much each second
+#define DECAY_STEP_US   1000000
+#define DECAY_Q16       64783u
+_Static_assert(SD_IO_HALF_LIFE_S == 60, "DECAY_Q16 is 2^(-1 / SD_IO_HALF_LIFE_S)");
+
+static uint32_t decay_by(uint32_t v, uint32_t steps)
+{
+    uint32_t halvings = steps / SD_IO_HALF_LIFE_S;
+    v = (halvings >= 32) ? 0 : v >> halvings;
+    for (uint32_t i = steps % SD_IO_HALF_LIFE_S; i > 0 && v; i--) v = (uint32_t)((uint64_t)v * DECAY_Q16 >> 16);
+    return v;
+}
+
+void sd_io_stats_decay(sd_io_stats_t *s, int64_t now_us)
+{
+    // Whole steps only, so frequent operations do not round the decay away
+    int64_t steps = (now_us - s->recent_us) / DECAY_STEP_US;
+    if (steps <= 0) return;
+    uint32_t n = (steps > UINT32_MAX) ? UINT32_MAX : (uint32_t)steps;
+    s->recent_slow = decay_by(s->recent_slow, n);
+    s->recent_stalls = decay_by(s->recent_stalls, n);
+    s->recent_us += steps * DECAY_STEP_US;
+}
+
+static uint32_t add_sat(uint32_t a, uint32_t b)
+{
+    return (a > UINT32_MAX - b) ? UINT32_MAX : a + b;
+}
+
+void sd_io_stats_add(sd_io_stats_t *s, sd_io_op_t op, uint32_t us, size_t bytes, bool ok, int64_t at_us)
+{
+    sd_io_op_stats_t *o = &s->op[op];
+    o->count++;
+    if (!ok) o->errors++;
+    o->total_us += us;
+    if (us > o->max_us) o->max_us = us;
+    o->hist[bucket_of(us)]++;
+
+    if (op == SD_IO_WRITE) s->bytes += bytes;
+    if (op == SD_IO_WRITE || op == SD_IO_FLUSH || op == SD_IO_SYNC) s->busy_us += us;
+    sd_io_stats_decay(s, at_us);
+    if (us >= SD_IO_SLOW_MS * 1000u) {
+        s->slow++;
+        s->recent_slow = add_sat(s->recent_slow, SD_IO_RECENT_ONE);
+    }
+    if (us >= SD_IO_STALL_MS * 1000u) s->recent_stalls = add_sat(s->recent_stalls, SD_IO_RECENT_ONE);
+    if (us > s->max_us) s->max_us = us;
+
+    // Slowest first; a new entry goes in if it beats the last one
+    if (us < 1000) return;
+    int i = s->n_outliers;
+    if (i == SD_IO_OUTLIERS) {
+        if (us <= s->outliers[i - 1].us) return;
+        i--;
+    } else {
+        s->n_outliers++;
+    }
+    for (; i > 0 && s->outliers[i - 1].us < us; i--) s->outliers[i] = s->outliers[i - 1];
+    s->outliers[i] = (sd_io_outlier_t){ .op = (uint8_t)op, .us = us, .bytes = (uint32_t)bytes, .at_us = at_us };
+}
+
+int64_t sd_io_begin(void)
+{
+    return esp_timer_get_time();
+}
+
+void sd_io_end(sd_io_op_t op, int64_t t0, size_t bytes, bool ok)
+{
+    int64_t dt = esp_timer_get_time() - t0;
+    uint32_t us = (dt < 0) ? 0 : (dt > UINT32_MAX) ? UINT32_MAX : (uint32_t)dt;
+
+    portENTER_CRITICAL(&s_lock);
+    sd_io_stats_add(&s_stats, op, us, bytes, ok, t0);
+    portEXIT_CRITICAL(&s_lock);
+}
+
+void sd_io_stats_get(sd_io_stats_t *out)
+{
+    int64_t now = esp_timer_get_time();
+    portENTER_CRITICAL(&s_lock);
+    *out = s_stats;
+    portEXIT_CRITICAL(&s_lock);
+    sd_io_stats_decay(out, now);
+}
+
+void sd_io_stats_reset(void)
+{
+    int64_t now = esp_timer_get_time();
+    portENTER_CRITICAL(&s_lock);
+    memset(&s_stats, 0, sizeof(s_stats));
+    s_stats.since_us = now;
+    s_stats.recent_us = now;
+    portEXIT_CRITICAL(&s_lock);
+}
+
+int sd_io_fsync(FILE *f)
+{
+    int64_t t0 = sd_io_begin();
+    int r = fflush(f);
+    if (r == 0) r = fsync(fileno(f));
+    sd_io_end(SD_IO_SYNC, t0, 0, r == 0);
+    return r;
+}
+
+uint32_t sd_io_bytes_per_s(const sd_io_stats_t *s)
+{
+    if (s->busy_us == 0) return 0;
+    uint64_t bps = s->bytes * 1000000ull / s->busy_us;
+    return (bps > UINT32_MAX) ? UINT32_MAX : (uint32_t)bps;
+}
+
+sd_health_t sd_io_health(const sd_io_stats_t *s)
+{
+    uint32_t ops = 0, errors = 0;
+    for (int i = 0; i < SD_IO_OP_COUNT; i++) {
+        ops += s->op[i].count;
+        errors += s->op[i].errors;
+    }
+
+    if (errors > 0) return SD_HEALTH_FAILING;
+    if (ops < SD_IO_MIN_OPS) return SD_HEALTH_UNKNOWN;
+
+    // Throughput only means something once the card has had real work
+    bool slow_rate = s->bytes >= 256 * 1024 && sd_io_bytes_per_s(s) < SD_IO_MIN_BPS;
+    // An old stall or a rare slow write says nothing about the card now
+    if (s->recent_stalls * 2 >= SD_IO_RECENT_ONE || s->recent_slow >= SD_IO_SLOW_RECENT * SD_IO_RECENT_ONE ||
+        slow_rate)
+        return SD_HEALTH_SLOW;
+    if (s->recent_slow >= SD_IO_FAIR_RECENT * SD_IO_RECENT_ONE) return SD_HEALTH_FAIR;
+    return SD_HEALTH_GOOD;
+}
+
+const char *sd_io_health_name(sd_health_t h)
+{
+    return ((unsigned)h < sizeof(k_health_names) / sizeof(k_health_names[0])) ? k_health_names[h] : "?";
+}
+
+const char *sd_io_op_name(sd_io_op_t op)
+{
+    return ((unsigned)op < SD_IO_OP_COUNT) ? k_op_names[op] : "?";
+}
+
+void sd_io_stats_write_csv(FILE *f, const sd_io_stats_t *s)
+{
+    fprintf(f, "SD Card,%s\n", sd_io_health_name(sd_io_health(s)));
+    fprintf(f, "SD Bytes Written,%llu\n", (unsigned long long)s->bytes);
+    fprintf(f, "SD Throughput (KB/s),%lu\n", (unsigned long)(sd_io_bytes_per_s(s) / 1024));
+    fprintf(f, "SD Slow Ops (>=%d ms),%lu\n", SD_IO_SLOW_MS, (unsigned long)s->slow);
+
+    fputs("SD Latency (ms),Count,Errors,Avg,Max,<1", f);
+    for (int b = 1; b < SD_IO_HIST_BUCKETS - 1; b++) fprintf(f, ",%d-%d", 1 << (b - 1), 1 << b);
+    fprintf(f, ",>=%d\n", 1 << (SD_IO_HIST_BUCKETS - 2));
+
+    for (int i = 0; i < SD_IO_OP_COUNT; i++) {
+        const sd_io_op_stats_t *o = &s->op[i];
+        double avg_ms = o->count ? (double)o->total_us / o->count * 1e-3 : 0.0;
+        fprintf(f, "SD %s,%lu,%lu,%.2f,%.1f", k_op_names[i], (unsigned long)o->count, (unsigned long)o->errors,
+                avg_ms, (double)o->max_us * 1e-3);
+        for (int b = 0; b < SD_IO_HIST_BUCKETS; b++) fprintf(f, ",%lu", (unsigned long)o->hist[b]);
+        fputc('\n', f);
+    }
+
+    // Worst operations with their time into the session, for lining up with gaps in the rows
+    fputs("SD Worst (ms)", f);
+    for (int i = 0; i < s->n_outliers; i++) {
+        const sd_io_outlier_t *w = &s->outliers[i];
+        int64_t at_s = (w->at_us - s->since_us) / 1000000;
+        if (at_s < 0) at_s = 0;
+        fprintf(f, ",%s %.1f @%02lld:%02lld:%02lld", sd_io_op_name((sd_io_op_t)w->op), (double)w->us * 1e-3,
+                (long long)(at_s / 3600), (long long)(at_s / 60 % 60), (long long)(at_s % 60));
+        if (w->bytes) fprintf(f, " %luB", (unsigned long)w->bytes);
+    }
+    fputc('\n', f);
+}
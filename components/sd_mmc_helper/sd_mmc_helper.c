@@ -1,12 +1,16 @@
 #include "sd_mmc_helper.h"
 
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 #include <errno.h>
+#include <unistd.h>
 
 #include "esp_log.h"
+#include "esp_timer.h"
 #include "esp_vfs_fat.h"
 #include "driver/sdmmc_host.h"
+#include "sd_io_stats.h"
 
 #define SD_TAG "sd_mmc_helper"
 
@@ -127,7 +131,7 @@ esp_err_t sd_mmc_helper_write_text(sd_mmc_helper_t *sd,
     const char *mode = append ? "a" : "w";
     ESP_LOGI(SD_TAG, "Opening %s (%s)", full_path, mode);
 
-    FILE *f = fopen(full_path, mode);
+    FILE *f = sd_io_fopen(full_path, mode);
     if (!f)
     {
         ESP_LOGE(SD_TAG,
@@ -137,8 +141,8 @@ esp_err_t sd_mmc_helper_write_text(sd_mmc_helper_t *sd,
     }
 
     size_t len = strlen(data);
-    size_t written = fwrite(data, 1, len, f);
-    fclose(f);
+    size_t written = sd_io_fwrite(data, 1, len, f);
+    sd_io_fclose(f);
 
     if (written != len)
     {
@@ -151,3 +155,70 @@ esp_err_t sd_mmc_helper_write_text(sd_mmc_helper_t *sd,
              (unsigned)len, full_path);
     return ESP_OK;
 }
+
+esp_err_t sd_mmc_helper_probe(sd_mmc_helper_t *sd, uint32_t kb, sd_io_stats_t *out)
+{
+    if (!sd || !out || kb == 0)
+    {
+        return ESP_ERR_INVALID_ARG;
+    }
+    memset(out, 0, sizeof(*out));
+    if (!sd->mounted)
+    {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    char path[96];
+    snprintf(path, sizeof(path), "%s/.sdprobe", sd->mount_point);
+
+    // Logger-sized writes with a sync every 32 KB, like a session with raw capture
+    const size_t chunk = 4096;
+    uint8_t *buf = malloc(chunk);
+    if (!buf)
+    {
+        return ESP_ERR_NO_MEM;
+    }
+    memset(buf, 0x5A, chunk);
+
+    out->since_us = esp_timer_get_time();
+    out->recent_us = out->since_us;
+    int64_t t0 = esp_timer_get_time();
+    FILE *f = fopen(path, "wb");
+    sd_io_stats_add(out, SD_IO_OPEN, (uint32_t)(esp_timer_get_time() - t0), 0, f != NULL, t0);
+    if (!f)
+    {
+        free(buf);
+        return ESP_FAIL;
+    }
+    setvbuf(f, NULL, _IONBF, 0);
+
+    esp_err_t err = ESP_OK;
+    for (uint32_t i = 0; i < kb / 4 && err == ESP_OK; i++)
+    {
+        t0 = esp_timer_get_time();
+        bool ok = fwrite(buf, 1, chunk, f) == chunk;
+        sd_io_stats_add(out, SD_IO_WRITE, (uint32_t)(esp_timer_get_time() - t0), chunk, ok, t0);
+        if (ok && (i + 1) % 8 == 0)
+        {
+            t0 = esp_timer_get_time();
+            ok = fsync(fileno(f)) == 0;
+            sd_io_stats_add(out, SD_IO_SYNC, (uint32_t)(esp_timer_get_time() - t0), 0, ok, t0);
+        }
+        if (!ok)
+        {
+            err = ESP_FAIL;
+        }
+    }
+
+    t0 = esp_timer_get_time();
+    bool closed = fclose(f) == 0;
+    sd_io_stats_add(out, SD_IO_CLOSE, (uint32_t)(esp_timer_get_time() - t0), 0, closed, t0);
+    unlink(path);
+    free(buf);
+
+    ESP_LOGI(SD_TAG, "Probe: %lu KB at %lu KB/s, worst %.1f ms, card %s",
+             (unsigned long)kb, (unsigned long)(sd_io_bytes_per_s(out) / 1024),
+             (double)out->max_us * 1e-3,
+             sd_io_health_name(sd_io_health(out)));
+    return (err == ESP_OK && closed) ? ESP_OK : ESP_FAIL;
+}
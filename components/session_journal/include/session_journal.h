@@ -0,0 +1,71 @@
+// components/session_journal/include/session_journal.h
+#pragma once
+
+/*
+ * Crash-safe session journal.
+ *
+ * <mount>/activities/journal.bin holds two fixed 512-byte slots. Each
+ * checkpoint overwrites the older slot with the live activity_t, the log
+ * file base name and how many bytes of each log file are known to be on
+ * the card, then fsyncs. A torn write leaves the other slot intact, and the
+ * CRC tells them apart.
+ *
+ * If the newest valid record is still ACTIVE at boot, the session never
+ * stopped cleanly: session_journal_recover() truncates the (preallocated)
+ * log files to the checkpointed lengths, appends a summary to the splits
+ * file, adds the session to index.bin, index.csv and activity_<id>.json
+ * like a clean stop, and closes the journal.
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "esp_err.h"
+#include "activity.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define SESSION_JOURNAL_SLOT_SIZE   512
+
+typedef enum {
+    SESSION_JOURNAL_IDLE = 0,
+    SESSION_JOURNAL_ACTIVE,
+} session_journal_state_t;
+
+typedef struct {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t act_size;          // sizeof(activity_t) of the firmware that wrote it
+    uint32_t seq;
+    uint8_t  state;             // session_journal_state_t
+    uint8_t  log_format;        // activity_log_format_t
+    uint8_t  raw_enabled;
+    uint8_t  reserved;
+    char     base[96];          // log base relative to the mount ("activities/...")
+    int64_t  main_len;          // bytes of the stroke file on the card
+    int64_t  splits_len;
+    int64_t  raw_len;
+    int64_t  mono_us;           // esp_timer time of the checkpoint
+    activity_t act;
+    uint32_t crc;               // crc32 of everything above
+} session_journal_rec_t;
+
+/* Open (or create) the journal and load the newest valid record. */
+esp_err_t session_journal_open(const char *mount_point);
+
+/* True if the last session did not close; `out` gets its last checkpoint. */
+bool session_journal_pending(session_journal_rec_t *out);
+
+/* Write `rec` (magic/seq/crc are filled in) to the older slot and fsync. */
+esp_err_t session_journal_checkpoint(session_journal_rec_t *rec);
+
+/* Mark the session closed. */
+esp_err_t session_journal_close(void);
+
+/* Finalize an interrupted session from its last checkpoint, then close it. */
+esp_err_t session_journal_recover(const char *mount_point, const session_journal_rec_t *rec);
+
+#ifdef __cplusplus
+}
+#endif
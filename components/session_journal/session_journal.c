@@ -0,0 +1,259 @@
+// components/session_journal/session_journal.c
+#include "session_journal.h"
+
+#include <fcntl.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "activity_index.h"
+#include "activity_log.h"
+#include "activity_raw_format.h"
+#include "sd_io_stats.h"
+
+static const char *TAG = "session_journal";
+
+#define JOURNAL_MAGIC   0x4A534352u     // "RCSJ"
+#define JOURNAL_VERSION 1
+#define JOURNAL_SLOTS   2
+
+_Static_assert(sizeof(session_journal_rec_t) <= SESSION_JOURNAL_SLOT_SIZE, "journal record outgrew its slot");
+
+static int s_fd = -1;
+static session_journal_rec_t s_last;    // newest valid record (seq 0 = none)
+static bool s_have_last;
+
+/* -------------------------------------------------------------------------- */
+/* Slots                                                                      */
+/* -------------------------------------------------------------------------- */
+
+static uint32_t rec_crc(const session_journal_rec_t *r)
+{
+    return alog_crc32(0, r, offsetof(session_journal_rec_t, crc));
+}
+
+static bool rec_valid(const session_journal_rec_t *r)
+{
+    return r->magic == JOURNAL_MAGIC && r->version == JOURNAL_VERSION &&
+           r->act_size == sizeof(activity_t) && r->crc == rec_crc(r);
+}
+
+static esp_err_t write_slot(const session_journal_rec_t *r)
+{
+    uint8_t slot[SESSION_JOURNAL_SLOT_SIZE] = {0};
+    memcpy(slot, r, sizeof(*r));
+
+    // Checkpoints run during the session: timed with the log writes (sd_io_stats.h)
+    off_t off = (off_t)(r->seq % JOURNAL_SLOTS) * SESSION_JOURNAL_SLOT_SIZE;
+    int64_t t0 = sd_io_begin();
+    bool ok = lseek(s_fd, off, SEEK_SET) == off && write(s_fd, slot, sizeof(slot)) == (ssize_t)sizeof(slot);
+    sd_io_end(SD_IO_WRITE, t0, sizeof(slot), ok);
+    if (!ok) {
+        ESP_LOGE(TAG, "slot write failed");
+        return ESP_FAIL;
+    }
+
+    t0 = sd_io_begin();
+    int rc = fsync(s_fd);
+    sd_io_end(SD_IO_SYNC, t0, 0, rc == 0);
+    return (rc == 0) ? ESP_OK : ESP_FAIL;
+}
+
+/* -------------------------------------------------------------------------- */
+/* Public API                                                                 */
+/* -------------------------------------------------------------------------- */
+
+esp_err_t session_journal_open(const char *mount_point)
+{
+    if (!mount_point) return ESP_ERR_INVALID_ARG;
+    if (s_fd >= 0) return ESP_OK;
+
+    char path[96];
+    snprintf(path, sizeof(path), "%s/activities", mount_point);
+    mkdir(path, 0775);
+    snprintf(path, sizeof(path), "%s/activities/journal.bin", mount_point);
+
+    s_fd = open(path, O_RDWR | O_CREAT, 0664);
+    if (s_fd < 0) {
+        ESP_LOGE(TAG, "open %s failed", path);
+        return ESP_FAIL;
+    }
+
+    s_have_last = false;
+    memset(&s_last, 0, sizeof(s_last));
+
+    uint8_t slot[SESSION_JOURNAL_SLOT_SIZE];
+    for (int i = 0; i < JOURNAL_SLOTS; i++) {
+        if (lseek(s_fd, (off_t)i * SESSION_JOURNAL_SLOT_SIZE, SEEK_SET) < 0) break;
+        if (read(s_fd, slot, sizeof(slot)) != (ssize_t)sizeof(slot)) break;
+
+        session_journal_rec_t r;
+        memcpy(&r, slot, sizeof(r));
+        if (rec_valid(&r) && (!s_have_last || r.seq > s_last.seq)) {
+            s_last = r;
+            s_have_last = true;
+        }
+    }
+
+    // Both slots exist from the first open on, so checkpoints only rewrite sectors
+    if (lseek(s_fd, 0, SEEK_END) < (off_t)(JOURNAL_SLOTS * SESSION_JOURNAL_SLOT_SIZE)) {
+        memset(slot, 0, sizeof(slot));
+        for (int i = 0; i < JOURNAL_SLOTS; i++) {
+            if (s_have_last && (int)(s_last.seq % JOURNAL_SLOTS) == i) continue;
+            lseek(s_fd, (off_t)i * SESSION_JOURNAL_SLOT_SIZE, SEEK_SET);
+            write(s_fd, slot, sizeof(slot));
+        }
+        fsync(s_fd);
+    }
+
+    ESP_LOGI(TAG, "Journal open: %s", s_have_last ? (s_last.state == SESSION_JOURNAL_ACTIVE ? "session pending" : "clean")
+                                                  : "empty");
+    return ESP_OK;
+}
+
+bool session_journal_pending(session_journal_rec_t *out)
+{
+    if (!s_have_last || s_last.state != SESSION_JOURNAL_ACTIVE) return false;
+    if (out) *out = s_last;
+    return true;
+}
+
+esp_err_t session_journal_checkpoint(session_journal_rec_t *rec)
+{
+    if (!rec) return ESP_ERR_INVALID_ARG;
+    if (s_fd < 0) return ESP_ERR_INVALID_STATE;
+
+    rec->magic = JOURNAL_MAGIC;
+    rec->version = JOURNAL_VERSION;
+    rec->act_size = sizeof(activity_t);
+    rec->seq = s_have_last ? s_last.seq + 1 : 1;
+    rec->mono_us = esp_timer_get_time();
+    rec->crc = rec_crc(rec);
+
+    esp_err_t err = write_slot(rec);
+    if (err == ESP_OK) {
+        s_last = *rec;
+        s_have_last = true;
+    }
+    return err;
+}
+
+esp_err_t session_journal_close(void)
+{
+    if (s_fd < 0) return ESP_ERR_INVALID_STATE;
+    if (!s_have_last || s_last.state == SESSION_JOURNAL_IDLE) return ESP_OK;
+
+    session_journal_rec_t r = s_last;
+    r.state = SESSION_JOURNAL_IDLE;
+    return session_journal_checkpoint(&r);
+}
+
+/* -------------------------------------------------------------------------- */
+/* Recovery                                                                   */
+/* -------------------------------------------------------------------------- */
+
+static void truncate_to(const char *path, int64_t len)
+{
+    if (len < 0) return;
+    if (truncate(path, (off_t)len) != 0) {
+        ESP_LOGW(TAG, "truncate %s to %lld failed", path, (long long)len);
+    }
+}
+
+static void fmt_hms(uint32_t total_ms, char *out, size_t len)
+{
+    uint32_t s = total_ms / 1000;
+    snprintf(out, len, "%02lu:%02lu:%02lu",
+             (unsigned long)(s / 3600), (unsigned long)((s % 3600) / 60), (unsigned long)(s % 60));
+}
+
+static void write_summary(const char *path, const activity_t *a)
+{
+    FILE *f = fopen(path, "a");
+    if (!f) {
+        ESP_LOGW(TAG, "open %s for summary failed", path);
+        return;
+    }
+
+    char dur[16];
+    fmt_hms(a->duration_ms, dur, sizeof(dur));
+    float pace = (a->avg_speed_mps > 0.1f) ? 500.0f / a->avg_speed_mps : 0.0f;
+
+    fprintf(f, "\nSession Summary,Recovered after power loss\n");
+    fprintf(f, "Duration,%s\n", dur);
+    fprintf(f, "Distance (m),%.0f\n", (double)a->distance_m);
+    fprintf(f, "Strokes,%lu\n", (unsigned long)a->stroke_count);
+    fprintf(f, "Avg Speed (m/s),%.2f\n", (double)a->avg_speed_mps);
+    fprintf(f, "Avg Pace (/500m),%02d:%04.1f\n", (int)(pace / 60.0f), (double)(pace - 60.0f * (int)(pace / 60.0f)));
+    fprintf(f, "Avg SPM,%.1f\n", (double)a->avg_spm);
+    fprintf(f, "Max SPM,%.1f\n", (double)a->max_spm);
+    for (int i = 0; i < BEST_EFFORT_COUNT; i++) {
+        const best_effort_target_t *t = &best_effort_targets[i];
+        float v = a->best_effort[i];
+        if (!(v > 0.0f)) continue;
+        if (t->is_time)
+            fprintf(f, "Best %s (m),%.0f\n", t->name, (double)v);
+        else
+            fprintf(f, "Best %s,%02d:%04.1f\n", t->name, (int)(v / 60.0f), (double)(v - 60.0f * (int)(v / 60.0f)));
+    }
+    fclose(f);
+}
+
+esp_err_t session_journal_recover(const char *mount_point, const session_journal_rec_t *rec)
+{
+    if (!mount_point || !rec) return ESP_ERR_INVALID_ARG;
+
+    int64_t t0 = esp_timer_get_time();
+    char path[192];
+
+    snprintf(path, sizeof(path), "%s/%s%s", mount_point, rec->base,
+             rec->log_format == ACTIVITY_LOG_FORMAT_BINARY ? ACTIVITY_LOG_SUFFIX_STROKES_BIN
+                                                           : ACTIVITY_LOG_SUFFIX_STROKES_CSV);
+    truncate_to(path, rec->main_len);
+    if (rec->log_format == ACTIVITY_LOG_FORMAT_BINARY) {
+        // The open block's header is only written when it closes
+        activity_log_seal_tail(path);
+    }
+
+    // The streamed FIT was never finished (zero data size, no CRC): rebuild
+    // it from the stroke log, or remove it so it is not served half-written
+    char fit_path[192];
+    struct stat st;
+    snprintf(fit_path, sizeof(fit_path), "%s/%s" ACTIVITY_LOG_SUFFIX_FIT, mount_point, rec->base);
+    if (stat(fit_path, &st) == 0 &&
+        (rec->log_format != ACTIVITY_LOG_FORMAT_BINARY || activity_log_export_fit(path, fit_path) != ESP_OK)) {
+        ESP_LOGW(TAG, "Removing unfinished %s", fit_path);
+        unlink(fit_path);
+    }
+
+    if (rec->raw_enabled) {
+        snprintf(path, sizeof(path), "%s/%s" ACTIVITY_RAW_FILE_SUFFIX, mount_point, rec->base);
+        truncate_to(path, rec->raw_len);
+    }
+
+    // Close the summary off at the last checkpoint
+    activity_t a = rec->act;
+    if (a.state == ACTIVITY_STATE_RECORDING) {
+        activity_stop(&a, a.start_utc_us + a.total_us);
+    }
+
+    snprintf(path, sizeof(path), "%s/%s" ACTIVITY_LOG_SUFFIX_SPLITS, mount_point, rec->base);
+    truncate_to(path, rec->splits_len);
+    write_summary(path, &a);
+    activity_index_append(&a, rec->base, ACTIVITY_INDEX_F_RECOVERED);
+    // activity_<id>.json and the index.csv row, as a clean stop writes them
+    sd_mmc_helper_t sd = { .mounted = true, .mount_point = mount_point };
+    esp_err_t save_err = activity_save_to_sd(&sd, &a, true);
+    if (save_err != ESP_OK) ESP_LOGW(TAG, "Cannot save the recovered summary: %s", esp_err_to_name(save_err));
+
+    esp_err_t err = session_journal_close();
+
+    ESP_LOGW(TAG, "Recovered session %lu (%s): %.0f m, %lu strokes in %lld ms",
+             (unsigned long)a.id, rec->base, (double)a.distance_m, (unsigned long)a.stroke_count,
+             (long long)((esp_timer_get_time() - t0) / 1000));
+    return err;
+}
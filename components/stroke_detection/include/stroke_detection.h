@@ -31,6 +31,10 @@ typedef struct {
     float recovery_time_s;
     uint32_t stroke_count;
 
+    // Event timestamps (same clock as the t_us passed to update), -1 if none yet
+    int64_t t_catch_us;
+    int64_t t_finish_us;
+
     // Telemetry
     float a_long;        // Raw longitudinal acceleration
     float a_long_f;      // Filtered surge signal (The Trigger)
@@ -68,7 +72,7 @@ typedef struct stroke_detection {
     stroke_detection_cfg_t cfg;
 
     bool has_prev_t;
-    float prev_t;
+    int64_t prev_t_us;
 
     // Gravity Estimation
     float g_est[3];
@@ -102,10 +106,10 @@ typedef struct stroke_detection {
     int phase; 
     uint32_t stroke_count;
     
-    // Timing
-    float t_last_catch;
-    float t_last_finish;
-    float t_last_event;
+    // Timing (microseconds, -1 = never)
+    int64_t t_last_catch_us;
+    int64_t t_last_finish_us;
+    int64_t t_last_event_us;
 
     // Peak Tracking
     float peak_norm; 
@@ -120,8 +124,9 @@ typedef struct stroke_detection {
 } stroke_detection_t;
 
 void stroke_detection_init(stroke_detection_t *sd, const stroke_detection_cfg_t *cfg);
+/* t_us: monotonic sample timestamp in microseconds (esp_timer clock). */
 stroke_event_t stroke_detection_update(stroke_detection_t *sd,
-                                       float t_s,
+                                       int64_t t_us,
                                        float ax, float ay, float az,
                                        float gx, float gy, float gz,
                                        stroke_metrics_t *out);
@@ -101,16 +101,18 @@ void stroke_detection_init(stroke_detection_t *sd_, const stroke_detection_cfg_t
     sd->polarity = +1;
     sd->phase = 0; // 0 = Recovery, 1 = Drive
     
-    sd->t_last_catch = -1.0f;
-    sd->t_last_finish = -1.0f;
-    sd->t_last_event = -1.0f;
+    sd->t_last_catch_us = -1;
+    sd->t_last_finish_us = -1;
+    sd->t_last_event_us = -1;
+    sd->last.t_catch_us = -1;
+    sd->last.t_finish_us = -1;
 
     period_hist_reset(sd);
 }
 
 // --- Update Logic (HULL MODE) ---
 stroke_event_t stroke_detection_update(stroke_detection_t *sd_,
-                                       float t_s,
+                                       int64_t t_us,
                                        float ax, float ay, float az,
                                        float gx, float gy, float gz,
                                        stroke_metrics_t *out)
@@ -121,11 +123,11 @@ stroke_event_t stroke_detection_update(stroke_detection_t *sd_,
     // 1. Time Delta
     float dt = 1.0f / sd->cfg.fs_hz;
     if (sd->has_prev_t) {
-        float dt_meas = t_s - sd->prev_t;
+        float dt_meas = (float)(t_us - sd->prev_t_us) * 1e-6f;
         if (dt_meas > 0.0005f && dt_meas < 0.1f) dt = dt_meas;
     }
     sd->has_prev_t = true;
-    sd->prev_t = t_s;
+    sd->prev_t_us = t_us;
 
     // 2. Remove Gravity (Estimate Gravity Vector)
     float a_raw[3] = {ax, ay, az};
@@ -192,7 +194,7 @@ stroke_event_t stroke_detection_update(stroke_detection_t *sd_,
     // 7. State Machine
     
     // Reset if idle too long
-    if (sd->t_last_event > 0.0f && (t_s - sd->t_last_event) > 6.0f) {
+    if (sd->t_last_event_us >= 0 && (t_us - sd->t_last_event_us) > 6000000LL) {
         sd->phase = 0;
         sd->peak_norm = 0.0f;
     }
@@ -204,17 +206,17 @@ stroke_event_t stroke_detection_update(stroke_detection_t *sd_,
             
             // --- CATCH DETECTED ---
             sd->phase = 1; 
-            float t_now = t_s;
+            int64_t t_now = t_us;
 
             // Rec Time
-            if (sd->t_last_finish > 0.0f) {
-                float rec_t = t_now - sd->t_last_finish;
+            if (sd->t_last_finish_us >= 0) {
+                float rec_t = (float)(t_now - sd->t_last_finish_us) * 1e-6f;
                 if (rec_t > 0.1f) sd->last.recovery_time_s = rec_t;
             }
 
             // Period / SPM
-            if (sd->t_last_catch > 0.0f) {
-                float period = t_now - sd->t_last_catch;
+            if (sd->t_last_catch_us >= 0) {
+                float period = (float)(t_now - sd->t_last_catch_us) * 1e-6f;
                 if (period >= sd->cfg.min_stroke_period_s && period <= sd->cfg.max_stroke_period_s) {
                     period_hist_push(sd, period);
                     float mean_period = period_hist_mean(sd);
@@ -229,8 +231,9 @@ stroke_event_t stroke_detection_update(stroke_detection_t *sd_,
                 ev = STROKE_EVENT_CATCH; 
             }
 
-            sd->t_last_catch = t_now;
-            sd->t_last_event = t_now;
+            sd->t_last_catch_us = t_now;
+            sd->t_last_event_us = t_now;
+            sd->last.t_catch_us = t_now;
             sd->peak_norm = 0.0f;
         }
 
@@ -247,15 +250,16 @@ stroke_event_t stroke_detection_update(stroke_detection_t *sd_,
             
             // --- FINISH DETECTED ---
             sd->phase = 0;
-            float t_now = t_s;
+            int64_t t_now = t_us;
 
-            if (sd->t_last_catch > 0.0f) {
-                float drv_t = t_now - sd->t_last_catch;
+            if (sd->t_last_catch_us >= 0) {
+                float drv_t = (float)(t_now - sd->t_last_catch_us) * 1e-6f;
                 if (drv_t > 0.1f) sd->last.drive_time_s = drv_t;
             }
             
-            sd->t_last_finish = t_now;
-            sd->t_last_event = t_now;
+            sd->t_last_finish_us = t_now;
+            sd->t_last_event_us = t_now;
+            sd->last.t_finish_us = t_now;
             ev = STROKE_EVENT_FINISH;
         }
     }
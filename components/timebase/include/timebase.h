@@ -0,0 +1,81 @@
+// components/timebase/include/timebase.h
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "esp_err.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Monotonic -> UTC time base.
+ *
+ * Keeps a linear mapping from the 64-bit esp_timer microsecond clock
+ * ("mono") to UTC microseconds since the Unix epoch:
+ *
+ *   utc_us = anchor_utc_us + (mono_us - anchor_mono_us) * (1 + rate_ppb * 1e-9)
+ *
+ * The mapping is stepped when the first reference arrives, when a better
+ * source takes over (RTC -> GPS) and when a reference is more than 0.5 s
+ * off; otherwise it is slewed by at most 1 ms per reference. A step can
+ * move UTC backwards, so while a session records (timebase_set_hold) steps
+ * that would go back are slewed out at that rate instead (about 15 min
+ * for the RTC's up to 1 s) and timestamps stay monotonic; forward steps
+ * still apply at once. The rate term absorbs
+ * the crystal error of the ESP32 clock against GPS.
+ *
+ * Everything is int64 microseconds; nothing accumulates in float.
+ */
+
+typedef enum {
+    TIMEBASE_SRC_NONE = 0,
+    TIMEBASE_SRC_RTC,       // PCF85063, 1 s resolution, read at boot
+    TIMEBASE_SRC_GPS,       // NMEA fix time, stamped at sentence start
+} timebase_src_t;
+
+typedef struct {
+    timebase_src_t src;
+    int64_t  anchor_mono_us;
+    int64_t  anchor_utc_us;
+    int32_t  rate_ppb;          // estimated mono clock error vs reference
+    int64_t  last_residual_us;  // reference - prediction at last discipline
+    uint32_t discipline_count;
+    uint32_t step_count;
+} timebase_status_t;
+
+/** Reset to "unsynced". Safe to call more than once. */
+void timebase_init(void);
+
+/**
+ * Feed a reference point: `utc_us` was true at monotonic time `mono_us`.
+ *
+ * A reference from a lower-quality source than the current one is ignored
+ * (the RTC never overrides GPS). Large residuals step the mapping (see
+ * timebase_set_hold); small ones are slewed in bounded increments.
+ */
+esp_err_t timebase_discipline(timebase_src_t src, int64_t mono_us, int64_t utc_us);
+
+/**
+ * Hold off backward steps (the session recording) or allow them again.
+ * A residual left over at release is stepped by the next reference.
+ */
+void timebase_set_hold(bool hold);
+
+/** Current monotonic time in microseconds (esp_timer). */
+int64_t timebase_mono_us(void);
+
+/** Map a monotonic timestamp to UTC microseconds (0 if never synced). */
+int64_t timebase_to_utc_us(int64_t mono_us);
+
+/** Convenience: timebase_to_utc_us(timebase_mono_us()). */
+int64_t timebase_now_utc_us(void);
+
+bool           timebase_is_synced(void);
+timebase_src_t timebase_source(void);
+void           timebase_get_status(timebase_status_t *out);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,182 @@
+// components/timebase/timebase.c
+#include "timebase.h"
+
+#include <string.h>
+
+#include "freertos/FreeRTOS.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+
+static const char *TAG = "timebase";
+
+/* Residuals larger than this are treated as a jump (new source, RTC seeded
+ * badly, etc.) and stepped; anything smaller is slewed. */
+#define TIMEBASE_STEP_THRESHOLD_US  500000LL
+
+/* Phase loop: correct 1/8 of the residual per reference, but never more than
+ * 1 ms at once. GPS references arrive ~1 s apart, so the mapping can never
+ * run backwards between two consecutive fixes. */
+#define TIMEBASE_PHASE_SHIFT        3
+#define TIMEBASE_SLEW_MAX_US        1000LL
+
+/* Frequency loop: every few minutes the phase corrections applied since the
+ * last checkpoint are folded into the rate term. */
+#define TIMEBASE_RATE_SPAN_US       (300LL * 1000000LL)
+#define TIMEBASE_RATE_LIMIT_PPB     200000
+
+typedef struct {
+    timebase_status_t st;
+    int64_t rate_ref_mono_us;
+    int64_t corr_sum_us;
+    bool    hold;               // no backward steps (timebase_set_hold)
+    bool    catching_up;        // slewing out a step that was held off
+} timebase_state_t;
+
+static timebase_state_t s_tb;
+static portMUX_TYPE s_lock = portMUX_INITIALIZER_UNLOCKED;
+
+static int64_t predict_locked(int64_t mono_us)
+{
+    int64_t d = mono_us - s_tb.st.anchor_mono_us;
+    return s_tb.st.anchor_utc_us + d + (d * s_tb.st.rate_ppb) / 1000000000LL;
+}
+
+static int64_t clamp_i64(int64_t v, int64_t lo, int64_t hi)
+{
+    return v < lo ? lo : (v > hi ? hi : v);
+}
+
+void timebase_init(void)
+{
+    taskENTER_CRITICAL(&s_lock);
+    memset(&s_tb, 0, sizeof(s_tb));
+    taskEXIT_CRITICAL(&s_lock);
+}
+
+esp_err_t timebase_discipline(timebase_src_t src, int64_t mono_us, int64_t utc_us)
+{
+    if (src == TIMEBASE_SRC_NONE || utc_us <= 0) return ESP_ERR_INVALID_ARG;
+
+    bool stepped = false, held = false;
+    int64_t residual = 0;
+
+    taskENTER_CRITICAL(&s_lock);
+
+    if (s_tb.st.src != TIMEBASE_SRC_NONE && src < s_tb.st.src) {
+        taskEXIT_CRITICAL(&s_lock);
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    if (s_tb.st.src != TIMEBASE_SRC_NONE) {
+        residual = utc_us - predict_locked(mono_us);
+    }
+
+    const bool jump = s_tb.st.src == TIMEBASE_SRC_NONE || src > s_tb.st.src ||
+                      residual > TIMEBASE_STEP_THRESHOLD_US || residual < -TIMEBASE_STEP_THRESHOLD_US;
+
+    if (jump && s_tb.hold && residual < 0) {
+        // Held: slew back at the bounded rate instead. The catch-up is not a
+        // clock error, so it stays out of the frequency loop.
+        int64_t corr = clamp_i64(residual / (1 << TIMEBASE_PHASE_SHIFT),
+                                 -TIMEBASE_SLEW_MAX_US, TIMEBASE_SLEW_MAX_US);
+        s_tb.st.anchor_utc_us = predict_locked(mono_us) + corr;
+        s_tb.st.anchor_mono_us = mono_us;
+        held = src != s_tb.st.src;
+        s_tb.st.src = src;
+        s_tb.rate_ref_mono_us = mono_us;
+        s_tb.corr_sum_us = 0;
+        s_tb.catching_up = true;
+    } else if (jump) {
+        // Step: take the reference as-is and restart the frequency loop.
+        s_tb.st.anchor_mono_us = mono_us;
+        s_tb.st.anchor_utc_us = utc_us;
+        s_tb.st.src = src;
+        s_tb.st.step_count++;
+        s_tb.rate_ref_mono_us = mono_us;
+        s_tb.corr_sum_us = 0;
+        s_tb.catching_up = false;
+        stepped = true;
+    } else {
+        // Slew: re-anchor on the predicted line plus a bounded correction.
+        int64_t corr = clamp_i64(residual / (1 << TIMEBASE_PHASE_SHIFT),
+                                 -TIMEBASE_SLEW_MAX_US, TIMEBASE_SLEW_MAX_US);
+        s_tb.st.anchor_utc_us = predict_locked(mono_us) + corr;
+        s_tb.st.anchor_mono_us = mono_us;
+        s_tb.corr_sum_us += corr;
+
+        // Until a held-off step is slewed out, the corrections are not clock error
+        if (s_tb.catching_up) {
+            s_tb.catching_up = residual < -TIMEBASE_SLEW_MAX_US || residual > TIMEBASE_SLEW_MAX_US;
+            s_tb.rate_ref_mono_us = mono_us;
+            s_tb.corr_sum_us = 0;
+        }
+
+        int64_t span = mono_us - s_tb.rate_ref_mono_us;
+        if (span >= TIMEBASE_RATE_SPAN_US) {
+            int64_t ppb = (int64_t)s_tb.st.rate_ppb + (s_tb.corr_sum_us * 1000000000LL) / span;
+            s_tb.st.rate_ppb = (int32_t)clamp_i64(ppb, -TIMEBASE_RATE_LIMIT_PPB, TIMEBASE_RATE_LIMIT_PPB);
+            s_tb.rate_ref_mono_us = mono_us;
+            s_tb.corr_sum_us = 0;
+        }
+    }
+
+    s_tb.st.last_residual_us = residual;
+    s_tb.st.discipline_count++;
+
+    taskEXIT_CRITICAL(&s_lock);
+
+    if (stepped) {
+        ESP_LOGI(TAG, "Stepped to src=%d utc=%lld.%06lld (residual %lld us)",
+                 (int)src, (long long)(utc_us / 1000000), (long long)(utc_us % 1000000),
+                 (long long)residual);
+    } else if (held) {
+        ESP_LOGI(TAG, "src=%d takes over %lld us behind; slewing while held", (int)src, (long long)-residual);
+    }
+    return ESP_OK;
+}
+
+void timebase_set_hold(bool hold)
+{
+    taskENTER_CRITICAL(&s_lock);
+    s_tb.hold = hold;
+    taskEXIT_CRITICAL(&s_lock);
+}
+
+int64_t timebase_mono_us(void)
+{
+    return esp_timer_get_time();
+}
+
+int64_t timebase_to_utc_us(int64_t mono_us)
+{
+    taskENTER_CRITICAL(&s_lock);
+    int64_t utc = (s_tb.st.src != TIMEBASE_SRC_NONE) ? predict_locked(mono_us) : 0;
+    taskEXIT_CRITICAL(&s_lock);
+    return utc;
+}
+
+int64_t timebase_now_utc_us(void)
+{
+    return timebase_to_utc_us(timebase_mono_us());
+}
+
+bool timebase_is_synced(void)
+{
+    return timebase_source() != TIMEBASE_SRC_NONE;
+}
+
+timebase_src_t timebase_source(void)
+{
+    taskENTER_CRITICAL(&s_lock);
+    timebase_src_t src = s_tb.st.src;
+    taskEXIT_CRITICAL(&s_lock);
+    return src;
+}
+
+void timebase_get_status(timebase_status_t *out)
+{
+    if (!out) return;
+    taskENTER_CRITICAL(&s_lock);
+    *out = s_tb.st;
+    taskEXIT_CRITICAL(&s_lock);
+}
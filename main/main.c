@@ -14,15 +14,25 @@
 #include "qmi8658.h"
 #include "sd_mmc_helper.h"
 #include "ble.h"
+#include "ble_rowing.h"
+#include "ble_sensors.h"
+#include "ble_xfer.h"
 #include "stroke_detection.h"
 #include "rtc_pcf85063.h"
 #include "battery_drv.h"
 #include "pwr_key.h"
 #include "activity.h"
+#include "activity_index.h"
 #include "activity_log.h"
+#include "activity_raw.h"
+#include "best_effort.h"
+#include "rolling_metrics.h"
+#include "session_journal.h"
 #include "gps_gtu8.h"
 #include "nvs_helper.h"
+#include "timebase.h"
 
+#include <sys/stat.h>
 #include <sys/time.h>
 #include <time.h>
 #include "esp_timer.h"
@@ -32,11 +42,17 @@
 #include "math.h"
 #include "ui/ui_settings_page.h" // Required for ui_settings_register_split_length_cb
 #include <stdio.h>
+#include <string.h>
 #include "ui_status_bar.h"
 
 static const char *TAG = "app";
 
-#define LOG_QUEUE_LEN 32
+_Static_assert((CONFIG_ACTIVITY_LOG_RING_LEN & (CONFIG_ACTIVITY_LOG_RING_LEN - 1)) == 0,
+               "CONFIG_ACTIVITY_LOG_RING_LEN must be a power of two");
+_Static_assert((CONFIG_ROLLING_METRICS_HISTORY & (CONFIG_ROLLING_METRICS_HISTORY - 1)) == 0,
+               "CONFIG_ROLLING_METRICS_HISTORY must be a power of two");
+_Static_assert((CONFIG_BEST_EFFORT_HISTORY & (CONFIG_BEST_EFFORT_HISTORY - 1)) == 0,
+               "CONFIG_BEST_EFFORT_HISTORY must be a power of two");
 
 /* ---------- Kconfig-based touch pins ---------- */
 
@@ -71,15 +87,31 @@ static bool s_activity_recording = false;
 static activity_t s_activity;
 static uint32_t s_activity_next_id = 1;
 
-static float s_session_time_s = 0.0f;          // session timer shown on data page
-static int64_t s_session_last_us = 0;          // for dt computation
+static int64_t s_session_time_us = 0;          // session timer shown on data page
+static int64_t s_session_start_us = 0;         // monotonic (esp_timer) at START
 
 static uint32_t s_last_session_stroke_count = 0; // baseline for session delta
 static SemaphoreHandle_t s_activity_mutex = NULL;
 
+/* Rolling windows over the session's catches, under s_activity_mutex */
+enum { ROLL_LAST_500M, ROLL_LAST_10, ROLL_LAST_MIN, ROLL_COUNT };
+static rm_sample_t s_roll_hist[CONFIG_ROLLING_METRICS_HISTORY];
+static rolling_metrics_t s_roll;
+
+/* Best efforts over the session's track, under s_activity_mutex */
+static best_effort_point_t s_best_pts[CONFIG_BEST_EFFORT_HISTORY];
+static best_effort_t s_best;
+
 /* Activity Log */
-static QueueHandle_t s_log_q = NULL;
+static activity_log_msg_t s_log_slots[CONFIG_ACTIVITY_LOG_RING_LEN];
+static activity_log_ring_t s_log_ring;          // stroke_task -> logger, in sample order
+static TaskHandle_t s_log_task = NULL;
+static alog_split_state_t s_split;              // split engine, under s_activity_mutex
 static activity_log_t s_act_log;
+static SemaphoreHandle_t s_log_mutex = NULL;   // s_act_log + journal; take before s_activity_mutex
+static bool s_journal_ok = false;
+
+#define JOURNAL_PERIOD_US (5LL * 1000000LL)    // checkpoint cadence while recording
 
 /* LVGL display + input */
 static lv_disp_t *s_disp = NULL;
@@ -114,6 +146,8 @@ static void app_pwr_key_setup(void);
 
 static void activity_worker_task(void *arg);
 static void on_stop_save_confirmed(void);
+static void activity_finish_session(void);
+static void journal_checkpoint_locked(void);
 
 static void activity_logger_task(void *arg);
 
@@ -134,6 +168,7 @@ static esp_err_t app_set_time_from_rtc(void);
  * ===========================================================
  */
 static bool s_time_synced_from_gps = false;
+static int64_t s_gps_last_time_rx_us = 0;     // last NMEA time fed to the timebase
 
 /* -------------------------------------------------------------------------- */
 /*  GPS / Time helpers                                                        */
@@ -141,20 +176,18 @@ static bool s_time_synced_from_gps = false;
 
 static time_t mktime_utc(struct tm *t)
 {
-    // mktime interprets as local time. Convert as UTC by temporarily setting TZ.
-    char *old = getenv("TZ");
-    char old_copy[64] = {0};
-    if (old) strncpy(old_copy, old, sizeof(old_copy)-1);
-
-    setenv("TZ", "UTC0", 1);
-    tzset();
-    time_t epoch = mktime(t);
-
-    if (old) setenv("TZ", old_copy, 1);
-    else unsetenv("TZ");
-    tzset();
-
-    return epoch;
+    // Days from civil (proleptic Gregorian), so no TZ juggling: this runs
+    // once per GPS fix from the GPS task.
+    int y = t->tm_year + 1900;
+    int m = t->tm_mon + 1;
+    y -= (m <= 2);
+    int era = (y >= 0 ? y : y - 399) / 400;
+    int yoe = y - era * 400;
+    int doy = (153 * (m + (m > 2 ? -3 : 9)) + 2) / 5 + t->tm_mday - 1;
+    int doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+    int64_t days = (int64_t)era * 146097 + doe - 719468;
+
+    return (time_t)(days * 86400 + t->tm_hour * 3600 + t->tm_min * 60 + t->tm_sec);
 }
 
 static void gps_fix_cb(const gps_fix_t *fix, void *user)
@@ -162,6 +195,17 @@ static void gps_fix_cb(const gps_fix_t *fix, void *user)
     (void)user;
     if (!fix) return;
 
+    // Discipline the monotonic->UTC mapping on every new NMEA time
+    if (fix->valid_time && fix->valid_date && fix->utc_rx_time_us != s_gps_last_time_rx_us) {
+        s_gps_last_time_rx_us = fix->utc_rx_time_us;
+        struct tm t = fix->utc_tm;
+        time_t epoch_utc = mktime_utc(&t);
+        if (epoch_utc > 1700000000) {
+            int64_t utc_us = (int64_t)epoch_utc * 1000000 + (int64_t)fix->utc_ms * 1000;
+            timebase_discipline(TIMEBASE_SRC_GPS, fix->utc_rx_time_us, utc_us);
+        }
+    }
+
     if (!s_time_synced_from_gps && fix->valid_time && fix->valid_date) {
         // 1) set system time (epoch in UTC)
         struct tm t = fix->utc_tm;
@@ -191,6 +235,25 @@ static void gps_fix_cb(const gps_fix_t *fix, void *user)
             s_time_synced_from_gps = true;
         }
     }
+    if (activity_raw_is_running()) {
+        activity_raw_gps_t g = {
+            .valid_fix = fix->valid_fix,
+            .valid_time = fix->valid_time && fix->valid_date,
+            .lat_deg = fix->lat_deg,
+            .lon_deg = fix->lon_deg,
+            .speed_mps = fix->speed_mps,
+            .course_deg = fix->course_deg,
+            .hdop = fix->hdop,
+            .sats = fix->sats,
+            .fix_quality = fix->fix_quality,
+        };
+        if (g.valid_time) {
+            struct tm t = fix->utc_tm;
+            g.utc_us = (int64_t)mktime_utc(&t) * 1000000 + (int64_t)fix->utc_ms * 1000;
+        }
+        activity_raw_push_gps(fix->rx_time_us, &g);
+    }
+
     ESP_LOGI("GPS", "fix=%d time=%d date=%d lat=%.7f lon=%.7f speed=%.2f sats=%d hdop=%.1f",
          fix->valid_fix, fix->valid_time, fix->valid_date,
          fix->lat_deg, fix->lon_deg, fix->speed_mps, fix->sats, fix->hdop);
@@ -242,8 +305,9 @@ static void touch_read_cb(lv_indev_t *indev, lv_indev_data_t *data)
 
 static void on_shutdown_confirmed(void)
 {
-    // Optional: save state, flush logs, stop peripherals, etc.
-    // Then cut the latch power:
+    // Close a running session synchronously so the files are complete on the card,
+    // then cut the latch power:
+    activity_finish_session();
     pwr_key_set_hold(false);
 }
 
@@ -333,51 +397,108 @@ static void activity_worker_task(void *arg)
 
         ui_go_to_page(UI_PAGE_DATA, true);
 
-        if (s_activity_mutex) xSemaphoreTake(s_activity_mutex, portMAX_DELAY);
-
         if (cmd == ACT_CMD_START) {
+            if (s_activity_mutex) xSemaphoreTake(s_activity_mutex, portMAX_DELAY);
+
             s_activity_recording = true;
-            s_session_time_s = 0.0f;
+            s_session_start_us = timebase_mono_us();
+            s_session_time_us = 0;
 
             uint32_t id = s_activity_next_id++;
             activity_init(&s_activity, id);
-            activity_start(&s_activity, time(NULL));
-
-            if (s_sd.mounted) {
-                // Starts the per-stroke CSV log file on the SD card
-                activity_log_start(&s_act_log, &s_sd, s_activity.start_ts, s_activity.id);
-            }
+            activity_start(&s_activity, timebase_to_utc_us(s_session_start_us));
+            // Row times must not run backwards when GPS takes over from the RTC
+            timebase_set_hold(true);
+            const time_t start_ts = s_activity.start_ts;
 
             s_last_session_stroke_count = 0;
+            activity_log_split_init(&s_act_log, &s_split);
+            rolling_metrics_reset(&s_roll);
+            best_effort_reset(&s_best);
 
             if (s_activity_mutex) xSemaphoreGive(s_activity_mutex);
 
+            if (s_sd.mounted) {
+                xSemaphoreTake(s_log_mutex, portMAX_DELAY);
+
+                // Starts the per-stroke log file (CSV or binary) on the SD card
+                activity_log_start(&s_act_log, &s_sd, start_ts, id);
+#if CONFIG_ACTIVITY_RAW_CAPTURE
+                char raw_path[192];
+                snprintf(raw_path, sizeof(raw_path), "%s/%s" ACTIVITY_RAW_FILE_SUFFIX,
+                         s_sd.mount_point, s_act_log.filename_base);
+                const activity_raw_config_t raw_cfg = {
+                    .accel_scale = s_imu.accel_scale,
+                    .gyro_scale = s_imu.gyro_scale,
+                };
+                activity_raw_start(raw_path, &raw_cfg);
+#endif
+                // First checkpoint marks the session open before any stroke lands
+                journal_checkpoint_locked();
+
+                xSemaphoreGive(s_log_mutex);
+            }
+
             data_page_show_activity_toast(true);
             ESP_LOGI("ACT", "START id=%lu", (unsigned long)id);
         }
 
         if (cmd == ACT_CMD_STOP_SAVE) {
-            s_activity_recording = false;
-            
-            // Stop logic updates end time and averages
-            activity_stop(&s_activity, time(NULL));
-
-            activity_t snapshot = s_activity; 
-            if (s_activity_mutex) xSemaphoreGive(s_activity_mutex);
-
+            activity_finish_session();
             data_page_show_activity_toast(false);
-            ESP_LOGI("ACT", "STOP id=%lu Dist=%.1fm", (unsigned long)snapshot.id, (double)snapshot.distance_m);
-
-            // STOP THE LOGGER: This flushes and closes the CSV file.
-            // The file is now complete and saved on the SD card.
-            activity_log_stop(&s_act_log);
-
-            // REMOVED: activity_save_to_sd(...)
-            // We deleted this call because the log file created above IS the save file.
         }
     }
 }
 
+/*
+ * Stop the running session and get everything onto the card: rows still
+ * queued, the logs (truncated to their real length) and the journal. Runs
+ * synchronously so the shutdown path can call it right before power-off.
+ */
+static void activity_finish_session(void)
+{
+    if (s_activity_mutex) xSemaphoreTake(s_activity_mutex, portMAX_DELAY);
+    if (!s_activity_recording) {
+        if (s_activity_mutex) xSemaphoreGive(s_activity_mutex);
+        return;
+    }
+    s_activity_recording = false;
+
+    // Stop logic updates end time and averages
+    activity_stop(&s_activity, timebase_now_utc_us());
+    timebase_set_hold(false);
+    if (best_effort_finish(&s_best)) best_effort_get(&s_best, s_activity.best_effort);
+    activity_t snapshot = s_activity;
+    // The partial split since the last boundary
+    activity_log_split_row_t last_split;
+    const bool has_last_split = alog_split_finish(&s_split, &last_split);
+    if (s_activity_mutex) xSemaphoreGive(s_activity_mutex);
+
+    xSemaphoreTake(s_log_mutex, portMAX_DELAY);
+
+    activity_log_drain(&s_act_log, &s_log_ring);
+    if (has_last_split) activity_log_append_last_split(&s_act_log, &last_split);
+
+    // The log file IS the save file; stopping flushes, truncates and closes it.
+    const bool logged = s_act_log.opened;
+    activity_log_stop(&s_act_log);
+    if (logged) {
+        activity_index_append(&snapshot, s_act_log.filename_base, 0);
+        // Human-readable companions: activity_<id>.json and a row in index.csv
+        esp_err_t err = activity_save_to_sd(&s_sd, &snapshot, true);
+        if (err != ESP_OK) ESP_LOGW(TAG, "Cannot save the session summary: %s", esp_err_to_name(err));
+    }
+    activity_raw_stop();
+    if (s_journal_ok) session_journal_close();
+
+    xSemaphoreGive(s_log_mutex);
+
+    ESP_LOGI("ACT", "STOP id=%lu Dist=%.1fm Best 500m=%.1fs 1k=%.1fs 2k=%.1fs 1min=%.0fm",
+             (unsigned long)snapshot.id, (double)snapshot.distance_m,
+             (double)snapshot.best_effort[BEST_EFFORT_500M], (double)snapshot.best_effort[BEST_EFFORT_1K],
+             (double)snapshot.best_effort[BEST_EFFORT_2K], (double)snapshot.best_effort[BEST_EFFORT_1MIN]);
+}
+
 static void on_stop_save_confirmed(void)
 {
     act_cmd_t cmd = ACT_CMD_STOP_SAVE;
@@ -391,18 +512,101 @@ static void on_stop_save_confirmed(void)
 /*  Activity logger task                                                       */
 /* -------------------------------------------------------------------------- */
 
+/* Caller holds s_log_mutex. */
+static void journal_checkpoint_locked(void)
+{
+    if (!s_journal_ok || !s_act_log.opened) return;
+
+    activity_log_sync(&s_act_log);
+
+    session_journal_rec_t rec = {0};
+    rec.state = SESSION_JOURNAL_ACTIVE;
+    rec.log_format = (uint8_t)s_act_log.format;
+    snprintf(rec.base, sizeof(rec.base), "%s", s_act_log.filename_base);
+    rec.main_len = activity_log_main_length(&s_act_log);
+    rec.splits_len = activity_log_splits_length(&s_act_log);
+
+    activity_raw_stats_t raw;
+    activity_raw_get_stats(&raw);
+    rec.raw_enabled = raw.running;
+    rec.raw_len = raw.file_bytes;
+
+    if (s_activity_mutex) xSemaphoreTake(s_activity_mutex, portMAX_DELAY);
+    rec.act = s_activity;
+    if (s_activity_mutex) xSemaphoreGive(s_activity_mutex);
+
+    session_journal_checkpoint(&rec);
+}
+
+/*
+ * Ring fill at which stroke_task wakes the logger early, for the card's
+ * current health: a card that stalls gets fewer, larger batches. The
+ * wake-up period stays CONFIG_ACTIVITY_LOG_MAX_LATENCY_MS whatever the card
+ * does, and a quarter of the ring is always left for rows that arrive
+ * while a batch is written.
+ */
+static uint32_t logger_wake_rows(sd_health_t health)
+{
+    switch (health) {
+    case SD_HEALTH_FAIR: return CONFIG_ACTIVITY_LOG_RING_LEN * 5 / 8;
+    case SD_HEALTH_SLOW: return CONFIG_ACTIVITY_LOG_RING_LEN * 3 / 4;
+    default:             return CONFIG_ACTIVITY_LOG_RING_LEN / 2;
+    }
+}
+
+// Written by the logger task, read by stroke_task
+static volatile uint32_t s_log_wake_rows = CONFIG_ACTIVITY_LOG_RING_LEN / 2;
+
 static void activity_logger_task(void *arg)
 {
     (void)arg;
 
-    activity_log_row_t row;
+    int64_t last_checkpoint_us = 0;
+    uint32_t reported_drops = 0;
+    sd_health_t health = SD_HEALTH_UNKNOWN;
     for (;;) {
-        if (xQueueReceive(s_log_q, &row, portMAX_DELAY) == pdTRUE) {
-            // Only append if file is open
-            if (s_act_log.opened) {
-                activity_log_append(&s_act_log, &row);
-            }
+        // One batch per wake-up: the latency bound, or stroke_task once the ring fills to s_log_wake_rows
+        ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(CONFIG_ACTIVITY_LOG_MAX_LATENCY_MS));
+
+        xSemaphoreTake(s_log_mutex, portMAX_DELAY);
+        activity_log_drain(&s_act_log, &s_log_ring);
+
+        int64_t now_us = esp_timer_get_time();
+        if (s_act_log.opened && now_us - last_checkpoint_us >= JOURNAL_PERIOD_US) {
+            journal_checkpoint_locked();
+            last_checkpoint_us = now_us;
         }
+        xSemaphoreGive(s_log_mutex);
+
+        uint32_t drops = alog_ring_dropped(&s_log_ring);
+        if (drops != reported_drops) {
+            ESP_LOGW(TAG, "Log ring full: %lu rows dropped so far (peak %lu/%lu waiting)",
+                     (unsigned long)drops, (unsigned long)s_log_ring.high_water,
+                     (unsigned long)alog_ring_capacity(&s_log_ring));
+            reported_drops = drops;
+        }
+
+        sd_io_stats_t io;
+        sd_io_stats_get(&io);
+        sd_health_t h = sd_io_health(&io);
+        if (h != health && h > SD_HEALTH_GOOD) {
+            ESP_LOGW(TAG, "SD card %s: %lu slow ops, worst %.1f ms, %lu KB/s; batching at %lu/%lu rows",
+                     sd_io_health_name(h), (unsigned long)io.slow,
+                     (double)io.max_us * 1e-3,
+                     (unsigned long)(sd_io_bytes_per_s(&io) / 1024), (unsigned long)logger_wake_rows(h),
+                     (unsigned long)CONFIG_ACTIVITY_LOG_RING_LEN);
+        }
+        health = h;
+        s_log_wake_rows = logger_wake_rows(h);
+    }
+}
+
+/* stroke_task side of the log ring. */
+static void log_push(const activity_log_msg_t *msg)
+{
+    alog_ring_push(&s_log_ring, msg);
+    if (s_log_task && alog_ring_count(&s_log_ring) >= s_log_wake_rows) {
+        xTaskNotifyGive(s_log_task);
     }
 }
 
@@ -512,6 +716,9 @@ static void stroke_task(void *arg)
     static double s_gps_lat = NAN;
     static double s_gps_lon = NAN;
 
+    // Rolling window values as of the last catch, for the data page
+    rm_result_t roll[ROLL_COUNT] = {0};
+
     const float fs_hz = 200.0f;
     const stroke_detection_cfg_t cfg = {
         .fs_hz = fs_hz,
@@ -545,7 +752,6 @@ static void stroke_task(void *arg)
 
     stroke_detection_init(&s_stroke, &cfg);
 
-    const int64_t t0_us = esp_timer_get_time();
     int64_t prev_us = esp_timer_get_time();
     TickType_t last_ui_tick = xTaskGetTickCount();
 
@@ -556,22 +762,33 @@ static void stroke_task(void *arg)
     const TickType_t ui_period    = pdMS_TO_TICKS(80);  // 12.5 Hz UI updates
 
     static float s_last_valid_spm = NAN;
-    static float s_last_spm_t_s = -1.0f;
+    static int64_t s_last_spm_us = -1;
+    const int64_t spm_stale_us = 12000000;
 
     while (1) {
-        float ax, ay, az, gx, gy, gz;
-        esp_err_t err = qmi8658_read_accel_gyro(&s_imu, &ax, &ay, &az, &gx, &gy, &gz);
+        int16_t raw[6];
+        esp_err_t err = qmi8658_read_raw(&s_imu, raw);
         if (err == ESP_OK) {
 
+            // Monotonic sample time; everything below derives from int64 us
             int64_t now_us = esp_timer_get_time();
-            float t_s  = (float)(now_us - t0_us) * 1e-6f;
-            float dt_s = (float)(now_us - prev_us) * 1e-6f;
+            activity_raw_push_imu(now_us, raw);
+
+            float ax = raw[0] * s_imu.accel_scale;
+            float ay = raw[1] * s_imu.accel_scale;
+            float az = raw[2] * s_imu.accel_scale;
+            float gx = raw[3] * s_imu.gyro_scale;
+            float gy = raw[4] * s_imu.gyro_scale;
+            float gz = raw[5] * s_imu.gyro_scale;
+            int64_t dt_us = now_us - prev_us;
             prev_us = now_us;
-            if (dt_s < 0.0f) dt_s = 0.0f;
-            if (dt_s > 0.1f) dt_s = 0.1f;
+            if (dt_us < 0) dt_us = 0;
+            if (dt_us > 100000) dt_us = 100000;
+            float dt_s = (float)dt_us * 1e-6f;
+            const int64_t sample_utc_us = timebase_to_utc_us(now_us);
 
             stroke_metrics_t m = {0};
-            stroke_event_t ev = stroke_detection_update(&s_stroke, t_s, ax, ay, az, gx, gy, gz, &m);
+            stroke_event_t ev = stroke_detection_update(&s_stroke, now_us, ax, ay, az, gx, gy, gz, &m);
 
             if (ev != STROKE_EVENT_NONE) {
                 ESP_LOGI("STROKE", "ev=%d count=%lu spm=%.1f period=%.2fs",
@@ -595,11 +812,11 @@ static void stroke_task(void *arg)
 
             if (isfinite(m.spm) && m.spm >= 10.0f && m.spm <= 80.0f) {
                 s_last_valid_spm = m.spm;
-                s_last_spm_t_s = t_s;
+                s_last_spm_us = now_us;
             }
 
             float spm_raw = s_last_valid_spm;
-            if (s_last_spm_t_s > 0.0f && (t_s - s_last_spm_t_s) > 12.0f) spm_raw = NAN;
+            if (s_last_spm_us >= 0 && (now_us - s_last_spm_us) > spm_stale_us) spm_raw = NAN;
             if (!isfinite(spm_raw)) spm_raw = 0.0f;
 
             // GPS Logic
@@ -622,6 +839,14 @@ static void stroke_task(void *arg)
             float speed_mps = gps_ok ? s_gps_speed_filt : 0.0f;
             float dist_delta_m = speed_mps * dt_s;
 
+            // Power meter over BLE (ble_sensors.h): NAN without a fresh reading
+            float power_w = NAN;
+            ble_sensor_reading_t power;
+            if (ble_sensors_latest(BLE_SENSOR_POWER, CONFIG_BLE_SENSOR_STALE_MS * 1000LL, &power)) {
+                power_w = power.value;
+            }
+            const float power_log_w = isfinite(power_w) ? power_w : 0.0f;
+
             // --- 1. Calculate Derived Metrics for Logging ---
             
             // Instant Pace (s/500m)
@@ -641,74 +866,96 @@ static void stroke_task(void *arg)
             // --- End Derived Metrics ---
 
             bool need_log = false;
-            activity_log_row_t row = {0}; 
+            activity_log_msg_t msg = { .kind = ACTIVITY_LOG_MSG_STROKE };
+            activity_log_row_t *row = &msg.row;
+            bool need_split = false;
+            activity_log_msg_t split_msg = { .kind = ACTIVITY_LOG_MSG_SPLIT };
+            // Live telemetry (custom service and FTMS): once per rate period, only with listeners
+            const bool ble_due = ble_rowing_due(now_us);
+            float ble_avg_speed_mps = 0.0f;
 
             if (s_activity_mutex) xSemaphoreTake(s_activity_mutex, portMAX_DELAY);
 
             if (s_activity_recording) {
-                s_session_time_s += dt_s;
+                s_session_time_us = now_us - s_session_start_us;
 
                 uint32_t stroke_delta = (ev == STROKE_EVENT_CATCH) ? 1 : 0;
 
                 // Update Session Model (Activity.c)
                 activity_update(&s_activity,
-                                dt_s,
+                                dt_us,
                                 speed_mps,
                                 spm_raw,
-                                0.0f, // Power placeholder
+                                power_log_w,
                                 dist_delta_m,
                                 stroke_delta);
 
-                // Calculate Avg Pace from Session Avg Speed
-                float avg_pace_s = (s_activity.avg_speed_mps > 0.1f) ? (500.0f / s_activity.avg_speed_mps) : 0.0f;
+                // Thinned track for the best efforts; the summary copy changes only on a new best
+                if (best_effort_update(&s_best, s_session_time_us, s_activity.distance_m))
+                    best_effort_get(&s_best, s_activity.best_effort);
+
+                // Splits close on the sample that crosses the boundary, not on the next stroke
+                need_split = alog_split_sample(&s_split, s_session_time_us, s_activity.distance_m, &split_msg.split);
+                if (stroke_delta) alog_split_stroke(&s_split, spm_raw, power_log_w);
+                if (ble_due) ble_avg_speed_mps = activity_avg_speed_mps(&s_activity);
 
                 // Only log on CATCH
                 if (ev == STROKE_EVENT_CATCH) {
-                    
+                    // Session averages are worked out here, once per stroke, not per sample
+                    const float avg_speed_mps = activity_avg_speed_mps(&s_activity);
+                    const float avg_pace_s = (avg_speed_mps > 0.1f) ? (500.0f / avg_speed_mps) : 0.0f;
+
+                    rolling_metrics_push(&s_roll, s_session_time_us, s_activity.distance_m, power_log_w);
+                    for (int i = 0; i < ROLL_COUNT; i++) rolling_metrics_get(&s_roll, i, &roll[i]);
+
                     // --- Populate the 16-Column Row ---
                     
-                    // 1. RTC Time
-                    row.rtc_time = time(NULL); 
+                    // 1. Absolute Time (timebase UTC of this sample)
+                    row->utc_us = sample_utc_us;
                     // 2. Session Time
-                    row.session_time_s = s_session_time_s;
+                    row->session_time_us = s_session_time_us;
                     // 3. Distance (Total)
-                    row.total_distance_m = s_activity.distance_m;
+                    row->total_distance_m = s_activity.distance_m;
                     // 4. Instant Pace
-                    row.pace_500m_s = instant_pace_s;
+                    row->pace_500m_s = instant_pace_s;
                     // 5. SPM Instant
-                    row.spm_instant = spm_raw;
+                    row->spm_instant = spm_raw;
                     // 6. Avg Pace
-                    row.avg_pace_500m_s = avg_pace_s;
+                    row->avg_pace_500m_s = avg_pace_s;
                     // 7. Avg Speed
-                    row.avg_speed_mps = s_activity.avg_speed_mps;
+                    row->avg_speed_mps = avg_speed_mps;
                     // 8. Stroke Length
-                    row.stroke_length_m = stroke_len_m;
+                    row->stroke_length_m = stroke_len_m;
                     // 9. Stroke Count
-                    row.stroke_count = s_activity.stroke_count;
+                    row->stroke_count = s_activity.stroke_count;
                     // 10. GPS Lat
-                    row.gps_lat = gps_ok ? s_gps_lat : 0.0;
+                    row->gps_lat = gps_ok ? s_gps_lat : 0.0;
                     // 11. GPS Long
-                    row.gps_lon = gps_ok ? s_gps_lon : 0.0;
+                    row->gps_lon = gps_ok ? s_gps_lon : 0.0;
                     // 12. Power
-                    row.power_w = 0.0f; 
+                    row->power_w = power_log_w;
                     // 13. Drive Time
-                    row.drive_time_s = m.drive_time_s;
+                    row->drive_time_s = m.drive_time_s;
                     // 14. Recovery Time
-                    row.recovery_time_s = m.recovery_time_s;
+                    row->recovery_time_s = m.recovery_time_s;
                     // 15. Recovery Ratio
-                    row.recovery_ratio = recov_ratio;
+                    row->recovery_ratio = recov_ratio;
+                    // 16-17. Rolling pace / rate
+                    row->roll_pace_500m_s = roll[ROLL_LAST_500M].pace_500m_s;
+                    row->roll_spm = roll[ROLL_LAST_10].spm;
 
                     need_log = true;
                 }
             } else {
-                s_session_time_s = 0.0f;
+                s_session_time_us = 0;
+                memset(roll, 0, sizeof(roll));
             }
 
             if (s_activity_mutex) xSemaphoreGive(s_activity_mutex);
 
-            if (need_log && s_log_q) {
-                xQueueSend(s_log_q, &row, 0); 
-            }
+            // Split first: the catch on this sample belongs to the next split
+            if (need_split) log_push(&split_msg);
+            if (need_log) log_push(&msg);
 
             // UI Update
             TickType_t now = xTaskGetTickCount();
@@ -716,25 +963,48 @@ static void stroke_task(void *arg)
             {
                 last_ui_tick = now;
                 float spm_raw_ui = s_last_valid_spm;
-                if (s_last_spm_t_s > 0.0f && (t_s - s_last_spm_t_s) > 12.0f) spm_raw_ui = NAN;
+                if (s_last_spm_us >= 0 && (now_us - s_last_spm_us) > spm_stale_us) spm_raw_ui = NAN;
 
                 float spm_disp = spm_raw_ui;
                 if (isfinite(spm_disp)) spm_disp = ceilf(spm_disp * 2.0f) / 2.0f;
 
                 bool recording = s_activity_recording;
                 float pace = (speed_mps > 0.2f) ? (500.0f / speed_mps) : NAN;
+                ble_sensor_reading_t hr;
+                const bool hr_ok = ble_sensors_latest(BLE_SENSOR_HR, CONFIG_BLE_SENSOR_STALE_MS * 1000LL, &hr);
 
                 data_values_t v = {
-                    .time_s = recording ? s_session_time_s : NAN,
+                    .time_s = recording ? (float)((double)s_session_time_us * 1e-6) : NAN,
                     .distance_m = recording ? s_activity.distance_m : NAN,
                     .pace_s_per_500m = recording ? pace : NAN,
                     .speed_mps = recording ? speed_mps : NAN,
                     .spm = spm_disp,
-                    .power_w = NAN,
+                    .power_w = power_w,
                     .stroke_count = recording ? s_activity.stroke_count : UINT32_MAX,
+                    .pace_last_500m_s = roll[ROLL_LAST_500M].strokes ? roll[ROLL_LAST_500M].pace_500m_s : NAN,
+                    .spm_last_10 = roll[ROLL_LAST_10].strokes ? roll[ROLL_LAST_10].spm : NAN,
+                    .pace_last_min_s = roll[ROLL_LAST_MIN].strokes ? roll[ROLL_LAST_MIN].pace_500m_s : NAN,
+                    .heart_rate_bpm = hr_ok ? hr.value : NAN,
                 };
                 data_page_set_values(&v);
             }
+
+            if (ble_due) {
+                bool recording = s_activity_recording;
+                ble_rowing_sample_t bs = {
+                    .t_ms = recording ? (uint32_t)(s_session_time_us / 1000) : 0,
+                    .spm = spm_raw,
+                    .pace_500m_s = instant_pace_s,
+                    .speed_mps = speed_mps,
+                    .distance_m = recording ? s_activity.distance_m : 0.0f,
+                    .stroke_count = recording ? s_activity.stroke_count : 0,
+                    .drive_time_s = m.drive_time_s,
+                    .recovery_time_s = m.recovery_time_s,
+                    .avg_pace_500m_s = (ble_avg_speed_mps > 0.1f) ? (500.0f / ble_avg_speed_mps) : 0.0f,
+                    .power_w = power_w,
+                };
+                ble_rowing_publish(&bs);
+            }
         }
         vTaskDelay(sample_delay);
     }
@@ -887,6 +1157,9 @@ static esp_err_t app_set_time_from_rtc(void)
     };
     settimeofday(&tv, NULL);
 
+    // Coarse (1 s) reference until GPS takes over
+    timebase_discipline(TIMEBASE_SRC_RTC, esp_timer_get_time(), (int64_t)epoch * 1000000);
+
     ESP_LOGI(TAG, "System time set from RTC: %04u-%02u-%02u %02u:%02u:%02u",
              (unsigned)dt.year, (unsigned)dt.month, (unsigned)dt.day,
              (unsigned)dt.hour, (unsigned)dt.minute, (unsigned)dt.second);
@@ -908,6 +1181,71 @@ static esp_err_t app_set_time_from_rtc(void)
 //         ESP_ERROR_CHECK(err);
 //     }
 // }
+/* ===========================================================
+ *  SESSION DOWNLOAD (ble_xfer source: the activity index)
+ * ===========================================================
+ */
+
+// BLE host task. The index is appended under s_log_mutex when a session stops.
+static bool xfer_index_get(uint32_t i, activity_index_rec_t *out)
+{
+    if (!s_log_mutex || xSemaphoreTake(s_log_mutex, pdMS_TO_TICKS(200)) != pdTRUE) return false;
+    esp_err_t err = activity_index_get(i, out);
+    xSemaphoreGive(s_log_mutex);
+    return err == ESP_OK;
+}
+
+static int xfer_count(void)
+{
+    return (int)activity_index_count();
+}
+
+static bool xfer_get(int i, ble_xfer_session_t *out)
+{
+    uint32_t n = activity_index_count();
+    activity_index_rec_t r;
+    if (i < 0 || (uint32_t)i >= n || !xfer_index_get(n - 1 - (uint32_t)i, &r)) return false;
+
+    *out = (ble_xfer_session_t){
+        .id = r.id,
+        .start_utc_us = r.start_utc_us,
+        .duration_ms = r.duration_ms,
+        .distance_m = r.distance_m,
+    };
+    return true;
+}
+
+static bool xfer_path(uint32_t id, ble_xfer_file_t file, char *out, size_t len)
+{
+    // Newest first: that is what gets downloaded
+    activity_index_rec_t r;
+    bool found = false;
+    for (uint32_t i = activity_index_count(); i > 0 && !found; i--)
+        found = xfer_index_get(i - 1, &r) && r.id == id;
+    if (!found) return false;
+
+    static const char *const k_suffix[BLE_XFER_FILE_COUNT] = {
+        [BLE_XFER_FILE_STROKES] = ACTIVITY_LOG_SUFFIX_STROKES_BIN,
+        [BLE_XFER_FILE_SPLITS] = ACTIVITY_LOG_SUFFIX_SPLITS,
+        [BLE_XFER_FILE_FIT] = ACTIVITY_LOG_SUFFIX_FIT,
+        [BLE_XFER_FILE_RAW] = ACTIVITY_RAW_FILE_SUFFIX,
+    };
+    struct stat st;
+    snprintf(out, len, "%s/%s%s", s_sd.mount_point, r.base, k_suffix[file]);
+    if (stat(out, &st) == 0) return true;
+    if (file != BLE_XFER_FILE_STROKES) return false;
+
+    // Sessions logged as CSV
+    snprintf(out, len, "%s/%s%s", s_sd.mount_point, r.base, ACTIVITY_LOG_SUFFIX_STROKES_CSV);
+    return stat(out, &st) == 0;
+}
+
+static const ble_xfer_source_t s_xfer_source = {
+    .count = xfer_count,
+    .get = xfer_get,
+    .path = xfer_path,
+};
+
 /* ===========================================================
  *  app_main – orchestrator
  * ===========================================================
@@ -915,6 +1253,7 @@ static esp_err_t app_set_time_from_rtc(void)
 
 void app_main(void)
 {
+    timebase_init();
     init_display_and_lvgl();
     init_touch_and_lvgl_input();
     init_imu();
@@ -951,12 +1290,48 @@ void app_main(void)
     ESP_ERROR_CHECK(ble_app_init());
     ble_set_device_name("ESP32S3-BLE"); // optional custom name
     ble_start_advertising();
+#if CONFIG_BLE_BOAT_OBSERVER
+    ble_start_observing();  // coach unit: listens to the boats
+#endif
+#if CONFIG_BLE_BOAT_BROADCAST
+    ble_start_broadcast(CONFIG_BLE_BOAT_BROADCAST_HZ);
+#endif
 
     esp_err_t sd_err = sd_mmc_helper_mount(&s_sd, "/sdcard");
     if (sd_err != ESP_OK)
     {
         ESP_LOGW(TAG, "SD mount failed: %s (continuing)", esp_err_to_name(sd_err));
     }
+    else
+    {
+        // A card that cannot keep up should be swapped before the session, not found out after
+        if (CONFIG_SD_MMC_HELPER_PROBE_KB > 0) {
+            sd_io_stats_t probe;
+            sd_mmc_helper_probe(&s_sd, CONFIG_SD_MMC_HELPER_PROBE_KB, &probe);
+            sd_health_t h = sd_io_health(&probe);
+            if (h >= SD_HEALTH_SLOW)
+                ESP_LOGW(TAG, "SD card is %s: logs may have gaps, replace it before racing", sd_io_health_name(h));
+        }
+
+        // Session history (rebuilt from the logs if it is missing or damaged)
+        activity_index_open(s_sd.mount_point);
+    }
+
+    if (sd_err == ESP_OK && session_journal_open(s_sd.mount_point) == ESP_OK)
+    {
+        s_journal_ok = true;
+
+        // A session that never reached STOP (brownout, reset): finalize it from its last checkpoint
+        session_journal_rec_t pending;
+        if (session_journal_pending(&pending)) {
+            session_journal_recover(s_sd.mount_point, &pending);
+        }
+    }
+
+    // Ids continue from the newest session on the card, recovered one included
+    if (activity_index_count() > 0) {
+        s_activity_next_id = activity_index_next_id();
+    }
 
     bool saved_dark = nvs_helper_get_dark_mode(); 
     ui_set_dark_mode(saved_dark);
@@ -966,6 +1341,15 @@ void app_main(void)
     uint32_t saved_split = nvs_helper_get_split_len();
     activity_log_init(&s_act_log); // Ensure log is init'd before setting interval
     activity_log_set_split_interval(&s_act_log, saved_split);
+#if CONFIG_ACTIVITY_LOG_SPLIT_TIME_S > 0
+    activity_log_set_split_time(&s_act_log, CONFIG_ACTIVITY_LOG_SPLIT_TIME_S);
+#endif
+#if CONFIG_ACTIVITY_LOG_BINARY
+    activity_log_set_format(&s_act_log, ACTIVITY_LOG_FORMAT_BINARY);
+#endif
+#if CONFIG_ACTIVITY_LOG_FIT
+    activity_log_set_fit(&s_act_log, true);
+#endif
 
 
     ui_register_dark_mode_cb(on_dark_mode_setting_changed);
@@ -975,17 +1359,26 @@ void app_main(void)
     ui_settings_register_split_length_cb(on_split_interval_changed);
 
     s_activity_mutex = xSemaphoreCreateMutex();
+    s_log_mutex = xSemaphoreCreateMutex();
+    if (sd_err == ESP_OK) ble_xfer_set_source(&s_xfer_source);
     activity_init(&s_activity, 0);
-    s_session_time_s = 0.0f;
-    s_session_last_us = esp_timer_get_time();
+    s_session_time_us = 0;
+    s_session_start_us = esp_timer_get_time();
 
     s_act_q = xQueueCreate(4, sizeof(act_cmd_t));
     assert(s_act_q);
 
-    s_log_q = xQueueCreate(LOG_QUEUE_LEN, sizeof(activity_log_row_t));
-    assert(s_log_q);
+    alog_ring_init(&s_log_ring, s_log_slots, CONFIG_ACTIVITY_LOG_RING_LEN);
+
+    // Window order matches ROLL_*; the first two are the stroke log's rolling columns
+    rolling_metrics_init(&s_roll, s_roll_hist, CONFIG_ROLLING_METRICS_HISTORY);
+    rolling_metrics_add_window(&s_roll, RM_WINDOW_DISTANCE, ALOG_ROLL_PACE_M);
+    rolling_metrics_add_window(&s_roll, RM_WINDOW_STROKES, ALOG_ROLL_RATE_STROKES);
+    rolling_metrics_add_window(&s_roll, RM_WINDOW_TIME, 60.0f);
+
+    best_effort_init(&s_best, s_best_pts, CONFIG_BEST_EFFORT_HISTORY);
 
-    xTaskCreate(activity_logger_task, "activity_logger", 6144, NULL, 6, NULL);
+    xTaskCreate(activity_logger_task, "activity_logger", 6144, NULL, 6, &s_log_task);
     xTaskCreate(activity_worker_task, "activity_worker", 8192, NULL, 9, &s_act_worker_task);
     xTaskCreatePinnedToCore(stroke_task, "stroke",
                             6144, NULL, 3, NULL, 0);                      
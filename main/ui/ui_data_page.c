@@ -2,13 +2,13 @@
 #include "ui_data_page.h"
 
 #include "esp_lvgl_port.h"
+#include "fastfmt.h"
 #include "lvgl.h"
 #include "ui_theme.h"
 
 #include <math.h>
 #include <stdbool.h>
 #include <stdint.h>
-#include <stdio.h>
 #include <string.h>
 
 #define DATA_SLOT_MAX 3
@@ -94,66 +94,39 @@ static int slot_count_for_current_orient(void)
     return is_landscape(s_orient) ? 3 : 3;
 }
 
-static void fmt_time_s(float sec, char *out, size_t out_len)
-{
-    if (!isfinite(sec) || sec < 0.0f) {
-        snprintf(out, out_len, "--:--.-");
-        return;
-    }
-
-    int total = (int)sec;
-    int tenths = (int)lroundf((sec - (float)total) * 10.0f);
-    if (tenths >= 10) {
-        tenths = 0;
-        total += 1;
-    }
-
-    int s = total % 60;
-    int m = (total / 60) % 60;
-    int h = total / 3600;
+/* value_buf in apply_metric_to_slot() is sized for any of these (>= FF_INT_MAX). */
 
-    if (h > 0) {
-        snprintf(out, out_len, "%d:%02d:%02d", h, m, s);
-    } else {
-        snprintf(out, out_len, "%02d:%02d.%d", m, s, tenths);
-    }
+static void fmt_time_s(float sec, char *out)
+{
+    ff_clock(out, sec);
 }
 
-static void fmt_pace_s_per_500m(float sec, char *out, size_t out_len)
+static void fmt_pace_s_per_500m(float sec, char *out)
 {
     if (!isfinite(sec) || sec <= 0.0f) {
-        snprintf(out, out_len, "--:--.-");
+        strcpy(out, "--:--.-");
         return;
     }
-    fmt_time_s(sec, out, out_len);
+    ff_clock(out, sec);
 }
 
-static void fmt_distance_m(float m, char *value_out, size_t value_len, const char **unit_out)
+static void fmt_distance_m(float m, char *value_out, const char **unit_out)
 {
     if (!isfinite(m) || m < 0.0f) {
-        snprintf(value_out, value_len, "--");
+        strcpy(value_out, "--");
         *unit_out = "m";
         return;
     }
 
     if (m >= 1000.0f) {
-        snprintf(value_out, value_len, "%.2f", (double)(m / 1000.0f));
+        ff_float(value_out, m / 1000.0f, 2);
         *unit_out = "km";
     } else {
-        snprintf(value_out, value_len, "%.0f", (double)m);
+        ff_float(value_out, m, 0);
         *unit_out = "m";
     }
 }
 
-static void fmt_seconds(float sec, char *out, size_t out_len)
-{
-    if (!isfinite(sec) || sec < 0.0f) {
-        snprintf(out, out_len, "--");
-        return;
-    }
-    snprintf(out, out_len, "%.2f", (double)sec);
-}
-
 static void metric_title_unit(data_metric_t metric, const char **title, const char **unit)
 {
     switch (metric) {
@@ -185,6 +158,22 @@ static void metric_title_unit(data_metric_t metric, const char **title, const ch
         *title = "Strokes";
         *unit = "";
         break;
+    case DATA_METRIC_PACE_LAST_500M:
+        *title = "Pace 500m";
+        *unit = "/500m";
+        break;
+    case DATA_METRIC_SPM_LAST_10:
+        *title = "SPM 10";
+        *unit = "";
+        break;
+    case DATA_METRIC_PACE_LAST_MIN:
+        *title = "Pace 1min";
+        *unit = "/500m";
+        break;
+    case DATA_METRIC_HEART_RATE:
+        *title = "Heart rate";
+        *unit = "bpm";
+        break;
     default:
         *title = "?";
         *unit = "";
@@ -208,53 +197,72 @@ static void apply_metric_to_slot(int idx)
 
     switch (metric) {
     case DATA_METRIC_PACE:
-        fmt_pace_s_per_500m(s_values.pace_s_per_500m, value_buf, sizeof(value_buf));
+        fmt_pace_s_per_500m(s_values.pace_s_per_500m, value_buf);
         break;
     case DATA_METRIC_TIME:
-        fmt_time_s(s_values.time_s, value_buf, sizeof(value_buf));
+        fmt_time_s(s_values.time_s, value_buf);
         break;
     case DATA_METRIC_DISTANCE:
-        fmt_distance_m(s_values.distance_m, value_buf, sizeof(value_buf), &unit_override);
+        fmt_distance_m(s_values.distance_m, value_buf, &unit_override);
         break;
     case DATA_METRIC_SPEED:
         if (!isfinite(s_values.speed_mps) || s_values.speed_mps < 0.0f) {
-            snprintf(value_buf, sizeof(value_buf), "--");
+            strcpy(value_buf, "--");
         } else {
             float kmh = s_values.speed_mps * 3.6f;
-            snprintf(value_buf, sizeof(value_buf), "%.1f", (double)kmh);
+            ff_float(value_buf, kmh, 1);
         }
         break;
     case DATA_METRIC_SPM:
         if (!isfinite(s_values.spm)) {
-            snprintf(value_buf, sizeof(value_buf), "--");
+            strcpy(value_buf, "--");
         } else {
             // If it's .0 show no decimals; if it's .5 show one decimal
             float x = s_values.spm;
             float frac = fabsf(x - floorf(x));
             if (fabsf(frac - 0.5f) < 0.01f) {
-                snprintf(value_buf, sizeof(value_buf), "%.1f", (double)x);
+                ff_float(value_buf, x, 1);
             } else {
-                snprintf(value_buf, sizeof(value_buf), "%.0f", (double)x);
+                ff_float(value_buf, x, 0);
             }
         }
         break;
     case DATA_METRIC_POWER:
         if (!isfinite(s_values.power_w) || s_values.power_w < 0.0f) {
-            snprintf(value_buf, sizeof(value_buf), "--");
+            strcpy(value_buf, "--");
         } else {
-            snprintf(value_buf, sizeof(value_buf), "%.0f", (double)s_values.power_w);
+            ff_float(value_buf, s_values.power_w, 0);
         }
         break;
     case DATA_METRIC_STROKE_COUNT:
         if (s_values.stroke_count == UINT32_MAX) {
-        snprintf(value_buf, sizeof(value_buf), "--");
+        strcpy(value_buf, "--");
+        } else {
+            ff_u32(value_buf, s_values.stroke_count);
+        }
+        break;
+    case DATA_METRIC_PACE_LAST_500M:
+        fmt_pace_s_per_500m(s_values.pace_last_500m_s, value_buf);
+        break;
+    case DATA_METRIC_SPM_LAST_10:
+        if (!isfinite(s_values.spm_last_10)) {
+            strcpy(value_buf, "--");
+        } else {
+            ff_float(value_buf, s_values.spm_last_10, 1);
+        }
+        break;
+    case DATA_METRIC_PACE_LAST_MIN:
+        fmt_pace_s_per_500m(s_values.pace_last_min_s, value_buf);
+        break;
+    case DATA_METRIC_HEART_RATE:
+        if (!(s_values.heart_rate_bpm > 0.0f)) {
+            strcpy(value_buf, "--");
         } else {
-            snprintf(value_buf, sizeof(value_buf), "%lu",
-                    (unsigned long)s_values.stroke_count);
+            ff_float(value_buf, s_values.heart_rate_bpm, 0);
         }
         break;
     default:
-        snprintf(value_buf, sizeof(value_buf), "--");
+        strcpy(value_buf, "--");
         break;
     }
 
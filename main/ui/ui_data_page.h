@@ -12,6 +12,10 @@ typedef enum {
     DATA_METRIC_SPM,
     DATA_METRIC_POWER,
     DATA_METRIC_STROKE_COUNT,
+    DATA_METRIC_PACE_LAST_500M,
+    DATA_METRIC_SPM_LAST_10,
+    DATA_METRIC_PACE_LAST_MIN,
+    DATA_METRIC_HEART_RATE,
     DATA_METRIC_COUNT
 } data_metric_t;
 
@@ -23,6 +27,10 @@ typedef struct {
     float spm;
     float power_w;
     uint32_t stroke_count;
+    float pace_last_500m_s;    // rolling windows, NAN until two strokes
+    float spm_last_10;
+    float pace_last_min_s;
+    float heart_rate_bpm;      // NAN without a fresh reading
 } data_values_t;
 
 void data_page_create(lv_obj_t *parent);
@@ -0,0 +1,251 @@
+// tools/bench/bench_activity.c
+/*
+ * Per-sample cost of the session statistics in activity_update().
+ *
+ *   bench_activity [hours]
+ *
+ * Replays a synthetic session (200 Hz samples with jittered dt, varying
+ * speed/SPM/power, a catch every ~2.3 s) through:
+ *
+ *   former: activity_ref.c, double sums and all three averages recomputed
+ *           on every sample, as activity_update() did before
+ *   fixed:  activity.c itself, activity_acc.c sums with the averages read
+ *           only at each catch (as stroke_task does) and at the end
+ *
+ * Both see the same inputs. Every average the fixed side reads is compared
+ * with the former side's value at that sample. The two are not bit
+ * identical: the former rounds each float x double product into a growing
+ * double sum, the fixed side sums exactly in int64 and rounds once, so an
+ * average may land on the neighbouring float. The program fails if any
+ * average differs by more than 1 ulp, or differs at all as the stroke rows
+ * and the summary print it (avg speed "%.3f", SPM and power "%.1f").
+ *
+ * Timings are host numbers and do not show the gain: x86 has hardware
+ * double, so the former update is the cheaper one here. On the ESP32-S3
+ * each double operation is a soft-float library call; measure there with
+ * CONFIG_ACTIVITY_STATS_CYCLES, which logs both updates' cycles per sample
+ * at the end of every session.
+ */
+#include <inttypes.h>
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define HAVE_TSC 1
+#endif
+
+#include "activity.h"
+#include "activity_ref.h"
+#include "timebase.h"
+
+#define MAX_ULPS 1
+
+typedef struct {
+    int32_t dt_us;
+    float speed_mps;
+    float spm;
+    float power_w;
+    float dist_m;
+    uint8_t catch_;
+} sample_t;
+
+/* activity.c takes its start time from here only when given none. */
+int64_t timebase_now_utc_us(void)
+{
+    return 0;
+}
+
+/* ---- synthetic session ---- */
+
+static uint64_t s_rng = 0x2545F4914F6CDD1Dull;
+
+static float rnd_unit(void)
+{
+    s_rng ^= s_rng << 13;
+    s_rng ^= s_rng >> 7;
+    s_rng ^= s_rng << 17;
+    return (float)(s_rng >> 40) / 16777216.0f;
+}
+
+static sample_t *make_session(size_t n)
+{
+    sample_t *s = malloc(n * sizeof(*s));
+    if (!s)
+        return NULL;
+
+    double t = 0, next_catch = 1.0;
+    for (size_t i = 0; i < n; i++) {
+        sample_t *p = &s[i];
+        p->dt_us = 5000 + (int32_t)(rnd_unit() * 400.0f) - 200;
+        t += p->dt_us * 1e-6;
+
+        // Pieces at different rates with rests in between, plus sensor noise
+        double piece = sin(t / 300.0);
+        float base = (piece > -0.6) ? (float)(3.6 + 0.8 * piece) : 0.4f;
+        float surge = (float)(0.5 * sin(2.0 * M_PI * t / 2.3));
+        p->speed_mps = fmaxf(0.0f, base + surge + (rnd_unit() - 0.5f) * 0.2f);
+        p->spm = (piece > -0.6) ? (float)(24.0 + 6.0 * piece) + (rnd_unit() - 0.5f) : 0.0f;
+        p->power_w = 2.8f * p->speed_mps * p->speed_mps * p->speed_mps;
+        p->dist_m = p->speed_mps * (float)p->dt_us * 1e-6f;
+
+        p->catch_ = 0;
+        if (t >= next_catch) {
+            p->catch_ = 1;
+            next_catch += 2.3 + (rnd_unit() - 0.5f) * 0.4f;
+        }
+    }
+    return s;
+}
+
+/* ---- timing ---- */
+
+static double now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec * 1e9 + (double)ts.tv_nsec;
+}
+
+static uint64_t cycles(void)
+{
+#ifdef HAVE_TSC
+    return __rdtsc();
+#else
+    return 0;
+#endif
+}
+
+static volatile float s_sink;
+
+static void run_former(const sample_t *s, size_t n, activity_ref_t *a)
+{
+    memset(a, 0, sizeof(*a));
+    for (size_t i = 0; i < n; i++) {
+        activity_ref_update(a, s[i].dt_us, s[i].speed_mps, s[i].spm, s[i].power_w, s[i].dist_m, s[i].catch_);
+        if (s[i].catch_)
+            s_sink = a->avg_speed_mps;
+    }
+}
+
+static void run_fixed(const sample_t *s, size_t n, activity_t *a)
+{
+    activity_init(a, 1);
+    activity_start(a, 1);
+    for (size_t i = 0; i < n; i++) {
+        activity_update(a, s[i].dt_us, s[i].speed_mps, s[i].spm, s[i].power_w, s[i].dist_m, s[i].catch_);
+        if (s[i].catch_)
+            s_sink = activity_avg_speed_mps(a);
+    }
+    activity_stop(a, 2);
+}
+
+/* Distance in representable floats (both finite, same sign here). */
+static uint32_t ulps(float x, float y)
+{
+    int32_t a, b;
+    memcpy(&a, &x, sizeof(a));
+    memcpy(&b, &y, sizeof(b));
+    return (a > b) ? (uint32_t)(a - b) : (uint32_t)(b - a);
+}
+
+/* The averages as the summary and the stroke rows print them. */
+static void print_avgs(char *buf, size_t len, float speed, float spm, float power, uint32_t duration_ms)
+{
+    snprintf(buf, len, "%.3f,%.2f,%.1f,%.1f,%lu", (double)speed, (double)speed, (double)spm, (double)power,
+             (unsigned long)duration_ms);
+}
+
+int main(int argc, char **argv)
+{
+    double hours = (argc > 1) ? strtod(argv[1], NULL) : 3.0;
+    if (!(hours > 0)) {
+        fprintf(stderr, "usage: bench_activity [hours]\n");
+        return 2;
+    }
+
+    const size_t n = (size_t)(hours * 3600.0 * 200.0);
+    sample_t *s = make_session(n);
+    if (!s) {
+        fprintf(stderr, "out of memory\n");
+        return 1;
+    }
+
+    // Lock-step pass: every average the fixed side reads against the former side's
+    activity_ref_t d;
+    activity_t f;
+    memset(&d, 0, sizeof(d));
+    activity_init(&f, 1);
+    activity_start(&f, 1);
+    size_t reads = 0, printed_diffs = 0, bit_diffs = 0;
+    uint32_t max_ulps = 0;
+    for (size_t i = 0; i < n; i++) {
+        activity_ref_update(&d, s[i].dt_us, s[i].speed_mps, s[i].spm, s[i].power_w, s[i].dist_m, s[i].catch_);
+        activity_update(&f, s[i].dt_us, s[i].speed_mps, s[i].spm, s[i].power_w, s[i].dist_m, s[i].catch_);
+        if (!s[i].catch_ && i + 1 != n)
+            continue;
+
+        activity_refresh_stats(&f);
+        reads++;
+
+        uint32_t u = ulps(d.avg_speed_mps, f.avg_speed_mps);
+        uint32_t u2 = ulps(d.avg_spm, f.avg_spm);
+        uint32_t u3 = ulps(d.avg_power_w, f.avg_power_w);
+        if (u2 > u) u = u2;
+        if (u3 > u) u = u3;
+        if (u) bit_diffs++;
+        if (u > max_ulps) max_ulps = u;
+
+        char pd[96], pf[96];
+        print_avgs(pd, sizeof(pd), d.avg_speed_mps, d.avg_spm, d.avg_power_w, d.duration_ms);
+        print_avgs(pf, sizeof(pf), f.avg_speed_mps, f.avg_spm, f.avg_power_w, f.duration_ms);
+        if (strcmp(pd, pf) != 0) {
+            if (printed_diffs < 5)
+                printf("  sample %zu: former %s fixed %s\n", i, pd, pf);
+            printed_diffs++;
+        }
+    }
+    activity_stop(&f, 2);
+
+    printf("session: %.2f h, %zu samples, %" PRIu32 " strokes, %.0f m\n", hours, n, f.stroke_count,
+           (double)f.distance_m);
+    printf("final:   avg speed %.6f m/s  avg spm %.4f  avg power %.3f W  duration %" PRIu32 " ms\n",
+           (double)f.avg_speed_mps, (double)f.avg_spm, (double)f.avg_power_w, f.duration_ms);
+    printf("compare: %zu reads, %zu differ as printed; %zu differ in the float (max %" PRIu32 " ulp, %d allowed)\n",
+           reads, printed_diffs, bit_diffs, max_ulps, MAX_ULPS);
+
+    // Timed passes, best of a few
+    double best_d = 1e30, best_f = 1e30;
+    uint64_t cyc_d = UINT64_MAX, cyc_f = UINT64_MAX;
+    for (int rep = 0; rep < 5; rep++) {
+        double t0 = now_ns();
+        uint64_t c0 = cycles();
+        run_former(s, n, &d);
+        uint64_t c1 = cycles();
+        double t1 = now_ns();
+        run_fixed(s, n, &f);
+        uint64_t c2 = cycles();
+        double t2 = now_ns();
+
+        if (t1 - t0 < best_d) best_d = t1 - t0;
+        if (t2 - t1 < best_f) best_f = t2 - t1;
+        if (c1 - c0 < cyc_d) cyc_d = c1 - c0;
+        if (c2 - c1 < cyc_f) cyc_f = c2 - c1;
+    }
+
+    printf("\n%-8s %12s %14s\n", "update", "ns/sample", "cycles/sample");
+#ifdef HAVE_TSC
+    printf("%-8s %12.2f %14.1f\n", "former", best_d / (double)n, (double)cyc_d / (double)n);
+    printf("%-8s %12.2f %14.1f\n", "fixed", best_f / (double)n, (double)cyc_f / (double)n);
+#else
+    printf("%-8s %12.2f %14s\n", "former", best_d / (double)n, "-");
+    printf("%-8s %12.2f %14s\n", "fixed", best_f / (double)n, "-");
+#endif
+
+    free(s);
+    return (printed_diffs || max_ulps > MAX_ULPS) ? 1 : 0;
+}
@@ -0,0 +1,281 @@
+/*
+ * Multi-boat broadcast: the firmware's advert encoding and observer table
+ * (components/ble/ble_boat_adv.c) fed with a synthetic scan.
+ *
+ * Each boat samples at 1-4 Hz and advertises its latest sample every
+ * 100-150 ms; a share of the adverts is lost on the way, and other devices
+ * (phones, beacons, malformed data) advertise around them. After the first
+ * fleet has rowed for a while it goes quiet and a second fleet with new
+ * addresses takes over, so entries must go stale and be handed on.
+ *
+ * At the end of each phase every boat's held sample is checked against what
+ * it sent (the sample itself, how far behind the latest it is, and the
+ * missed count against the adverts that really got lost). The table is fed
+ * from a recorded stream so the time per advert excludes the simulation.
+ *
+ *   bench_boats [-n boats] [-l loss_permille] [-s seconds] [-o others]
+ */
+
+#include <getopt.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "ble_boat_adv.h"
+
+#define MAX_FLEET   128
+#define STALE_US    10000000LL
+#define MAX_SAMPLES 512             // per boat per phase
+
+typedef struct {
+    uint8_t  addr[6];
+    uint32_t period_ms;             // 1-4 Hz
+    int64_t  start_us;
+    int64_t  next_adv_us;
+    bool     got[MAX_SAMPLES];      // sample i heard at least once
+    int      latest;                // last sample advertised
+} boat_t;
+
+typedef struct {
+    int64_t t_us;
+    uint8_t addr[6];
+    uint8_t addr_type;
+    int8_t  rssi;
+    uint8_t len;
+    uint8_t data[31];
+} report_t;
+
+static uint32_t s_rng = 7;
+
+static uint32_t rnd(void)
+{
+    s_rng ^= s_rng << 13;
+    s_rng ^= s_rng >> 17;
+    s_rng ^= s_rng << 5;
+    return s_rng;
+}
+
+static ble_rowing_sample_t sample_of(const boat_t *b, int i)
+{
+    return (ble_rowing_sample_t){
+        .t_ms = (uint32_t)(b->start_us / 1000) + (uint32_t)i * b->period_ms,
+        .spm = 20.0f + (float)(i % 12),
+        .pace_500m_s = 110.0f,
+        .speed_mps = 4.5f,
+        .distance_m = (float)i * 4.0f,
+        .stroke_count = (uint32_t)i,
+        .drive_time_s = 0.8f,
+        .recovery_time_s = 1.6f,
+    };
+}
+
+static report_t *s_stream;
+static size_t s_stream_len, s_stream_cap;
+
+static report_t *push(int64_t t_us)
+{
+    if (s_stream_len == s_stream_cap) {
+        s_stream_cap = s_stream_cap ? s_stream_cap * 2 : 65536;
+        s_stream = realloc(s_stream, s_stream_cap * sizeof(report_t));
+    }
+    report_t *r = &s_stream[s_stream_len++];
+    memset(r, 0, sizeof(*r));
+    r->t_us = t_us;
+    r->rssi = (int8_t)(-40 - (int)(rnd() % 50));
+    return r;
+}
+
+/* Something else on the air: a phone, a beacon, or junk. */
+static void push_other(int64_t t_us, int who)
+{
+    report_t *r = push(t_us);
+    r->addr[0] = (uint8_t)who;
+    r->addr[5] = 0xC0;
+    r->addr_type = 1;
+    uint8_t *d = r->data;
+    size_t n = 0;
+    d[n++] = 2; d[n++] = 0x01; d[n++] = 0x06;
+    switch (who % 4) {
+    case 0:     // manufacturer data from a real company
+        d[n++] = 9; d[n++] = 0xFF; d[n++] = 0x4C; d[n++] = 0x00;
+        for (int i = 0; i < 6; i++) d[n++] = (uint8_t)rnd();
+        break;
+    case 1:     // our company ID, someone else's magic and length
+        d[n++] = 1 + BLE_BOAT_ADV_LEN; d[n++] = 0xFF; d[n++] = 0xFF; d[n++] = 0xFF; d[n++] = 0x17;
+        for (int i = 3; i < BLE_BOAT_ADV_LEN; i++) d[n++] = (uint8_t)rnd();
+        break;
+    case 2:     // a name
+        d[n++] = 7; d[n++] = 0x09;
+        memcpy(d + n, "Phone6", 6);
+        n += 6;
+        break;
+    default:    // a length running past the end
+        d[n++] = 30; d[n++] = 0xFF; d[n++] = 0xFF;
+        break;
+    }
+    r->len = (uint8_t)n;
+}
+
+/* Advertise boat `b` at `t_us` over the lossy link. */
+static void boat_advert(boat_t *b, int64_t t_us, int loss_permille)
+{
+    const int i = (int)((t_us - b->start_us) / 1000 / b->period_ms);
+    if (i >= MAX_SAMPLES) return;
+    b->latest = i;
+    if ((int)(rnd() % 1000) < loss_permille) return;
+    b->got[i] = true;
+
+    report_t *r = push(t_us);
+    memcpy(r->addr, b->addr, 6);
+    uint8_t *d = r->data;
+    d[0] = 2; d[1] = 0x01; d[2] = 0x06;
+    d[3] = 1 + BLE_BOAT_ADV_LEN; d[4] = 0xFF;
+    const ble_rowing_sample_t s = sample_of(b, i);
+    r->len = (uint8_t)(5 + ble_boat_adv_encode(d + 5, (uint8_t)i, &s));
+}
+
+/* One fleet rowing from `t0` to `t1` among `others` other devices. */
+static void simulate(boat_t *fleet, int n, int64_t t0, int64_t t1, int others, int loss_permille)
+{
+    int64_t *other_next = calloc((size_t)others + 1, sizeof(int64_t));
+    for (int k = 0; k < others; k++) other_next[k] = t0 + (int64_t)(rnd() % 100) * 1000;
+    for (int64_t t = t0; t < t1; t += 1000) {
+        for (int k = 0; k < n; k++) {
+            if (t >= fleet[k].next_adv_us) {
+                boat_advert(&fleet[k], t, loss_permille);
+                fleet[k].next_adv_us = t + (100 + (int64_t)(rnd() % 50)) * 1000;
+            }
+        }
+        for (int k = 0; k < others; k++) {
+            if (t >= other_next[k]) {
+                push_other(t, k);
+                other_next[k] = t + (int64_t)(100 + rnd() % 900) * 1000;
+            }
+        }
+    }
+    free(other_next);
+}
+
+static void make_fleet(boat_t *fleet, int n, uint8_t tag, int64_t start_us)
+{
+    memset(fleet, 0, (size_t)n * sizeof(boat_t));
+    for (int k = 0; k < n; k++) {
+        boat_t *b = &fleet[k];
+        b->addr[0] = (uint8_t)k;
+        b->addr[1] = (uint8_t)rnd();
+        b->addr[2] = (uint8_t)rnd();
+        b->addr[5] = tag;
+        b->period_ms = 1000 / (1 + (uint32_t)k % 4);
+        b->start_us = start_us + (int64_t)(rnd() % 1000) * 1000;
+        b->next_adv_us = b->start_us;
+        b->latest = -1;
+    }
+}
+
+/* Feed the stream up to `until_us`; returns the feed time in ns. */
+static double feed(ble_boat_table_t *t, size_t *pos, int64_t until_us, uint32_t *boat_reports)
+{
+    struct timespec a, b;
+    clock_gettime(CLOCK_MONOTONIC, &a);
+    while (*pos < s_stream_len && s_stream[*pos].t_us < until_us) {
+        const report_t *r = &s_stream[*pos];
+        *boat_reports += ble_boat_table_feed(t, r->addr, r->addr_type, r->rssi, r->data, r->len, r->t_us);
+        (*pos)++;
+    }
+    clock_gettime(CLOCK_MONOTONIC, &b);
+    return (b.tv_sec - a.tv_sec) * 1e9 + (b.tv_nsec - a.tv_nsec);
+}
+
+/* Compare the table with what fleet `f` sent. Returns the number of failures. */
+static int check(const char *phase, const ble_boat_table_t *t, const boat_t *f, int n, int64_t now_us)
+{
+    static ble_boat_t snap[BLE_BOATS_MAX];
+    const int got = ble_boat_table_snapshot(t, snap, BLE_BOATS_MAX, now_us);
+    const int want = n < BLE_BOATS_MAX ? n : BLE_BOATS_MAX;
+    int fails = got != want, current = 0, behind1 = 0, behind_more = 0, bad_sample = 0, bad_missed = 0;
+
+    for (int j = 0; j < got; j++) {
+        const ble_boat_t *s = &snap[j];
+        const boat_t *b = NULL;
+        for (int k = 0; k < n && !b; k++)
+            if (memcmp(f[k].addr, s->addr, 6) == 0) b = &f[k];
+        if (!b) {
+            fails++;
+            continue;
+        }
+
+        const int i = (int)s->sample.stroke_count;
+        const ble_rowing_sample_t want_s = sample_of(b, i);
+        if ((uint8_t)i != s->seq || s->sample.t_ms != want_s.t_ms || !b->got[i]) bad_sample++;
+
+        // Missed: samples that never got through since the table took the boat in
+        // (a boat turned away from a full table starts later than its first advert)
+        const int first = (int)((s->first_us - b->start_us) / 1000 / b->period_ms);
+        int missed = 0;
+        for (int k = first + 1; k < i; k++) missed += !b->got[k];
+        if ((int)s->missed != missed) bad_missed++;
+
+        const int lag = b->latest - i;
+        if (lag == 0) current++;
+        else if (lag == 1) behind1++;
+        else behind_more++;
+    }
+    fails += bad_sample + bad_missed;
+
+    printf("%-8s boats %2d/%2d  current %2d  one behind %2d  more %2d  bad sample %d  bad missed %d  %s\n", phase, got,
+           want, current, behind1, behind_more, bad_sample, bad_missed, fails ? "FAIL" : "ok");
+    return fails;
+}
+
+int main(int argc, char **argv)
+{
+    int n = 50, loss = 300, secs = 60, others = 60;
+    int opt;
+    while ((opt = getopt(argc, argv, "n:l:s:o:")) != -1) {
+        switch (opt) {
+        case 'n': n = atoi(optarg); break;
+        case 'l': loss = atoi(optarg); break;
+        case 's': secs = atoi(optarg); break;
+        case 'o': others = atoi(optarg); break;
+        default:
+            fprintf(stderr, "usage: %s [-n boats] [-l loss_permille] [-s seconds] [-o others]\n", argv[0]);
+            return 2;
+        }
+    }
+    if (n < 1) n = 1;
+    if (n > MAX_FLEET) n = MAX_FLEET;
+    if (secs < 20) secs = 20;
+    if (secs > 100) secs = 100;     // MAX_SAMPLES at 4 Hz, with room for the handover
+
+    static boat_t fleet_a[MAX_FLEET], fleet_b[MAX_FLEET];
+    const int64_t t_a = 1000000, t_b = t_a + secs * 1000000LL, t_end = t_b + secs * 1000000LL;
+
+    // The first fleet, then the second once the first has gone quiet
+    make_fleet(fleet_a, n, 0xA0, t_a);
+    simulate(fleet_a, n, t_a, t_b, others, loss);
+    make_fleet(fleet_b, n, 0xB0, t_b);
+    simulate(fleet_b, n, t_b, t_end, others, loss);
+
+    static ble_boat_table_t table;
+    ble_boat_table_init(&table, STALE_US);
+    size_t pos = 0;
+    uint32_t boat_reports = 0;
+    double ns = 0;
+    int fails = 0;
+
+    ns += feed(&table, &pos, t_b, &boat_reports);
+    fails += check("fleet A", &table, fleet_a, n, t_b);
+    ns += feed(&table, &pos, t_end, &boat_reports);
+    fails += check("fleet B", &table, fleet_b, n, t_end);
+
+    printf("%zu reports (%u from boats, %.0f%% lost before the scanner), %.1f ns per report, "
+           "%u new boats turned away, %u sweeps, table %zu bytes\n",
+           s_stream_len, (unsigned)boat_reports, loss / 10.0, ns / (double)s_stream_len, (unsigned)table.full,
+           (unsigned)table.compactions, sizeof(table));
+
+    free(s_stream);
+    return fails ? 1 : 0;
+}
@@ -0,0 +1,291 @@
+// tools/bench/bench_fastfmt.c
+/*
+ * fastfmt against snprintf on the strings the logger and the data page
+ * produce every stroke / every refresh.
+ *
+ *   bench_fastfmt [iterations]
+ *
+ * Each case formats the same pseudo-random inputs both ways, reports ns per
+ * call for each and counts outputs that differ. The snprintf side is the
+ * code fastfmt replaced, so the only expected differences are in "pace",
+ * where the old "%02d:%04.1f" printed 59.96 s as "00:60.0"; those are
+ * counted separately as carries.
+ */
+#include <inttypes.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "fastfmt.h"
+
+#define N_INPUTS 4096
+
+typedef struct {
+    int64_t utc_us;
+    int64_t session_us;
+    float distance_m;
+    float pace_s;
+    float spm;
+    float avg_pace_s;
+    float speed_mps;
+    float stroke_len_m;
+    uint32_t stroke_count;
+    double lat;
+    double lon;
+    float power_w;
+    float drive_s;
+    float recovery_s;
+    float ratio;
+} row_t;
+
+static row_t s_rows[N_INPUTS];
+static volatile size_t s_sink;
+
+static uint64_t s_rng = 0x9E3779B97F4A7C15ull;
+
+static uint32_t rnd(void)
+{
+    s_rng ^= s_rng << 13;
+    s_rng ^= s_rng >> 7;
+    s_rng ^= s_rng << 17;
+    return (uint32_t)(s_rng >> 32);
+}
+
+static float rnd_f(float lo, float hi)
+{
+    return lo + (hi - lo) * (float)rnd() / 4294967296.0f;
+}
+
+static void make_inputs(void)
+{
+    for (int i = 0; i < N_INPUTS; i++) {
+        row_t *r = &s_rows[i];
+        r->utc_us = 1735714800000000ll + (int64_t)rnd() * 1000;
+        r->session_us = (int64_t)rnd() * 3;
+        r->distance_m = rnd_f(0, 42000);
+        // Mostly rowing paces, with a few "no pace" and near-minute values
+        r->pace_s = (i % 16 == 0) ? 0.0f : (i % 16 == 1) ? 119.95f + rnd_f(0, 0.1f) : rnd_f(80, 400);
+        r->spm = rnd_f(14, 40);
+        r->avg_pace_s = rnd_f(90, 200);
+        r->speed_mps = rnd_f(0, 6);
+        r->stroke_len_m = rnd_f(5, 12);
+        r->stroke_count = rnd() % 20000;
+        r->lat = -90.0 + 180.0 * rnd() / 4294967296.0;
+        r->lon = -180.0 + 360.0 * rnd() / 4294967296.0;
+        r->power_w = rnd_f(0, 600);
+        r->drive_s = rnd_f(0.5f, 1.2f);
+        r->recovery_s = rnd_f(0.8f, 3.0f);
+        r->ratio = r->recovery_s / r->drive_s;
+    }
+}
+
+/* ---- the snprintf formatters fastfmt replaced ---- */
+
+static void ref_pace(float seconds, char *buf, size_t len)
+{
+    if (seconds <= 0.0f || seconds > 3600.0f) {
+        snprintf(buf, len, "--:--.-");
+        return;
+    }
+    int min = (int)(seconds / 60.0f);
+    float sec_rem = seconds - (min * 60.0f);
+    snprintf(buf, len, "%02d:%04.1f", min, (double)sec_rem);
+}
+
+static void ref_hms_ms(int64_t total_us, char *out, size_t len)
+{
+    if (total_us < 0)
+        total_us = 0;
+    int64_t total_ms = total_us / 1000;
+    int ms = (int)(total_ms % 1000);
+    int64_t total_sec = total_ms / 1000;
+    snprintf(out, len, "%02d:%02d:%02d.%03d", (int)(total_sec / 3600), (int)((total_sec % 3600) / 60),
+             (int)(total_sec % 60), ms);
+}
+
+static void ref_datetime_ms(int64_t utc_us, char *buf, size_t len)
+{
+    time_t ts = (time_t)(utc_us / 1000000);
+    struct tm tm_info;
+    gmtime_r(&ts, &tm_info);
+    strftime(buf, len, "%Y-%m-%d %H:%M:%S", &tm_info);
+    size_t n = strlen(buf);
+    snprintf(buf + n, len - n, ".%03d", (int)((utc_us / 1000) % 1000));
+}
+
+static void ref_clock(float sec, char *out, size_t out_len)
+{
+    if (!isfinite(sec) || sec < 0.0f) {
+        snprintf(out, out_len, "--:--.-");
+        return;
+    }
+    int total = (int)sec;
+    int tenths = (int)lroundf((sec - (float)total) * 10.0f);
+    if (tenths >= 10) {
+        tenths = 0;
+        total += 1;
+    }
+    int s = total % 60;
+    int m = (total / 60) % 60;
+    int h = total / 3600;
+    if (h > 0)
+        snprintf(out, out_len, "%d:%02d:%02d", h, m, s);
+    else
+        snprintf(out, out_len, "%02d:%02d.%d", m, s, tenths);
+}
+
+static size_t ref_row(const row_t *r, char *buf, size_t len)
+{
+    char time_str[32], session_str[32], pace_str[24], avg_str[24];
+    ref_datetime_ms(r->utc_us, time_str, sizeof(time_str));
+    ref_hms_ms(r->session_us, session_str, sizeof(session_str));
+    ref_pace(r->pace_s, pace_str, sizeof(pace_str));
+    ref_pace(r->avg_pace_s, avg_str, sizeof(avg_str));
+    int n = snprintf(buf, len, "%s,%s,%.1f,%s,%.1f,%s,%.2f,%.2f,%lu,%.7f,%.7f,%.1f,%.2f,%.2f,%.2f\n",
+                     time_str, session_str, (double)r->distance_m, pace_str, (double)r->spm, avg_str,
+                     (double)r->speed_mps, (double)r->stroke_len_m, (unsigned long)r->stroke_count, r->lat,
+                     r->lon, (double)r->power_w, (double)r->drive_s, (double)r->recovery_s, (double)r->ratio);
+    return (n > 0 && (size_t)n < len) ? (size_t)n : 0;
+}
+
+/* ---- the same strings through fastfmt ---- */
+
+static size_t ff_row(const row_t *r, char *buf)
+{
+    char *p = buf;
+    p += ff_datetime_ms(p, r->utc_us);
+    *p++ = ',';
+    p += ff_hms_ms(p, r->session_us);
+    *p++ = ',';
+    p += ff_float(p, r->distance_m, 1);
+    *p++ = ',';
+    p += ff_pace(p, r->pace_s);
+    *p++ = ',';
+    p += ff_float(p, r->spm, 1);
+    *p++ = ',';
+    p += ff_pace(p, r->avg_pace_s);
+    *p++ = ',';
+    p += ff_float(p, r->speed_mps, 2);
+    *p++ = ',';
+    p += ff_float(p, r->stroke_len_m, 2);
+    *p++ = ',';
+    p += ff_u32(p, r->stroke_count);
+    *p++ = ',';
+    p += ff_double(p, r->lat, 7);
+    *p++ = ',';
+    p += ff_double(p, r->lon, 7);
+    *p++ = ',';
+    p += ff_float(p, r->power_w, 1);
+    *p++ = ',';
+    p += ff_float(p, r->drive_s, 2);
+    *p++ = ',';
+    p += ff_float(p, r->recovery_s, 2);
+    *p++ = ',';
+    p += ff_float(p, r->ratio, 2);
+    *p++ = '\n';
+    *p = '\0';
+    return (size_t)(p - buf);
+}
+
+/* ---- cases ---- */
+
+typedef enum { CASE_FLOAT1, CASE_FLOAT2, CASE_LATLON, CASE_PACE, CASE_CLOCK, CASE_HMS, CASE_DATETIME, CASE_ROW } case_t;
+
+static const char *const k_case_names[] = {
+    "%.1f", "%.2f", "%.7f lat/lon", "pace MM:SS.t", "clock (UI)", "HH:MM:SS.mmm", "datetime.mmm", "CSV stroke row",
+};
+
+static void run_ref(case_t c, const row_t *r, char *buf, size_t len)
+{
+    switch (c) {
+    case CASE_FLOAT1: snprintf(buf, len, "%.1f", (double)r->distance_m); break;
+    case CASE_FLOAT2: snprintf(buf, len, "%.2f", (double)r->ratio); break;
+    case CASE_LATLON: snprintf(buf, len, "%.7f", r->lat); break;
+    case CASE_PACE: ref_pace(r->pace_s, buf, len); break;
+    case CASE_CLOCK: ref_clock((float)r->session_us * 1e-6f, buf, len); break;
+    case CASE_HMS: ref_hms_ms(r->session_us, buf, len); break;
+    case CASE_DATETIME: ref_datetime_ms(r->utc_us, buf, len); break;
+    case CASE_ROW: ref_row(r, buf, len); break;
+    }
+}
+
+static void run_ff(case_t c, const row_t *r, char *buf)
+{
+    switch (c) {
+    case CASE_FLOAT1: ff_float(buf, r->distance_m, 1); break;
+    case CASE_FLOAT2: ff_float(buf, r->ratio, 2); break;
+    case CASE_LATLON: ff_double(buf, r->lat, 7); break;
+    case CASE_PACE: ff_pace(buf, r->pace_s); break;
+    case CASE_CLOCK: ff_clock(buf, (float)r->session_us * 1e-6f); break;
+    case CASE_HMS: ff_hms_ms(buf, r->session_us); break;
+    case CASE_DATETIME: ff_datetime_ms(buf, r->utc_us); break;
+    case CASE_ROW: ff_row(r, buf); break;
+    }
+}
+
+static double now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec * 1e9 + (double)ts.tv_nsec;
+}
+
+int main(int argc, char **argv)
+{
+    long iters = (argc > 1) ? strtol(argv[1], NULL, 10) : 200;
+    if (iters <= 0) {
+        fprintf(stderr, "usage: bench_fastfmt [iterations]\n");
+        return 2;
+    }
+    make_inputs();
+
+    printf("%-16s %12s %12s %8s %10s %8s\n", "case", "snprintf ns", "fastfmt ns", "speedup", "mismatch", "carry");
+
+    int failed = 0;
+    for (case_t c = CASE_FLOAT1; c <= CASE_ROW; c++) {
+        char a[512], b[512];
+
+        // Correctness pass over every input
+        unsigned mismatch = 0, carry = 0;
+        for (int i = 0; i < N_INPUTS; i++) {
+            run_ref(c, &s_rows[i], a, sizeof(a));
+            run_ff(c, &s_rows[i], b);
+            if (strcmp(a, b) == 0)
+                continue;
+            if (strstr(a, ":60.0")) {
+                carry++;
+            } else {
+                if (mismatch < 3)
+                    printf("  %s: snprintf \"%s\" fastfmt \"%s\"\n", k_case_names[c], a, b);
+                mismatch++;
+            }
+        }
+
+        double t0 = now_ns();
+        for (long it = 0; it < iters; it++) {
+            for (int i = 0; i < N_INPUTS; i++) {
+                run_ref(c, &s_rows[i], a, sizeof(a));
+                s_sink += (size_t)a[1];
+            }
+        }
+        double t1 = now_ns();
+        for (long it = 0; it < iters; it++) {
+            for (int i = 0; i < N_INPUTS; i++) {
+                run_ff(c, &s_rows[i], b);
+                s_sink += (size_t)b[1];
+            }
+        }
+        double t2 = now_ns();
+
+        double calls = (double)iters * N_INPUTS;
+        double ns_ref = (t1 - t0) / calls;
+        double ns_ff = (t2 - t1) / calls;
+        printf("%-16s %12.1f %12.1f %7.1fx %10u %8u\n", k_case_names[c], ns_ref, ns_ff, ns_ref / ns_ff, mismatch,
+               carry);
+        if (mismatch)
+            failed = 1;
+    }
+    return failed;
+}
@@ -0,0 +1,374 @@
+// tools/bench/bench_logger.c
+/*
+ * Logger throughput against a slow SD card.
+ *
+ *   bench_logger [-r rows/s] [-s seconds] [-c none|good|slow] [-f csv|bin]
+ *                [-n] [-p period_ms] [-q ring] [-d dir] [-v]
+ *
+ * Runs the firmware's logger (activity_log.c and friends, unchanged) the
+ * way main.c does: a producer thread stands in for stroke_task and pushes
+ * stroke rows and splits into an activity_log_ring_t at a fixed rate,
+ * waking the logger once the ring fills to logger_wake_rows() for the
+ * card's health; a logger thread stands in for activity_logger_task and
+ * drains the ring every period or when woken.
+ * Files go to a simulated card (sim_card.h) that sleeps for the latency a
+ * card would take: per-write latency, slow-write tails, and 50-300 ms
+ * stalls on cluster allocation.
+ *
+ * Each run reports the rows offered and written, the sustained write rate,
+ * the deepest the ring got, rows dropped, the longest drain and what
+ * sd_io_stats made of the card. Without -r it sweeps a range of rates; a
+ * rate that drops nothing has headroom, on the device the stroke log runs
+ * at about 0.5 rows/s. Rows carry 2 s of session time each, so the files
+ * look like a long session played fast.
+ */
+#include <getopt.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <time.h>
+
+#include "activity_log.h"
+#include "esp_timer.h"
+#include "sd_io_stats.h"
+#include "sdkconfig.h"
+#include "sim_card.h"
+#include "timebase.h"
+
+int esp_log_verbose;
+
+/* activity_log_start() reads it for the FIT header. */
+void timebase_get_status(timebase_status_t *out)
+{
+    memset(out, 0, sizeof(*out));
+}
+
+typedef struct {
+    double rate;                    // rows/s offered
+    double seconds;
+    activity_log_format_t format;
+    bool fit;
+    uint32_t period_ms;
+    uint32_t ring_len;
+    const char *dir;
+} bench_cfg_t;
+
+typedef struct {
+    uint32_t offered;               // stroke rows
+    uint32_t written;               // stroke rows drained to the log
+    uint32_t dropped;               // stroke rows the ring had no room for
+    uint32_t peak;
+    uint32_t drains;
+    int64_t max_drain_us;
+    double elapsed_s;               // first push to the last drain
+    double stop_ms;
+    sd_io_stats_t io;
+    sim_card_stats_t card;
+} bench_result_t;
+
+typedef struct {
+    const bench_cfg_t *cfg;
+    activity_log_t log;
+    activity_log_ring_t ring;
+    pthread_mutex_t lock;
+    pthread_cond_t wake;
+    bool notified;
+    atomic_bool done;
+    int64_t t0_us;
+    int64_t last_drain_us;
+    atomic_uint wake_rows;
+    uint32_t drained;               // messages, split rows included
+    uint32_t splits;                // split rows the ring took
+    bench_result_t res;
+} bench_t;
+
+/* main.c's logger_wake_rows(). */
+static uint32_t logger_wake_rows(const bench_cfg_t *cfg, sd_health_t health)
+{
+    switch (health) {
+    case SD_HEALTH_FAIR: return cfg->ring_len * 5 / 8;
+    case SD_HEALTH_SLOW: return cfg->ring_len * 3 / 4;
+    default:             return cfg->ring_len / 2;
+    }
+}
+
+static void notify(bench_t *b)
+{
+    pthread_mutex_lock(&b->lock);
+    b->notified = true;
+    pthread_cond_signal(&b->wake);
+    pthread_mutex_unlock(&b->lock);
+}
+
+/* ulTaskNotifyTake(pdTRUE, period). */
+static void wait_notify(bench_t *b, uint32_t period_ms)
+{
+    struct timespec until;
+    clock_gettime(CLOCK_REALTIME, &until);
+    until.tv_sec += period_ms / 1000;
+    until.tv_nsec += (long)(period_ms % 1000) * 1000000;
+    if (until.tv_nsec >= 1000000000) {
+        until.tv_sec++;
+        until.tv_nsec -= 1000000000;
+    }
+
+    pthread_mutex_lock(&b->lock);
+    while (!b->notified) {
+        if (pthread_cond_timedwait(&b->wake, &b->lock, &until) != 0) break;
+    }
+    b->notified = false;
+    pthread_mutex_unlock(&b->lock);
+}
+
+static void *logger_thread(void *arg)
+{
+    bench_t *b = arg;
+    for (;;) {
+        wait_notify(b, b->cfg->period_ms);
+
+        // Read before the drain: rows pushed after it wait for the next wake-up
+        bool last = atomic_load(&b->done);
+
+        int64_t t0 = esp_timer_get_time();
+        uint32_t n = activity_log_drain(&b->log, &b->ring);
+        int64_t t1 = esp_timer_get_time();
+        if (n > 0) {
+            b->drained += n;
+            b->res.drains++;
+            b->last_drain_us = t1;
+            if (t1 - t0 > b->res.max_drain_us) b->res.max_drain_us = t1 - t0;
+        }
+        if (last && alog_ring_count(&b->ring) == 0) break;
+
+        sd_io_stats_t io;
+        sd_io_stats_get(&io);
+        atomic_store(&b->wake_rows, logger_wake_rows(b->cfg, sd_io_health(&io)));
+    }
+    return NULL;
+}
+
+static bool push(bench_t *b, const activity_log_msg_t *msg)
+{
+    bool ok = alog_ring_push(&b->ring, msg);
+    if (alog_ring_count(&b->ring) >= atomic_load(&b->wake_rows)) notify(b);
+    return ok;
+}
+
+static void push_split(bench_t *b, const activity_log_msg_t *msg)
+{
+    if (push(b, msg)) b->splits++;
+}
+
+/* stroke_task: a row every 1/rate s of wall time, 2 s and 8 m of session each. */
+static void produce(bench_t *b)
+{
+    const bench_cfg_t *cfg = b->cfg;
+    const uint32_t rows = (uint32_t)(cfg->rate * cfg->seconds + 0.5);
+    const int64_t start_utc_us = 1735714800LL * 1000000;
+
+    alog_split_state_t sp;
+    activity_log_split_init(&b->log, &sp);
+
+    struct timespec next;
+    clock_gettime(CLOCK_MONOTONIC, &next);
+    b->t0_us = esp_timer_get_time();
+
+    for (uint32_t i = 1; i <= rows; i++) {
+        int64_t t_us = (int64_t)i * 2000000;
+        float dist = (float)i * 8.0f;
+        float spm = 28.0f + (float)(i % 5);
+        float power = 140.0f + (float)(i % 23);
+
+        activity_log_msg_t m = { .kind = ACTIVITY_LOG_MSG_SPLIT };
+        if (alog_split_sample(&sp, t_us, dist, &m.split)) push_split(b, &m);
+        alog_split_stroke(&sp, spm, power);
+
+        m = (activity_log_msg_t){ .kind = ACTIVITY_LOG_MSG_STROKE };
+        m.row = (activity_log_row_t){
+            .utc_us = start_utc_us + t_us,
+            .session_time_us = t_us,
+            .total_distance_m = dist,
+            .pace_500m_s = 125.0f,
+            .spm_instant = spm,
+            .avg_pace_500m_s = 125.0f,
+            .avg_speed_mps = 4.0f,
+            .stroke_length_m = 8.0f,
+            .stroke_count = i,
+            .gps_lat = 22.3 + i * 1e-6,
+            .gps_lon = 114.1 + i * 1e-6,
+            .power_w = power,
+            .drive_time_s = 0.8f,
+            .recovery_time_s = 1.2f,
+            .recovery_ratio = 1.5f,
+            .roll_pace_500m_s = 125.0f,
+            .roll_spm = spm,
+        };
+        if (!push(b, &m)) b->res.dropped++;
+        b->res.offered++;
+
+        long step_ns = (long)(1e9 / cfg->rate);
+        next.tv_sec += step_ns / 1000000000;
+        next.tv_nsec += step_ns % 1000000000;
+        if (next.tv_nsec >= 1000000000) {
+            next.tv_sec++;
+            next.tv_nsec -= 1000000000;
+        }
+        clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &next, NULL);
+    }
+
+    activity_log_msg_t m = { .kind = ACTIVITY_LOG_MSG_SPLIT };
+    if (alog_split_finish(&sp, &m.split)) push_split(b, &m);
+}
+
+static int run(const bench_cfg_t *cfg, const sim_card_profile_t *card, bench_result_t *out)
+{
+    static bench_t b;
+    memset(&b, 0, sizeof(b));
+    b.cfg = cfg;
+    atomic_init(&b.wake_rows, cfg->ring_len / 2);
+    pthread_mutex_init(&b.lock, NULL);
+    pthread_cond_init(&b.wake, NULL);
+
+    activity_log_msg_t *slots = calloc(cfg->ring_len, sizeof(*slots));
+    if (!slots) return -1;
+    alog_ring_init(&b.ring, slots, cfg->ring_len);
+
+    sim_card_init(card, cfg->dir, 12345);
+    sd_mmc_helper_t sd = { .mounted = true, .mount_point = cfg->dir };
+    activity_log_init(&b.log);
+    activity_log_set_format(&b.log, cfg->format);
+    activity_log_set_fit(&b.log, cfg->fit);
+    activity_log_set_split_interval(&b.log, 500);
+    if (activity_log_start(&b.log, &sd, 1735714800, 1) != ESP_OK) {
+        fprintf(stderr, "activity_log_start failed in %s\n", cfg->dir);
+        free(slots);
+        return -1;
+    }
+
+    pthread_t logger;
+    pthread_create(&logger, NULL, logger_thread, &b);
+    produce(&b);
+    atomic_store(&b.done, true);
+    notify(&b);
+    pthread_join(logger, NULL);
+
+    int64_t t_stop = esp_timer_get_time();
+    activity_log_stop(&b.log);
+    b.res.stop_ms = (double)(esp_timer_get_time() - t_stop) * 1e-3;
+
+    b.res.elapsed_s = (double)(b.last_drain_us - b.t0_us) * 1e-6;
+    // Everything the ring took has been drained by now
+    b.res.written = b.drained - b.splits;
+    b.res.peak = b.ring.high_water;
+    sd_io_stats_get(&b.res.io);
+    sim_card_get_stats(&b.res.card);
+    *out = b.res;
+
+    pthread_cond_destroy(&b.wake);
+    pthread_mutex_destroy(&b.lock);
+    free(slots);
+    return 0;
+}
+
+static void print_header(void)
+{
+    printf("%8s %8s %8s %7s %9s %8s %6s %9s %8s %8s %9s %5s %6s %7s %8s\n", "rate/s", "offered", "written",
+           "dropped", "peak", "rows/s", "drains", "drain ms", "stop ms", "card", "worst ms", "slow", "stalls", "writes",
+           "sectors");
+}
+
+static void print_result(const bench_cfg_t *cfg, const bench_result_t *r)
+{
+    char peak[16];
+    snprintf(peak, sizeof(peak), "%u/%u", (unsigned)r->peak, (unsigned)cfg->ring_len);
+    double rows_s = (r->elapsed_s > 0) ? r->written / r->elapsed_s : 0.0;
+    printf("%8.1f %8u %8u %7u %9s %8.1f %6u %9.1f %8.1f %8s %9.1f %5u %6u %7llu %8llu\n", cfg->rate,
+           (unsigned)r->offered, (unsigned)r->written, (unsigned)r->dropped, peak, rows_s, (unsigned)r->drains,
+           (double)r->max_drain_us * 1e-3, r->stop_ms, sd_io_health_name(sd_io_health(&r->io)),
+           (double)r->io.max_us * 1e-3, (unsigned)r->io.slow, (unsigned)r->card.stalls,
+           (unsigned long long)r->card.writes, (unsigned long long)r->card.sectors);
+    fflush(stdout);
+}
+
+static void usage(void)
+{
+    fprintf(stderr,
+            "usage: bench_logger [-r rows/s] [-s seconds] [-c none|good|slow] [-f csv|bin]\n"
+            "                    [-n] [-p period_ms] [-q ring] [-d dir] [-v]\n"
+            "  -r  rows per second (default: sweep 1 .. 2000)\n"
+            "  -s  seconds per run (default 10)\n"
+            "  -c  card profile (default good)\n"
+            "  -f  stroke log format (default %s)\n"
+            "  -n  no FIT file\n"
+            "  -p  logger period, ms (default %d)\n"
+            "  -q  ring length, power of two (default %d)\n"
+            "  -d  directory standing in for the card (default bench_sd)\n"
+            "  -v  logger messages; twice for debug\n",
+            CONFIG_ACTIVITY_LOG_BINARY ? "bin" : "csv", CONFIG_ACTIVITY_LOG_MAX_LATENCY_MS,
+            CONFIG_ACTIVITY_LOG_RING_LEN);
+}
+
+int main(int argc, char **argv)
+{
+    bench_cfg_t cfg = {
+        .rate = 0,
+        .seconds = 10,
+        .format = CONFIG_ACTIVITY_LOG_BINARY ? ACTIVITY_LOG_FORMAT_BINARY : ACTIVITY_LOG_FORMAT_CSV,
+        .fit = CONFIG_ACTIVITY_LOG_FIT,
+        .period_ms = CONFIG_ACTIVITY_LOG_MAX_LATENCY_MS,
+        .ring_len = CONFIG_ACTIVITY_LOG_RING_LEN,
+        .dir = "bench_sd",
+    };
+    const sim_card_profile_t *card = sim_card_profile("good");
+
+    bool bad = false;
+    int opt;
+    while ((opt = getopt(argc, argv, "r:s:c:f:np:q:d:vh")) != -1) {
+        switch (opt) {
+        case 'r': cfg.rate = strtod(optarg, NULL); break;
+        case 's': cfg.seconds = strtod(optarg, NULL); break;
+        case 'c': card = sim_card_profile(optarg); break;
+        case 'f':
+            if (strcmp(optarg, "csv") == 0) cfg.format = ACTIVITY_LOG_FORMAT_CSV;
+            else if (strcmp(optarg, "bin") == 0) cfg.format = ACTIVITY_LOG_FORMAT_BINARY;
+            else bad = true;
+            break;
+        case 'n': cfg.fit = false; break;
+        case 'p': cfg.period_ms = (uint32_t)strtoul(optarg, NULL, 10); break;
+        case 'q': cfg.ring_len = (uint32_t)strtoul(optarg, NULL, 10); break;
+        case 'd': cfg.dir = optarg; break;
+        case 'v': esp_log_verbose++; break;
+        default: bad = true; break;
+        }
+    }
+    bool ring_ok = cfg.ring_len >= 2 && (cfg.ring_len & (cfg.ring_len - 1)) == 0;
+    if (bad || !card || !ring_ok || cfg.rate < 0 || !(cfg.seconds > 0) || cfg.period_ms == 0 || optind != argc) {
+        usage();
+        return 2;
+    }
+    mkdir(cfg.dir, 0775);
+
+    static const double sweep[] = { 1, 10, 50, 100, 200, 500, 1000, 2000 };
+    const double *rates = cfg.rate > 0 ? &cfg.rate : sweep;
+    size_t n_rates = cfg.rate > 0 ? 1 : sizeof(sweep) / sizeof(sweep[0]);
+
+    printf("card %s, %s%s, ring %u, period %u ms, %.0f s per run\n", card->name,
+           cfg.format == ACTIVITY_LOG_FORMAT_BINARY ? "bin" : "csv", cfg.fit ? " + fit" : "",
+           (unsigned)cfg.ring_len, (unsigned)cfg.period_ms, cfg.seconds);
+    print_header();
+
+    for (size_t i = 0; i < n_rates; i++) {
+        bench_cfg_t c = cfg;
+        c.rate = rates[i];
+        bench_result_t r;
+        if (run(&c, card, &r) != 0) return 1;
+        print_result(&c, &r);
+        if (esp_log_verbose) sd_io_stats_write_csv(stdout, &r.io);
+    }
+    return 0;
+}
@@ -0,0 +1,149 @@
+/*
+ * The scan's device list (components/ble/ble_scan_table.c) in a busy
+ * boathouse: many phones, watches and sensors advertising at 20 ms-1 s
+ * intervals with noisy RSSI, some naming themselves only in scan responses.
+ *
+ * Counts the UI refreshes the old list made (one per advertising report)
+ * against the coalesced ones (at most one per period, only when something
+ * shown changed), times each report, and checks the list afterwards: no
+ * device twice, every entry findable, and exactly the BLE_MAX_DEVICES
+ * devices heard most recently.
+ *
+ *   bench_scan [-n devices] [-s seconds] [-p ui_period_ms]
+ */
+
+#include <getopt.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "ble_scan_table.h"
+
+#define MAX_DEV 1000
+
+typedef struct {
+    uint8_t addr[6];
+    int64_t itvl_us;
+    int64_t next_us;
+    int64_t last_us;            // last report heard
+    int     rssi;
+    bool    named;              // puts its name in the advert
+} dev_t_;
+
+static uint32_t s_rng = 11;
+
+static uint32_t rnd(void)
+{
+    s_rng ^= s_rng << 13;
+    s_rng ^= s_rng >> 17;
+    s_rng ^= s_rng << 5;
+    return s_rng;
+}
+
+static double now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+int main(int argc, char **argv)
+{
+    int n = 150, secs = 30, period_ms = 250;
+    int opt;
+    while ((opt = getopt(argc, argv, "n:s:p:")) != -1) {
+        switch (opt) {
+        case 'n': n = atoi(optarg); break;
+        case 's': secs = atoi(optarg); break;
+        case 'p': period_ms = atoi(optarg); break;
+        default:
+            fprintf(stderr, "usage: %s [-n devices] [-s seconds] [-p ui_period_ms]\n", argv[0]);
+            return 2;
+        }
+    }
+    if (n < 1) n = 1;
+    if (n > MAX_DEV) n = MAX_DEV;
+    if (period_ms < 1) period_ms = 1;
+
+    static dev_t_ devs[MAX_DEV];
+    for (int k = 0; k < n; k++) {
+        dev_t_ *d = &devs[k];
+        for (int b = 0; b < 6; b++) d->addr[b] = (uint8_t)rnd();
+        d->itvl_us = (20 + (int64_t)(rnd() % 980)) * 1000;
+        d->next_us = (int64_t)(rnd() % 1000) * 1000;
+        d->last_us = -1;
+        d->rssi = -45 - (int)(rnd() % 50);
+        d->named = rnd() % 3 != 0;
+    }
+
+    static ble_scan_table_t t;
+    ble_scan_table_clear(&t);
+    ble_scan_table_take_dirty(&t);
+
+    uint32_t reports = 0, refreshes = 0;
+    double ns = 0;
+    const int64_t end_us = (int64_t)secs * 1000000, ui_us = (int64_t)period_ms * 1000;
+    int64_t next_ui = ui_us;
+
+    for (int64_t now = 0; now < end_us; now += 1000) {
+        for (int k = 0; k < n; k++) {
+            dev_t_ *d = &devs[k];
+            if (now < d->next_us) continue;
+            d->next_us = now + d->itvl_us + (int64_t)(rnd() % 10) * 1000;   // advDelay
+
+            uint8_t data[31];
+            size_t len = 0;
+            data[len++] = 2; data[len++] = 0x01; data[len++] = 0x06;
+            if (d->named) {
+                int l = snprintf((char *)data + len + 2, sizeof(data) - len - 2, "Dev-%04d", k);
+                data[len++] = (uint8_t)(l + 1);
+                data[len++] = 0x09;
+                len += (size_t)l;
+            }
+            const int8_t rssi = (int8_t)(d->rssi + (int)(rnd() % 13) - 6);
+
+            double a = now_ns();
+            ble_scan_table_feed(&t, d->addr, 0, rssi, data, len, now);
+            ns += now_ns() - a;
+            d->last_us = now;
+            reports++;
+        }
+        if (now >= next_ui) {
+            next_ui += ui_us;
+            refreshes += ble_scan_table_take_dirty(&t);
+        }
+    }
+
+    // The list: no duplicates, every entry findable, and the most recently heard devices
+    int fails = 0;
+    for (int i = 0; i < t.count; i++) {
+        for (int j = i + 1; j < t.count; j++)
+            fails += memcmp(t.e[i].dev.addr, t.e[j].dev.addr, 6) == 0;
+        ble_scan_table_t probe = t;
+        fails += ble_scan_table_feed(&probe, t.e[i].dev.addr, 0, -50, NULL, 0, end_us);
+    }
+    int heard = 0;
+    for (int k = 0; k < n; k++) heard += devs[k].last_us >= 0;
+    const int want = heard < BLE_MAX_DEVICES ? heard : BLE_MAX_DEVICES;
+    int recent_missing = 0;
+    for (int k = 0; k < n; k++) {
+        if (devs[k].last_us < 0) continue;
+        int newer = 0;
+        for (int j = 0; j < n; j++) newer += devs[j].last_us > devs[k].last_us;
+        if (newer >= want) continue;
+        bool found = false;
+        for (int i = 0; i < t.count && !found; i++) found = memcmp(t.e[i].dev.addr, devs[k].addr, 6) == 0;
+        recent_missing += !found;
+    }
+    fails += recent_missing + (t.count != want);
+
+    printf("%d devices, %d s: %u reports (%.0f/s), %.1f ns per report, %u evictions\n", n, secs, (unsigned)reports,
+           reports / (double)secs, ns / reports, (unsigned)t.evictions);
+    printf("UI refreshes: %u one per report, %u coalesced at %d ms (%.1f/s)\n", (unsigned)reports,
+           (unsigned)refreshes, period_ms, refreshes / (double)secs);
+    printf("list: %d entries, %d of the most recent missing, %s\n", t.count, recent_missing, fails ? "FAIL" : "ok");
+    return fails ? 1 : 0;
+}
@@ -0,0 +1,267 @@
+/*
+ * Session download over a simulated BLE link: the firmware's framing and
+ * flow control (components/ble/ble_xfer_proto.c) with the device's sender
+ * and a client's receiver on either end of a connection-event model.
+ *
+ * Each connection event the peripheral sends queued notifications, split
+ * into link-layer packets of the negotiated data length, as long as they
+ * fit the event (and the per-event packet limit some phones impose). A
+ * notification that leaves frees a stack buffer and the sender refills it
+ * at once, as the NOTIFY_TX handler does. The client's ACK/REWIND writes
+ * arrive one event after the chunks that caused them. Chunks can be
+ * corrupted and the connection dropped to exercise REWIND and resume; the
+ * received file is compared with the original at the end.
+ *
+ *   bench_xfer [-s KB] [-p 1|2] [-i ms] [-l 27|251] [-m mtu] [-e pkts] [-b bufs]
+ *              [-w window] [-x permille] [-d drops]
+ *
+ * Without -p/-i/-l a table over PHY, interval and data length is printed.
+ */
+
+#include <getopt.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "ble_xfer_proto.h"
+
+#define MAX_BUFS    64
+#define T_IFS_US    150
+
+typedef struct {
+    int    phy;                 // 1 or 2 (Mbit/s)
+    double itvl_ms;
+    int    ll_len;              // link-layer payload: 27, or 251 with data length extension
+    int    mtu;
+    int    pkts_per_event;      // 0: as many as fit
+    int    bufs;                // notifications the stack can hold
+    int    window;
+    int    corrupt_permille;
+    int    drops;               // disconnects spread over the transfer
+} link_cfg_t;
+
+typedef struct {
+    double   secs;
+    uint32_t events;
+    uint32_t chunks;
+    uint32_t rewinds;
+    uint32_t bad;
+    uint32_t resumes;
+    bool     intact;
+} result_t;
+
+typedef struct {
+    uint8_t  buf[BLE_XFER_MAX_CHUNK + BLE_XFER_CHUNK_OVERHEAD];
+    uint16_t len;
+    uint16_t payload;           // file bytes in it
+} note_t;
+
+static uint32_t s_rng = 1;
+
+static uint32_t rnd(void)
+{
+    s_rng ^= s_rng << 13;
+    s_rng ^= s_rng >> 17;
+    s_rng ^= s_rng << 5;
+    return s_rng;
+}
+
+/* Air time of one exchange: our packet, the central's empty reply, two gaps. */
+static double packet_us(const link_cfg_t *c, int payload)
+{
+    int overhead = (c->phy == 2 ? 2 : 1) + 4 + 2 + 3;     // preamble, access address, header, CRC
+    double us_per_byte = 8.0 / c->phy;
+    return (overhead + payload) * us_per_byte + T_IFS_US + overhead * us_per_byte + T_IFS_US;
+}
+
+/* Notification air time: L2CAP and ATT headers, fragmented to the data length. */
+static double note_us(const link_cfg_t *c, int value_len, int *packets)
+{
+    int bytes = 4 + 3 + value_len;
+    double us = 0;
+    *packets = 0;
+    while (bytes > 0) {
+        int n = bytes < c->ll_len ? bytes : c->ll_len;
+        us += packet_us(c, n);
+        bytes -= n;
+        (*packets)++;
+    }
+    return us;
+}
+
+static void run(const link_cfg_t *c, const uint8_t *file, uint32_t size, result_t *res)
+{
+    memset(res, 0, sizeof(*res));
+    uint8_t *got = calloc(1, size ? size : 1);
+    note_t *q = calloc(MAX_BUFS, sizeof(note_t));
+    int q_len = 0;
+
+    const uint16_t chunk = ble_xfer_chunk_max((uint16_t)c->mtu);
+    ble_xfer_tx_t tx;
+    ble_xfer_rx_t rx;
+    ble_xfer_tx_start(&tx, size, 0, chunk, (uint32_t)c->window);
+    ble_xfer_rx_start(&rx, size, 0, (uint32_t)c->window);
+
+    uint8_t ctrl[8][16];            // client writes on their way to the device
+    size_t ctrl_len[8];
+    int ctrl_n = 0;
+    uint32_t next_drop = c->drops ? size / (uint32_t)(c->drops + 1) : UINT32_MAX;
+    const double event_us = c->itvl_ms * 1000.0;
+
+    while (!ble_xfer_tx_done(&tx) || !ble_xfer_rx_done(&rx)) {
+        res->events++;
+        if (res->events > 10000000) break;
+
+        // Writes from the last event reach the device first
+        for (int i = 0; i < ctrl_n; i++) {
+            ble_xfer_req_t r;
+            if (!ble_xfer_req_parse(ctrl[i], ctrl_len[i], &r)) continue;
+            if (r.op == BLE_XFER_OP_ACK) ble_xfer_tx_ack(&tx, r.offset);
+            if (r.op == BLE_XFER_OP_REWIND) ble_xfer_tx_rewind(&tx, r.offset);
+        }
+        ctrl_n = 0;
+
+        double used = 0;
+        int pkts = 0;
+        for (;;) {
+            // The sender's pump: fill the stack's buffers up to the window
+            while (q_len < c->bufs) {
+                uint32_t off;
+                uint16_t len = ble_xfer_tx_next(&tx, &off);
+                if (!len) break;
+                note_t *n = &q[q_len++];
+                memcpy(n->buf + 4, file + off, len);
+                n->len = (uint16_t)ble_xfer_chunk_seal(n->buf, off, len);
+                n->payload = len;
+                ble_xfer_tx_sent(&tx, len);
+                res->chunks++;
+            }
+            if (q_len == 0) break;
+
+            int n_pkts;
+            double us = note_us(c, q[0].len, &n_pkts);
+            if (used + us > event_us - T_IFS_US) break;
+            if (c->pkts_per_event && pkts + n_pkts > c->pkts_per_event) break;
+            used += us;
+            pkts += n_pkts;
+
+            // Delivered
+            note_t n = q[0];
+            memmove(q, q + 1, (size_t)(--q_len) * sizeof(note_t));
+            if (c->corrupt_permille && (int)(rnd() % 1000) < c->corrupt_permille) n.buf[4 + rnd() % n.payload] ^= 0x5A;
+
+            const uint8_t *payload;
+            uint16_t plen;
+            uint32_t at = rx.next;
+            if (ble_xfer_rx_chunk(&rx, n.buf, n.len, &payload, &plen) == BLE_XFER_RX_DATA) memcpy(got + at, payload, plen);
+
+            size_t w = (ctrl_n < 8) ? ble_xfer_rx_reply(&rx, ctrl[ctrl_n]) : 0;
+            if (w) ctrl_len[ctrl_n++] = w;
+        }
+
+        // Connection lost: queued notifications and writes with it; the client reopens where it got to
+        if (rx.next >= next_drop && !ble_xfer_rx_done(&rx)) {
+            res->resumes++;
+            q_len = 0;
+            ctrl_n = 0;
+            res->rewinds += tx.rewinds;
+            ble_xfer_tx_start(&tx, size, rx.next, chunk, (uint32_t)c->window);
+            ble_xfer_rx_start(&rx, size, rx.next, (uint32_t)c->window);
+            next_drop = (res->resumes < (uint32_t)c->drops) ? size / (uint32_t)(c->drops + 1) * (res->resumes + 1)
+                                                            : UINT32_MAX;
+        }
+    }
+
+    res->rewinds += tx.rewinds;
+    res->bad = rx.bad;
+    res->secs = res->events * c->itvl_ms / 1000.0;
+    res->intact = memcmp(got, file, size) == 0;
+    free(got);
+    free(q);
+}
+
+static void print_header(void)
+{
+    printf("%-4s %7s %5s %5s %6s %5s %9s %8s %8s %7s %7s %s\n", "PHY", "itvl_ms", "LL", "MTU", "chunk", "bufs",
+           "KB/s", "2h_s", "chunks", "rewind", "resume", "file");
+}
+
+static void print_row(const link_cfg_t *c, uint32_t size, const result_t *r)
+{
+    // A 2-hour binary stroke log: 28-byte records at 30 strokes/min plus block headers, about 100 KB
+    const double two_hour_kb = 100.0;
+    double kbps = r->secs > 0 ? size / 1024.0 / r->secs : 0;
+    printf("%dM   %7.1f %5d %5d %6u %5d %9.1f %8.1f %8u %7u %7u %s\n", c->phy, c->itvl_ms, c->ll_len, c->mtu,
+           (unsigned)ble_xfer_chunk_max((uint16_t)c->mtu), c->bufs, kbps, kbps > 0 ? two_hour_kb / kbps : 0,
+           (unsigned)r->chunks, (unsigned)r->rewinds, (unsigned)r->resumes, r->intact ? "ok" : "CORRUPT");
+}
+
+int main(int argc, char **argv)
+{
+    link_cfg_t c = {
+        .phy = 2, .itvl_ms = 15, .ll_len = 251, .mtu = 247, .bufs = 12, .window = BLE_XFER_DEFAULT_WINDOW,
+    };
+    uint32_t size_kb = 512;
+    bool sweep = true;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "s:p:i:l:m:e:b:w:x:d:")) != -1) {
+        switch (opt) {
+        case 's': size_kb = (uint32_t)atoi(optarg); break;
+        case 'p': c.phy = atoi(optarg) == 1 ? 1 : 2; sweep = false; break;
+        case 'i': c.itvl_ms = atof(optarg); sweep = false; break;
+        case 'l': c.ll_len = atoi(optarg); sweep = false; break;
+        case 'm': c.mtu = atoi(optarg); break;
+        case 'e': c.pkts_per_event = atoi(optarg); break;
+        case 'b': c.bufs = atoi(optarg); break;
+        case 'w': c.window = atoi(optarg); break;
+        case 'x': c.corrupt_permille = atoi(optarg); break;
+        case 'd': c.drops = atoi(optarg); break;
+        default:
+            fprintf(stderr, "usage: %s [-s KB] [-p 1|2] [-i ms] [-l 27|251] [-m mtu] [-e pkts] [-b bufs] "
+                            "[-w window] [-x permille] [-d drops]\n", argv[0]);
+            return 2;
+        }
+    }
+    if (c.bufs < 1) c.bufs = 1;
+    if (c.bufs > MAX_BUFS) c.bufs = MAX_BUFS;
+    if (c.ll_len < 27) c.ll_len = 27;
+    if (c.ll_len > 251) c.ll_len = 251;
+    if (c.mtu < 23) c.mtu = 23;
+    if (c.mtu > 512) c.mtu = 512;
+
+    uint32_t size = size_kb * 1024;
+    uint8_t *file = malloc(size ? size : 1);
+    for (uint32_t i = 0; i < size; i++) file[i] = (uint8_t)rnd();
+
+    int fails = 0;
+    result_t r;
+    print_header();
+    if (!sweep) {
+        run(&c, file, size, &r);
+        print_row(&c, size, &r);
+        fails += !r.intact;
+    } else {
+        static const int phys[] = { 1, 2 };
+        static const double itvls[] = { 7.5, 15, 30, 50 };
+        static const int lls[] = { 27, 251 };
+        for (size_t p = 0; p < 2; p++) {
+            for (size_t l = 0; l < 2; l++) {
+                for (size_t i = 0; i < 4; i++) {
+                    link_cfg_t s = c;
+                    s.phy = phys[p];
+                    s.ll_len = lls[l];
+                    s.itvl_ms = itvls[i];
+                    run(&s, file, size, &r);
+                    print_row(&s, size, &r);
+                    fails += !r.intact;
+                }
+            }
+        }
+    }
+
+    free(file);
+    return fails ? 1 : 0;
+}
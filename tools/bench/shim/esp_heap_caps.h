@@ -0,0 +1,29 @@
+// tools/bench/shim/esp_heap_caps.h
+#pragma once
+
+/* Host stand-in for esp_heap_caps.h: one heap, capabilities ignored. */
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+#define MALLOC_CAP_DMA      (1u << 3)
+#define MALLOC_CAP_8BIT     (1u << 2)
+#define MALLOC_CAP_INTERNAL (1u << 11)
+
+static inline void *heap_caps_malloc(size_t size, uint32_t caps)
+{
+    (void)caps;
+    return malloc(size);
+}
+
+static inline void *heap_caps_aligned_alloc(size_t alignment, size_t size, uint32_t caps)
+{
+    (void)caps;
+    return aligned_alloc(alignment, (size + alignment - 1) / alignment * alignment);
+}
+
+static inline void heap_caps_free(void *ptr)
+{
+    free(ptr);
+}
@@ -0,0 +1,14 @@
+// tools/bench/shim/esp_log.h
+#pragma once
+
+/* Host stand-in for esp_log.h: warnings and errors go to stderr, info and
+ * debug only when the benchmark runs with -v. */
+
+#include <stdio.h>
+
+extern int esp_log_verbose;
+
+#define ESP_LOGE(tag, fmt, ...) fprintf(stderr, "E %s: " fmt "\n", tag, ##__VA_ARGS__)
+#define ESP_LOGW(tag, fmt, ...) fprintf(stderr, "W %s: " fmt "\n", tag, ##__VA_ARGS__)
+#define ESP_LOGI(tag, fmt, ...) do { if (esp_log_verbose) fprintf(stderr, "I %s: " fmt "\n", tag, ##__VA_ARGS__); } while (0)
+#define ESP_LOGD(tag, fmt, ...) do { if (esp_log_verbose > 1) fprintf(stderr, "D %s: " fmt "\n", tag, ##__VA_ARGS__); } while (0)
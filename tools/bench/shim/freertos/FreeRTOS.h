@@ -0,0 +1,12 @@
+// tools/bench/shim/freertos/FreeRTOS.h
+#pragma once
+
+/* Host stand-in for the critical sections sd_io_stats.c takes: a mutex. */
+
+#include <pthread.h>
+
+typedef pthread_mutex_t portMUX_TYPE;
+
+#define portMUX_INITIALIZER_UNLOCKED    PTHREAD_MUTEX_INITIALIZER
+#define portENTER_CRITICAL(mux)         pthread_mutex_lock(mux)
+#define portEXIT_CRITICAL(mux)          pthread_mutex_unlock(mux)
@@ -0,0 +1,12 @@
+// tools/bench/shim/sdkconfig.h
+#pragma once
+
+/* The logger's Kconfig defaults (components/activity_log/Kconfig). */
+
+#define CONFIG_ACTIVITY_LOG_BINARY              1
+#define CONFIG_ACTIVITY_LOG_FIT                 1
+#define CONFIG_ACTIVITY_LOG_RING_LEN            64
+#define CONFIG_ACTIVITY_LOG_MAX_LATENCY_MS      5000
+#define CONFIG_ACTIVITY_LOG_IO_BUF_KB           4
+#define CONFIG_ACTIVITY_LOG_SPLIT_TIME_S        0
+#define CONFIG_ACTIVITY_LOG_PREALLOC_KB         512
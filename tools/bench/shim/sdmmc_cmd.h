@@ -0,0 +1,6 @@
+// tools/bench/shim/sdmmc_cmd.h
+#pragma once
+
+/* Host stand-in: sd_mmc_helper_t only holds a pointer to the card. */
+
+typedef struct sdmmc_card_t sdmmc_card_t;
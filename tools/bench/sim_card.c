@@ -0,0 +1,232 @@
+// tools/bench/sim_card.c
+#define _GNU_SOURCE
+#include "sim_card.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+const sim_card_profile_t sim_card_profiles[] = {
+    // Host disk speed: what the logger costs on its own
+    { .name = "none", .cluster_bytes = 32768 },
+    // A decent card on the 1-bit bus: mostly quick, a long stall every 512 KB of new clusters
+    { .name = "good", .cluster_bytes = 32768, .program_kbps = 2000,
+      .write_min_us = 500, .write_max_us = 2000,
+      .tail_permille = 20, .tail_min_us = 5000, .tail_max_us = 40000,
+      .alloc_us = 1500, .stall_every = 16, .stall_min_ms = 50, .stall_max_ms = 300,
+      .sync_min_us = 3000, .sync_max_us = 12000 },
+    // A worn or cheap card: slow programs, frequent and longer stalls
+    { .name = "slow", .cluster_bytes = 32768, .program_kbps = 400,
+      .write_min_us = 1000, .write_max_us = 5000,
+      .tail_permille = 50, .tail_min_us = 20000, .tail_max_us = 120000,
+      .alloc_us = 4000, .stall_every = 4, .stall_min_ms = 150, .stall_max_ms = 800,
+      .sync_min_us = 10000, .sync_max_us = 40000 },
+    { .name = NULL },
+};
+
+#define SIM_MAX_FILES 8
+
+typedef struct {
+    FILE   *f;                      // NULL = free slot
+    int     fd;
+    int64_t alloc;                  // bytes covered by allocated clusters
+} sim_file_t;
+
+// Only the logger thread touches these once a session is open
+static const sim_card_profile_t *s_prof = &sim_card_profiles[0];
+static char s_root[128];
+static size_t s_root_len;
+static uint32_t s_rng = 1;
+static sim_file_t s_files[SIM_MAX_FILES];
+static sim_card_stats_t s_stats;
+
+FILE *__real_fopen(const char *path, const char *mode);
+int __real_fileno(FILE *f);
+int __real_fsync(int fd);
+
+const sim_card_profile_t *sim_card_profile(const char *name)
+{
+    for (const sim_card_profile_t *p = sim_card_profiles; p->name; p++) {
+        if (strcmp(p->name, name) == 0) return p;
+    }
+    return NULL;
+}
+
+void sim_card_init(const sim_card_profile_t *profile, const char *root, uint32_t seed)
+{
+    s_prof = profile;
+    snprintf(s_root, sizeof(s_root), "%s", root);
+    s_root_len = strlen(s_root);
+    s_rng = seed ? seed : 1;
+    memset(&s_stats, 0, sizeof(s_stats));
+}
+
+void sim_card_get_stats(sim_card_stats_t *out)
+{
+    *out = s_stats;
+}
+
+/* -------------------------------------------------------------------------- */
+/* Latency model                                                              */
+/* -------------------------------------------------------------------------- */
+
+static uint32_t rand_range(uint32_t lo, uint32_t hi)
+{
+    s_rng ^= s_rng << 13;
+    s_rng ^= s_rng >> 17;
+    s_rng ^= s_rng << 5;
+    return (hi > lo) ? lo + s_rng % (hi - lo + 1) : lo;
+}
+
+static void card_busy(uint32_t us)
+{
+    if (us == 0) return;
+    s_stats.injected_us += us;
+    if (us > s_stats.max_injected_us) s_stats.max_injected_us = us;
+
+    struct timespec ts = { .tv_sec = us / 1000000, .tv_nsec = (long)(us % 1000000) * 1000 };
+    while (nanosleep(&ts, &ts) != 0 && errno == EINTR) {
+    }
+}
+
+/* FAT work for a write that ends at `end`: new clusters, and the periodic stall. */
+static uint32_t allocate(sim_file_t *sf, int64_t end)
+{
+    const int64_t cs = s_prof->cluster_bytes;
+    if (end <= sf->alloc) return 0;
+
+    uint32_t k = (uint32_t)((end + cs - 1) / cs - (sf->alloc + cs - 1) / cs);
+    sf->alloc = (end + cs - 1) / cs * cs;
+    if (k == 0) return 0;
+
+    uint32_t before = s_stats.clusters;
+    s_stats.clusters += k;
+
+    uint32_t us = s_prof->alloc_us;
+    if (s_prof->stall_every && before / s_prof->stall_every != s_stats.clusters / s_prof->stall_every) {
+        s_stats.stalls++;
+        us += rand_range(s_prof->stall_min_ms, s_prof->stall_max_ms) * 1000;
+    }
+    return us;
+}
+
+static uint32_t write_latency(size_t n)
+{
+    const sim_card_profile_t *p = s_prof;
+    uint32_t us = rand_range(p->write_min_us, p->write_max_us);
+    if (p->tail_permille && rand_range(0, 999) < p->tail_permille)
+        us += rand_range(p->tail_min_us, p->tail_max_us);
+    if (p->program_kbps)
+        us += (uint32_t)((uint64_t)n * 1000000 / ((uint64_t)p->program_kbps * 1024));
+    return us;
+}
+
+/* -------------------------------------------------------------------------- */
+/* Cookie streams                                                             */
+/* -------------------------------------------------------------------------- */
+
+static ssize_t sim_write(void *cookie, const char *buf, size_t n)
+{
+    sim_file_t *sf = cookie;
+    off_t pos = lseek(sf->fd, 0, SEEK_CUR);
+    if (pos < 0) return -1;
+
+    card_busy(write_latency(n) + allocate(sf, (int64_t)pos + (int64_t)n));
+    s_stats.writes++;
+    s_stats.bytes += n;
+    if (n > 0) s_stats.sectors += (uint64_t)((pos + (off_t)n - 1) / 512 - pos / 512 + 1);
+
+    size_t done = 0;
+    while (done < n) {
+        ssize_t r = write(sf->fd, buf + done, n - done);
+        if (r < 0) {
+            if (errno == EINTR) continue;
+            return done ? (ssize_t)done : -1;
+        }
+        done += (size_t)r;
+    }
+    return (ssize_t)done;
+}
+
+static int sim_seek(void *cookie, off64_t *pos, int whence)
+{
+    sim_file_t *sf = cookie;
+    off_t r = lseek(sf->fd, (off_t)*pos, whence);
+    if (r < 0) return -1;
+    *pos = r;
+    return 0;
+}
+
+static int sim_close(void *cookie)
+{
+    sim_file_t *sf = cookie;
+    int r = close(sf->fd);
+    sf->f = NULL;
+    return r;
+}
+
+static sim_file_t *find_file(FILE *f)
+{
+    for (int i = 0; f && i < SIM_MAX_FILES; i++) {
+        if (s_files[i].f == f) return &s_files[i];
+    }
+    return NULL;
+}
+
+/* -------------------------------------------------------------------------- */
+/* Link-time wrappers                                                         */
+/* -------------------------------------------------------------------------- */
+
+FILE *__wrap_fopen(const char *path, const char *mode)
+{
+    // The logger only creates its files; reads and anything elsewhere are real
+    bool ours = s_root_len && strncmp(path, s_root, s_root_len) == 0 && path[s_root_len] == '/';
+    if (!ours || mode[0] != 'w') return __real_fopen(path, mode);
+
+    sim_file_t *sf = NULL;
+    for (int i = 0; !sf && i < SIM_MAX_FILES; i++) {
+        if (!s_files[i].f) sf = &s_files[i];
+    }
+    if (!sf) {
+        errno = EMFILE;
+        return NULL;
+    }
+
+    int fd = open(path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) return NULL;
+
+    *sf = (sim_file_t){ .fd = fd, .alloc = 0 };
+    card_busy(s_prof->alloc_us);    // directory entry
+
+    cookie_io_functions_t io = { .write = sim_write, .seek = sim_seek, .close = sim_close };
+    FILE *f = fopencookie(sf, mode, io);
+    if (!f) {
+        close(fd);
+        return NULL;
+    }
+    sf->f = f;
+    return f;
+}
+
+int __wrap_fileno(FILE *f)
+{
+    sim_file_t *sf = find_file(f);
+    return sf ? sf->fd : __real_fileno(f);
+}
+
+int __wrap_fsync(int fd)
+{
+    for (int i = 0; i < SIM_MAX_FILES; i++) {
+        if (s_files[i].f && s_files[i].fd == fd) {
+            // The host's own durability is beside the point; only the card's time counts
+            card_busy(rand_range(s_prof->sync_min_us, s_prof->sync_max_us));
+            s_stats.syncs++;
+            return 0;
+        }
+    }
+    return __real_fsync(fd);
+}
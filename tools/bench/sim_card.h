@@ -0,0 +1,74 @@
+// tools/bench/sim_card.h
+#pragma once
+
+/*
+ * A slow-storage stand-in for the SD card, for the logger benchmark.
+ *
+ * Files the logger creates under the simulated mount point are opened as
+ * fopencookie() streams over a real file. stdio still does the buffering
+ * (setvbuf() works as on the device), and whenever it spills a buffer the
+ * cookie sleeps for what the card would take before passing the bytes on:
+ *
+ *   - a base latency per write, plus the bytes at the card's program rate
+ *   - now and then a slow write (page program, wear levelling)
+ *   - a FAT update when the write grows the file into new clusters, and
+ *     every `stall_every` clusters allocated on the card a long stall
+ *   - a directory/FAT update on fsync()
+ *
+ * The latency is real wall time on the thread that writes, so a producer
+ * running alongside sees the ring fill exactly as stroke_task would.
+ *
+ * The logger opens with fopen() and reaches the descriptor through
+ * fileno() (fsync, ftruncate). The benchmark links with
+ * -Wl,--wrap=fopen,--wrap=fileno,--wrap=fsync so those calls land here;
+ * anything outside the mount point goes to the real functions.
+ */
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct {
+    const char *name;
+    uint32_t cluster_bytes;         // FAT cluster size
+    uint32_t program_kbps;          // sustained program rate, KB/s (0 = free)
+    uint32_t write_min_us;          // per write call, uniform
+    uint32_t write_max_us;
+    uint32_t tail_permille;         // writes that take a slow path ...
+    uint32_t tail_min_us;           // ... of this long
+    uint32_t tail_max_us;
+    uint32_t alloc_us;              // FAT update when a write allocates clusters
+    uint32_t stall_every;           // clusters between allocation stalls (0 = none)
+    uint32_t stall_min_ms;
+    uint32_t stall_max_ms;
+    uint32_t sync_min_us;           // per fsync, uniform
+    uint32_t sync_max_us;
+} sim_card_profile_t;
+
+/* "none", "good", "slow"; NULL-name terminated. */
+extern const sim_card_profile_t sim_card_profiles[];
+
+/* The profile called `name`, or NULL. */
+const sim_card_profile_t *sim_card_profile(const char *name);
+
+/* Simulate `profile` for files created under `root`. Resets the counters. */
+void sim_card_init(const sim_card_profile_t *profile, const char *root, uint32_t seed);
+
+typedef struct {
+    uint64_t writes;                // buffer spills that reached the card
+    uint64_t bytes;
+    uint64_t sectors;               // 512-byte sectors those writes touched
+    uint32_t syncs;
+    uint32_t clusters;              // allocated since init
+    uint32_t stalls;                // allocation stalls
+    uint64_t injected_us;           // total latency added
+    uint32_t max_injected_us;       // longest single operation
+} sim_card_stats_t;
+
+void sim_card_get_stats(sim_card_stats_t *out);
+
+#ifdef __cplusplus
+}
+#endif
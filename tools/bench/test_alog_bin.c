@@ -0,0 +1,160 @@
+/*
+ * Binary stroke log records (components/activity_log/activity_log_bin.c):
+ * a row packed and unpacked prints the same distance, position, power,
+ * drive and recovery CSV columns as the row itself, for random values,
+ * exact rounding ties and values past the old 8-bit fields' range; values
+ * past a field's range saturate; headers parse back.
+ *
+ *   test_alog_bin              (exit status 0 = pass)
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "activity_log_bin.h"
+#include "fastfmt.h"
+
+static int s_failed;
+
+#define CHECK(cond)                                                         \
+    do {                                                                    \
+        if (!(cond)) {                                                      \
+            fprintf(stderr, "%s:%d: %s\n", __FILE__, __LINE__, #cond);      \
+            s_failed++;                                                     \
+        }                                                                   \
+    } while (0)
+
+static uint64_t s_rng = 0x9E3779B97F4A7C15ull;
+
+static uint32_t rnd(void)
+{
+    s_rng ^= s_rng << 13;
+    s_rng ^= s_rng >> 7;
+    s_rng ^= s_rng << 17;
+    return (uint32_t)(s_rng >> 32);
+}
+
+static float rnd_float(float max)
+{
+    return (float)rnd() / 4294967296.0f * max;
+}
+
+static const alog_bin_file_hdr_t s_hdr = {
+    .session_id = 42,
+    .start_utc_us = 1735714800000000LL,
+};
+
+static activity_log_row_t round_trip(const activity_log_row_t *row)
+{
+    alog_bin_record_t rec;
+    activity_log_row_t out;
+    alog_bin_pack(row, &rec);
+    alog_bin_unpack(&s_hdr, &rec, NULL, &out);
+    return out;
+}
+
+/* Compare one column as alog_csv_format_stroke() prints it. */
+static bool same_column(float want, float got, int decimals, const char *name)
+{
+    char a[32], b[32];
+    a[ff_float(a, want, decimals)] = '\0';
+    b[ff_float(b, got, decimals)] = '\0';
+    if (strcmp(a, b) == 0) return true;
+    fprintf(stderr, "%s: device %s, export %s\n", name, a, b);
+    return false;
+}
+
+static int check_row(const activity_log_row_t *row)
+{
+    activity_log_row_t out = round_trip(row);
+    int bad = 0;
+    bad += !same_column(row->total_distance_m, out.total_distance_m, 1, "distance");
+    bad += !same_column(row->power_w, out.power_w, 1, "power");
+    bad += !same_column(row->drive_time_s, out.drive_time_s, 2, "drive");
+    bad += !same_column(row->recovery_time_s, out.recovery_time_s, 2, "recovery");
+
+    char a[32], b[32];
+    a[ff_double(a, row->gps_lat, 7)] = '\0';
+    b[ff_double(b, out.gps_lat, 7)] = '\0';
+    if (strcmp(a, b) != 0) {
+        fprintf(stderr, "lat: device %s, export %s\n", a, b);
+        bad++;
+    }
+    return bad;
+}
+
+/* Every CSV column the record stores at the CSV's resolution comes back as printed. */
+static void test_columns(void)
+{
+    int bad = 0;
+    for (int i = 0; i < 200000; i++) {
+        activity_log_row_t row = {
+            .total_distance_m = rnd_float(50000.0f),
+            .power_w = rnd_float(3000.0f),
+            .drive_time_s = rnd_float(10.0f),
+            .recovery_time_s = rnd_float(60.0f),
+            .gps_lat = (double)(int32_t)rnd() * 1e-7 / 50.0,
+        };
+        bad += check_row(&row);
+    }
+
+    // Exact ties (x.x5 and x.xx5 in binary): half to even on both sides
+    for (int k = 0; k < 4000; k++) {
+        activity_log_row_t row = {
+            .total_distance_m = (float)k * 0.25f,
+            .power_w = (float)k * 0.25f,
+            .drive_time_s = (float)k * 0.125f / 16.0f,
+            .recovery_time_s = (float)k * 0.125f,
+        };
+        bad += check_row(&row);
+    }
+    CHECK(bad == 0);
+}
+
+/* Hard sprints and long rests the 8-bit fields cut off at 1020 W, 2.55 s and 5.1 s. */
+static void test_range(void)
+{
+    activity_log_row_t row = {
+        .power_w = 1650.3f,
+        .drive_time_s = 3.27f,
+        .recovery_time_s = 42.81f,
+    };
+    CHECK(check_row(&row) == 0);
+
+    // Past the top of a field: the largest value it holds
+    row = (activity_log_row_t){ .power_w = 9000.0f, .drive_time_s = 1000.0f, .recovery_time_s = -1.0f };
+    activity_log_row_t out = round_trip(&row);
+    CHECK(same_column(6553.5f, out.power_w, 1, "power max"));
+    CHECK(same_column(655.35f, out.drive_time_s, 2, "drive max"));
+    CHECK(out.recovery_time_s == 0.0f);
+}
+
+static void test_header(void)
+{
+    uint8_t buf[ALOG_BIN_HEADER_SIZE];
+    alog_bin_build_header(&s_hdr, buf);
+
+    alog_bin_file_hdr_t h;
+    CHECK(alog_bin_parse_header(buf, sizeof(buf), &h));
+    CHECK(h.version == ALOG_BIN_VERSION && h.record_size == sizeof(alog_bin_record_t));
+    CHECK(h.session_id == s_hdr.session_id && h.start_utc_us == s_hdr.start_utc_us);
+
+    buf[20] ^= 1;
+    CHECK(!alog_bin_parse_header(buf, sizeof(buf), &h));
+}
+
+int main(void)
+{
+    test_columns();
+    test_range();
+    test_header();
+
+    if (s_failed) {
+        printf("test_alog_bin: %d check(s) failed\n", s_failed);
+        return 1;
+    }
+    printf("test_alog_bin: ok\n");
+    return 0;
+}
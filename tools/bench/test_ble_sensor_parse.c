@@ -0,0 +1,207 @@
+/*
+ * Heart Rate and Cycling Power measurement parsing
+ * (components/ble/ble_sensor_parse.c): every optional field, and every way
+ * a notification can be split across buffer segments, as NimBLE mbuf
+ * chains split them.
+ *
+ *   test_ble_sensor_parse      (exit status 0 = pass)
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "ble_sensor_parse.h"
+
+static int s_failed;
+
+#define CHECK(cond)                                                         \
+    do {                                                                    \
+        if (!(cond)) {                                                      \
+            fprintf(stderr, "%s:%d: %s\n", __FILE__, __LINE__, #cond);      \
+            s_failed++;                                                     \
+        }                                                                   \
+    } while (0)
+
+#define MAX_SEGS 64
+
+/* A chain of segments over one buffer; the last one has len 0 and ends it. */
+typedef struct {
+    const uint8_t *p;
+    uint16_t len;
+} seg_t;
+
+static bool seg_next(const void **seg, const uint8_t **p, uint16_t *len)
+{
+    const seg_t *s = (const seg_t *)*seg + 1;
+    if (!s->p) return false;
+    *seg = s;
+    *p = s->p;
+    *len = s->len;
+    return true;
+}
+
+/* Cut buf[0..len) at the offsets in `cuts` (ascending); empty segments allowed. */
+static ble_sensor_rd_t chain(seg_t *segs, const uint8_t *buf, size_t len, const size_t *cuts, int ncuts)
+{
+    size_t from = 0;
+    int n = 0;
+    for (int i = 0; i <= ncuts; i++) {
+        size_t to = (i < ncuts) ? cuts[i] : len;
+        segs[n++] = (seg_t){ .p = buf + from, .len = (uint16_t)(to - from) };
+        from = to;
+    }
+    segs[n] = (seg_t){ 0 };
+    return (ble_sensor_rd_t){ .seg = segs, .p = segs[0].p, .left = segs[0].len, .next = seg_next };
+}
+
+/* Chains chain_k() builds for a buffer of `len` bytes. */
+#define CHAINS(len) ((int)(len) + 3)
+
+/* Chain k of a buffer: split in two at k (either part may be empty), one
+ * byte per segment, or with an empty segment in the middle. */
+static ble_sensor_rd_t chain_k(seg_t *segs, const uint8_t *buf, size_t len, int k)
+{
+    size_t cuts[MAX_SEGS];
+    if (k <= (int)len) {
+        cuts[0] = (size_t)k;                            // two segments, either may be empty
+        return chain(segs, buf, len, cuts, 1);
+    }
+    if (k == (int)len + 1) {
+        for (size_t i = 1; i < len; i++) cuts[i - 1] = i;      // one byte each
+        return chain(segs, buf, len, cuts, len > 1 ? (int)len - 1 : 0);
+    }
+    cuts[0] = cuts[1] = len / 2;                        // an empty segment in the middle
+    return chain(segs, buf, len, cuts, 2);
+}
+
+static void test_hr(void)
+{
+    // u8 BPM, contact detected
+    static const uint8_t u8_bpm[] = { 0x06, 72 };
+    for (int k = 0; k < CHAINS(sizeof(u8_bpm)); k++) {
+        seg_t cs[MAX_SEGS];
+        ble_sensor_rd_t rd = chain_k(cs, u8_bpm, sizeof(u8_bpm), k);
+        ble_hr_meas_t m;
+        CHECK(ble_hr_meas_parse(&rd, &m));
+        CHECK(m.bpm == 72 && m.contact && m.rr_count == 0);
+    }
+
+    // u16 BPM, energy expended and three RR intervals
+    static const uint8_t full[] = {
+        0x1F, 0x2C, 0x01,                   // flags, 300 bpm
+        0x34, 0x12,                         // energy, skipped
+        0x20, 0x03, 0x34, 0x03, 0x16, 0x03, // RR 800, 820, 790
+    };
+    for (int k = 0; k < CHAINS(sizeof(full)); k++) {
+        seg_t cs[MAX_SEGS];
+        ble_sensor_rd_t rd = chain_k(cs, full, sizeof(full), k);
+        ble_hr_meas_t m;
+        CHECK(ble_hr_meas_parse(&rd, &m));
+        CHECK(m.bpm == 300 && m.contact && m.rr_count == 3 && m.rr_last == 790);
+    }
+
+    // RR without energy
+    static const uint8_t rr_only[] = { 0x10, 60, 0x00, 0x04, 0x10, 0x04 };
+    for (int k = 0; k < CHAINS(sizeof(rr_only)); k++) {
+        seg_t cs[MAX_SEGS];
+        ble_sensor_rd_t rd = chain_k(cs, rr_only, sizeof(rr_only), k);
+        ble_hr_meas_t m;
+        CHECK(ble_hr_meas_parse(&rd, &m));
+        CHECK(m.bpm == 60 && m.rr_count == 2 && m.rr_last == 1040);
+    }
+
+    // Contact: not supported counts as contact, supported but lost does not
+    static const uint8_t no_contact[] = { 0x04, 80 };
+    static const uint8_t unsupported[] = { 0x00, 80 };
+    seg_t segs[MAX_SEGS];
+    ble_hr_meas_t m;
+    ble_sensor_rd_t rd = chain(segs, no_contact, sizeof(no_contact), NULL, 0);
+    CHECK(ble_hr_meas_parse(&rd, &m) && !m.contact);
+    rd = chain(segs, unsupported, sizeof(unsupported), NULL, 0);
+    CHECK(ble_hr_meas_parse(&rd, &m) && m.contact);
+
+    // Truncated before the end of energy expended: rejected; inside the RR list: the whole ones count
+    for (size_t len = 0; len < sizeof(full); len++) {
+        for (int k = 0; k < CHAINS(len); k++) {
+            seg_t cs[MAX_SEGS];
+            ble_sensor_rd_t rd2 = chain_k(cs, full, len, k);
+            const bool ok = ble_hr_meas_parse(&rd2, &m);
+            CHECK(ok == (len >= 5));
+            if (ok) CHECK(m.rr_count == (len - 5) / 2);
+        }
+    }
+}
+
+static void test_cp(void)
+{
+    // Power only
+    static const uint8_t power[] = { 0x00, 0x00, 0xF5, 0x00 };
+    for (int k = 0; k < CHAINS(sizeof(power)); k++) {
+        seg_t cs[MAX_SEGS];
+        ble_sensor_rd_t rd = chain_k(cs, power, sizeof(power), k);
+        ble_cp_meas_t m;
+        CHECK(ble_cp_meas_parse(&rd, &m));
+        CHECK(m.power_w == 245 && !m.has_crank);
+    }
+
+    // Negative power (back-pedalling on some meters)
+    static const uint8_t negative[] = { 0x00, 0x00, 0xFB, 0xFF };
+    seg_t segs[MAX_SEGS];
+    ble_cp_meas_t m;
+    ble_sensor_rd_t rd = chain(segs, negative, sizeof(negative), NULL, 0);
+    CHECK(ble_cp_meas_parse(&rd, &m) && m.power_w == -5);
+
+    // Crank data after balance, accumulated torque and wheel revolutions
+    static const uint8_t full[] = {
+        0x35, 0x00,                         // flags: balance, torque, wheel, crank
+        0x2C, 0x01,                         // 300 W
+        0x64,                               // balance
+        0x10, 0x20,                         // accumulated torque
+        0x01, 0x02, 0x03, 0x04, 0x05, 0x06, // wheel revolutions + event time
+        0xD2, 0x04,                         // crank revolutions 1234
+        0xF0, 0xFF,                         // last crank event 0xFFF0
+    };
+    for (int k = 0; k < CHAINS(sizeof(full)); k++) {
+        seg_t cs[MAX_SEGS];
+        ble_sensor_rd_t rd2 = chain_k(cs, full, sizeof(full), k);
+        CHECK(ble_cp_meas_parse(&rd2, &m));
+        CHECK(m.power_w == 300 && m.has_crank && m.crank_revs == 1234 && m.crank_time == 0xFFF0);
+    }
+
+    // Crank data with only the wheel before it
+    static const uint8_t wheel[] = { 0x30, 0x00, 0x96, 0x00, 1, 2, 3, 4, 5, 6, 0x0A, 0x00, 0x00, 0x04 };
+    for (int k = 0; k < CHAINS(sizeof(wheel)); k++) {
+        seg_t cs[MAX_SEGS];
+        ble_sensor_rd_t rd2 = chain_k(cs, wheel, sizeof(wheel), k);
+        CHECK(ble_cp_meas_parse(&rd2, &m));
+        CHECK(m.power_w == 150 && m.has_crank && m.crank_revs == 10 && m.crank_time == 1024);
+    }
+
+    // Truncated anywhere: rejected
+    for (size_t len = 0; len < sizeof(full); len++) {
+        for (int k = 0; k < CHAINS(len); k++) {
+            seg_t cs[MAX_SEGS];
+            ble_sensor_rd_t rd2 = chain_k(cs, full, len, k);
+            CHECK(!ble_cp_meas_parse(&rd2, &m));
+        }
+    }
+    // ...except that without the crank flag the optional fields are not needed
+    static const uint8_t no_crank[] = { 0x15, 0x00, 0x2C, 0x01 };
+    rd = chain(segs, no_crank, sizeof(no_crank), NULL, 0);
+    CHECK(ble_cp_meas_parse(&rd, &m) && m.power_w == 300 && !m.has_crank);
+}
+
+int main(void)
+{
+    test_hr();
+    test_cp();
+
+    if (s_failed) {
+        printf("test_ble_sensor_parse: %d check(s) failed\n", s_failed);
+        return 1;
+    }
+    printf("test_ble_sensor_parse: ok\n");
+    return 0;
+}
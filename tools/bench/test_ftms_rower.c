@@ -0,0 +1,228 @@
+/*
+ * FTMS Rower Data encoder (components/ble/ftms_rower.c): which fields each
+ * frame carries, and that a client decoding every frame onto its last
+ * values sees what the device had, at FTMS resolution.
+ *
+ *   test_ftms_rower            (exit status 0 = pass)
+ */
+
+#include <math.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "ftms_rower.h"
+
+static int s_failed;
+
+#define CHECK(cond)                                                         \
+    do {                                                                    \
+        if (!(cond)) {                                                      \
+            fprintf(stderr, "%s:%d: %s\n", __FILE__, __LINE__, #cond);      \
+            s_failed++;                                                     \
+        }                                                                   \
+    } while (0)
+
+#define F_ALL (FTMS_ROWER_F_DISTANCE | FTMS_ROWER_F_PACE | FTMS_ROWER_F_AVG_PACE | FTMS_ROWER_F_ELAPSED)
+
+static ftms_rower_values_t boat(void)
+{
+    return (ftms_rower_values_t){
+        .spm = 24.5f,
+        .stroke_count = 310,
+        .distance_m = 1523.0f,
+        .pace_500m_s = 118.6f,
+        .avg_pace_500m_s = 121.2f,
+        .power_w = 182.0f,
+        .elapsed_s = 612,
+    };
+}
+
+/* What a client holds after decoding frames of `v`: every field at FTMS resolution. */
+static bool same_on_air(const ftms_rower_values_t *got, const ftms_rower_values_t *v)
+{
+    return got->spm == roundf(v->spm * 2.0f) * 0.5f && got->stroke_count == v->stroke_count &&
+           got->distance_m == floorf(v->distance_m + 0.5f) && got->pace_500m_s == floorf(v->pace_500m_s + 0.5f) &&
+           got->avg_pace_500m_s == floorf(v->avg_pace_500m_s + 0.5f) && got->elapsed_s == v->elapsed_s &&
+           (isnan(v->power_w) || got->power_w == rintf(v->power_w));
+}
+
+/* The frame's flags as the client decodes them, or -2 when there is no frame. */
+static int encode(ftms_rower_enc_t *e, const ftms_rower_values_t *v, uint8_t *buf, ftms_rower_values_t *client)
+{
+    size_t len = ftms_rower_encode(e, v, buf);
+    CHECK(len <= FTMS_ROWER_MAX_LEN);
+    if (len == 0) return -2;
+    int flags = ftms_rower_decode(buf, len, client);
+    CHECK(flags >= 0);
+    return flags;
+}
+
+static void test_first_frame(void)
+{
+    ftms_rower_enc_t e;
+    ftms_rower_enc_reset(&e);
+    ftms_rower_values_t v = boat(), got = { .power_w = NAN };
+    uint8_t buf[FTMS_ROWER_MAX_LEN];
+
+    size_t len = ftms_rower_encode(&e, &v, buf);
+    CHECK(len == FTMS_ROWER_MAX_LEN);
+    int flags = ftms_rower_decode(buf, len, &got);
+    // More Data clear: stroke rate and count are present
+    CHECK(flags == (F_ALL | FTMS_ROWER_F_POWER));
+    CHECK(same_on_air(&got, &v));
+
+    // A new subscriber gets everything again
+    ftms_rower_enc_reset(&e);
+    CHECK(ftms_rower_encode(&e, &v, buf) == FTMS_ROWER_MAX_LEN);
+}
+
+static void test_changed_fields_only(void)
+{
+    ftms_rower_enc_t e;
+    ftms_rower_enc_reset(&e);
+    ftms_rower_values_t v = boat(), got = { .power_w = NAN };
+    uint8_t buf[FTMS_ROWER_MAX_LEN];
+    encode(&e, &v, buf, &got);
+
+    // Nothing changed, or not at the resolution FTMS carries: no notification
+    CHECK(ftms_rower_encode(&e, &v, buf) == 0);
+    v.distance_m += 0.3f;
+    v.spm += 0.2f;
+    v.power_w += 0.4f;
+    CHECK(ftms_rower_encode(&e, &v, buf) == 0);
+
+    v.distance_m += 1.0f;
+    CHECK(encode(&e, &v, buf, &got) == (FTMS_ROWER_F_MORE_DATA | FTMS_ROWER_F_DISTANCE));
+    CHECK(ftms_rower_encode(&e, &v, buf) == 0);
+
+    // A new stroke: rate and count, and nothing else
+    v.stroke_count++;
+    CHECK(encode(&e, &v, buf, &got) == 0);
+    CHECK(got.stroke_count == v.stroke_count);
+
+    v.pace_500m_s = 117.0f;
+    v.elapsed_s++;
+    CHECK(encode(&e, &v, buf, &got) == (FTMS_ROWER_F_MORE_DATA | FTMS_ROWER_F_PACE | FTMS_ROWER_F_ELAPSED));
+
+    v.avg_pace_500m_s = 120.0f;
+    v.power_w = 190.0f;
+    CHECK(encode(&e, &v, buf, &got) == (FTMS_ROWER_F_MORE_DATA | FTMS_ROWER_F_AVG_PACE | FTMS_ROWER_F_POWER));
+    CHECK(same_on_air(&got, &v));
+}
+
+static void test_power(void)
+{
+    ftms_rower_enc_t e;
+    ftms_rower_enc_reset(&e);
+    ftms_rower_values_t v = boat(), got = { .power_w = NAN };
+    uint8_t buf[FTMS_ROWER_MAX_LEN];
+
+    // No power source: the first frame leaves the field out
+    v.power_w = NAN;
+    CHECK(encode(&e, &v, buf, &got) == F_ALL);
+    CHECK(isnan(got.power_w));
+
+    // It appears, at 0 W too, which is also the encoder's initial value
+    v.power_w = 0.0f;
+    CHECK(encode(&e, &v, buf, &got) == (FTMS_ROWER_F_MORE_DATA | FTMS_ROWER_F_POWER));
+    CHECK(got.power_w == 0.0f);
+    CHECK(ftms_rower_encode(&e, &v, buf) == 0);
+
+    v.power_w = -3.0f;
+    CHECK(encode(&e, &v, buf, &got) == (FTMS_ROWER_F_MORE_DATA | FTMS_ROWER_F_POWER));
+    CHECK(got.power_w == -3.0f);
+
+    // It goes: no frame for that alone, and later frames leave it out
+    v.power_w = NAN;
+    CHECK(ftms_rower_encode(&e, &v, buf) == 0);
+    v.elapsed_s++;
+    CHECK(encode(&e, &v, buf, &got) == (FTMS_ROWER_F_MORE_DATA | FTMS_ROWER_F_ELAPSED));
+
+    // It comes back with a new value
+    v.power_w = 150.0f;
+    CHECK(encode(&e, &v, buf, &got) == (FTMS_ROWER_F_MORE_DATA | FTMS_ROWER_F_POWER));
+    CHECK(got.power_w == 150.0f);
+
+    // Clamped to s16
+    v.power_w = 40000.0f;
+    CHECK(encode(&e, &v, buf, &got) == (FTMS_ROWER_F_MORE_DATA | FTMS_ROWER_F_POWER));
+    CHECK(got.power_w == 32767.0f);
+}
+
+/* A session's worth of samples: the client's copy follows the device's. */
+static void test_round_trip(void)
+{
+    ftms_rower_enc_t e;
+    ftms_rower_enc_reset(&e);
+    ftms_rower_values_t v = boat(), got = { .power_w = NAN };
+    uint8_t buf[FTMS_ROWER_MAX_LEN];
+    unsigned frames = 0, bytes = 0;
+
+    srand(1);
+    for (int i = 0; i < 20000; i++) {
+        const float speed = 3.5f + (float)(rand() % 200) * 0.005f;
+        v.distance_m += speed * 0.1f;
+        v.pace_500m_s = 500.0f / speed;
+        v.avg_pace_500m_s = 500.0f / (v.distance_m / (float)(i / 10 + 600));
+        v.elapsed_s = 612 + (uint32_t)(i / 10);
+        if (i % 25 == 0) {
+            v.stroke_count++;
+            v.spm = 18.0f + (float)(rand() % 30) * 0.5f;
+        }
+        // Power sensor drops out for a while
+        v.power_w = (i / 1000) % 4 == 3 ? NAN : 120.0f + (float)(rand() % 1200) * 0.1f;
+
+        size_t len = ftms_rower_encode(&e, &v, buf);
+        CHECK(len <= FTMS_ROWER_MAX_LEN);
+        if (len) {
+            CHECK(ftms_rower_decode(buf, len, &got) >= 0);
+            frames++;
+            bytes += (unsigned)len;
+        }
+        if (!same_on_air(&got, &v)) {
+            fprintf(stderr, "sample %d: client out of step\n", i);
+            s_failed++;
+            break;
+        }
+    }
+    printf("round trip: 20000 samples, %u frames, %.1f bytes/frame\n", frames, frames ? (double)bytes / frames : 0.0);
+}
+
+static void test_decode_rejects(void)
+{
+    ftms_rower_enc_t e;
+    ftms_rower_enc_reset(&e);
+    ftms_rower_values_t v = boat(), got = boat();
+    uint8_t buf[FTMS_ROWER_MAX_LEN];
+    size_t len = ftms_rower_encode(&e, &v, buf);
+
+    for (size_t n = 0; n < len; n++) CHECK(ftms_rower_decode(buf, n, &got) == -1);
+
+    // Flags past the known fields
+    uint8_t bad[FTMS_ROWER_MAX_LEN] = { 0x01, 0x20 };
+    CHECK(ftms_rower_decode(bad, sizeof(bad), &got) == -1);
+
+    // Fields this encoder never sends are stepped over: heart rate between power and elapsed time
+    uint8_t other[] = { 0x21, 0x0A, 0x96, 0x00, 0x8C, 0x64, 0x00 };
+    got = boat();
+    CHECK(ftms_rower_decode(other, sizeof(other), &got) == 0x0A21);
+    CHECK(got.power_w == 150.0f && got.elapsed_s == 100);
+}
+
+int main(void)
+{
+    test_first_frame();
+    test_changed_fields_only();
+    test_power();
+    test_round_trip();
+    test_decode_rejects();
+
+    if (s_failed) {
+        printf("test_ftms_rower: %d check(s) failed\n", s_failed);
+        return 1;
+    }
+    printf("test_ftms_rower: ok\n");
+    return 0;
+}
@@ -0,0 +1,283 @@
+/*
+ * Raw capture block codec (components/activity_log/activity_raw_codec.c):
+ * blocks filled the way activity_raw.c fills them decode to the records
+ * that went in, for a constant signal, full-scale steps, and residuals
+ * that escape to raw 32-bit codes; truncated payloads decode to a prefix
+ * of them and then stop, and a full payload never runs past its capacity.
+ *
+ *   test_raw_codec             (exit status 0 = pass)
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "activity_raw_codec.h"
+#include "activity_raw_format.h"
+
+static int s_failed;
+
+#define CHECK(cond)                                                         \
+    do {                                                                    \
+        if (!(cond)) {                                                      \
+            fprintf(stderr, "%s:%d: %s\n", __FILE__, __LINE__, #cond);      \
+            s_failed++;                                                     \
+        }                                                                   \
+    } while (0)
+
+#define PAYLOAD_CAP (ACTIVITY_RAW_BLOCK_SIZE - sizeof(activity_raw_block_hdr_t))
+#define MAX_RECS    4096
+#define OTHER_LEN   28                  // a GPS record
+
+typedef struct {
+    bool     imu;
+    uint32_t toff;
+    int16_t  v[6];
+} rec_t;
+
+/* Record i of a case; returns false once the case has no more. */
+typedef bool (*gen_fn)(int i, rec_t *r);
+
+typedef struct {
+    rec_t   recs[MAX_RECS];
+    int     n;                          // records the encoder took
+    uint8_t payload[PAYLOAD_CAP];
+    size_t  len;
+    bool    full;                       // stopped because the block was full
+} block_t;
+
+/* The bytes an "other" record carries: its tag word, then a pattern. */
+static void other_bytes(const rec_t *r, uint8_t *out)
+{
+    uint32_t word = ACTIVITY_RAW_TAG_WORD(ACTIVITY_RAW_TAG_GPS, r->toff);
+    memcpy(out, &word, sizeof(word));
+    for (int i = 4; i < OTHER_LEN; i++) out[i] = (uint8_t)(r->toff * 7u + (uint32_t)i);
+}
+
+static void fill(block_t *b, gen_fn gen)
+{
+    raw_encoder_t e;
+    raw_encoder_init(&e, b->payload, sizeof(b->payload));
+    b->n = 0;
+    b->full = false;
+
+    rec_t r;
+    while (b->n < MAX_RECS && gen(b->n, &r)) {
+        const size_t pos = e.pos;
+        const int nacc = e.nacc;
+        bool ok;
+        if (r.imu) {
+            ok = raw_encoder_put_imu(&e, r.toff, r.v);
+        } else {
+            uint8_t buf[OTHER_LEN];
+            other_bytes(&r, buf);
+            ok = raw_encoder_put_other(&e, buf, sizeof(buf));
+        }
+        if (!ok) {
+            // Refused records leave the payload as it was
+            CHECK(e.pos == pos && e.nacc == nacc);
+            b->full = true;
+            break;
+        }
+        b->recs[b->n++] = r;
+    }
+    b->len = raw_encoder_finish(&e);
+    CHECK(b->len <= sizeof(b->payload));
+}
+
+/* Decode len bytes of b's payload; returns how many records matched, in order, before the end. */
+static int decode(const block_t *b, size_t len, int *last)
+{
+    raw_decoder_t d;
+    raw_decoder_init(&d, b->payload, len);
+    int i = 0;
+    for (;;) {
+        uint8_t out[64];
+        int n = raw_decoder_next(&d, out, sizeof(out));
+        *last = n;
+        if (n <= 0) return i;
+        if (i >= b->n) return -1;
+
+        const rec_t *r = &b->recs[i];
+        if (r->imu) {
+            activity_raw_imu_rec_t got, want = {
+                .tag_toff = ACTIVITY_RAW_TAG_WORD(ACTIVITY_RAW_TAG_IMU, r->toff),
+                .ax = r->v[0], .ay = r->v[1], .az = r->v[2],
+                .gx = r->v[3], .gy = r->v[4], .gz = r->v[5],
+            };
+            if (n != (int)sizeof(got)) return -1;
+            memcpy(&got, out, sizeof(got));
+            if (memcmp(&got, &want, sizeof(got)) != 0) return -1;
+        } else {
+            uint8_t want[OTHER_LEN];
+            other_bytes(r, want);
+            if (n != OTHER_LEN || memcmp(out, want, OTHER_LEN) != 0) return -1;
+        }
+        i++;
+    }
+}
+
+/* Encode a case, decode it whole and cut short. Returns payload bytes. */
+static size_t round_trip(const char *name, gen_fn gen, block_t *b)
+{
+    fill(b, gen);
+
+    int last;
+    const int got = decode(b, b->len, &last);
+    if (got != b->n || last != 0) {
+        fprintf(stderr, "%s: decoded %d of %d records (last %d)\n", name, got, b->n, last);
+        s_failed++;
+    }
+
+    // A cut payload gives the records that fit whole, then an end or an error.
+    // Every cut through the keyframe and the first records, then a spread.
+    int bad_cuts = 0;
+    for (size_t len = 0; len < b->len; len += (len < 256) ? 1 : 97) {
+        const int k = decode(b, len, &last);
+        if (k < 0 || k > b->n || last > 0) bad_cuts++;
+    }
+    if (bad_cuts) {
+        fprintf(stderr, "%s: %d truncations decoded something that was not written\n", name, bad_cuts);
+        s_failed++;
+    }
+
+    int imu = 0;
+    for (int i = 0; i < b->n; i++) imu += b->recs[i].imu;
+    printf("%-12s %5d records (%4d IMU)  %6zu bytes  %5.2f bytes/IMU record%s\n", name, b->n, imu, b->len,
+           imu ? (double)b->len / imu : 0.0, b->full ? "  block full" : "");
+    return b->len;
+}
+
+/* ---- cases ---- */
+
+static uint64_t s_rng;
+
+static uint32_t rnd(void)
+{
+    s_rng ^= s_rng << 13;
+    s_rng ^= s_rng >> 7;
+    s_rng ^= s_rng << 17;
+    return (uint32_t)(s_rng >> 32);
+}
+
+/* Sensor at rest: every axis and the 200 Hz interval constant. */
+static bool gen_constant(int i, rec_t *r)
+{
+    static const int16_t rest[6] = { 12, -40, 2048, -3, 5, 1 };
+    *r = (rec_t){ .imu = true, .toff = 1000u + (uint32_t)i * 5000u };
+    memcpy(r->v, rest, sizeof(rest));
+    return i < 2000;
+}
+
+/* Rails: every axis swings between the int16 extremes, as a steady run
+ * and as a square wave, with the time offset stepping to its maximum. */
+static bool gen_step(int i, rec_t *r)
+{
+    *r = (rec_t){ .imu = true };
+    r->toff = (i < 500) ? (uint32_t)i * 5000u : ACTIVITY_RAW_TOFF_MAX - (uint32_t)(999 - i) * 5000u;
+    for (int a = 0; a < 6; a++) {
+        bool high;
+        if (i < 200) high = (a & 1);                    // constant at the rails
+        else if (i < 600) high = ((i / 50) + a) & 1;    // steps every 50 samples
+        else high = (i + a) & 1;                        // full-scale step every sample
+        r->v[a] = high ? INT16_MAX : INT16_MIN;
+    }
+    return i < 1000;
+}
+
+/* Quiet signal with a GPS record now and then and, with s_spikes, a
+ * full-scale spike on every axis every 17 samples. The adapted Rice
+ * parameter stays small, so a spike's residuals escape to raw codes. */
+static bool s_spikes;
+
+#define ESCAPE_RECS     1200
+#define IS_SPIKE(i)     ((i) % 17 == 0)
+
+static bool gen_escape(int i, rec_t *r)
+{
+    *r = (rec_t){ .imu = (i % 40) != 39, .toff = (uint32_t)i * 5000u + (rnd() & 63) };
+    if (!r->imu) return i < ESCAPE_RECS;
+    for (int a = 0; a < 6; a++) {
+        r->v[a] = (int16_t)((int)(rnd() & 7) - 4);
+        if (s_spikes && IS_SPIKE(i)) r->v[a] = (a & 1) ? INT16_MAX : INT16_MIN;
+    }
+    return i < ESCAPE_RECS;
+}
+
+/* Uniform full-scale noise: nothing to predict, the block fills at its worst-case margin. */
+static bool gen_noise(int i, rec_t *r)
+{
+    *r = (rec_t){ .imu = true, .toff = (uint32_t)i * 5000u + (rnd() & 0xFFFF) };
+    for (int a = 0; a < 6; a++) r->v[a] = (int16_t)rnd();
+    return true;
+}
+
+/* Small payloads fed spikes until they refuse: nothing is written past the
+ * capacity, whatever record the end lands on. */
+static void test_capacity(void)
+{
+    int overruns = 0;
+    for (size_t cap = 1; cap <= 600; cap++) {
+        static uint8_t buf[600 + 64];
+        memset(buf, 0xA5, sizeof(buf));
+        raw_encoder_t e;
+        raw_encoder_init(&e, buf, cap);
+
+        s_spikes = true;
+        s_rng = 0x9E3779B97F4A7C15ull + cap;
+        rec_t r;
+        for (int i = 0; gen_escape(i, &r); i++) {
+            if (!r.imu) continue;
+            if (!raw_encoder_put_imu(&e, r.toff, r.v)) break;
+        }
+        const size_t len = raw_encoder_finish(&e);
+        bool intact = len <= cap;
+        for (size_t i = cap; i < sizeof(buf); i++) intact &= buf[i] == 0xA5;
+        if (!intact) overruns++;
+    }
+    CHECK(overruns == 0);
+}
+
+int main(void)
+{
+    static block_t b;
+
+    // A byte per sample once the Rice parameters have come down: the flag
+    // and a single 0 bit per channel
+    size_t len = round_trip("constant", gen_constant, &b);
+    CHECK(b.n == 2000 && !b.full);
+    CHECK(len < (size_t)b.n * 5 / 4);
+
+    round_trip("step", gen_step, &b);
+    CHECK(b.n == 1000 && !b.full);
+
+    // Every spiked axis costs at least an escape (24-bit run + 32 raw bits)
+    s_rng = 0x9E3779B97F4A7C15ull;
+    const size_t quiet = round_trip("quiet", gen_escape, &b);
+    s_spikes = true;
+    s_rng = 0x9E3779B97F4A7C15ull;
+    len = round_trip("escape", gen_escape, &b);
+    CHECK(b.n == ESCAPE_RECS && !b.full);
+    int spikes = 0;
+    for (int i = 0; i < b.n; i++) spikes += b.recs[i].imu && IS_SPIKE(i);
+    CHECK((len - quiet) * 8 >= (size_t)spikes * 6 * (24 + 32));
+
+    // Nothing to predict: about the raw size, and the block refuses a
+    // record only when less than one worst case (50 bytes) is left
+    s_rng = 0x2545F4914F6CDD1Dull;
+    len = round_trip("noise", gen_noise, &b);
+    CHECK(b.full);
+    CHECK(len > (size_t)b.n * 12);
+    CHECK(sizeof(b.payload) - len <= 51);
+
+    test_capacity();
+
+    if (s_failed) {
+        printf("test_raw_codec: %d check(s) failed\n", s_failed);
+        return 1;
+    }
+    printf("test_raw_codec: ok\n");
+    return 0;
+}
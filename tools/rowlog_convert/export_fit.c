@@ -0,0 +1,56 @@
+// tools/rowlog_convert/export_fit.c
+#include "rowlog_convert.h"
+
+#include <stdlib.h>
+
+#include "fit_writer.h"
+
+/* Replays the session through the device's FIT writer, laps where the device cut them. */
+int write_fit(const session_t *s, const char *path)
+{
+    FILE *f = open_output(path);
+    if (!f)
+        return -1;
+
+    fit_writer_t *w = malloc(sizeof(*w));
+    if (!w) {
+        fclose(f);
+        return -1;
+    }
+
+    fit_writer_config_t cfg = {
+        .serial = s->hdr.session_id,
+        .start_utc_us = s->hdr.start_utc_us,
+        .utc_offset_s = s->hdr.utc_offset_s,
+        .sub_sport = FIT_SUB_SPORT_GENERIC,
+    };
+    fit_writer_begin(w, f, &cfg);
+
+    const fit_lap_trigger_t trigger =
+        (s->hdr.split_mode == ALOG_SPLIT_TIME) ? FIT_LAP_TRIGGER_TIME : FIT_LAP_TRIGGER_DISTANCE;
+    size_t lap = 0;
+    for (size_t i = 0; i < s->n_rows; i++) {
+        const activity_log_row_t *r = &s->rows[i];
+
+        // Laps closed before this catch, as the device wrote them
+        for (; lap < s->n_laps && s->laps[lap].closed && s->laps[lap].end == i; lap++)
+            fit_writer_lap(w, trigger);
+
+        fit_record_t rec = {
+            .utc_us = r->utc_us,
+            .distance_m = r->total_distance_m,
+            .speed_mps = (r->pace_500m_s > 0) ? 500.0f / r->pace_500m_s : 0,
+            .power_w = r->power_w,
+            .spm = r->spm_instant,
+            .has_fix = r->gps_lat != 0.0 || r->gps_lon != 0.0,
+            .lat_deg = r->gps_lat,
+            .lon_deg = r->gps_lon,
+        };
+        fit_writer_record(w, &rec);
+    }
+
+    bool ok = fit_writer_finish(w);
+    free(w);
+    int err = close_output(f, path);
+    return ok ? err : -1;
+}
@@ -0,0 +1,142 @@
+// tools/rowlog_convert/export_raw.c
+#include "rowlog_convert.h"
+
+#include <stddef.h>
+#include <string.h>
+
+#include "activity_raw_codec.h"
+#include "activity_raw_format.h"
+
+#define RAW_CSV_HEADER \
+    "Type,Mono (us),UTC (us),ax (m/s2),ay (m/s2),az (m/s2),gx (rad/s),gy (rad/s),gz (rad/s)," \
+    "Lat,Lon,Speed (m/s),Course (deg),HDOP,Sats,Fix,GNSS UTC (ms)\n"
+
+typedef struct {
+    FILE *f;
+    const activity_raw_block_hdr_t *h;
+    raw_export_stats_t *st;
+} raw_out_t;
+
+static bool block_valid(const uint8_t *blk, const activity_raw_block_hdr_t *h, uint32_t seq)
+{
+    if (h->magic != ACTIVITY_RAW_BLOCK_MAGIC || h->version != ACTIVITY_RAW_VERSION || h->seq != seq)
+        return false;
+    if (h->payload_len > ACTIVITY_RAW_BLOCK_SIZE - sizeof(*h))
+        return false;
+
+    uint32_t crc = alog_crc32(0, blk + sizeof(*h), h->payload_len);
+    return alog_crc32(crc, h, offsetof(activity_raw_block_hdr_t, crc)) == h->crc;
+}
+
+static void emit(raw_out_t *o, const uint8_t *rec, size_t len)
+{
+    uint32_t w;
+    memcpy(&w, rec, sizeof(w));
+    int64_t toff = ACTIVITY_RAW_WORD_TOFF(w);
+    int64_t mono = o->h->base_mono_us + toff;
+    long long utc = o->h->base_utc_us ? (long long)(o->h->base_utc_us + toff) : 0;
+
+    switch (ACTIVITY_RAW_WORD_TAG(w)) {
+    case ACTIVITY_RAW_TAG_IMU: {
+        if (len < sizeof(activity_raw_imu_rec_t)) return;
+        activity_raw_imu_rec_t r;
+        memcpy(&r, rec, sizeof(r));
+        double a = o->h->accel_scale, g = o->h->gyro_scale;
+        fprintf(o->f, "IMU,%lld,%lld,%.4f,%.4f,%.4f,%.5f,%.5f,%.5f,,,,,,,,\n", (long long)mono, utc,
+                r.ax * a, r.ay * a, r.az * a, r.gx * g, r.gy * g, r.gz * g);
+        o->st->imu++;
+        break;
+    }
+    case ACTIVITY_RAW_TAG_GPS: {
+        if (len < sizeof(activity_raw_gps_rec_t)) return;
+        activity_raw_gps_rec_t r;
+        memcpy(&r, rec, sizeof(r));
+        fprintf(o->f, "GPS,%lld,%lld,,,,,,,", (long long)mono, utc);
+        if (r.flags & ACTIVITY_RAW_GPS_FIX)
+            fprintf(o->f, "%.7f,%.7f,", r.lat_e7 * 1e-7, r.lon_e7 * 1e-7);
+        else
+            fputs(",,", o->f);
+        if (r.speed_cmps != 0xFFFF) fprintf(o->f, "%.2f", r.speed_cmps * 0.01);
+        fputc(',', o->f);
+        if (r.course_cdeg != 0xFFFF) fprintf(o->f, "%.2f", r.course_cdeg * 0.01);
+        fputc(',', o->f);
+        if (r.hdop_x10 != 0xFFFF) fprintf(o->f, "%.1f", r.hdop_x10 * 0.1);
+        fprintf(o->f, ",%d,%d,", r.sats, r.fix_quality);
+        if (r.flags & ACTIVITY_RAW_GPS_TIME)
+            fprintf(o->f, "%llu", (unsigned long long)r.utc_s * 1000ULL + r.utc_ms);
+        fputc('\n', o->f);
+        o->st->gps++;
+        break;
+    }
+    default:
+        break;
+    }
+}
+
+/* Returns false if the payload turned out to be damaged. */
+static bool emit_block(raw_out_t *o, const uint8_t *payload, size_t len)
+{
+    if (o->h->encoding == ACTIVITY_RAW_ENC_RICE) {
+        raw_decoder_t d;
+        raw_decoder_init(&d, payload, len);
+        uint8_t rec[256];
+        int n;
+        while ((n = raw_decoder_next(&d, rec, sizeof(rec))) > 0)
+            emit(o, rec, (size_t)n);
+        return n == 0;
+    }
+    if (o->h->encoding != ACTIVITY_RAW_ENC_NONE)
+        return false;
+
+    size_t pos = 0;
+    while (pos + 4 <= len) {
+        uint32_t w;
+        memcpy(&w, payload + pos, sizeof(w));
+        size_t rec_len;
+        switch (ACTIVITY_RAW_WORD_TAG(w)) {
+        case ACTIVITY_RAW_TAG_IMU: rec_len = sizeof(activity_raw_imu_rec_t); break;
+        case ACTIVITY_RAW_TAG_GPS: rec_len = sizeof(activity_raw_gps_rec_t); break;
+        case ACTIVITY_RAW_TAG_END: return true;
+        default:                   return false;
+        }
+        if (pos + rec_len > len)
+            return false;
+        emit(o, payload + pos, rec_len);
+        pos += rec_len;
+    }
+    return true;
+}
+
+int write_raw_csv(const mapped_file_t *m, const char *path, raw_export_stats_t *st)
+{
+    memset(st, 0, sizeof(*st));
+
+    FILE *f = open_output(path);
+    if (!f)
+        return -1;
+    fputs(RAW_CSV_HEADER, f);
+
+    size_t n_blocks = m->len / ACTIVITY_RAW_BLOCK_SIZE;
+    for (uint32_t seq = 0; seq < n_blocks; seq++) {
+        const uint8_t *blk = m->data + (size_t)seq * ACTIVITY_RAW_BLOCK_SIZE;
+        activity_raw_block_hdr_t h;
+        memcpy(&h, blk, sizeof(h));
+
+        // Past the end of the data, the preallocated tail of an unclean stop
+        if (h.magic == 0)
+            break;
+
+        if (!block_valid(blk, &h, seq)) {
+            st->bad_blocks++;
+            continue;
+        }
+
+        raw_out_t o = { .f = f, .h = &h, .st = st };
+        if (!emit_block(&o, blk + sizeof(h), h.payload_len))
+            st->bad_blocks++;
+        st->blocks++;
+        st->dropped_blocks = h.dropped_blocks;
+    }
+
+    return close_output(f, path);
+}
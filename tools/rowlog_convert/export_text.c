@@ -0,0 +1,146 @@
+// tools/rowlog_convert/export_text.c
+#include "rowlog_convert.h"
+
+#include "activity_log_csv.h"
+
+static bool has_fix(const activity_log_row_t *r)
+{
+    return r->gps_lat != 0.0 || r->gps_lon != 0.0;
+}
+
+/* -------------------------------------------------------------------------- */
+/* CSV (byte-for-byte what the device writes)                                 */
+/* -------------------------------------------------------------------------- */
+
+int write_strokes_csv(const session_t *s, const char *path)
+{
+    FILE *f = open_output(path);
+    if (!f)
+        return -1;
+
+    fputs(ALOG_CSV_STROKE_HEADER, f);
+    for (size_t i = 0; i < s->n_rows; i++)
+        alog_csv_write_stroke(f, &s->rows[i], s->hdr.utc_offset_s);
+
+    return close_output(f, path);
+}
+
+int write_splits_csv(const session_t *s, const char *path)
+{
+    FILE *f = open_output(path);
+    if (!f)
+        return -1;
+
+    alog_csv_write_splits_preamble(f, s->hdr.start_utc_us / 1000000, s->hdr.utc_offset_s,
+                                   (alog_split_mode_t)s->hdr.split_mode, (float)s->hdr.split_interval,
+                                   s->hdr.session_id);
+    for (size_t i = 0; i < s->n_laps; i++) {
+        if (s->laps[i].closed)
+            alog_csv_write_split(f, &s->laps[i].split);
+    }
+
+    return close_output(f, path);
+}
+
+/* -------------------------------------------------------------------------- */
+/* GPX 1.1                                                                    */
+/* -------------------------------------------------------------------------- */
+
+int write_gpx(const session_t *s, const char *path)
+{
+    FILE *f = open_output(path);
+    if (!f)
+        return -1;
+
+    char t[40];
+    format_iso8601(s->hdr.start_utc_us, false, t, sizeof(t));
+
+    fprintf(f, "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
+               "<gpx version=\"1.1\" creator=\"RowCoach\" xmlns=\"http://www.topografix.com/GPX/1/1\">\n"
+               " <metadata><time>%s</time></metadata>\n"
+               " <trk>\n"
+               "  <name>Session %lu</name>\n"
+               "  <type>rowing</type>\n"
+               "  <trkseg>\n",
+            t, (unsigned long)s->hdr.session_id);
+
+    for (size_t i = 0; i < s->n_rows; i++) {
+        const activity_log_row_t *r = &s->rows[i];
+        if (!has_fix(r))
+            continue;
+        format_iso8601(r->utc_us, true, t, sizeof(t));
+        fprintf(f, "   <trkpt lat=\"%.7f\" lon=\"%.7f\"><time>%s</time></trkpt>\n", r->gps_lat, r->gps_lon, t);
+    }
+
+    fputs("  </trkseg>\n </trk>\n</gpx>\n", f);
+    return close_output(f, path);
+}
+
+/* -------------------------------------------------------------------------- */
+/* TCX (Garmin Training Center v2)                                            */
+/* -------------------------------------------------------------------------- */
+
+int write_tcx(const session_t *s, const char *path)
+{
+    FILE *f = open_output(path);
+    if (!f)
+        return -1;
+
+    char t[40];
+    format_iso8601(s->hdr.start_utc_us, false, t, sizeof(t));
+
+    fprintf(f, "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
+               "<TrainingCenterDatabase xmlns=\"http://www.garmin.com/xmlschemas/TrainingCenterDatabase/v2\""
+               " xmlns:ns3=\"http://www.garmin.com/xmlschemas/ActivityExtension/v2\">\n"
+               " <Activities>\n"
+               "  <Activity Sport=\"Other\">\n"
+               "   <Id>%s</Id>\n",
+            t);
+
+    const bool time_splits = s->hdr.split_mode == ALOG_SPLIT_TIME;
+    for (size_t l = 0; l < s->n_laps; l++) {
+        const session_lap_t *lap = &s->laps[l];
+        format_iso8601(lap->start_utc_us, false, t, sizeof(t));
+        fprintf(f, "   <Lap StartTime=\"%s\">\n"
+                   "    <TotalTimeSeconds>%.1f</TotalTimeSeconds>\n"
+                   "    <DistanceMeters>%.1f</DistanceMeters>\n"
+                   "    <MaximumSpeed>%.2f</MaximumSpeed>\n"
+                   "    <Calories>0</Calories>\n"
+                   "    <Intensity>Active</Intensity>\n"
+                   "    <Cadence>%d</Cadence>\n"
+                   "    <TriggerMethod>%s</TriggerMethod>\n",
+                t, (double)lap->time_s, (double)lap->dist_m, (double)lap->max_speed_mps,
+                (int)(lap->avg_spm + 0.5f), !lap->closed ? "Manual" : time_splits ? "Time" : "Distance");
+
+        // A Track needs a Trackpoint; a split with no catch in it has none
+        if (lap->end > lap->first)
+            fputs("    <Track>\n", f);
+
+        for (size_t i = lap->first; i < lap->end; i++) {
+            const activity_log_row_t *r = &s->rows[i];
+            float speed = (r->pace_500m_s > 0) ? 500.0f / r->pace_500m_s : 0;
+
+            format_iso8601(r->utc_us, true, t, sizeof(t));
+            fprintf(f, "     <Trackpoint>\n      <Time>%s</Time>\n", t);
+            if (has_fix(r))
+                fprintf(f, "      <Position><LatitudeDegrees>%.7f</LatitudeDegrees>"
+                           "<LongitudeDegrees>%.7f</LongitudeDegrees></Position>\n",
+                        r->gps_lat, r->gps_lon);
+            fprintf(f, "      <DistanceMeters>%.1f</DistanceMeters>\n"
+                       "      <Cadence>%d</Cadence>\n"
+                       "      <Extensions><ns3:TPX><ns3:Speed>%.2f</ns3:Speed><ns3:Watts>%d</ns3:Watts></ns3:TPX></Extensions>\n"
+                       "     </Trackpoint>\n",
+                    (double)r->total_distance_m, (int)(r->spm_instant + 0.5f), (double)speed,
+                    (int)(r->power_w + 0.5f));
+        }
+        if (lap->end > lap->first)
+            fputs("    </Track>\n", f);
+        fputs("   </Lap>\n", f);
+    }
+
+    fputs("   <Creator xsi:type=\"Device_t\" xmlns:xsi=\"http://www.w3.org/2001/XMLSchema-instance\">"
+          "<Name>RowCoach</Name><UnitId>0</UnitId><ProductID>0</ProductID>"
+          "<Version><VersionMajor>1</VersionMajor><VersionMinor>0</VersionMinor></Version></Creator>\n"
+          "  </Activity>\n </Activities>\n</TrainingCenterDatabase>\n", f);
+    return close_output(f, path);
+}
@@ -0,0 +1,477 @@
+// tools/rowlog_convert/rowlog_convert.c
+/*
+ * Bulk converter for RowCoach session logs.
+ *
+ *   rowlog_convert [-j jobs] [-o outdir] [-t csv,gpx,tcx,fit,raw,best] [-q] <file|dir>...
+ *
+ * Inputs are "<base>_Strokes.bin" and "<base>_Raw.bin" files, or directories
+ * searched recursively for them (e.g. a copy of the card's activities/).
+ * Each file is memory-mapped and converted by a pool of worker threads, one
+ * file per job, largest first.
+ *
+ *   <base>_Strokes.bin -> <base>_Strokes.csv, <base>_Splits.csv, .gpx, .tcx, .fit
+ *   <base>_Raw.bin     -> <base>_Raw.csv
+ *   (all sessions)     -> best_efforts.csv, only when -t lists best
+ *
+ * -t replaces the default outputs (all but best): -t csv,gpx,tcx,fit,raw,best
+ * for everything, -t best for the summary alone.
+ *
+ * The CSV layouts are the device's own (shared activity_log_csv.c). A splits
+ * file the device wrote next to the input is kept (copied when -o points
+ * elsewhere) since it may carry a recovery summary; otherwise it is rebuilt.
+ *
+ * best_efforts.csv (in the output directory, else the current one) lists
+ * each session's fastest 500 m / 1 km / 2 km and longest minute, then the
+ * best of each over the whole archive. Every log is read once, in one
+ * linear pass, like the rest of the conversion.
+ */
+#include "rowlog_convert.h"
+
+#include <dirent.h>
+#include <errno.h>
+#include <limits.h>
+#include <pthread.h>
+#include <stdarg.h>
+#include <stdatomic.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "activity_log_bin.h"
+#include "activity_raw_format.h"
+#include "fastfmt.h"
+
+#define SUFFIX_STROKES_BIN  "_Strokes.bin"
+#define SUFFIX_STROKES_CSV  "_Strokes.csv"
+#define SUFFIX_SPLITS_CSV   "_Splits.csv"
+#define SUFFIX_RAW_CSV      "_Raw.csv"
+#define BEST_EFFORTS_CSV    "best_efforts.csv"
+
+enum {
+    OUT_CSV = 1 << 0,
+    OUT_GPX = 1 << 1,
+    OUT_TCX = 1 << 2,
+    OUT_FIT = 1 << 3,
+    OUT_RAW = 1 << 4,
+    OUT_BEST = 1 << 5,
+};
+
+typedef enum { JOB_STROKES, JOB_RAW } job_kind_t;
+
+typedef struct {
+    char *path;
+    job_kind_t kind;
+    off_t size;
+
+    // Strokes jobs, for best_efforts.csv
+    bool    summarised;
+    int64_t start_utc_us;
+    float   distance_m;
+    float   best_effort[BEST_EFFORT_COUNT];
+} job_t;
+
+static struct {
+    job_t *jobs;
+    size_t n_jobs, cap_jobs;
+    atomic_size_t next;
+
+    const char *out_dir;
+    unsigned outputs;
+    bool quiet;
+
+    pthread_mutex_t print_lock;
+    atomic_uint failed;
+    atomic_ullong rows;
+    atomic_ullong raw_records;
+} s_ctx = {
+    .outputs = OUT_CSV | OUT_GPX | OUT_TCX | OUT_FIT | OUT_RAW,
+    .print_lock = PTHREAD_MUTEX_INITIALIZER,
+};
+
+/* -------------------------------------------------------------------------- */
+/* Inputs                                                                     */
+/* -------------------------------------------------------------------------- */
+
+static bool has_suffix(const char *s, const char *suffix)
+{
+    size_t n = strlen(s), m = strlen(suffix);
+    return n >= m && strcmp(s + n - m, suffix) == 0;
+}
+
+static void add_job(const char *path, job_kind_t kind, off_t size)
+{
+    if (s_ctx.n_jobs == s_ctx.cap_jobs) {
+        s_ctx.cap_jobs = s_ctx.cap_jobs ? s_ctx.cap_jobs * 2 : 256;
+        s_ctx.jobs = realloc(s_ctx.jobs, s_ctx.cap_jobs * sizeof(*s_ctx.jobs));
+        if (!s_ctx.jobs) {
+            perror("rowlog_convert");
+            exit(1);
+        }
+    }
+    s_ctx.jobs[s_ctx.n_jobs++] = (job_t){ .path = strdup(path), .kind = kind, .size = size };
+}
+
+static void scan(const char *path, bool explicit)
+{
+    struct stat st;
+    if (stat(path, &st) != 0) {
+        fprintf(stderr, "rowlog_convert: %s: %s\n", path, strerror(errno));
+        s_ctx.failed++;
+        return;
+    }
+
+    if (S_ISDIR(st.st_mode)) {
+        DIR *d = opendir(path);
+        if (!d)
+            return;
+        struct dirent *e;
+        while ((e = readdir(d)) != NULL) {
+            if (e->d_name[0] == '.')
+                continue;
+            char child[PATH_MAX];
+            snprintf(child, sizeof(child), "%s/%s", path, e->d_name);
+            scan(child, false);
+        }
+        closedir(d);
+        return;
+    }
+
+    if (has_suffix(path, SUFFIX_STROKES_BIN))
+        add_job(path, JOB_STROKES, st.st_size);
+    else if (has_suffix(path, ACTIVITY_RAW_FILE_SUFFIX))
+        add_job(path, JOB_RAW, st.st_size);
+    else if (explicit)
+        fprintf(stderr, "rowlog_convert: %s: not a session log, skipped\n", path);
+}
+
+static int by_size_desc(const void *a, const void *b)
+{
+    off_t sa = ((const job_t *)a)->size, sb = ((const job_t *)b)->size;
+    return (sa < sb) - (sa > sb);
+}
+
+/* "<dir>/<base>" for an input path ending in `suffix`. */
+static void output_base(const char *in, const char *suffix, char *out, size_t len)
+{
+    size_t n = strlen(in) - strlen(suffix);
+    if (!s_ctx.out_dir) {
+        snprintf(out, len, "%.*s", (int)n, in);
+        return;
+    }
+    const char *slash = strrchr(in, '/');
+    size_t start = slash ? (size_t)(slash - in + 1) : 0;
+    snprintf(out, len, "%s/%.*s", s_ctx.out_dir, (int)(n - start), in + start);
+}
+
+static int copy_file(const char *from, const char *to)
+{
+    mapped_file_t m;
+    if (map_file(from, &m) != 0)
+        return -1;
+    FILE *f = open_output(to);
+    if (!f) {
+        unmap_file(&m);
+        return -1;
+    }
+    if (m.len)
+        fwrite(m.data, 1, m.len, f);
+    unmap_file(&m);
+    return close_output(f, to);
+}
+
+/* -------------------------------------------------------------------------- */
+/* Jobs                                                                       */
+/* -------------------------------------------------------------------------- */
+
+static void report(const char *fmt, ...) __attribute__((format(printf, 1, 2)));
+
+static void report(const char *fmt, ...)
+{
+    if (s_ctx.quiet)
+        return;
+    va_list ap;
+    va_start(ap, fmt);
+    pthread_mutex_lock(&s_ctx.print_lock);
+    vfprintf(stderr, fmt, ap);
+    pthread_mutex_unlock(&s_ctx.print_lock);
+    va_end(ap);
+}
+
+static int convert_strokes(job_t *job, const mapped_file_t *m)
+{
+    session_t s;
+    if (session_load(m, &s) != 0) {
+        session_free(&s);
+        fprintf(stderr, "rowlog_convert: %s: no valid header\n", job->path);
+        return -1;
+    }
+
+    char base[PATH_MAX], path[PATH_MAX + 16];
+    output_base(job->path, SUFFIX_STROKES_BIN, base, sizeof(base));
+    int err = 0;
+
+    if (s_ctx.outputs & OUT_CSV) {
+        snprintf(path, sizeof(path), "%s" SUFFIX_STROKES_CSV, base);
+        err |= write_strokes_csv(&s, path);
+
+        char device_splits[PATH_MAX + 16];
+        char in_base[PATH_MAX];
+        snprintf(in_base, sizeof(in_base), "%.*s",
+                 (int)(strlen(job->path) - strlen(SUFFIX_STROKES_BIN)), job->path);
+        snprintf(device_splits, sizeof(device_splits), "%s" SUFFIX_SPLITS_CSV, in_base);
+        snprintf(path, sizeof(path), "%s" SUFFIX_SPLITS_CSV, base);
+
+        if (access(device_splits, R_OK) != 0)
+            err |= write_splits_csv(&s, path);
+        else if (strcmp(device_splits, path) != 0)
+            err |= copy_file(device_splits, path);
+    }
+    if (s_ctx.outputs & OUT_GPX) {
+        snprintf(path, sizeof(path), "%s.gpx", base);
+        err |= write_gpx(&s, path);
+    }
+    if (s_ctx.outputs & OUT_TCX) {
+        snprintf(path, sizeof(path), "%s.tcx", base);
+        err |= write_tcx(&s, path);
+    }
+    if (s_ctx.outputs & OUT_FIT) {
+        snprintf(path, sizeof(path), "%s.fit", base);
+        err |= write_fit(&s, path);
+    }
+
+    job->summarised = true;
+    job->start_utc_us = s.hdr.start_utc_us;
+    job->distance_m = s.n_rows ? s.rows[s.n_rows - 1].total_distance_m : 0.0f;
+    memcpy(job->best_effort, s.best_effort, sizeof(job->best_effort));
+
+    report("%s: %zu strokes, %zu laps%s\n", job->path, s.n_rows, s.n_laps,
+           s.bad_blocks ? " (damaged blocks skipped)" : "");
+    s_ctx.rows += s.n_rows;
+    session_free(&s);
+    return err ? -1 : 0;
+}
+
+static int convert_raw(const job_t *job, const mapped_file_t *m)
+{
+    if (!(s_ctx.outputs & OUT_RAW))
+        return 0;
+
+    char base[PATH_MAX], path[PATH_MAX + 16];
+    output_base(job->path, ACTIVITY_RAW_FILE_SUFFIX, base, sizeof(base));
+    snprintf(path, sizeof(path), "%s" SUFFIX_RAW_CSV, base);
+
+    raw_export_stats_t st;
+    int err = write_raw_csv(m, path, &st);
+
+    report("%s: %u blocks, %llu IMU, %llu GPS, %u bad, %u dropped on device\n", job->path, st.blocks,
+           (unsigned long long)st.imu, (unsigned long long)st.gps, st.bad_blocks, st.dropped_blocks);
+    s_ctx.raw_records += st.imu + st.gps;
+    return err;
+}
+
+static void *worker(void *arg)
+{
+    (void)arg;
+    for (;;) {
+        size_t i = atomic_fetch_add(&s_ctx.next, 1);
+        if (i >= s_ctx.n_jobs)
+            break;
+
+        job_t *job = &s_ctx.jobs[i];
+        mapped_file_t m;
+        if (map_file(job->path, &m) != 0) {
+            fprintf(stderr, "rowlog_convert: %s: %s\n", job->path, strerror(errno));
+            s_ctx.failed++;
+            continue;
+        }
+
+        int err = (job->kind == JOB_STROKES) ? convert_strokes(job, &m) : convert_raw(job, &m);
+        if (err)
+            s_ctx.failed++;
+        unmap_file(&m);
+    }
+    return NULL;
+}
+
+/* -------------------------------------------------------------------------- */
+/* Best efforts                                                               */
+/* -------------------------------------------------------------------------- */
+
+static int by_start(const void *a, const void *b)
+{
+    const job_t *x = *(const job_t *const *)a, *y = *(const job_t *const *)b;
+    return (x->start_utc_us > y->start_utc_us) - (x->start_utc_us < y->start_utc_us);
+}
+
+/* Times as on the data page, meters whole; empty when not reached. */
+static char *put_best(char *p, int i, float v)
+{
+    *p++ = ',';
+    if (!(v > 0.0f))
+        return p;
+    return p + (best_effort_targets[i].is_time ? ff_u32(p, (uint32_t)(v + 0.5f)) : ff_clock(p, v));
+}
+
+static int write_best_efforts(void)
+{
+    char path[PATH_MAX];
+    snprintf(path, sizeof(path), "%s%s" BEST_EFFORTS_CSV, s_ctx.out_dir ? s_ctx.out_dir : "",
+             s_ctx.out_dir ? "/" : "");
+
+    const job_t **order = malloc(s_ctx.n_jobs * sizeof(*order));
+    if (!order)
+        return -1;
+    size_t n = 0;
+    for (size_t i = 0; i < s_ctx.n_jobs; i++) {
+        if (s_ctx.jobs[i].summarised)
+            order[n++] = &s_ctx.jobs[i];
+    }
+    qsort(order, n, sizeof(*order), by_start);
+
+    FILE *f = open_output(path);
+    if (!f) {
+        free(order);
+        fprintf(stderr, "rowlog_convert: %s: %s\n", path, strerror(errno));
+        return -1;
+    }
+
+    fputs("Session,Start (UTC),Distance (m)", f);
+    for (int i = 0; i < BEST_EFFORT_COUNT; i++)
+        fprintf(f, ",Best %s%s", best_effort_targets[i].name, best_effort_targets[i].is_time ? " (m)" : "");
+    fputc('\n', f);
+
+    float archive[BEST_EFFORT_COUNT] = {0};
+    for (size_t j = 0; j < n; j++) {
+        const job_t *job = order[j];
+        const char *name = strrchr(job->path, '/');
+        name = name ? name + 1 : job->path;
+
+        char line[PATH_MAX + 128], *p = line;
+        p += sprintf(p, "%.*s,", (int)(strlen(name) - strlen(SUFFIX_STROKES_BIN)), name);
+        p += ff_datetime(p, job->start_utc_us / 1000000);
+        *p++ = ',';
+        p += ff_u32(p, (uint32_t)(job->distance_m + 0.5f));
+        for (int i = 0; i < BEST_EFFORT_COUNT; i++) {
+            float v = job->best_effort[i];
+            p = put_best(p, i, v);
+            if (v > 0.0f && (archive[i] == 0.0f || (best_effort_targets[i].is_time ? v > archive[i] : v < archive[i])))
+                archive[i] = v;
+        }
+        *p++ = '\n';
+        fwrite(line, 1, (size_t)(p - line), f);
+    }
+
+    char line[128], *p = line;
+    p += sprintf(p, "All sessions,,");
+    for (int i = 0; i < BEST_EFFORT_COUNT; i++)
+        p = put_best(p, i, archive[i]);
+    *p++ = '\n';
+    fwrite(line, 1, (size_t)(p - line), f);
+
+    free(order);
+    return close_output(f, path);
+}
+
+/* -------------------------------------------------------------------------- */
+/* Main                                                                       */
+/* -------------------------------------------------------------------------- */
+
+static unsigned parse_outputs(const char *list)
+{
+    static const struct { const char *name; unsigned bit; } names[] = {
+        { "csv", OUT_CSV }, { "gpx", OUT_GPX }, { "tcx", OUT_TCX }, { "fit", OUT_FIT }, { "raw", OUT_RAW },
+        { "best", OUT_BEST },
+    };
+    unsigned bits = 0;
+    char *copy = strdup(list), *save = NULL;
+    for (char *tok = strtok_r(copy, ",", &save); tok; tok = strtok_r(NULL, ",", &save)) {
+        size_t i;
+        for (i = 0; i < sizeof(names) / sizeof(names[0]); i++) {
+            if (strcmp(tok, names[i].name) == 0) {
+                bits |= names[i].bit;
+                break;
+            }
+        }
+        if (i == sizeof(names) / sizeof(names[0])) {
+            fprintf(stderr, "rowlog_convert: unknown output type '%s'\n", tok);
+            bits = 0;
+            break;
+        }
+    }
+    free(copy);
+    return bits;
+}
+
+static void usage(void)
+{
+    fprintf(stderr, "usage: rowlog_convert [-j jobs] [-o outdir] [-t csv,gpx,tcx,fit,raw,best] [-q] <file|dir>...\n");
+    exit(2);
+}
+
+int main(int argc, char **argv)
+{
+    long jobs = sysconf(_SC_NPROCESSORS_ONLN);
+    int opt;
+    while ((opt = getopt(argc, argv, "j:o:t:qh")) != -1) {
+        switch (opt) {
+        case 'j': jobs = strtol(optarg, NULL, 10); break;
+        case 'o': s_ctx.out_dir = optarg; break;
+        case 't':
+            s_ctx.outputs = parse_outputs(optarg);
+            if (!s_ctx.outputs) usage();
+            break;
+        case 'q': s_ctx.quiet = true; break;
+        default:  usage();
+        }
+    }
+    if (optind >= argc)
+        usage();
+    if (jobs < 1)
+        jobs = 1;
+
+    if (s_ctx.out_dir && mkdir(s_ctx.out_dir, 0775) != 0 && errno != EEXIST) {
+        fprintf(stderr, "rowlog_convert: %s: %s\n", s_ctx.out_dir, strerror(errno));
+        return 1;
+    }
+
+    for (int i = optind; i < argc; i++)
+        scan(argv[i], true);
+    if (s_ctx.n_jobs == 0) {
+        fprintf(stderr, "rowlog_convert: no session logs found\n");
+        return 1;
+    }
+    qsort(s_ctx.jobs, s_ctx.n_jobs, sizeof(*s_ctx.jobs), by_size_desc);
+
+    // The CRC table is built lazily; do it before the workers race for it
+    alog_crc32(0, NULL, 0);
+
+    struct timespec t0, t1;
+    clock_gettime(CLOCK_MONOTONIC, &t0);
+
+    if ((size_t)jobs > s_ctx.n_jobs)
+        jobs = (long)s_ctx.n_jobs;
+    pthread_t *threads = calloc((size_t)jobs, sizeof(*threads));
+    for (long i = 0; i < jobs; i++)
+        pthread_create(&threads[i], NULL, worker, NULL);
+    for (long i = 0; i < jobs; i++)
+        pthread_join(threads[i], NULL);
+    free(threads);
+
+    if ((s_ctx.outputs & OUT_BEST) && write_best_efforts() != 0)
+        s_ctx.failed++;
+
+    clock_gettime(CLOCK_MONOTONIC, &t1);
+    double secs = (double)(t1.tv_sec - t0.tv_sec) + (double)(t1.tv_nsec - t0.tv_nsec) * 1e-9;
+
+    if (!s_ctx.quiet)
+        fprintf(stderr, "%zu files (%llu strokes, %llu raw records) in %.2f s on %ld threads, %u failed\n",
+                s_ctx.n_jobs, (unsigned long long)s_ctx.rows, (unsigned long long)s_ctx.raw_records, secs,
+                jobs, (unsigned)s_ctx.failed);
+
+    for (size_t i = 0; i < s_ctx.n_jobs; i++)
+        free(s_ctx.jobs[i].path);
+    free(s_ctx.jobs);
+    return s_ctx.failed ? 1 : 0;
+}
@@ -0,0 +1,74 @@
+// tools/rowlog_convert/rowlog_convert.h
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#include "activity_log_bin.h"
+#include "activity_log_split.h"
+#include "activity_log_types.h"
+#include "best_effort.h"
+
+typedef struct {
+    const uint8_t *data;
+    size_t len;
+} mapped_file_t;
+
+/* Read-only mmap of a whole file. Empty files map to {NULL, 0}. */
+int  map_file(const char *path, mapped_file_t *m);
+void unmap_file(mapped_file_t *m);
+
+/* Open for writing with a large stdio buffer (outputs are written row by row). */
+FILE *open_output(const char *path);
+int   close_output(FILE *f, const char *path);
+
+/* One distance split, plus the rows it covers. */
+typedef struct {
+    size_t  first, end;         // rows [first, end)
+    int64_t start_utc_us;
+    float   time_s;
+    float   dist_m;
+    float   avg_spm;
+    float   max_spm;
+    float   avg_power_w;
+    float   max_speed_mps;
+    uint32_t strokes;
+    bool    closed;             // ended on a split boundary (false: session end)
+    activity_log_split_row_t split;
+} session_lap_t;
+
+typedef struct {
+    alog_bin_file_hdr_t hdr;
+    activity_log_row_t *rows;
+    size_t n_rows;
+    session_lap_t *laps;
+    size_t n_laps;
+    uint32_t bad_blocks;
+    float best_effort[BEST_EFFORT_COUNT];   // as the device's summary
+} session_t;
+
+/* Decode a mapped "<base>_Strokes.bin". Returns 0 on success. */
+int  session_load(const mapped_file_t *m, session_t *s);
+void session_free(session_t *s);
+
+int write_strokes_csv(const session_t *s, const char *path);
+int write_splits_csv(const session_t *s, const char *path);
+int write_gpx(const session_t *s, const char *path);
+int write_tcx(const session_t *s, const char *path);
+int write_fit(const session_t *s, const char *path);
+
+typedef struct {
+    uint32_t blocks;
+    uint32_t bad_blocks;
+    uint32_t dropped_blocks;    // as reported by the device
+    uint64_t imu;
+    uint64_t gps;
+} raw_export_stats_t;
+
+/* Decode a mapped "<base>_Raw.bin" (plain or Rice-coded blocks) to CSV. */
+int write_raw_csv(const mapped_file_t *m, const char *path, raw_export_stats_t *st);
+
+/* "YYYY-MM-DDTHH:MM:SS[.mmm]Z" */
+void format_iso8601(int64_t utc_us, bool with_ms, char *buf, size_t len);
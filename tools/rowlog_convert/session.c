@@ -0,0 +1,206 @@
+// tools/rowlog_convert/session.c
+#include "rowlog_convert.h"
+
+#include <fcntl.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "activity_log_csv.h"
+
+#define OUTPUT_BUF_SIZE (1 << 20)
+
+/* -------------------------------------------------------------------------- */
+/* Files                                                                      */
+/* -------------------------------------------------------------------------- */
+
+int map_file(const char *path, mapped_file_t *m)
+{
+    m->data = NULL;
+    m->len = 0;
+
+    int fd = open(path, O_RDONLY);
+    if (fd < 0)
+        return -1;
+
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+        close(fd);
+        return -1;
+    }
+    if (st.st_size == 0) {
+        close(fd);
+        return 0;
+    }
+
+    void *p = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (p == MAP_FAILED)
+        return -1;
+
+    madvise(p, (size_t)st.st_size, MADV_SEQUENTIAL);
+    m->data = p;
+    m->len = (size_t)st.st_size;
+    return 0;
+}
+
+void unmap_file(mapped_file_t *m)
+{
+    if (m->data)
+        munmap((void *)m->data, m->len);
+    m->data = NULL;
+    m->len = 0;
+}
+
+FILE *open_output(const char *path)
+{
+    FILE *f = fopen(path, "wb");
+    if (f)
+        setvbuf(f, NULL, _IOFBF, OUTPUT_BUF_SIZE);
+    return f;
+}
+
+int close_output(FILE *f, const char *path)
+{
+    int err = ferror(f);
+    if (fclose(f) != 0 || err) {
+        fprintf(stderr, "rowlog_convert: write %s failed\n", path);
+        return -1;
+    }
+    return 0;
+}
+
+void format_iso8601(int64_t utc_us, bool with_ms, char *buf, size_t len)
+{
+    time_t ts = (time_t)(utc_us / 1000000);
+    struct tm tm_utc;
+    gmtime_r(&ts, &tm_utc);
+    size_t n = strftime(buf, len, "%Y-%m-%dT%H:%M:%S", &tm_utc);
+    if (with_ms)
+        snprintf(buf + n, len - n, ".%03dZ", (int)((utc_us / 1000) % 1000));
+    else
+        snprintf(buf + n, len - n, "Z");
+}
+
+/* -------------------------------------------------------------------------- */
+/* Decode                                                                     */
+/* -------------------------------------------------------------------------- */
+
+/* Append the split the engine just closed: rows [first, end) plus its totals. */
+static int lap_add(session_t *s, size_t *cap, size_t first, size_t end, int64_t start_session_us,
+                   const activity_log_split_row_t *split, bool closed)
+{
+    if (s->n_laps == *cap) {
+        size_t n = *cap ? *cap * 2 : 16;
+        session_lap_t *laps = realloc(s->laps, n * sizeof(*laps));
+        if (!laps)
+            return -1;
+        s->laps = laps;
+        *cap = n;
+    }
+
+    session_lap_t *lap = &s->laps[s->n_laps++];
+    *lap = (session_lap_t){
+        .first = first,
+        .end = end,
+        .start_utc_us = s->hdr.start_utc_us + start_session_us + (start_session_us * s->hdr.rate_ppb) / 1000000000LL,
+        .time_s = split->split_time_s,
+        .dist_m = split->split_dist_m,
+        .avg_spm = split->avg_spm,
+        .avg_power_w = split->avg_power_w,
+        .strokes = split->stroke_count,
+        .closed = closed,
+        .split = *split,
+    };
+
+    for (size_t i = first; i < end; i++) {
+        const activity_log_row_t *r = &s->rows[i];
+        float speed = (r->pace_500m_s > 0) ? 500.0f / r->pace_500m_s : 0;
+        if (r->spm_instant > lap->max_spm) lap->max_spm = r->spm_instant;
+        if (speed > lap->max_speed_mps) lap->max_speed_mps = speed;
+    }
+    return 0;
+}
+
+int session_load(const mapped_file_t *m, session_t *s)
+{
+    memset(s, 0, sizeof(*s));
+    if (!alog_bin_parse_header(m->data, m->len, &s->hdr))
+        return -1;
+
+    size_t body = m->len > ALOG_BIN_HEADER_SIZE ? m->len - ALOG_BIN_HEADER_SIZE : 0;
+    size_t n_blocks = (body + ALOG_BIN_BLOCK_SIZE - 1) / ALOG_BIN_BLOCK_SIZE;
+
+    s->rows = malloc((n_blocks * ALOG_BIN_RECORDS_PER_BLOCK + 1) * sizeof(*s->rows));
+    if (!s->rows)
+        return -1;
+
+    alog_bin_unpack_state_t st = {0};
+    alog_csv_roll_t roll;
+    alog_csv_roll_init(&roll);
+    for (uint32_t seq = 0; seq < n_blocks; seq++) {
+        size_t off = (size_t)alog_bin_block_offset(seq);
+        size_t len = m->len - off < ALOG_BIN_BLOCK_SIZE ? m->len - off : ALOG_BIN_BLOCK_SIZE;
+
+        int count = alog_bin_check_block(m->data + off, len, seq);
+        if (count < 0) {
+            s->bad_blocks++;
+            continue;
+        }
+
+        // Records are 4-byte aligned in the mapping (page-aligned file, 16-byte block header)
+        const alog_bin_record_t *recs = alog_bin_block_records(m->data + off);
+        for (int i = 0; i < count; i++) {
+            activity_log_row_t *row = &s->rows[s->n_rows++];
+            alog_bin_unpack(&s->hdr, &recs[i], &st, row);
+            alog_csv_roll_fill(&roll, row);
+        }
+    }
+
+    // Best efforts from the stroke rows, as an index rebuild on the device finds them.
+    // The ring holds the whole session, so no window is cut short.
+    uint32_t cap_pts = 2;
+    while (cap_pts < s->n_rows + 1) cap_pts <<= 1;
+    best_effort_point_t *pts = malloc(cap_pts * sizeof(*pts));
+    if (!pts)
+        return -1;
+    best_effort_t be;
+    best_effort_init(&be, pts, cap_pts);
+    for (size_t i = 0; i < s->n_rows; i++)
+        best_effort_update(&be, s->rows[i].session_time_us, s->rows[i].total_distance_m);
+    best_effort_finish(&be);
+    best_effort_get(&be, s->best_effort);
+    free(pts);
+
+    // Splits the way the device cut them, plus the unfinished one at the end.
+    // Stroke rows are the only samples left, so boundaries interpolate between catches.
+    alog_split_state_t sp;
+    alog_split_init(&sp, (alog_split_mode_t)s->hdr.split_mode, (float)s->hdr.split_interval);
+    activity_log_split_row_t split;
+    size_t cap = 0, first = 0;
+    for (size_t i = 0; i < s->n_rows; i++) {
+        const activity_log_row_t *r = &s->rows[i];
+        int64_t start_us = sp.start_time_us;
+        while (alog_split_sample(&sp, r->session_time_us, r->total_distance_m, &split)) {
+            if (lap_add(s, &cap, first, i, start_us, &split, true) != 0)
+                return -1;
+            first = i;
+            start_us = sp.start_time_us;
+        }
+        alog_split_stroke(&sp, r->spm_instant, r->power_w);
+    }
+    int64_t start_us = sp.start_time_us;
+    if (alog_split_finish(&sp, &split) && lap_add(s, &cap, first, s->n_rows, start_us, &split, false) != 0)
+        return -1;
+    return 0;
+}
+
+void session_free(session_t *s)
+{
+    free(s->rows);
+    free(s->laps);
+    memset(s, 0, sizeof(*s));
+}